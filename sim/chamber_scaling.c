@@ -0,0 +1,81 @@
+/**
+ * Filament Dryer - Verificação do custo por câmara
+ *
+ * Roda o simulador compilado com 1, 2, 3 e 4 câmaras (CHAMBER_COUNT) por uma
+ * hora simulada e lê o tempo ocupado do núcleo 0 por iteração do loop de
+ * controle ("core0 busy per cycle" no relatório). Cada câmara a mais tem que
+ * custar o mesmo: os incrementos ficam a menos de CHECK_TOLERANCE da média.
+ *
+ * Uso: chamber_scaling sim1 sim2 sim3 sim4 (código de saída 0 = passou; roda
+ * pelo ctest com os dryer_sim_chambersN)
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK_MAX_CHAMBERS 4
+#define CHECK_HOURS "1"
+#define CHECK_TOLERANCE 0.15           // Desvio aceito de cada incremento (fração da média)
+
+static int failures;
+
+static void expect(int ok, const char *what) {
+    printf("%s: %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+// Tempo ocupado por iteração (ms) no relatório do simulador; < 0 se faltar
+static double run_sim(const char *path) {
+    char command[1024];
+    snprintf(command, sizeof(command), "\"%s\" --hours " CHECK_HOURS, path);
+    FILE *out = popen(command, "r");
+    if (!out) {
+        return -1.0;
+    }
+    double busy_ms = -1.0;
+    char line[512];
+    while (fgets(line, sizeof(line), out)) {
+        const char *field = strstr(line, "core0 busy per cycle:");
+        if (field) {
+            sscanf(field + strlen("core0 busy per cycle:"), "%lf", &busy_ms);
+        }
+    }
+    if (pclose(out) != 0) {
+        return -1.0;
+    }
+    return busy_ms;
+}
+
+int main(int argc, char **argv) {
+    int count = argc - 1;
+    if (count < 3 || count > CHECK_MAX_CHAMBERS) {
+        fprintf(stderr, "usage: %s sim1 sim2 sim3 [sim4] (one build per chamber count)\n", argv[0]);
+        return 2;
+    }
+
+    double busy[CHECK_MAX_CHAMBERS];
+    for (int i = 0; i < count; i++) {
+        busy[i] = run_sim(argv[i + 1]);
+        if (busy[i] < 0.0) {
+            fprintf(stderr, "%s: no 'core0 busy per cycle' in the report\n", argv[i + 1]);
+            return 1;
+        }
+        printf("%d chamber(s): %.3f ms per cycle\n", i + 1, busy[i]);
+    }
+
+    double mean = (busy[count - 1] - busy[0]) / (count - 1);
+    printf("mean cost per added chamber: %.3f ms\n", mean);
+    expect(mean > 0.0, "each chamber adds work to the cycle");
+
+    double worst = 0.0;
+    for (int i = 1; i < count; i++) {
+        double step = busy[i] - busy[i - 1];
+        worst = fmax(worst, fabs(step - mean) / mean);
+    }
+    printf("worst deviation from the mean step: %.1f%%\n", 100.0 * worst);
+    expect(worst <= CHECK_TOLERANCE, "cost per cycle grows linearly with the chamber count");
+    return failures ? 1 : 0;
+}
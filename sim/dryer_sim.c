@@ -0,0 +1,910 @@
+/**
+ * Filament Dryer - Simulador de host em malha fechada
+ *
+ * Roda o firmware real (main, PID, sensor_manager, hardware_control, display)
+ * contra a HAL simulada e o modelo térmico da estufa. Uma sessão de 24 h
+ * roda em segundos e gera as métricas de controle para avaliar qualquer
+ * mudança antes de gravar o firmware na estufa.
+ *
+ * Com CHAMBER_COUNT > 1 cada câmara tem a sua planta, todas no setpoint
+ * padrão; o roteiro, as falhas injetadas e o ACS712/NTC ficam na primeira.
+ *
+ * --profile segura o botão no boot e solta no perfil pedido (seleção do
+ * drying_profile); o setpoint passa a ser do perfil, sem roteiro nem
+ * métricas por trecho. --flash guarda o flash em arquivo no fim e o carrega
+ * no início: duas execuções seguidas simulam uma queda de energia (o
+ * setpoint também fica com o perfil continuado).
+ *
+ * Uso:
+ *   dryer_sim [--hours H] [--setpoint C] [--step S:C]... [--ambient C]
+ *             [--band C] [--dht-dropout S:D] [--supply S:V] [--spi-stall S:D]
+ *             [--sensor-detach S] [--fan-fail S] [--fan-slow S:RPM] [--drive S:MODO]
+ *             [--profile NOME] [--flash arquivo] [--csv arquivo]
+ */
+
+#include "sim_hal.h"
+#include "thermal_plant.h"
+#include "sensor_manager.h"
+#include "hardware_control.h"
+#include "button_controller.h"
+#include "ntc.h"
+#include "safety_supervisor.h"
+#include "drying_profile.h"
+#include "dryer_config.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#define PLANT_STEP_US 100000           // Passo da planta: 100 ms
+#define CSV_INTERVAL_US 10000000       // Uma linha do CSV a cada 10 s
+#define MAX_SEGMENTS 16                // Setpoint inicial + mudanças (--step)
+#define MAX_BUTTON_EVENTS 512
+#define NOISE_SETTLE_US 600000000ULL   // Ruído da saída medido 10 min após entrar na banda
+#define DETACHED_SENSOR_TAU_S 60.0f    // Sensor solto esfria até o ambiente com esta constante
+#define FAN_FAIL_BLOCK_TO_AIR 0.15f    // Bloco -> ar só por convecção natural (W/K)
+#define FAN_NOMINAL_RPM 3000.0f        // Ventoinha de circulação saudável (tacômetro: 2 pulsos/volta)
+#define SPOOL_DRY_MASS_G 1250.0f       // Carretel vazio (250 g) + 1 kg de filamento seco
+#define HX711_RATE_HZ 10.0f            // Pino RATE em GND
+#define HX711_NOISE_COUNTS 150         // Ruído de pico por conversão (~0.35 g)
+
+// Botão: pressões curtas (+1°C) geradas pelo roteiro de setpoints
+#define BUTTON_FIRST_PRESS_US 4000000  // Depois da tela de inicialização (3 s)
+#define BUTTON_PRESS_US 250000
+#define BUTTON_PERIOD_US 600000
+
+// ACS712 5A com polaridade invertida (como recomendado no sensor_manager)
+#define ACS712_ZERO_VOLTAGE 2.5f
+#define ACS712_SENSITIVITY 0.185f
+
+// MOSFET do heater com o gate direto no GPIO: cada borda leva ~1 us com
+// tensão e corrente cheias se cruzando (E = V * I * t / 2). Estimativa.
+#define MOSFET_EDGE_TIME_S 1e-6
+
+int dryer_firmware_main(void);
+
+// Métricas de um trecho com setpoint constante
+typedef struct {
+    float setpoint;
+    uint64_t start_us;
+    uint64_t end_us;
+    float start_temp;
+
+    bool reached;                // Temperatura real já entrou na banda
+    uint64_t reached_us;
+    bool in_band_since_valid;
+    uint64_t in_band_since_us;   // Início do último intervalo contínuo dentro da banda
+    float max_temp;
+    float min_temp;
+    double band_time_s;          // Tempo dentro da banda após entrar nela
+    double tracked_time_s;       // Tempo após entrar na banda
+    double error_sum;            // Soma do erro (°C·s) após entrar na banda
+    double iae;                  // Integral do erro absoluto (°C·s)
+    double energy_start_j;
+    double energy_j;
+    uint32_t cutoffs;
+    double duty_step_sq;         // Soma dos quadrados da variação do PWM por ciclo (após a banda)
+    uint32_t duty_steps;
+} segment_metrics_t;
+
+// Câmaras além da primeira (CHAMBER_COUNT): setpoint padrão o tempo todo
+typedef struct {
+    bool in_band_since_valid;
+    uint64_t in_band_since_us;   // Início do último intervalo contínuo dentro da banda
+    double iae;                  // Integral do erro absoluto (°C·s)
+    float peak_air_temp;
+} chamber_metrics_t;
+
+typedef struct {
+    thermal_plant_t plant[CHAMBER_COUNT];  // Uma estufa por câmara; a primeira segue o roteiro
+    chamber_metrics_t chamber[CHAMBER_COUNT];
+    float band;
+
+    // Roteiro de setpoints (temperatura e instante em que o botão começa)
+    segment_metrics_t seg[MAX_SEGMENTS];
+    int seg_count;
+    int seg_current;             // -1 antes do primeiro setpoint valer
+
+    // Roteiro do botão
+    uint64_t button_time[MAX_BUTTON_EVENTS];
+    bool button_level[MAX_BUTTON_EVENTS];
+    int button_count;
+    int button_next;
+    float firmware_target;       // Setpoint que o firmware tem no momento
+    bool profile_mode;           // Botão só escolhe o perfil no boot (setpoint do perfil)
+
+    // Falha injetada no DHT22
+    uint64_t dropout_start_us;
+    uint64_t dropout_end_us;
+
+    // Perturbação injetada: tensão da fonte do heater muda (ex: fonte fraca)
+    uint64_t supply_change_us;
+    float supply_voltage;
+
+    // Falhas injetadas para o detector de thermal runaway
+    uint64_t sensor_detach_us;   // DHT22 cai do carretel: passa a ler perto do ambiente
+    float detached_temp;
+    uint64_t fan_fail_us;        // Ventoinha para: bloco quase não troca calor com o ar
+    uint64_t fan_slow_us;        // Ventoinha perde rotação (rolamento gasto)
+    float fan_slow_rpm;
+    float block_to_air;          // Condutância com a ventoinha em FAN_NOMINAL_RPM
+    uint64_t fan_cut_us;         // Supervisor cortou o heater pela ventoinha (0 = não)
+    uint64_t runaway_cut_us;     // ... pelo thermal runaway
+
+    // Troca do acionamento do heater em operação (--drive)
+    uint64_t drive_change_us;
+    heater_drive_t drive;
+
+    // Perda de chaveamento do MOSFET (bordas nos pinos do heater)
+    uint64_t last_edges;
+    double switching_loss_j;
+
+    // Corrente da fonte do heater: pico instantâneo (fases das zonas), pico
+    // médio no tempo, valor eficaz e média
+    float peak_current;
+    double peak_time_as;
+    double square_a2s;
+    double charge_c;
+
+    // Picos reais (o que o firmware não vê com o sensor solto)
+    float peak_air_temp;
+    float peak_block_temp;
+
+    // Proteção de overshoot vista de fora (mesma regra do main)
+    float last_reported_temp;
+    bool overshoot_active;
+
+    // Secagem da primeira câmara: exaustão e instante/energia em que saiu
+    // metade e 90% da água do filamento
+    double vent_duty_s;          // Integral do duty da exaustão (s)
+    double vent_on_s;            // Tempo com a exaustão girando
+    double dry_time_s[2];
+    double dry_energy_j[2];
+    float last_water;
+    float water_rate_gph;        // Saída de água do filamento no último passo (g/h)
+
+    // Ruído da saída: PWM amostrado a cada ciclo de controle do firmware
+    uint64_t next_duty_sample_us;
+    float last_duty_sample;
+
+    FILE *csv;
+    uint64_t next_csv_us;
+} sim_context_t;
+
+static sim_context_t sim;
+
+// Saídas do heater: zonas (HEATER_ZONE_COUNT, mesma resistência total dividida
+// em partes iguais, uma por pino, todas na primeira câmara) ou o heater
+// inteiro de cada câmara (CHAMBER_COUNT)
+#if CHAMBER_COUNT > 1
+#define SIM_HEATER_OUTPUTS CHAMBER_COUNT
+#else
+#define SIM_HEATER_OUTPUTS HEATER_ZONE_COUNT
+#endif
+
+// Pinos de cada câmara, na ordem de CHAMBER_TABLE
+static const struct {
+    uint8_t dht22_pin;
+    uint8_t heater_pin;
+    uint8_t energy_pin;
+    uint8_t ntc_pin;
+    uint8_t vent_pin;
+    uint8_t tach_pin;
+} chamber_table[] = CHAMBER_TABLE;
+
+static uint output_pins[SIM_HEATER_OUTPUTS];
+
+// Agenda as pressões curtas necessárias para ir de 'from' até 'to' (com a
+// mesma volta de TEMP_MAX para TEMP_MIN do button_controller)
+static uint64_t schedule_presses(float from, float to, uint64_t start_us) {
+    uint64_t t = start_us;
+    float target = from;
+    int guard = 0;
+
+    while (fabsf(target - to) > 0.01f && guard++ < (TEMP_MAX - TEMP_MIN + 1)) {
+        if (sim.button_count + 2 > MAX_BUTTON_EVENTS) {
+            break;
+        }
+        sim.button_time[sim.button_count] = t;
+        sim.button_level[sim.button_count++] = false;   // Pressionado (pull-up)
+        sim.button_time[sim.button_count] = t + BUTTON_PRESS_US;
+        sim.button_level[sim.button_count++] = true;
+        t += BUTTON_PERIOD_US;
+
+        target += TEMP_STEP_SINGLE;
+        if (target > TEMP_MAX) {
+            target = TEMP_MIN;
+        }
+    }
+    return t;
+}
+
+static void segment_close(segment_metrics_t *s, uint64_t now_us) {
+    s->end_us = now_us;
+    s->energy_j = sim.plant[0].energy_j - s->energy_start_j;
+}
+
+static void segment_open(int index, uint64_t now_us) {
+    segment_metrics_t *s = &sim.seg[index];
+    s->start_us = now_us;
+    s->start_temp = sim.plant[0].air_temp;
+    s->max_temp = sim.plant[0].air_temp;
+    s->min_temp = sim.plant[0].air_temp;
+    s->energy_start_j = sim.plant[0].energy_j;
+    sim.seg_current = index;
+}
+
+static void update_metrics(uint64_t now_us, float dt) {
+    if (sim.seg_current < 0) {
+        return;
+    }
+    segment_metrics_t *s = &sim.seg[sim.seg_current];
+    float temp = sim.plant[0].air_temp;
+    float error = temp - s->setpoint;
+
+    if (fabsf(error) <= sim.band) {
+        if (!s->reached) {
+            s->reached = true;
+            s->reached_us = now_us;
+        }
+        if (!s->in_band_since_valid) {
+            s->in_band_since_valid = true;
+            s->in_band_since_us = now_us;
+        }
+    } else {
+        s->in_band_since_valid = false;
+    }
+
+    if (s->reached) {
+        s->tracked_time_s += dt;
+        s->error_sum += error * dt;
+        if (fabsf(error) <= sim.band) {
+            s->band_time_s += dt;
+        }
+    }
+    if (temp > s->max_temp) {
+        s->max_temp = temp;
+    }
+    if (temp < s->min_temp) {
+        s->min_temp = temp;
+    }
+    s->iae += fabsf(error) * dt;
+
+    // Variação do PWM por ciclo de controle em regime (10 min após entrar na banda,
+    // fora da transição do pré-aquecimento): ruído que chega ao heater
+    if (now_us >= sim.next_duty_sample_us) {
+        sim.next_duty_sample_us = now_us + UPDATE_INTERVAL_MS * 1000ULL;
+        if (s->reached && now_us >= s->reached_us + NOISE_SETTLE_US) {
+            float step = (sim.plant[0].duty - sim.last_duty_sample) * 100.0f;
+            s->duty_step_sq += step * step;
+            s->duty_steps++;
+        }
+        sim.last_duty_sample = sim.plant[0].duty;
+    }
+
+    // Corte de segurança: mesma condição do main sobre a última leitura do DHT22
+    bool overshoot = sim.last_reported_temp > sim.firmware_target + TEMP_OVERSHOOT_LIMIT;
+    if (overshoot && !sim.overshoot_active) {
+        s->cutoffs++;
+    }
+    sim.overshoot_active = overshoot;
+}
+
+// Banda, IAE e pico de cada câmara em torno do setpoint padrão
+static void update_chamber_metrics(uint64_t now_us, float dt) {
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        chamber_metrics_t *m = &sim.chamber[c];
+        float error = sim.plant[c].air_temp - TEMP_TARGET_DEFAULT;
+        if (fabsf(error) <= sim.band) {
+            if (!m->in_band_since_valid) {
+                m->in_band_since_valid = true;
+                m->in_band_since_us = now_us;
+            }
+        } else {
+            m->in_band_since_valid = false;
+        }
+        m->iae += fabsf(error) * dt;
+        if (sim.plant[c].air_temp > m->peak_air_temp) {
+            m->peak_air_temp = sim.plant[c].air_temp;
+        }
+    }
+}
+
+static void plant_step(void *ctx, uint64_t now_us) {
+    (void)ctx;
+    const float dt = PLANT_STEP_US / 1e6f;
+
+    // Botão: aplicar eventos agendados e acompanhar o setpoint do firmware
+    while (sim.button_next < sim.button_count && sim.button_time[sim.button_next] <= now_us) {
+        bool level = sim.button_level[sim.button_next++];
+        sim_hal_set_gpio_input(BUTTON_PIN, level);
+        if (level && !sim.profile_mode) {
+            sim.firmware_target += TEMP_STEP_SINGLE;
+            if (sim.firmware_target > TEMP_MAX) {
+                sim.firmware_target = TEMP_MIN;
+            }
+        }
+    }
+
+    // Trecho de setpoint começa quando o firmware recebeu a última pressão
+    int next = sim.seg_current + 1;
+    if (next < sim.seg_count && fabsf(sim.firmware_target - sim.seg[next].setpoint) < 0.01f &&
+        now_us >= sim.seg[next].start_us) {
+        if (sim.seg_current >= 0) {
+            segment_close(&sim.seg[sim.seg_current], now_us);
+        }
+        segment_open(next, now_us);
+    }
+
+    if (now_us >= sim.supply_change_us) {
+        for (int c = 0; c < CHAMBER_COUNT; c++) {
+            sim.plant[c].p.supply_voltage = sim.supply_voltage;
+        }
+    }
+    // Ventoinha: troca bloco -> ar cai com a vazão (~RPM^0.8, convecção
+    // forçada) até só a convecção natural; o tacômetro segue o RPM
+    float fan_rpm = now_us >= sim.fan_fail_us ? 0.0f :
+                    now_us >= sim.fan_slow_us ? sim.fan_slow_rpm : FAN_NOMINAL_RPM;
+    if (fan_rpm != FAN_NOMINAL_RPM) {
+        sim.plant[0].p.block_to_air = FAN_FAIL_BLOCK_TO_AIR + (sim.block_to_air - FAN_FAIL_BLOCK_TO_AIR) *
+                                      powf(fan_rpm / FAN_NOMINAL_RPM, 0.8f);
+    }
+    if (chamber_table[0].tach_pin != SENSOR_PIN_NONE) {
+        sim_hal_set_gpio_pulses(chamber_table[0].tach_pin, fan_rpm * 2.0f / 60.0f);
+    }
+    safety_supervisor_stats_t safety;
+    safety_supervisor_get_stats(&safety);
+    if (!sim.fan_cut_us && (safety.chamber_faults[0] & SAFETY_FAULT_FAN)) {
+        sim.fan_cut_us = now_us;
+    }
+    if (!sim.runaway_cut_us && (safety.chamber_faults[0] & SAFETY_FAULT_RUNAWAY)) {
+        sim.runaway_cut_us = now_us;
+    }
+
+    if (now_us >= sim.drive_change_us) {
+        sim.drive_change_us = UINT64_MAX;
+        hardware_control_set_heater_drive(sim.drive);
+    }
+
+    // Planta: duty cycle médio dos pinos do heater no passo
+    float full_current = sim.plant[0].p.supply_voltage / sim.plant[0].p.heater_resistance;
+    float output_current[SIM_HEATER_OUTPUTS];
+    uint64_t edges = 0;
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        sim.plant[c].duty = 0.0f;
+        sim.plant[c].vent_duty = VENT_ENABLED ? sim_hal_pwm_duty(chamber_table[c].vent_pin) : 0.0f;
+    }
+    for (int i = 0; i < SIM_HEATER_OUTPUTS; i++) {
+        thermal_plant_t *plant = &sim.plant[CHAMBER_COUNT > 1 ? i : 0];
+        output_current[i] = full_current / HEATER_ZONE_COUNT;
+        plant->duty += sim_hal_pwm_duty(output_pins[i]) / HEATER_ZONE_COUNT;
+        edges += sim_hal_pwm_edges(output_pins[i]);
+    }
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        thermal_plant_step(&sim.plant[c], dt);
+    }
+
+    sim.switching_loss_j += (double)(edges - sim.last_edges) * 0.5 * sim.plant[0].p.supply_voltage *
+                            output_current[0] * MOSFET_EDGE_TIME_S;
+    sim.last_edges = edges;
+    float peak, rms;
+    sim_hal_pwm_supply_current(output_pins, output_current, SIM_HEATER_OUTPUTS, &peak, &rms);
+    if (peak > sim.peak_current) {
+        sim.peak_current = peak;
+    }
+    sim.peak_time_as += peak * dt;
+    sim.square_a2s += rms * rms * dt;
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        sim.charge_c += sim.plant[c].duty * full_current * dt;
+    }
+
+    if (sim.plant[0].air_temp > sim.peak_air_temp) {
+        sim.peak_air_temp = sim.plant[0].air_temp;
+    }
+    if (sim.plant[0].block_temp > sim.peak_block_temp) {
+        sim.peak_block_temp = sim.plant[0].block_temp;
+    }
+    sim.vent_duty_s += sim.plant[0].vent_duty * dt;
+    sim.vent_on_s += sim.plant[0].vent_duty > 0.0f ? dt : 0.0;
+    for (int k = 0; k < 2; k++) {
+        float removed = 1.0f - sim.plant[0].water_mass / sim.plant[0].p.water_mass;
+        if (sim.dry_time_s[k] == 0.0 && removed >= (k == 0 ? 0.5f : 0.9f)) {
+            sim.dry_time_s[k] = now_us / 1e6;
+            sim.dry_energy_j[k] = sim.plant[0].energy_j;
+        }
+    }
+
+    // Célula de carga: carretel + filamento + água que ainda não saiu
+    if (now_us > PLANT_STEP_US) {
+        sim.water_rate_gph = (sim.last_water - sim.plant[0].water_mass) / dt * 3600.0f;
+    }
+    sim.last_water = sim.plant[0].water_mass;
+#if LOAD_CELL_ENABLED
+    sim_hal_hx711_set(LOAD_CELL_OFFSET +
+                      (int32_t)lroundf(LOAD_CELL_COUNTS_PER_G * (SPOOL_DRY_MASS_G + sim.plant[0].water_mass)));
+#endif
+
+    // DHT22: atraso do encapsulamento já está na planta, resolução no quadro
+    float sensor_temp = sim.plant[0].sensor_temp;
+    if (now_us >= sim.sensor_detach_us) {
+        sim.detached_temp += (sim.plant[0].p.ambient_temp - sim.detached_temp) * dt / DETACHED_SENSOR_TAU_S;
+        sensor_temp = sim.detached_temp;
+    } else {
+        sim.detached_temp = sim.plant[0].sensor_temp;
+    }
+    bool responding = !(now_us >= sim.dropout_start_us && now_us < sim.dropout_end_us);
+    sim_hal_dht22_set(DHT22_PIN, sensor_temp,
+                      thermal_plant_relative_humidity(&sim.plant[0]), responding);
+    if (responding) {
+        sim.last_reported_temp = roundf(sensor_temp * 10.0f) / 10.0f;
+    }
+#if AMBIENT_SENSOR_ENABLED
+    sim_hal_dht22_set(AMBIENT_DHT22_PIN, sim.plant[0].p.ambient_temp, sim.plant[0].p.ambient_rh, true);
+#endif
+    // Outras câmaras: só o DHT22 (sem ACS712 e NTC) e sem falhas injetadas
+    for (int c = 1; c < CHAMBER_COUNT; c++) {
+        sim_hal_dht22_set(chamber_table[c].dht22_pin, sim.plant[c].sensor_temp,
+                          thermal_plant_relative_humidity(&sim.plant[c]), true);
+    }
+
+    // ACS712: tensão cai com a corrente (saída invertida para proteger o ADC);
+    // segue o nível do PWM em cada período, como a corrente real. Com zonas,
+    // a média das zonas (defasadas, o filtro do sensor vê a soma)
+    if (HEATER_ZONE_COUNT > 1) {
+        sim_hal_set_adc_voltage(ENERGY_SENSOR_PIN - 26,
+                                ACS712_ZERO_VOLTAGE - ACS712_SENSITIVITY * full_current * sim.plant[0].duty);
+    } else {
+        sim_hal_set_adc_pwm_voltage(ENERGY_SENSOR_PIN - 26, HEATER_PIN, ACS712_ZERO_VOLTAGE,
+                                    ACS712_ZERO_VOLTAGE - ACS712_SENSITIVITY * full_current);
+    }
+
+    // NTC do bloco: divisor com pull-up de NTC_PULLUP (equação Beta)
+    float r_ntc = NTC_R25 * expf(NTC_BETA * (1.0f / (sim.plant[0].block_temp + 273.15f) - 1.0f / 298.15f));
+    sim_hal_set_adc_voltage(BLOCK_NTC_PIN - 26, 3.3f * r_ntc / (r_ntc + NTC_PULLUP));
+
+    update_metrics(now_us, dt);
+    update_chamber_metrics(now_us, dt);
+
+    if (sim.csv && now_us >= sim.next_csv_us) {
+        sim.next_csv_us += CSV_INTERVAL_US;
+        fprintf(sim.csv, "%.1f,%.1f,%.2f,%.2f,%.2f,%.3f,%.1f,%.3f\n",
+                now_us / 1e6, sim.firmware_target, sim.plant[0].air_temp, sim.plant[0].sensor_temp,
+                sim.plant[0].block_temp, sim.plant[0].duty, thermal_plant_relative_humidity(&sim.plant[0]),
+                sim.plant[0].water_mass);
+    }
+}
+
+static void print_segment(int index, const segment_metrics_t *s) {
+    double duration_s = (s->end_us - s->start_us) / 1e6;
+    double settle_s = -1.0;
+    if (s->in_band_since_valid) {
+        settle_s = (s->in_band_since_us - s->start_us) / 1e6;
+    }
+
+    printf("Segment %d: setpoint %.0f C from t=%.0f s for %.2f h (start %.1f C)\n",
+           index, s->setpoint, s->start_us / 1e6, duration_s / 3600.0, s->start_temp);
+    if (settle_s >= 0.0) {
+        printf("  settling time (+/-%.1f C): %.0f s (%.1f min)\n", sim.band, settle_s, settle_s / 60.0);
+    } else {
+        printf("  settling time (+/-%.1f C): not settled\n", sim.band);
+    }
+    // Overshoot no sentido do degrau (para baixo quando o setpoint diminui)
+    float overshoot = (s->setpoint >= s->start_temp) ? s->max_temp - s->setpoint
+                                                     : s->setpoint - s->min_temp;
+    printf("  overshoot:                  %.2f C\n", overshoot > 0.0f ? overshoot : 0.0f);
+    if (s->reached) {
+        printf("  time in band:               %.1f %%\n",
+               s->tracked_time_s > 0 ? 100.0 * s->band_time_s / s->tracked_time_s : 0.0);
+        printf("  mean error in band phase:   %+.2f C\n",
+               s->tracked_time_s > 0 ? s->error_sum / s->tracked_time_s : 0.0);
+        printf("  output noise (RMS dPWM):    %.2f %% (steady state)\n",
+               s->duty_steps > 0 ? sqrt(s->duty_step_sq / s->duty_steps) : 0.0);
+    } else {
+        printf("  time in band:               band never reached\n");
+    }
+    printf("  IAE:                        %.1f C.min\n", s->iae / 60.0);
+    printf("  energy:                     %.1f Wh\n", s->energy_j / 3600.0);
+    printf("  safety cutoffs:             %lu\n", (unsigned long)s->cutoffs);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --hours H          Simulated session length (default 24)\n"
+            "  --setpoint C       Initial setpoint, set via button presses (default %d)\n"
+            "  --step S:C         Change setpoint to C at S seconds (repeatable)\n"
+            "  --ambient C        Ambient temperature (default 25)\n"
+            "  --ambient-rh P     Ambient relative humidity (default 60)\n"
+            "  --water G          Water in the filament load (default 5 g)\n"
+            "  --band C           Settling / in-band tolerance (default 1.0)\n"
+            "  --dht-dropout S:D  DHT22 stops answering at S seconds for D seconds\n"
+            "  --supply S:V       Heater supply changes to V volts at S seconds\n"
+            "  --spi-stall S:D    Display SPI hangs at S seconds for D seconds\n"
+            "  --sensor-detach S  DHT22 falls off the spool at S seconds (reads near ambient)\n"
+            "  --fan-fail S       Circulation fan stops at S seconds\n"
+            "  --fan-slow S:RPM   Circulation fan slows down to RPM at S seconds\n"
+            "  --drive S:MODE     Switch heater drive to pwm, sigma-delta or burst at S seconds\n"
+            "  --profile NAME     Select a drying profile at boot (PLA, PETG, ABS, PA, TPU, MANUAL)\n"
+            "  --flash FILE       Load the flash image at start and save it at the end\n"
+            "  --csv FILE         Write a 10 s trace (t,sp,air,sensor,block,duty,rh,water)\n",
+            prog, TEMP_TARGET_DEFAULT);
+}
+
+int main(int argc, char **argv) {
+    thermal_plant_params_t params;
+    thermal_plant_default_params(&params);
+
+    double hours = 24.0;
+    float setpoints[MAX_SEGMENTS];
+    double step_at_s[MAX_SEGMENTS];
+    int setpoint_count = 1;
+    setpoints[0] = TEMP_TARGET_DEFAULT;
+    step_at_s[0] = 0.0;
+    const char *csv_path = NULL;
+    double spi_stall_s = 0.0;
+    double spi_stall_len_s = 0.0;
+    const char *flash_path = NULL;
+    int profile = -1;
+
+    sim.band = 1.0f;
+    sim.dropout_start_us = UINT64_MAX;
+    sim.dropout_end_us = UINT64_MAX;
+    sim.supply_change_us = UINT64_MAX;
+    sim.sensor_detach_us = UINT64_MAX;
+    sim.fan_fail_us = UINT64_MAX;
+    sim.fan_slow_us = UINT64_MAX;
+    sim.drive_change_us = UINT64_MAX;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!val) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(arg, "--hours") == 0) {
+            hours = atof(val);
+        } else if (strcmp(arg, "--setpoint") == 0) {
+            setpoints[0] = (float)atof(val);
+        } else if (strcmp(arg, "--step") == 0 && setpoint_count < MAX_SEGMENTS) {
+            double at;
+            float temp;
+            if (sscanf(val, "%lf:%f", &at, &temp) != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+            step_at_s[setpoint_count] = at;
+            setpoints[setpoint_count++] = temp;
+        } else if (strcmp(arg, "--ambient") == 0) {
+            params.ambient_temp = (float)atof(val);
+        } else if (strcmp(arg, "--ambient-rh") == 0) {
+            params.ambient_rh = (float)atof(val);
+        } else if (strcmp(arg, "--water") == 0) {
+            params.water_mass = (float)atof(val);
+        } else if (strcmp(arg, "--band") == 0) {
+            sim.band = (float)atof(val);
+        } else if (strcmp(arg, "--dht-dropout") == 0) {
+            double start, duration;
+            if (sscanf(val, "%lf:%lf", &start, &duration) != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+            sim.dropout_start_us = (uint64_t)(start * 1e6);
+            sim.dropout_end_us = (uint64_t)((start + duration) * 1e6);
+        } else if (strcmp(arg, "--supply") == 0) {
+            double at;
+            if (sscanf(val, "%lf:%f", &at, &sim.supply_voltage) != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+            sim.supply_change_us = (uint64_t)(at * 1e6);
+        } else if (strcmp(arg, "--spi-stall") == 0) {
+            if (sscanf(val, "%lf:%lf", &spi_stall_s, &spi_stall_len_s) != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(arg, "--sensor-detach") == 0) {
+            sim.sensor_detach_us = (uint64_t)(atof(val) * 1e6);
+        } else if (strcmp(arg, "--fan-fail") == 0) {
+            sim.fan_fail_us = (uint64_t)(atof(val) * 1e6);
+        } else if (strcmp(arg, "--fan-slow") == 0) {
+            double at;
+            if (sscanf(val, "%lf:%f", &at, &sim.fan_slow_rpm) != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+            sim.fan_slow_us = (uint64_t)(at * 1e6);
+        } else if (strcmp(arg, "--drive") == 0) {
+            double at;
+            char mode[16];
+            if (sscanf(val, "%lf:%15s", &at, mode) != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+            if (strcmp(mode, "pwm") == 0) {
+                sim.drive = HEATER_DRIVE_PWM;
+            } else if (strcmp(mode, "sigma-delta") == 0) {
+                sim.drive = HEATER_DRIVE_SIGMA_DELTA;
+            } else if (strcmp(mode, "burst") == 0) {
+                sim.drive = HEATER_DRIVE_BURST;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+            sim.drive_change_us = (uint64_t)(at * 1e6);
+        } else if (strcmp(arg, "--profile") == 0) {
+            for (int id = 0; id < DRYING_PROFILE_COUNT; id++) {
+                if (strcasecmp(val, drying_profile_name((drying_profile_id_t)id)) == 0) {
+                    profile = id;
+                }
+            }
+            if (profile < 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(arg, "--flash") == 0) {
+            flash_path = val;
+        } else if (strcmp(arg, "--csv") == 0) {
+            csv_path = val;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    // O botão ajusta a câmara que está no display (que alterna sozinho): o
+    // roteiro de setpoints só vale com uma câmara
+    if (CHAMBER_COUNT > 1 && (setpoint_count > 1 || setpoints[0] != TEMP_TARGET_DEFAULT)) {
+        fprintf(stderr, "--setpoint and --step need CHAMBER_COUNT=1 (%d chambers run at %d C)\n",
+                CHAMBER_COUNT, TEMP_TARGET_DEFAULT);
+        return 1;
+    }
+    // Com perfil (escolhido agora ou continuado do flash) o setpoint é do firmware
+    if ((profile >= 0 || flash_path) && (setpoint_count > 1 || setpoints[0] != TEMP_TARGET_DEFAULT)) {
+        fprintf(stderr, "--profile and --flash leave the setpoint to the profile: no --setpoint or --step\n");
+        return 1;
+    }
+    for (int i = 0; i < setpoint_count; i++) {
+        if (setpoints[i] < TEMP_MIN || setpoints[i] > TEMP_MAX) {
+            fprintf(stderr, "Setpoint %.0f C outside button range %d-%d C\n",
+                    setpoints[i], TEMP_MIN, TEMP_MAX);
+            return 1;
+        }
+    }
+
+    // Roteiro: cada setpoint vira uma sequência de pressões do botão
+    sim.firmware_target = TEMP_TARGET_DEFAULT;
+    sim.seg_current = -1;
+    float target = TEMP_TARGET_DEFAULT;
+    for (int i = 0; i < setpoint_count; i++) {
+        uint64_t start = (uint64_t)(step_at_s[i] * 1e6);
+        if (start < BUTTON_FIRST_PRESS_US) {
+            start = BUTTON_FIRST_PRESS_US;
+        }
+        sim.seg[i].setpoint = setpoints[i];
+        sim.seg[i].start_us = start;
+        schedule_presses(target, setpoints[i], start);
+        target = setpoints[i];
+    }
+    sim.seg_count = setpoint_count;
+    
+    // Perfil: botão segurado desde o boot e solto no meio da vez do perfil
+    // na seleção (começa depois da tela de inicialização, PLA primeiro)
+    if (profile >= 0 || flash_path) {
+        sim.profile_mode = true;
+        sim.firmware_target = NAN;
+        sim.seg_count = 0;
+        sim.button_count = 0;
+    }
+    if (profile >= 0) {
+        int pos = (profile - DRYING_PROFILE_PLA + DRYING_PROFILE_COUNT) % DRYING_PROFILE_COUNT;
+        sim.button_time[sim.button_count] = 0;
+        sim.button_level[sim.button_count++] = false;
+        sim.button_time[sim.button_count] = 3000000ull + (uint64_t)pos * PROFILE_SELECT_STEP_MS * 1000ull +
+                                            PROFILE_SELECT_STEP_MS * 500ull;
+        sim.button_level[sim.button_count++] = true;
+    }
+
+    if (csv_path) {
+        sim.csv = fopen(csv_path, "w");
+        if (!sim.csv) {
+            perror(csv_path);
+            return 1;
+        }
+        fprintf(sim.csv, "time_s,setpoint,air_temp,sensor_temp,block_temp,duty,rh,water_g\n");
+    }
+
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        thermal_plant_init(&sim.plant[c], &params);
+        sim.chamber[c].peak_air_temp = sim.plant[c].air_temp;
+    }
+    sim.last_reported_temp = sim.plant[0].sensor_temp;
+    sim.peak_air_temp = sim.plant[0].air_temp;
+    sim.peak_block_temp = sim.plant[0].block_temp;
+    sim.block_to_air = params.block_to_air;
+#if CHAMBER_COUNT > 1
+    for (int i = 0; i < SIM_HEATER_OUTPUTS; i++) {
+        output_pins[i] = chamber_table[i].heater_pin;
+    }
+#else
+    static const uint zone_pins[] = HEATER_ZONE_PINS;
+    for (int i = 0; i < SIM_HEATER_OUTPUTS; i++) {
+        output_pins[i] = zone_pins[i];
+    }
+#endif
+
+    sim_hal_reset();
+    sim_hal_flash_erase();
+    if (flash_path && sim_hal_flash_load(flash_path)) {
+        printf("Flash image loaded from %s\n", flash_path);
+    }
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        sim_hal_dht22_attach(chamber_table[c].dht22_pin);
+    }
+#if AMBIENT_SENSOR_ENABLED
+    sim_hal_dht22_attach(AMBIENT_DHT22_PIN);
+#endif
+#if LOAD_CELL_ENABLED
+    sim_hal_hx711_attach(LOAD_CELL_DOUT_PIN, LOAD_CELL_SCK_PIN, HX711_RATE_HZ, HX711_NOISE_COUNTS);
+#endif
+    sim_hal_set_adc_noise(3);
+    sim_hal_set_gpio_input(BUTTON_PIN, true);
+    sim_hal_set_step_hook(plant_step, NULL, PLANT_STEP_US);
+    sim_hal_spi_stall((uint64_t)(spi_stall_s * 1e6), (uint64_t)(spi_stall_len_s * 1e6));
+
+    struct timespec wall_start, wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+
+    uint64_t end_us = sim_hal_run(dryer_firmware_main, (uint64_t)(hours * 3600.0 * 1e6));
+
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    double wall_s = (wall_end.tv_sec - wall_start.tv_sec) + (wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+
+    if (sim.seg_current >= 0) {
+        segment_close(&sim.seg[sim.seg_current], end_us);
+    }
+    if (sim.csv) {
+        fclose(sim.csv);
+    }
+    if (flash_path && !sim_hal_flash_save(flash_path)) {
+        perror(flash_path);
+    }
+
+    printf("\n=== DRYER SIMULATION REPORT ===\n");
+    printf("Simulated %.2f h in %.2f s (%.0fx real time)\n",
+           end_us / 3.6e9, wall_s, wall_s > 0 ? end_us / 1e6 / wall_s : 0.0);
+    printf("Ambient %.1f C, heater %.0f W, band +/-%.1f C\n",
+           params.ambient_temp, thermal_plant_heater_max_power(&sim.plant[0]), sim.band);
+
+    uint32_t total_cutoffs = 0;
+    for (int i = 0; i <= sim.seg_current; i++) {
+        print_segment(i, &sim.seg[i]);
+        total_cutoffs += sim.seg[i].cutoffs;
+    }
+
+    safety_supervisor_stats_t safety;
+    safety_supervisor_get_stats(&safety);
+    double energy_j = 0.0;
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        energy_j += sim.plant[c].energy_j;
+    }
+    for (int c = 0; CHAMBER_COUNT > 1 && c < CHAMBER_COUNT; c++) {
+        const chamber_metrics_t *m = &sim.chamber[c];
+        if (sim.profile_mode) {
+            // Setpoint do perfil: sem banda nem IAE em torno do padrão
+            printf("Chamber %d: drying profile\n", c + 1);
+            printf("  peak air temp:              %.1f C\n", m->peak_air_temp);
+            printf("  energy:                     %.1f Wh\n", sim.plant[c].energy_j / 3600.0);
+            printf("  supervisor faults now:      0x%lx\n", (unsigned long)safety.chamber_faults[c]);
+            continue;
+        }
+        printf("Chamber %d: setpoint %d C\n", c + 1, TEMP_TARGET_DEFAULT);
+        if (m->in_band_since_valid) {
+            double settle_s = m->in_band_since_us / 1e6;
+            printf("  settling time (+/-%.1f C): %.0f s (%.1f min)\n", sim.band, settle_s, settle_s / 60.0);
+        } else {
+            printf("  settling time (+/-%.1f C): not settled\n", sim.band);
+        }
+        printf("  IAE:                        %.1f C.min\n", m->iae / 60.0);
+        printf("  peak air temp:              %.1f C\n", m->peak_air_temp);
+        printf("  energy:                     %.1f Wh\n", sim.plant[c].energy_j / 3600.0);
+        printf("  supervisor faults now:      0x%lx\n", (unsigned long)safety.chamber_faults[c]);
+    }
+
+    printf("Session totals:\n");
+    printf("  energy:                     %.1f Wh\n", energy_j / 3600.0);
+    printf("  safety cutoffs:             %lu\n", (unsigned long)total_cutoffs);
+    printf("  supervisor trips:           %lu (fault->cutoff max %.1f ms)\n",
+           (unsigned long)safety.trips, safety.max_latency_us / 1000.0);
+    printf("  watchdog expirations:       %lu\n", (unsigned long)sim_hal_watchdog_resets());
+    uint32_t flash_erases, flash_programs;
+    sim_hal_flash_stats(&flash_erases, &flash_programs);
+    printf("  flash (checkpoint):         %lu sector erases, %lu page writes\n",
+           (unsigned long)flash_erases, (unsigned long)flash_programs);
+    if (sim.fan_fail_us < end_us) {
+        // Detecção pelo tacômetro x pelo thermal runaway (energia sem subida)
+        printf("  fan stop -> heater cut:     %s%.1f s by tach, ", sim.fan_cut_us ? "" : "never ",
+               sim.fan_cut_us ? (sim.fan_cut_us - sim.fan_fail_us) / 1e6 : 0.0);
+        if (sim.runaway_cut_us) {
+            printf("%.1f s by runaway\n", (sim.runaway_cut_us - sim.fan_fail_us) / 1e6);
+        } else {
+            printf("runaway never\n");
+        }
+    }
+    printf("  peak air / block temp:      %.1f / %.1f C\n", sim.peak_air_temp, sim.peak_block_temp);
+    printf("  water removed:              %.2f of %.2f g\n",
+           params.water_mass - sim.plant[0].water_mass, params.water_mass);
+    for (int k = 0; k < 2; k++) {
+        if (sim.dry_time_s[k] > 0.0) {
+            printf("  %d%% of the water removed:   %.2f h, %.1f Wh\n", k == 0 ? 50 : 90,
+                   sim.dry_time_s[k] / 3600.0, sim.dry_energy_j[k] / 3600.0);
+        } else {
+            printf("  %d%% of the water removed:   not reached\n", k == 0 ? 50 : 90);
+        }
+    }
+#if LOAD_CELL_ENABLED
+    // Estimativa do firmware no log de estatísticas ("Load cell: ...")
+    uint32_t hx711_lost;
+    uint32_t hx711_samples = sim_hal_hx711_samples(&hx711_lost);
+    printf("  HX711 conversions read:     %lu (%.1f/s), %lu lost\n", (unsigned long)hx711_samples,
+           hx711_samples / (end_us / 1e6), (unsigned long)hx711_lost);
+    printf("  spool mass (true):          %.1f g, losing %.2f g/h\n",
+           SPOOL_DRY_MASS_G + sim.plant[0].water_mass, sim.water_rate_gph);
+#endif
+    printf("  vent average duty:          %.1f%% (running %.1f%% of the time)\n",
+           100.0 * sim.vent_duty_s / (end_us / 1e6), 100.0 * sim.vent_on_s / (end_us / 1e6));
+    printf("  DHT22 frames:               %lu\n", (unsigned long)sim_hal_dht22_frames(DHT22_PIN));
+    printf("  display SPI traffic:        %.1f MB\n", sim_hal_spi_bytes() / 1e6);
+    for (int core = 0; core < 2; core++) {
+        uint64_t idle_us;
+        uint32_t wakeups;
+        sim_hal_wfe_stats(core, &idle_us, &wakeups);
+        if (wakeups) {
+            printf("  core%d idle (WFE):           %.1f%%, %.1f wakeups/s\n", core,
+                   100.0 * idle_us / end_us, wakeups * 1e6 / end_us);
+        }
+        if (core == 0) {
+            // Custo de uma iteração do loop de controle (todas as câmaras)
+            double cycles = end_us / (SENSOR_TASK_PERIOD_MS * 1000.0);
+            printf("  core0 busy per cycle:       %.3f ms (every %d ms)\n",
+                   (end_us - idle_us) / 1000.0 / cycles, SENSOR_TASK_PERIOD_MS);
+        }
+    }
+
+    uint32_t level_hz[8];
+    uint64_t level_us[8];
+    uint32_t levels, switches;
+    sim_hal_clock_stats(level_hz, level_us, &levels, &switches);
+    for (uint32_t i = 0; i < levels; i++) {
+        printf("  clk_sys %6.2f MHz:          %.2f%% of the time\n",
+               level_hz[i] / 1e6, 100.0 * level_us[i] / end_us);
+    }
+    printf("  clock switches:             %lu (%.2f/s)\n",
+           (unsigned long)switches, switches * 1e6 / end_us);
+    printf("  MCU power (estimated):      %.1f mW\n", sim_hal_mcu_power_mw());
+    printf("  heater PWM frequency:       %.1f Hz\n", sim_hal_pwm_frequency(HEATER_PIN));
+    printf("  heater drive:               %s\n",
+           hardware_control_heater_drive_name(hardware_control_get_heater_drive()));
+    printf("  heater switching edges:     %llu (%.0f/s)\n",
+           (unsigned long long)sim.last_edges, sim.last_edges * 1e6 / end_us);
+    printf("  MOSFET switching loss (est): %.1f mW avg, %.2f Wh\n",
+           sim.switching_loss_j * 1e9 / end_us, sim.switching_loss_j / 3600.0);
+    printf("  PSU current:                peak %.2f A max, %.2f A time-avg; RMS %.2f A; avg %.2f A\n",
+           sim.peak_current, sim.peak_time_as * 1e6 / end_us, sqrt(sim.square_a2s * 1e6 / end_us),
+           sim.charge_c * 1e6 / end_us);
+    heater_zones_t zones;
+    uint32_t rephases;
+    if (hardware_control_heater_zones_stats(&zones, &rephases)) {
+        printf("  heater zones:               %d, stagger %s, budget %.2f A, rephased %lu\n",
+               zones.count, zones.stagger ? "on" : "off", zones.budget_a, (unsigned long)rephases);
+        printf("  firmware peak estimate:     %.2f A (%.2f A if aligned), limited %lu of %lu plans\n",
+               zones.max_peak_a, zones.max_peak_aligned_a, (unsigned long)zones.limited,
+               (unsigned long)zones.plans);
+    }
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+#ifndef SIM_HARDWARE_ADC_H
+#define SIM_HARDWARE_ADC_H
+
+// Subconjunto de hardware/adc.h: as tensões vêm do modelo da planta
+
+#include "pico/types.h"
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint16_t adc_read(void);
+
+#endif // SIM_HARDWARE_ADC_H
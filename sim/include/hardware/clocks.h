@@ -0,0 +1,34 @@
+#ifndef SIM_HARDWARE_CLOCKS_H
+#define SIM_HARDWARE_CLOCKS_H
+
+// Subconjunto de hardware/clocks.h: o clk_sys simulado define quanto a CPU
+// leva para alimentar o SPI e entra na estimativa de consumo do sim_hal
+
+#include "pico/types.h"
+
+enum clock_index {
+    clk_gpout0 = 0,
+    clk_gpout1,
+    clk_gpout2,
+    clk_gpout3,
+    clk_ref,
+    clk_sys,
+    clk_peri,
+    clk_usb,
+    clk_adc,
+    clk_rtc,
+    CLK_COUNT
+};
+
+// Valores de hardware/regs/clocks.h
+#define CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLK_REF 0x0u
+#define CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX 0x1u
+#define CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS 0x0u
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS 0x0u
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS 0x1u
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+bool clock_configure(enum clock_index clk_index, uint32_t src, uint32_t auxsrc,
+                     uint32_t src_freq, uint32_t freq);
+
+#endif // SIM_HARDWARE_CLOCKS_H
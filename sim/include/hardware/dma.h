@@ -0,0 +1,74 @@
+#ifndef SIM_HARDWARE_DMA_H
+#define SIM_HARDWARE_DMA_H
+
+// Subconjunto de hardware/dma.h: canais pacejados pelo wrap de um slice do
+// PWM e canais sem DREQ (ex: controle que reinicia outro canal). O sim_hal
+// faz uma transferência por período do PWM no relógio virtual; escrita no
+// al3_read_addr_trig de outro canal reinicia aquele canal.
+
+#include "pico/types.h"
+#include <stdint.h>
+
+#define NUM_DMA_CHANNELS 12
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+#define DREQ_PWM_WRAP0 24
+#define DREQ_FORCE 0x3f
+
+// Registros do canal (endereços com a largura do ponteiro do host)
+typedef struct {
+    volatile uintptr_t read_addr;
+    volatile uintptr_t write_addr;
+    volatile uint32_t transfer_count;
+    volatile uintptr_t al3_read_addr_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+    enum dma_channel_transfer_size size;
+    bool read_increment;
+    bool write_increment;
+    uint dreq;
+    uint chain_to;
+} dma_channel_config;
+
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(uint channel);
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c,
+                                                         enum dma_channel_transfer_size size) {
+    c->size = size;
+}
+
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+    c->read_increment = incr;
+}
+
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+    c->write_increment = incr;
+}
+
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq) {
+    c->dreq = dreq;
+}
+
+static inline void channel_config_set_chain_to(dma_channel_config *c, uint chain_to) {
+    c->chain_to = chain_to;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+
+/**
+ * Registros do canal, com a posição de leitura atualizada até o instante atual
+ */
+dma_channel_hw_t *dma_channel_hw_addr(uint channel);
+
+#endif // SIM_HARDWARE_DMA_H
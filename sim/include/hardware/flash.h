@@ -0,0 +1,24 @@
+#ifndef SIM_HARDWARE_FLASH_H
+#define SIM_HARDWARE_FLASH_H
+
+// Subconjunto de hardware/flash.h: o flash de 2 MB é um vetor do simulador
+// mapeado em XIP_BASE, com as regras do NOR (apagar vai para 0xFF, programar
+// só zera bits)
+
+#include "pico/types.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+
+extern uint8_t sim_flash_memory[PICO_FLASH_SIZE_BYTES];
+
+#define XIP_BASE ((uintptr_t)sim_flash_memory)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif // SIM_HARDWARE_FLASH_H
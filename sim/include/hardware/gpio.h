@@ -0,0 +1,58 @@
+#ifndef SIM_HARDWARE_GPIO_H
+#define SIM_HARDWARE_GPIO_H
+
+// Subconjunto de hardware/gpio.h: os pinos são emulados pelo sim_hal
+
+#include "pico/types.h"
+
+#define GPIO_OUT 1
+#define GPIO_IN  0
+
+typedef enum {
+    GPIO_FUNC_XIP = 0,
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_GPCK = 8,
+    GPIO_FUNC_USB = 9,
+    GPIO_FUNC_NULL = 0x1f,
+} gpio_function_t;
+
+enum gpio_override {
+    GPIO_OVERRIDE_NORMAL = 0,
+    GPIO_OVERRIDE_INVERT = 1,
+    GPIO_OVERRIDE_LOW = 2,
+    GPIO_OVERRIDE_HIGH = 3,
+};
+
+void gpio_init(uint gpio);
+void gpio_set_function(uint gpio, gpio_function_t fn);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+
+// Força a saída do pino (vale também com função PWM): LOW/HIGH ignoram o periférico
+void gpio_set_outover(uint gpio, uint value);
+
+// Interrupção por borda/nível: no simulador o callback roda no instante
+// virtual em que o nível do pino muda (sim_hal_set_gpio_input)
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled,
+                                        gpio_irq_callback_t callback);
+
+#endif // SIM_HARDWARE_GPIO_H
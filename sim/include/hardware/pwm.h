@@ -0,0 +1,93 @@
+#ifndef SIM_HARDWARE_PWM_H
+#define SIM_HARDWARE_PWM_H
+
+// Subconjunto de hardware/pwm.h: o nível de cada canal é lido pela planta.
+// O registro CC tem buffer duplo como no RP2040: vale a partir do próximo wrap.
+// Nos modos de contagem o contador avança com as bordas do pino B
+// (sim_hal_set_gpio_pulses) em vez do clock.
+
+#include "pico/types.h"
+#include "hardware/dma.h"
+
+enum pwm_chan {
+    PWM_CHAN_A = 0,
+    PWM_CHAN_B = 1
+};
+
+// Registros do slice: só o endereço do CC é usado (destino do DMA); EN
+// espelha os slices ligados (pwm_set_mask_enabled)
+typedef struct {
+    volatile uint32_t csr;
+    volatile uint32_t div;
+    volatile uint32_t ctr;
+    volatile uint32_t cc;
+    volatile uint32_t top;
+} pwm_slice_hw_t;
+
+typedef struct {
+    pwm_slice_hw_t slice[8];
+    volatile uint32_t en;
+} pwm_hw_t;
+
+extern _Thread_local pwm_hw_t sim_pwm_hw;
+#define pwm_hw (&sim_pwm_hw)
+
+enum pwm_clkdiv_mode {
+    PWM_DIV_FREE_RUNNING = 0,
+    PWM_DIV_B_HIGH = 1,
+    PWM_DIV_B_RISING = 2,
+    PWM_DIV_B_FALLING = 3
+};
+
+typedef struct {
+    float clkdiv;
+    uint16_t top;
+    enum pwm_clkdiv_mode mode;
+} pwm_config;
+
+static inline uint pwm_gpio_to_slice_num(uint gpio) {
+    return (gpio >> 1u) & 7u;
+}
+
+static inline uint pwm_gpio_to_channel(uint gpio) {
+    return gpio & 1u;
+}
+
+static inline uint pwm_get_dreq(uint slice_num) {
+    return DREQ_PWM_WRAP0 + slice_num;
+}
+
+static inline pwm_config pwm_get_default_config(void) {
+    pwm_config c = { .clkdiv = 1.0f, .top = 0xffff, .mode = PWM_DIV_FREE_RUNNING };
+    return c;
+}
+
+static inline void pwm_config_set_clkdiv(pwm_config *c, float div) {
+    c->clkdiv = div;
+}
+
+static inline void pwm_config_set_clkdiv_int_frac(pwm_config *c, uint8_t integer, uint8_t fract) {
+    c->clkdiv = (float)integer + (float)fract / 16.0f;
+}
+
+static inline void pwm_config_set_clkdiv_mode(pwm_config *c, enum pwm_clkdiv_mode mode) {
+    c->mode = mode;
+}
+
+static inline void pwm_config_set_wrap(pwm_config *c, uint16_t wrap) {
+    c->top = wrap;
+}
+
+void pwm_init(uint slice_num, pwm_config *c, bool start);
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level);
+void pwm_set_enabled(uint slice_num, bool enabled);
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract);
+void pwm_set_wrap(uint slice_num, uint16_t wrap);
+
+// Contador: com o slice ligado vale na hora (o período em curso encurta ou
+// alonga); slices ligados juntos pela máscara partem no mesmo ciclo
+void pwm_set_counter(uint slice_num, uint16_t c);
+uint16_t pwm_get_counter(uint slice_num);
+void pwm_set_mask_enabled(uint32_t mask);
+
+#endif // SIM_HARDWARE_PWM_H
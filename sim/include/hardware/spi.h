@@ -0,0 +1,16 @@
+#ifndef SIM_HARDWARE_SPI_H
+#define SIM_HARDWARE_SPI_H
+
+// Subconjunto de hardware/spi.h: o display é descartado, só contamos bytes
+
+#include "pico/types.h"
+
+typedef struct spi_inst spi_inst_t;
+
+#define spi0 ((spi_inst_t *)0)
+#define spi1 ((spi_inst_t *)1)
+
+uint spi_init(spi_inst_t *spi, uint baudrate);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+
+#endif // SIM_HARDWARE_SPI_H
@@ -0,0 +1,25 @@
+#ifndef SIM_HARDWARE_SYNC_H
+#define SIM_HARDWARE_SYNC_H
+
+// Subconjunto de hardware/sync.h: barreiras de memória do host, o SEV
+// (acorda o WFE dos dois núcleos) e a máscara de interrupções
+
+#include "pico/types.h"
+
+static inline void __dmb(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void __sev(void);
+
+// Interrupções só rodam quando o relógio virtual avança e uma espera curta
+// não atrasa nada: mascarar não muda o resultado da simulação
+static inline uint32_t save_and_disable_interrupts(void) {
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status) {
+    (void)status;
+}
+
+#endif // SIM_HARDWARE_SYNC_H
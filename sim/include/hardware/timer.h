@@ -0,0 +1,13 @@
+#ifndef SIM_HARDWARE_TIMER_H
+#define SIM_HARDWARE_TIMER_H
+
+// Subconjunto de hardware/timer.h: espera ativa curta (bit-bang) sobre o
+// relógio virtual
+
+#include "pico/time.h"
+
+static inline void busy_wait_us_32(uint32_t delay_us) {
+    sleep_us(delay_us);
+}
+
+#endif // SIM_HARDWARE_TIMER_H
@@ -0,0 +1,13 @@
+#ifndef SIM_HARDWARE_WATCHDOG_H
+#define SIM_HARDWARE_WATCHDOG_H
+
+// Subconjunto de hardware/watchdog.h: o simulador não reinicia o firmware,
+// só conta quantas vezes o watchdog teria disparado (sim_hal_watchdog_resets)
+
+#include "pico/types.h"
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug);
+void watchdog_update(void);
+bool watchdog_caused_reboot(void);
+
+#endif // SIM_HARDWARE_WATCHDOG_H
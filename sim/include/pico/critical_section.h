@@ -0,0 +1,25 @@
+#ifndef SIM_PICO_CRITICAL_SECTION_H
+#define SIM_PICO_CRITICAL_SECTION_H
+
+// Subconjunto de pico/critical_section.h: no simulador os núcleos só trocam
+// nas esperas da HAL, então a seção crítica não precisa fazer nada
+
+#include "pico/types.h"
+
+typedef struct {
+    bool initialized;
+} critical_section_t;
+
+static inline void critical_section_init(critical_section_t *crit_sec) {
+    crit_sec->initialized = true;
+}
+
+static inline void critical_section_enter_blocking(critical_section_t *crit_sec) {
+    (void)crit_sec;
+}
+
+static inline void critical_section_exit(critical_section_t *crit_sec) {
+    (void)crit_sec;
+}
+
+#endif // SIM_PICO_CRITICAL_SECTION_H
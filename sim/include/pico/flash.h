@@ -0,0 +1,14 @@
+#ifndef SIM_PICO_FLASH_H
+#define SIM_PICO_FLASH_H
+
+// Subconjunto de pico/flash.h: no simulador o outro núcleo não executa do
+// flash, então a operação roda direto
+
+#include "pico/types.h"
+
+#define PICO_OK 0
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
+bool flash_safe_execute_core_init(void);
+
+#endif // SIM_PICO_FLASH_H
@@ -0,0 +1,11 @@
+#ifndef SIM_PICO_MULTICORE_H
+#define SIM_PICO_MULTICORE_H
+
+// Subconjunto de pico/multicore.h: o core1 roda como corrotina no sim_hal,
+// com relógio virtual próprio (o que ele gasta não atrasa o core0)
+
+#include "pico/types.h"
+
+void multicore_launch_core1(void (*entry)(void));
+
+#endif // SIM_PICO_MULTICORE_H
@@ -0,0 +1,17 @@
+#ifndef SIM_PICO_STDLIB_H
+#define SIM_PICO_STDLIB_H
+
+// Substituto de pico/stdlib.h para o build de host (simulador)
+
+#include "pico/types.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+#ifndef PICO_DEFAULT_LED_PIN
+#define PICO_DEFAULT_LED_PIN 25
+#endif
+
+bool stdio_init_all(void);
+bool stdio_usb_connected(void);
+
+#endif // SIM_PICO_STDLIB_H
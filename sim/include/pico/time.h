@@ -0,0 +1,89 @@
+#ifndef SIM_PICO_TIME_H
+#define SIM_PICO_TIME_H
+
+// Subconjunto de pico/time.h sobre o relógio virtual do simulador.
+// Toda espera avança o relógio virtual (e a planta térmica) em vez de
+// bloquear, por isso o firmware roda muito mais rápido que o tempo real.
+
+#include "pico/types.h"
+
+absolute_time_t get_absolute_time(void);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t t);
+
+/**
+ * WFE até um evento (SEV do outro núcleo, interrupção de timer ou GPIO do
+ * núcleo) ou até o instante informado
+ * @return true se voltou pelo tempo
+ */
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp);
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000u);
+}
+
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) {
+    return t + us;
+}
+
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) {
+    return t + (uint64_t)ms * 1000u;
+}
+
+static inline absolute_time_t make_timeout_time_us(uint64_t us) {
+    return delayed_by_us(get_absolute_time(), us);
+}
+
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return delayed_by_ms(get_absolute_time(), ms);
+}
+
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+static inline bool time_reached(absolute_time_t t) {
+    return get_absolute_time() >= t;
+}
+
+static inline absolute_time_t from_us_since_boot(uint64_t us) {
+    return us;
+}
+
+static inline uint64_t time_us_64(void) {
+    return get_absolute_time();
+}
+
+static inline uint32_t time_us_32(void) {
+    return (uint32_t)get_absolute_time();
+}
+
+// Timer repetitivo: no simulador o callback roda no instante virtual exato,
+// como a interrupção do alarme no RP2040
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *rt);
+
+struct repeating_timer {
+    int64_t delay_us;
+    repeating_timer_callback_t callback;
+    void *user_data;
+    uint64_t next_us;
+    bool active;
+    uint8_t core;                       // Núcleo que recebe a interrupção
+};
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback,
+                            void *user_data, repeating_timer_t *out);
+bool cancel_repeating_timer(repeating_timer_t *timer);
+
+static inline bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback,
+                                          void *user_data, repeating_timer_t *out) {
+    return add_repeating_timer_us((int64_t)delay_ms * 1000, callback, user_data, out);
+}
+
+#endif // SIM_PICO_TIME_H
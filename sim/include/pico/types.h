@@ -0,0 +1,16 @@
+#ifndef SIM_PICO_TYPES_H
+#define SIM_PICO_TYPES_H
+
+// Subconjunto de pico/types.h para o build de host (simulador)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+// No SDK real absolute_time_t pode ser opaco; no simulador é sempre
+// o número de microssegundos desde o boot (relógio virtual)
+typedef uint64_t absolute_time_t;
+
+#endif // SIM_PICO_TYPES_H
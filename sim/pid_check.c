@@ -0,0 +1,104 @@
+/**
+ * Filament Dryer - Verificação da troca de forma do PID
+ *
+ * Dois controladores recebem a mesma sequência de leituras de uma planta de
+ * primeira ordem controlada pelo primeiro (0.1°C como o DHT22, feed-forward
+ * e saída fora da saturação). Um fica na forma posicional; o outro troca
+ * para a de velocidade e depois volta.
+ * Com o integral dentro de ±integral_max as duas formas são a mesma lei de
+ * controle, então as saídas precisam coincidir em todos os ciclos. Também
+ * confere que voltar para a posicional limita um integral fora da faixa.
+ *
+ * Uso: pid_check (código de saída 0 = passou; roda pelo ctest)
+ */
+
+#include "sim_hal.h"
+#include "pid_controller.h"
+#include "pico/time.h"
+#include "dryer_config.h"
+#include <math.h>
+#include <stdio.h>
+
+#define CHECK_CYCLES 480               // 20 min a cada SENSOR_TASK_PERIOD_MS
+#define CHECK_SWITCH_TO_VELOCITY 120
+#define CHECK_SWITCH_TO_POSITIONAL 300
+#define CHECK_TOLERANCE 1e-3f          // Diferença aceita na saída (%)
+#define CHECK_PLANT_TAU_S 600.0f
+
+static int failures;
+
+static void expect(bool ok, const char *what) {
+    printf("%s: %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+static void setup(pid_controller_t *pid) {
+    static const pid_gain_entry_t schedule[] = PID_GAIN_SCHEDULE;
+    pid_init(pid, PID_KP, PID_KI, PID_KD, PID_OUTPUT_MIN, PID_OUTPUT_MAX, PID_SAMPLE_TIME_MS);
+    pid_set_gain_schedule(pid, schedule, sizeof(schedule) / sizeof(schedule[0]));
+    pid_set_setpoint_weights(pid, PID_SETPOINT_WEIGHT_B, PID_SETPOINT_WEIGHT_C);
+    pid_set_derivative_filter(pid, PID_DERIVATIVE_FILTER_N);
+    pid_set_form(pid, PID_FORM_POSITIONAL);
+    pid_set_setpoint(pid, 60.0f);
+    pid_set_feedforward(pid, 35.0f);
+}
+
+// Planta de primeira ordem em torno do setpoint: 35% segura 60°C com 25°C
+// fora; o ambiente cai 3°C no meio (perturbação). Leitura em 0.1°C
+typedef struct {
+    float temp;
+} check_plant_t;
+
+static float plant_step(check_plant_t *plant, float output, int cycle) {
+    float ambient = (cycle >= 200 && cycle < 260) ? 22.0f : 25.0f;
+    float dt = SENSOR_TASK_PERIOD_MS / 1000.0f;
+    plant->temp += (ambient + output - plant->temp) * dt / CHECK_PLANT_TAU_S;
+    return roundf(plant->temp * 10.0f) / 10.0f;
+}
+
+static void check_same_output(void) {
+    pid_controller_t reference;
+    pid_controller_t switched;
+    setup(&reference);
+    setup(&switched);
+
+    check_plant_t plant = { .temp = 59.2f };
+    float pv = 59.2f;
+    float max_diff = 0.0f;
+    bool in_range = true;
+    for (int cycle = 0; cycle < CHECK_CYCLES; cycle++) {
+        if (cycle == CHECK_SWITCH_TO_VELOCITY) {
+            pid_set_form(&switched, PID_FORM_VELOCITY);
+        } else if (cycle == CHECK_SWITCH_TO_POSITIONAL) {
+            pid_set_form(&switched, PID_FORM_POSITIONAL);
+        }
+        sleep_ms(SENSOR_TASK_PERIOD_MS);
+        float a = pid_compute(&reference, pv);
+        float b = pid_compute(&switched, pv);
+        max_diff = fmaxf(max_diff, fabsf(a - b));
+        in_range = in_range && a > PID_OUTPUT_MIN && a < PID_OUTPUT_MAX &&
+                   fabsf(reference.integral) < reference.integral_max;
+        pv = plant_step(&plant, a, cycle);
+    }
+    printf("max output difference %.6f%%\n", max_diff);
+    expect(in_range, "output and integral stay inside their limits (valid comparison)");
+    expect(max_diff <= CHECK_TOLERANCE, "positional -> velocity -> positional gives the same output");
+}
+
+static void check_clamp_on_return(void) {
+    pid_controller_t pid;
+    setup(&pid);
+    pid_set_form(&pid, PID_FORM_VELOCITY);
+    pid.integral = 3.0f * pid.integral_max;
+    pid_set_form(&pid, PID_FORM_POSITIONAL);
+    expect(pid.integral == pid.integral_max, "switching back to positional clamps the integral");
+}
+
+int main(void) {
+    sim_hal_reset();
+    check_same_output();
+    check_clamp_on_return();
+    return failures ? 1 : 0;
+}
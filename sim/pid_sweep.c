@@ -0,0 +1,617 @@
+/**
+ * Filament Dryer - Varredura paralela de ganhos do PID
+ *
+ * Cada ponto (Kp, Ki, Kd, setpoint) é uma simulação independente em malha
+ * fechada do pid_controller.c real contra o modelo térmico da estufa, com o
+ * mesmo ciclo da tarefa de controle do firmware (leitura do DHT22 e PID a
+ * cada SENSOR_TASK_PERIOD_MS, corte por TEMP_OVERSHOOT_LIMIT). As simulações
+ * são distribuídas em um pool de threads; cada thread tem o seu próprio
+ * relógio virtual.
+ *
+ * Os resultados são ranqueados por uma função de custo (IAE, overshoot,
+ * energia) e a fronteira de Pareto dos três critérios é impressa.
+ *
+ * Uso:
+ *   pid_sweep [--grid N | --random N | --lhs N] [--kp MIN:MAX] [--ki MIN:MAX]
+ *             [--kd MIN:MAX] [--setpoints 45,60,80] [--minutes M]
+ *             [--weights IAE:OS:E[:NOISE]] [--threads T] [--top K] [--front K]
+ *             [--seed S] [--emit-schedule] [--b B] [--c C] [--n N] [--velocity 0|1]
+ *
+ * Com --emit-schedule cada setpoint também é otimizado separadamente e a
+ * tabela de ganhos é impressa no formato de PID_GAIN_SCHEDULE (dryer_config.h).
+ *
+ * Pesos do setpoint (b, c), filtro do derivativo (N) e forma de velocidade
+ * valem para todos os pontos; o padrão é o de dryer_config.h. O ruído da
+ * saída (RMS da variação do PWM por ciclo, após entrar na banda) mostra o
+ * efeito da quantização de 0.1°C do DHT22 em cada configuração.
+ */
+
+#include "sim_hal.h"
+#include "thermal_plant.h"
+#include "pid_controller.h"
+#include "pico/time.h"
+#include "dryer_config.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PLANT_STEP_US 500000           // Passo da planta: 500 ms (só o modelo térmico)
+#define MAX_SETPOINTS 8
+#define MAX_THREADS 256
+
+typedef enum {
+    SAMPLE_GRID,
+    SAMPLE_RANDOM,
+    SAMPLE_LHS
+} sample_mode_t;
+
+typedef struct {
+    float kp, ki, kd;
+    bool scheduled;             // Usar PID_GAIN_SCHEDULE de dryer_config.h
+} gains_t;
+
+// Resultado de uma simulação (um conjunto de ganhos em um setpoint)
+typedef struct {
+    float iae;                  // °C·min
+    float overshoot;            // °C
+    float energy;               // Wh
+    float settle_s;             // -1 se não acomodou na banda
+    float noise;                // RMS da variação do PWM por ciclo após entrar na banda (%)
+    uint32_t cutoffs;
+} run_result_t;
+
+// Resultado agregado de um conjunto de ganhos em todos os setpoints
+typedef struct {
+    gains_t gains;
+    float iae;
+    float overshoot;            // Pior caso entre os setpoints
+    float energy;
+    float noise;                // Média entre os setpoints
+    float cost;
+    uint32_t cutoffs;
+    int settled;                // Quantos setpoints acomodaram
+    bool pareto;
+} point_result_t;
+
+// Estrutura do PID comum a todos os pontos (2DOF, filtro, forma)
+typedef struct {
+    float b, c, n;
+    bool velocity;
+} pid_options_t;
+
+typedef struct {
+    gains_t *points;
+    point_result_t *results;
+    int point_count;
+    float setpoints[MAX_SETPOINTS];
+    int setpoint_count;
+    float minutes;
+    float band;
+    float w_iae, w_overshoot, w_energy, w_noise;
+    pid_options_t opts;
+    atomic_int next;
+} sweep_t;
+
+typedef struct {
+    thermal_plant_t *plant;
+} run_ctx_t;
+
+static void plant_step(void *ctx, uint64_t now_us) {
+    (void)now_us;
+    run_ctx_t *run = (run_ctx_t *)ctx;
+    thermal_plant_step(run->plant, PLANT_STEP_US / 1e6f);
+}
+
+// Uma sessão com o mesmo ciclo do main: lê o sensor, corte de overshoot, PID
+static run_result_t simulate(const gains_t *g, const pid_options_t *opts,
+                             float setpoint, float minutes, float band) {
+    run_result_t r = {0};
+    thermal_plant_params_t params;
+    thermal_plant_t plant;
+    run_ctx_t ctx = { .plant = &plant };
+
+    thermal_plant_default_params(&params);
+    params.model_moisture = false;
+    thermal_plant_init(&plant, &params);
+
+    sim_hal_reset();
+    sim_hal_set_step_hook(plant_step, &ctx, PLANT_STEP_US);
+
+    pid_controller_t pid;
+    pid_init(&pid, g->kp, g->ki, g->kd, PID_OUTPUT_MIN, PID_OUTPUT_MAX, PID_SAMPLE_TIME_MS);
+    if (g->scheduled) {
+        static const pid_gain_entry_t schedule[] = PID_GAIN_SCHEDULE;
+        pid_set_gain_schedule(&pid, schedule, sizeof(schedule) / sizeof(schedule[0]));
+    }
+    pid_set_setpoint_weights(&pid, opts->b, opts->c);
+    pid_set_derivative_filter(&pid, opts->n);
+    pid_set_form(&pid, opts->velocity ? PID_FORM_VELOCITY : PID_FORM_POSITIONAL);
+    pid_set_setpoint(&pid, setpoint);
+
+    const uint32_t cycles = (uint32_t)(minutes * 60000.0f / SENSOR_TASK_PERIOD_MS);
+    const float dt = SENSOR_TASK_PERIOD_MS / 1000.0f;
+    float max_temp = plant.air_temp;
+    bool overshoot_active = false;
+    int64_t in_band_since = -1;
+    bool reached = false;
+    float last_output = 0.0f;
+    double noise_sq = 0.0;
+    uint32_t noise_count = 0;
+
+    for (uint32_t i = 0; i < cycles; i++) {
+        sleep_ms(SENSOR_TASK_PERIOD_MS);
+
+        // DHT22: resolução de 0.1°C sobre a temperatura atrasada do sensor
+        float measured = roundf(plant.sensor_temp * 10.0f) / 10.0f;
+        float output;
+        bool overshoot = measured > setpoint + TEMP_OVERSHOOT_LIMIT;
+        if (overshoot) {
+            pid_reset(&pid);
+            output = 0.0f;
+            if (!overshoot_active) {
+                r.cutoffs++;
+            }
+        } else {
+            output = pid_compute(&pid, measured);
+        }
+        overshoot_active = overshoot;
+        plant.duty = output / 100.0f;
+        if (reached) {
+            noise_sq += (output - last_output) * (output - last_output);
+            noise_count++;
+        }
+        last_output = output;
+
+        float error = plant.air_temp - setpoint;
+        r.iae += fabsf(error) * dt;
+        if (plant.air_temp > max_temp) {
+            max_temp = plant.air_temp;
+        }
+        if (fabsf(error) <= band) {
+            reached = true;
+            if (in_band_since < 0) {
+                in_band_since = (int64_t)i;
+            }
+        } else {
+            in_band_since = -1;
+        }
+    }
+
+    r.iae /= 60.0f;
+    r.overshoot = max_temp > setpoint ? max_temp - setpoint : 0.0f;
+    r.energy = (float)(plant.energy_j / 3600.0);
+    r.settle_s = in_band_since >= 0 ? in_band_since * dt : -1.0f;
+    r.noise = noise_count > 0 ? (float)sqrt(noise_sq / noise_count) : 0.0f;
+    return r;
+}
+
+static void *worker(void *arg) {
+    sweep_t *sw = (sweep_t *)arg;
+
+    for (;;) {
+        int idx = atomic_fetch_add(&sw->next, 1);
+        if (idx >= sw->point_count) {
+            break;
+        }
+
+        point_result_t *res = &sw->results[idx];
+        memset(res, 0, sizeof(*res));
+        res->gains = sw->points[idx];
+
+        for (int s = 0; s < sw->setpoint_count; s++) {
+            run_result_t r = simulate(&res->gains, &sw->opts, sw->setpoints[s], sw->minutes, sw->band);
+            res->iae += r.iae;
+            res->energy += r.energy;
+            res->noise += r.noise / sw->setpoint_count;
+            res->cutoffs += r.cutoffs;
+            if (r.overshoot > res->overshoot) {
+                res->overshoot = r.overshoot;
+            }
+            if (r.settle_s >= 0.0f) {
+                res->settled++;
+            }
+        }
+
+        // Custo: overshoot pesa ao quadrado (perto do corte de segurança é inaceitável)
+        res->cost = sw->w_iae * res->iae +
+                    sw->w_overshoot * res->overshoot * res->overshoot +
+                    sw->w_energy * res->energy +
+                    sw->w_noise * res->noise;
+    }
+    return NULL;
+}
+
+static void run_pool(sweep_t *sw, int threads) {
+    pthread_t pool[MAX_THREADS];
+
+    atomic_store(&sw->next, 0);
+    for (int t = 0; t < threads; t++) {
+        pthread_create(&pool[t], NULL, worker, sw);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(pool[t], NULL);
+    }
+}
+
+// === AMOSTRAGEM ===
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static double rng_uniform(void) {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (double)((rng_state * 2685821657736338717ull) >> 11) / 9007199254740992.0;
+}
+
+static float lerp_range(const float range[2], double u) {
+    return (float)(range[0] + (range[1] - range[0]) * u);
+}
+
+static int generate_points(gains_t **out, sample_mode_t mode, int n, const float ranges[3][2]) {
+    int count = (mode == SAMPLE_GRID) ? n * n * n : n;
+    gains_t *pts = calloc((size_t)count, sizeof(gains_t));
+    if (!pts) {
+        return 0;
+    }
+
+    if (mode == SAMPLE_GRID) {
+        int idx = 0;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                for (int k = 0; k < n; k++) {
+                    double div = n > 1 ? (double)(n - 1) : 1.0;
+                    pts[idx].kp = lerp_range(ranges[0], i / div);
+                    pts[idx].ki = lerp_range(ranges[1], j / div);
+                    pts[idx].kd = lerp_range(ranges[2], k / div);
+                    idx++;
+                }
+            }
+        }
+    } else if (mode == SAMPLE_RANDOM) {
+        for (int i = 0; i < count; i++) {
+            pts[i].kp = lerp_range(ranges[0], rng_uniform());
+            pts[i].ki = lerp_range(ranges[1], rng_uniform());
+            pts[i].kd = lerp_range(ranges[2], rng_uniform());
+        }
+    } else {
+        // Latin hypercube: uma amostra por estrato em cada eixo, estratos embaralhados
+        int *perm = malloc((size_t)count * sizeof(int));
+        if (!perm) {
+            free(pts);
+            return 0;
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            for (int i = 0; i < count; i++) {
+                perm[i] = i;
+            }
+            for (int i = count - 1; i > 0; i--) {
+                int j = (int)(rng_uniform() * (i + 1));
+                int tmp = perm[i];
+                perm[i] = perm[j];
+                perm[j] = tmp;
+            }
+            for (int i = 0; i < count; i++) {
+                float v = lerp_range(ranges[axis], (perm[i] + rng_uniform()) / count);
+                if (axis == 0) {
+                    pts[i].kp = v;
+                } else if (axis == 1) {
+                    pts[i].ki = v;
+                } else {
+                    pts[i].kd = v;
+                }
+            }
+        }
+        free(perm);
+    }
+
+    *out = pts;
+    return count;
+}
+
+// === RANKING E PARETO ===
+
+static int compare_cost(const void *a, const void *b) {
+    const point_result_t *pa = (const point_result_t *)a;
+    const point_result_t *pb = (const point_result_t *)b;
+    return (pa->cost > pb->cost) - (pa->cost < pb->cost);
+}
+
+static int compare_iae(const void *a, const void *b) {
+    const point_result_t *pa = *(const point_result_t *const *)a;
+    const point_result_t *pb = *(const point_result_t *const *)b;
+    return (pa->iae > pb->iae) - (pa->iae < pb->iae);
+}
+
+static bool dominates(const point_result_t *a, const point_result_t *b) {
+    bool no_worse = a->iae <= b->iae && a->overshoot <= b->overshoot && a->energy <= b->energy;
+    bool better = a->iae < b->iae || a->overshoot < b->overshoot || a->energy < b->energy;
+    return no_worse && better;
+}
+
+// Ordenado por IAE, um ponto só pode ser dominado por quem tem IAE menor ou igual
+static int mark_pareto(point_result_t *results, int count, point_result_t ***front_out) {
+    point_result_t **sorted = malloc((size_t)count * sizeof(point_result_t *));
+    point_result_t **front = malloc((size_t)count * sizeof(point_result_t *));
+    int front_count = 0;
+
+    if (!sorted || !front) {
+        free(sorted);
+        free(front);
+        *front_out = NULL;
+        return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        sorted[i] = &results[i];
+    }
+    qsort(sorted, (size_t)count, sizeof(point_result_t *), compare_iae);
+
+    for (int i = 0; i < count; i++) {
+        bool dominated = false;
+        for (int j = 0; j < front_count && !dominated; j++) {
+            dominated = dominates(front[j], sorted[i]);
+        }
+        if (!dominated) {
+            // Pontos com IAE igual podem remover membros já aceitos
+            int keep = 0;
+            for (int j = 0; j < front_count; j++) {
+                if (!dominates(sorted[i], front[j])) {
+                    front[keep++] = front[j];
+                } else {
+                    front[j]->pareto = false;
+                }
+            }
+            front_count = keep;
+            sorted[i]->pareto = true;
+            front[front_count++] = sorted[i];
+        }
+    }
+
+    free(sorted);
+    *front_out = front;
+    return front_count;
+}
+
+static void print_row(int rank, const point_result_t *r, int setpoint_count) {
+    printf("%5d %8.3f %8.4f %8.3f %10.1f %9.2f %9.1f %8.2f %7lu %4d/%-3d %10.2f\n",
+           rank, r->gains.kp, r->gains.ki, r->gains.kd, r->iae, r->overshoot, r->energy,
+           r->noise, (unsigned long)r->cutoffs, r->settled, setpoint_count, r->cost);
+}
+
+static void print_header(void) {
+    printf("%5s %8s %8s %8s %10s %9s %9s %8s %7s %8s %10s\n",
+           "rank", "Kp", "Ki", "Kd", "IAE[C.min]", "OS[C]", "E[Wh]", "noise[%]", "cutoffs", "settled", "cost");
+}
+
+static bool parse_range(const char *s, float range[2]) {
+    return sscanf(s, "%f:%f", &range[0], &range[1]) == 2;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --grid N          N x N x N grid over Kp/Ki/Kd\n"
+            "  --random N        N uniform random points\n"
+            "  --lhs N           N Latin-hypercube points (default 1000)\n"
+            "  --kp MIN:MAX      Kp range (default 5:60)\n"
+            "  --ki MIN:MAX      Ki range (default 0.01:0.5)\n"
+            "  --kd MIN:MAX      Kd range (default 0:50)\n"
+            "  --setpoints LIST  Comma-separated setpoints (default 45,60,80)\n"
+            "  --minutes M       Session per run, from ambient (default 120)\n"
+            "  --band C          Settling band (default 1.0)\n"
+            "  --weights A:B:C[:D] Cost weights for IAE, overshoot^2, energy, output noise\n"
+            "                    (default 1:200:0.5:0)\n"
+            "  --b B             Setpoint weight on P (default PID_SETPOINT_WEIGHT_B)\n"
+            "  --c C             Setpoint weight on D (default PID_SETPOINT_WEIGHT_C)\n"
+            "  --n N             Derivative filter N, 0 = off (default PID_DERIVATIVE_FILTER_N)\n"
+            "  --velocity 0|1    Velocity form (default PID_VELOCITY_FORM)\n"
+            "  --threads T       Worker threads (default: all cores)\n"
+            "  --top K           Rows in the ranking (default 15)\n"
+            "  --front K         Max Pareto rows, evenly spaced by IAE (default 25)\n"
+            "  --seed S          Seed for random/LHS sampling\n"
+            "  --emit-schedule   Also optimise each setpoint alone and print PID_GAIN_SCHEDULE\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    sweep_t sw;
+    memset(&sw, 0, sizeof(sw));
+
+    sample_mode_t mode = SAMPLE_LHS;
+    int n = 1000;
+    float ranges[3][2] = { {5.0f, 60.0f}, {0.01f, 0.5f}, {0.0f, 50.0f} };
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int top = 15;
+    int front_rows = 25;
+    bool emit_schedule = false;
+
+    sw.setpoints[0] = 45.0f;
+    sw.setpoints[1] = 60.0f;
+    sw.setpoints[2] = 80.0f;
+    sw.setpoint_count = 3;
+    sw.minutes = 120.0f;
+    sw.band = 1.0f;
+    sw.w_iae = 1.0f;
+    sw.w_overshoot = 200.0f;
+    sw.w_energy = 0.5f;
+    sw.w_noise = 0.0f;
+    sw.opts.b = PID_SETPOINT_WEIGHT_B;
+    sw.opts.c = PID_SETPOINT_WEIGHT_C;
+    sw.opts.n = PID_DERIVATIVE_FILTER_N;
+    sw.opts.velocity = PID_VELOCITY_FORM;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool ok = true;
+
+        if (strcmp(arg, "--emit-schedule") == 0) {
+            emit_schedule = true;
+            continue;
+        }
+
+        if (!val) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(arg, "--grid") == 0) {
+            mode = SAMPLE_GRID;
+            n = atoi(val);
+        } else if (strcmp(arg, "--random") == 0) {
+            mode = SAMPLE_RANDOM;
+            n = atoi(val);
+        } else if (strcmp(arg, "--lhs") == 0) {
+            mode = SAMPLE_LHS;
+            n = atoi(val);
+        } else if (strcmp(arg, "--kp") == 0) {
+            ok = parse_range(val, ranges[0]);
+        } else if (strcmp(arg, "--ki") == 0) {
+            ok = parse_range(val, ranges[1]);
+        } else if (strcmp(arg, "--kd") == 0) {
+            ok = parse_range(val, ranges[2]);
+        } else if (strcmp(arg, "--setpoints") == 0) {
+            char buf[128];
+            snprintf(buf, sizeof(buf), "%s", val);
+            sw.setpoint_count = 0;
+            for (char *tok = strtok(buf, ","); tok && sw.setpoint_count < MAX_SETPOINTS;
+                 tok = strtok(NULL, ",")) {
+                sw.setpoints[sw.setpoint_count++] = (float)atof(tok);
+            }
+            ok = sw.setpoint_count > 0;
+        } else if (strcmp(arg, "--minutes") == 0) {
+            sw.minutes = (float)atof(val);
+        } else if (strcmp(arg, "--band") == 0) {
+            sw.band = (float)atof(val);
+        } else if (strcmp(arg, "--weights") == 0) {
+            ok = sscanf(val, "%f:%f:%f:%f", &sw.w_iae, &sw.w_overshoot, &sw.w_energy, &sw.w_noise) >= 3;
+        } else if (strcmp(arg, "--b") == 0) {
+            sw.opts.b = (float)atof(val);
+        } else if (strcmp(arg, "--c") == 0) {
+            sw.opts.c = (float)atof(val);
+        } else if (strcmp(arg, "--n") == 0) {
+            sw.opts.n = (float)atof(val);
+        } else if (strcmp(arg, "--velocity") == 0) {
+            sw.opts.velocity = atoi(val) != 0;
+        } else if (strcmp(arg, "--threads") == 0) {
+            threads = atoi(val);
+        } else if (strcmp(arg, "--top") == 0) {
+            top = atoi(val);
+        } else if (strcmp(arg, "--front") == 0) {
+            front_rows = atoi(val);
+        } else if (strcmp(arg, "--seed") == 0) {
+            rng_state ^= strtoull(val, NULL, 0) * 0xBF58476D1CE4E5B9ull;
+        } else {
+            ok = false;
+        }
+
+        if (!ok || n <= 0) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    if (threads < 1) {
+        threads = 1;
+    } else if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+
+    sw.point_count = generate_points(&sw.points, mode, n, ranges);
+    sw.results = calloc((size_t)sw.point_count, sizeof(point_result_t));
+    if (sw.point_count == 0 || !sw.results) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    atomic_init(&sw.next, 0);
+
+    struct timespec wall_start, wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+
+    run_pool(&sw, threads);
+
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    double wall_s = (wall_end.tv_sec - wall_start.tv_sec) + (wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+    long runs = (long)sw.point_count * sw.setpoint_count;
+
+    printf("=== PID GAIN SWEEP ===\n");
+    printf("%d gain sets x %d setpoints = %ld closed-loop runs of %.0f min on %d threads\n",
+           sw.point_count, sw.setpoint_count, runs, sw.minutes, threads);
+    printf("Wall time %.2f s (%.0f runs/s)\n", wall_s, wall_s > 0 ? runs / wall_s : 0.0);
+    printf("PID: b=%.2f c=%.2f N=%.1f %s form\n", sw.opts.b, sw.opts.c, sw.opts.n,
+           sw.opts.velocity ? "velocity" : "positional");
+    printf("Cost = %.2f*IAE + %.2f*overshoot^2 + %.2f*energy + %.2f*noise, summed over setpoints",
+           sw.w_iae, sw.w_overshoot, sw.w_energy, sw.w_noise);
+    printf(" (overshoot = worst setpoint)\n\n");
+
+    point_result_t **front;
+    int front_count = mark_pareto(sw.results, sw.point_count, &front);
+
+    // Fronteiras grandes são amostradas uniformemente ao longo do IAE
+    int shown = front_count < front_rows ? front_count : front_rows;
+    printf("Pareto front (IAE, overshoot, energy): %d points, showing %d by IAE\n",
+           front_count, shown);
+    print_header();
+    for (int i = 0; i < shown; i++) {
+        int idx = shown > 1 ? (int)((long)i * (front_count - 1) / (shown - 1)) : 0;
+        print_row(idx + 1, front[idx], sw.setpoint_count);
+    }
+    free(front);
+
+    qsort(sw.results, (size_t)sw.point_count, sizeof(point_result_t), compare_cost);
+    printf("\nBest %d by cost:\n", top < sw.point_count ? top : sw.point_count);
+    print_header();
+    for (int i = 0; i < top && i < sw.point_count; i++) {
+        print_row(i + 1, &sw.results[i], sw.setpoint_count);
+    }
+
+    if (emit_schedule) {
+        // Melhor conjunto de ganhos por setpoint, no formato de dryer_config.h
+        float all_setpoints[MAX_SETPOINTS];
+        int all_count = sw.setpoint_count;
+        memcpy(all_setpoints, sw.setpoints, sizeof(all_setpoints));
+
+        printf("\n#define PID_GAIN_SCHEDULE { \\\n");
+        for (int sp = 0; sp < all_count; sp++) {
+            sw.setpoints[0] = all_setpoints[sp];
+            sw.setpoint_count = 1;
+            run_pool(&sw, threads);
+
+            const point_result_t *best = &sw.results[0];
+            for (int i = 1; i < sw.point_count; i++) {
+                if (sw.results[i].cost < best->cost) {
+                    best = &sw.results[i];
+                }
+            }
+            printf("    { %.1ff, %.3ff, %.4ff, %.3ff }, /* IAE %.1f C.min, OS %.2f C */ \\\n",
+                   all_setpoints[sp], best->gains.kp, best->gains.ki, best->gains.kd,
+                   best->iae, best->overshoot);
+        }
+        printf("}\n");
+
+        memcpy(sw.setpoints, all_setpoints, sizeof(all_setpoints));
+        sw.setpoint_count = all_count;
+    }
+
+    printf("\nCurrent firmware gains (Kp=%.2f Ki=%.3f Kd=%.2f) for reference:\n", PID_KP, PID_KI, PID_KD);
+    sw.points[0] = (gains_t){ PID_KP, PID_KI, PID_KD, false };
+    sw.points[1] = (gains_t){ PID_KP, PID_KI, PID_KD, true };
+    sw.point_count = sw.point_count > 1 ? 2 : 1;
+    run_pool(&sw, 1);
+    print_header();
+    print_row(0, &sw.results[0], sw.setpoint_count);
+    if (sw.point_count > 1) {
+        printf("Configured PID_GAIN_SCHEDULE (gains interpolated per setpoint):\n");
+        print_row(0, &sw.results[1], sw.setpoint_count);
+    }
+
+    free(sw.points);
+    free(sw.results);
+    return 0;
+}
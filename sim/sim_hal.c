@@ -0,0 +1,1430 @@
+#include "sim_hal.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/adc.h"
+#include "hardware/spi.h"
+#include "pico/multicore.h"
+#include "hardware/watchdog.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include <math.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+#define SIM_NUM_GPIO 30
+#define SIM_NUM_PWM_SLICES 8
+#define SIM_NUM_ADC_INPUTS 5
+#define SIM_MAX_DHT22 5
+
+#define ADC_VREF 3.3f
+#define ADC_MAX_COUNTS 4095
+#define ADC_CONVERSION_US 2
+
+// Quadro do DHT22: liberação + resposta (3 segmentos), 40 bits (2 cada), fim
+#define DHT22_FRAME_SEGMENTS (3 + 40 * 2 + 1)
+#define DHT22_MIN_START_LOW_US 800
+
+#define SIM_CORE1_STACK_SIZE (256 * 1024)
+#define SIM_MAX_TIMERS 4
+#define SIM_WFE_SLICE_US 10000             // Granularidade do SEV entre núcleos no WFE
+#define SIM_MAX_CLOCK_LEVELS 8
+#define SIM_NUM_DMA_CHANNELS NUM_DMA_CHANNELS
+
+// Clocks no boot (PLL_SYS 125 MHz, XOSC 12 MHz, PLL_USB 48 MHz)
+#define SIM_SYS_CLOCK_HZ 125000000u
+#define SIM_REF_CLOCK_HZ 12000000u
+#define SIM_USB_CLOCK_HZ 48000000u
+
+// Custo de CPU do spi_write_blocking: chamada + espera do fim, e por byte a
+// CPU alimentando a FIFO (com clk_sys baixo a CPU limita, não o barramento)
+#define SIM_SPI_CALL_CYCLES 40
+#define SIM_SPI_BYTE_CYCLES 16
+
+// Estimativa de consumo do RP2040 (3.3 V): fixo (XOSC, PLLs, regulador), mais
+// proporcional ao clk_sys (barramento, SRAM, periféricos) e por núcleo fora
+// do WFE. Ordem de grandeza da tabela de consumo do datasheet, não medida.
+#define SIM_SUPPLY_V 3.3
+#define SIM_I_BASE_MA 1.5
+#define SIM_I_SYS_MA_PER_MHZ 0.06
+#define SIM_I_CORE_MA_PER_MHZ 0.12
+
+typedef struct {
+    uint gpio;
+    float temperature;
+    float humidity;
+    bool responding;
+
+    // Quadro em transmissão
+    bool active;
+    uint64_t start_us;
+    uint32_t seg_end[DHT22_FRAME_SEGMENTS];   // Fim de cada segmento (us desde start)
+    uint8_t seg_count;
+    uint8_t cursor;
+    uint32_t frames;
+} sim_dht22_t;
+
+// HX711: conversão contínua na taxa configurada; DOUT baixo com dado
+// pronto, cada subida do PD_SCK põe o próximo bit (MSB primeiro) e o 25º
+// pulso (canal A, ganho 128) termina a leitura. PD_SCK alto por mais de
+// HX711_POWER_DOWN_US desliga o conversor (leitura perdida)
+#define HX711_POWER_DOWN_US 60
+
+typedef struct {
+    bool attached;
+    uint dout;
+    uint sck;
+    uint64_t period_us;
+    int32_t counts;                         // Valor que a próxima conversão entrega
+    uint16_t noise;                         // Ruído (pico, contagens)
+    uint64_t ready_us;                      // Próximo dado pronto
+    bool reading;
+    uint8_t bits;                           // Pulsos desde o início da leitura
+    int32_t word;
+    bool out;                               // DOUT durante a leitura
+    uint32_t samples;
+    uint32_t lost;                          // Leituras perdidas por PD_SCK alto demais
+} sim_hx711_t;
+
+typedef struct {
+    bool claimed;
+    bool busy;
+    dma_channel_config cfg;
+    uint32_t reload_count;                  // TRANS_COUNT recarregado a cada disparo
+    dma_channel_hw_t hw;
+} sim_dma_t;
+
+typedef struct {
+    uint64_t now_us;                        // Relógio do núcleo em execução
+    uint64_t end_us;
+    jmp_buf *exit_jmp;
+
+    // Núcleos como corrotinas: roda sempre o que está com o relógio mais atrasado
+    int core;                               // Núcleo em execução
+    bool core1_active;
+    uint64_t core_now_us[2];
+    ucontext_t core_ctx[2];
+    void (*core1_entry)(void);
+    void *core1_stack;
+
+    sim_hal_step_fn step_fn;
+    void *step_ctx;
+    uint32_t step_period_us;
+    uint64_t next_step_us;
+
+    // Timers repetitivos (interrupção do alarme) e watchdog
+    repeating_timer_t *timers[SIM_MAX_TIMERS];
+    bool watchdog_enabled;
+    uint32_t watchdog_timeout_us;
+    uint64_t watchdog_last_us;
+    uint32_t watchdog_resets;
+
+    // Flash (contadores; o conteúdo é sim_flash_memory)
+    uint32_t flash_erases;                  // Setores apagados
+    uint32_t flash_programs;                // Páginas programadas
+
+    // Registro de evento do WFE por núcleo (SEV, interrupções)
+    volatile bool event[2];
+    uint64_t wfe_idle_us[2];
+    uint32_t wfe_wakeups[2];
+
+    // Clocks, tempo em cada frequência do clk_sys e ciclos fora do WFE
+    uint32_t clk_hz[CLK_COUNT];
+    bool peri_from_sys;                     // clk_peri derivado do clk_sys (padrão do SDK)
+    uint64_t clk_since_us;
+    uint32_t clk_level_hz[SIM_MAX_CLOCK_LEVELS];
+    uint64_t clk_level_us[SIM_MAX_CLOCK_LEVELS];
+    uint32_t clk_level_count;
+    uint32_t clk_switches;
+    bool core_running[2];
+    uint64_t core_since_us[2];
+    double core_cycles[2];
+
+    // GPIO
+    bool gpio_out[SIM_NUM_GPIO];
+    bool gpio_level[SIM_NUM_GPIO];          // Nível escrito pelo firmware
+    bool gpio_input[SIM_NUM_GPIO];          // Nível imposto externamente
+    bool gpio_input_set[SIM_NUM_GPIO];
+    bool gpio_pull_up[SIM_NUM_GPIO];
+    uint64_t gpio_fall_us[SIM_NUM_GPIO];
+    uint64_t gpio_rise_us[SIM_NUM_GPIO];
+    uint32_t gpio_irq_mask[SIM_NUM_GPIO];
+    gpio_irq_callback_t gpio_irq_callback;
+    int gpio_irq_core;
+
+    // PWM: nível em vigor e o escrito no CC (vale no próximo wrap); tempo
+    // ligado, duração e bordas acumulados período a período
+    uint16_t pwm_top[SIM_NUM_PWM_SLICES];
+    float pwm_div[SIM_NUM_PWM_SLICES];
+    uint16_t pwm_level[SIM_NUM_PWM_SLICES][2];
+    uint16_t pwm_pending[SIM_NUM_PWM_SLICES][2];
+    bool pwm_enabled[SIM_NUM_PWM_SLICES];
+    double pwm_wrap_us[SIM_NUM_PWM_SLICES]; // Próximo wrap (slice ligado)
+    double pwm_ctr[SIM_NUM_PWM_SLICES];     // Contador (slice parado)
+    bool pwm_forced_low[SIM_NUM_PWM_SLICES][2]; // gpio_set_outover(GPIO_OVERRIDE_LOW)
+    bool pwm_end_high[SIM_NUM_PWM_SLICES][2];   // Saída alta no fim do último período
+    double pwm_on_us[SIM_NUM_PWM_SLICES][2];    // Desde a última sim_hal_pwm_duty()
+    double pwm_span_us[SIM_NUM_PWM_SLICES];
+    double pwm_edges[SIM_NUM_PWM_SLICES][2];
+    uint8_t pwm_mode[SIM_NUM_PWM_SLICES];   // enum pwm_clkdiv_mode
+    double pwm_input_hz[SIM_NUM_PWM_SLICES];    // Pulsos no pino B (modos de contagem)
+    double pwm_input_ctr[SIM_NUM_PWM_SLICES];   // Bordas contadas / divisor
+    uint64_t pwm_input_us[SIM_NUM_PWM_SLICES];  // Contagem atualizada até aqui
+
+    // DMA
+    sim_dma_t dma[SIM_NUM_DMA_CHANNELS];
+
+    // ADC (entrada que acompanha a saída de um pino PWM: ex. corrente do heater)
+    uint adc_input;
+    float adc_volts[SIM_NUM_ADC_INPUTS];
+    int adc_pwm_gpio[SIM_NUM_ADC_INPUTS];   // -1 = tensão fixa
+    float adc_pwm_volts_on[SIM_NUM_ADC_INPUTS];
+    uint16_t adc_noise;
+    uint32_t noise_state;
+
+    // SPI
+    uint spi_baud;
+    uint32_t spi_peri_hz;                   // clk_peri quando o baud foi programado
+    uint64_t spi_bytes;
+    uint64_t spi_ns_pending;
+    uint64_t spi_stall_start_us;          // Barramento travado neste intervalo
+    uint64_t spi_stall_end_us;
+
+    sim_dht22_t dht[SIM_MAX_DHT22];
+    int dht_count;
+
+    sim_hx711_t hx711;
+} sim_hal_state_t;
+
+static _Thread_local sim_hal_state_t hal;
+
+// Conteúdo do flash: global (2 MB por thread seria demais) e fora do
+// sim_hal_reset(); só o dryer_sim, de uma thread, usa o flash
+uint8_t sim_flash_memory[PICO_FLASH_SIZE_BYTES];
+_Thread_local pwm_hw_t sim_pwm_hw;
+
+static void sim_pwm_advance_all(uint64_t now);
+static double sim_pwm_counter(uint slice);
+static void sim_pwm_set_counter_at(uint slice, double c);
+
+// === RELÓGIO VIRTUAL ===
+
+static void sim_switch_core(void) {
+    int from = hal.core;
+    hal.core_now_us[from] = hal.now_us;
+    hal.core = 1 - from;
+    hal.now_us = hal.core_now_us[hal.core];
+    swapcontext(&hal.core_ctx[from], &hal.core_ctx[hal.core]);
+}
+
+// Próximo timer ativo a vencer até 'until' (NULL se nenhum)
+static repeating_timer_t *sim_next_timer(uint64_t until) {
+    repeating_timer_t *next = NULL;
+    for (int i = 0; i < SIM_MAX_TIMERS; i++) {
+        repeating_timer_t *t = hal.timers[i];
+        if (t && t->active && t->next_us <= until && (!next || t->next_us < next->next_us)) {
+            next = t;
+        }
+    }
+    return next;
+}
+
+// Passos da planta, interrupções dos timers e watchdog em ordem de tempo.
+// Com wake_core >= 0 para no primeiro evento desse núcleo (WFE).
+static void sim_run_events(uint64_t until, int wake_core) {
+    while (!(wake_core >= 0 && hal.event[wake_core])) {
+        repeating_timer_t *timer = sim_next_timer(until);
+        bool step_due = hal.step_fn && hal.next_step_us <= until;
+
+        if (timer && (!step_due || timer->next_us < hal.next_step_us)) {
+            hal.now_us = timer->next_us;
+            timer->next_us += (uint64_t)(timer->delay_us < 0 ? -timer->delay_us : timer->delay_us);
+            if (!timer->callback(timer)) {
+                timer->active = false;
+            }
+            hal.event[timer->core] = true;   // Interrupção acorda o WFE do núcleo
+        } else if (step_due) {
+            hal.now_us = hal.next_step_us;
+            hal.next_step_us += hal.step_period_us;
+            hal.step_fn(hal.step_ctx, hal.now_us);
+        } else {
+            break;
+        }
+
+        // Sem atualização no prazo o RP2040 reiniciaria: contar e rearmar
+        if (hal.watchdog_enabled && hal.now_us - hal.watchdog_last_us > hal.watchdog_timeout_us) {
+            hal.watchdog_resets++;
+            hal.watchdog_last_us = hal.now_us;
+        }
+    }
+}
+
+static void sim_advance_to(uint64_t target, int wake_core) {
+    // O outro núcleo ficou para trás: ele roda até alcançar este. Assim o
+    // núcleo em execução tem sempre o menor relógio e a planta está em dia
+    // para ele; o tempo gasto em um núcleo não atrasa o outro.
+    if (hal.core1_active && hal.core_now_us[1 - hal.core] < target) {
+        hal.now_us = target;
+        sim_switch_core();
+        target = hal.now_us;
+        wake_core = -1; // Relógio já foi para target: os eventos até lá têm que rodar
+    }
+
+    uint64_t now = hal.now_us;
+    sim_run_events(target, wake_core);
+    if (wake_core >= 0 && hal.event[wake_core]) {
+        return; // Acordou no instante do evento
+    }
+    hal.now_us = target > now ? target : now;
+}
+
+static void sim_advance_us(uint64_t us) {
+    sim_advance_to(hal.now_us + us, -1);
+}
+
+// Acumula até 'now' o tempo na frequência atual do clk_sys e os ciclos dos
+// núcleos fora do WFE. Com relógios diferentes por núcleo o tempo nunca volta.
+static void sim_clock_account(uint64_t now) {
+    uint32_t hz = hal.clk_hz[clk_sys];
+
+    if (now > hal.clk_since_us) {
+        uint32_t i = 0;
+        while (i < hal.clk_level_count && hal.clk_level_hz[i] != hz) {
+            i++;
+        }
+        if (i == hal.clk_level_count && i < SIM_MAX_CLOCK_LEVELS) {
+            hal.clk_level_hz[i] = hz;
+            hal.clk_level_count++;
+        }
+        if (i < SIM_MAX_CLOCK_LEVELS) {
+            hal.clk_level_us[i] += now - hal.clk_since_us;
+        }
+        hal.clk_since_us = now;
+    }
+    for (int c = 0; c < 2; c++) {
+        if (hal.core_running[c] && now > hal.core_since_us[c]) {
+            hal.core_cycles[c] += (double)(now - hal.core_since_us[c]) * hz / 1e6;
+            hal.core_since_us[c] = now;
+        }
+    }
+}
+
+void sim_hal_reset(void) {
+    memset(&hal, 0, sizeof(hal));
+    hal.noise_state = 0x12345678u;
+    for (int i = 0; i < SIM_NUM_PWM_SLICES; i++) {
+        hal.pwm_top[i] = 0xffff;
+        hal.pwm_div[i] = 1.0f;
+    }
+    hal.clk_hz[clk_ref] = SIM_REF_CLOCK_HZ;
+    hal.clk_hz[clk_sys] = SIM_SYS_CLOCK_HZ;
+    hal.clk_hz[clk_peri] = SIM_SYS_CLOCK_HZ;
+    hal.clk_hz[clk_usb] = SIM_USB_CLOCK_HZ;
+    hal.clk_hz[clk_adc] = SIM_USB_CLOCK_HZ;
+    hal.peri_from_sys = true;
+    hal.core_running[0] = true;
+    for (int i = 0; i < SIM_NUM_ADC_INPUTS; i++) {
+        hal.adc_pwm_gpio[i] = -1;
+    }
+    memset(&sim_pwm_hw, 0, sizeof(sim_pwm_hw));
+}
+
+void sim_hal_set_step_hook(sim_hal_step_fn fn, void *ctx, uint32_t period_us) {
+    hal.step_fn = fn;
+    hal.step_ctx = ctx;
+    hal.step_period_us = period_us;
+    hal.next_step_us = hal.now_us + period_us;
+}
+
+uint64_t sim_hal_run(int (*entry)(void), uint64_t duration_us) {
+    jmp_buf exit_jmp;
+
+    hal.end_us = hal.now_us + duration_us;
+    hal.exit_jmp = &exit_jmp;
+
+    if (setjmp(exit_jmp) == 0) {
+        entry();
+    }
+
+    hal.exit_jmp = NULL;
+    hal.core1_active = false;
+    free(hal.core1_stack);
+    hal.core1_stack = NULL;
+    return hal.now_us;
+}
+
+absolute_time_t get_absolute_time(void) {
+    return hal.now_us;
+}
+
+void sleep_us(uint64_t us) {
+    sim_advance_us(us);
+}
+
+// O firmware roda em loop infinito: encerrar na primeira espera longa após o fim
+static void sim_check_exit(void) {
+    if (!hal.exit_jmp || hal.now_us < hal.end_us) {
+        return;
+    }
+    if (hal.core == 1) {
+        // core1 para aqui; o fim da execução sai pela pilha do core0
+        hal.core1_active = false;
+        hal.core_now_us[1] = hal.now_us;
+        hal.core = 0;
+        hal.now_us = hal.core_now_us[0];
+        setcontext(&hal.core_ctx[0]);
+    }
+    longjmp(*hal.exit_jmp, 1);
+}
+
+static void sim_core1_trampoline(void) {
+    hal.core1_entry();
+    // Retorno do core1: fica parado até o fim
+    while (true) {
+        sleep_ms(1000);
+    }
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    if (hal.core1_active) {
+        return;
+    }
+    if (!hal.core1_stack) {
+        hal.core1_stack = malloc(SIM_CORE1_STACK_SIZE);
+    }
+    hal.core1_entry = entry;
+    getcontext(&hal.core_ctx[1]);
+    hal.core_ctx[1].uc_stack.ss_sp = hal.core1_stack;
+    hal.core_ctx[1].uc_stack.ss_size = SIM_CORE1_STACK_SIZE;
+    hal.core_ctx[1].uc_link = NULL;
+    makecontext(&hal.core_ctx[1], sim_core1_trampoline, 0);
+
+    // core1 começa no instante atual e roda na próxima espera do core0
+    hal.core_now_us[1] = hal.now_us;
+    hal.core1_active = true;
+    hal.core_running[1] = true;
+    hal.core_since_us[1] = hal.now_us;
+}
+
+void sleep_ms(uint32_t ms) {
+    sim_advance_us((uint64_t)ms * 1000u);
+    sim_check_exit();
+}
+
+void sleep_until(absolute_time_t t) {
+    if (t > hal.now_us) {
+        sim_advance_us(t - hal.now_us);
+    }
+    sim_check_exit();
+}
+
+// O WFE só sai pelo evento do próprio núcleo. Eventos do outro núcleo (SEV)
+// são vistos com atraso de até SIM_WFE_SLICE_US, porque o relógio deste
+// núcleo já foi adiantado quando o outro roda.
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp) {
+    int core = hal.core;
+    uint64_t start = hal.now_us;
+
+    sim_clock_account(start);
+    hal.core_running[core] = false;
+
+    while (!hal.event[core] && hal.now_us < timeout_timestamp) {
+        uint64_t slice = hal.now_us + SIM_WFE_SLICE_US;
+        sim_advance_to(slice < timeout_timestamp ? slice : timeout_timestamp, core);
+        sim_check_exit();
+    }
+
+    hal.event[core] = false;
+    hal.core_running[core] = true;
+    hal.core_since_us[core] = hal.now_us;
+    hal.wfe_idle_us[core] += hal.now_us - start;
+    hal.wfe_wakeups[core]++;
+    return hal.now_us >= timeout_timestamp;
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    return hal.clk_hz[clk_index];
+}
+
+bool clock_configure(enum clock_index clk_index, uint32_t src, uint32_t auxsrc,
+                     uint32_t src_freq, uint32_t freq) {
+    (void)src;
+    if (freq == 0 || freq > src_freq) {
+        return false;
+    }
+    // Contadores do PWM seguem de onde estavam no ritmo do clock novo
+    double pwm_ctr[SIM_NUM_PWM_SLICES];
+    if (clk_index == clk_sys) {
+        sim_pwm_advance_all(hal.now_us);
+        sim_clock_account(hal.now_us);
+        hal.clk_switches++;
+        if (hal.peri_from_sys) {
+            hal.clk_hz[clk_peri] = freq;
+        }
+        for (uint slice = 0; slice < SIM_NUM_PWM_SLICES; slice++) {
+            pwm_ctr[slice] = sim_pwm_counter(slice);
+        }
+    }
+    if (clk_index == clk_peri) {
+        hal.peri_from_sys = auxsrc == CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS;
+    }
+    hal.clk_hz[clk_index] = freq;
+    if (clk_index == clk_sys) {
+        for (uint slice = 0; slice < SIM_NUM_PWM_SLICES; slice++) {
+            sim_pwm_set_counter_at(slice, pwm_ctr[slice]);
+        }
+    }
+    return true;
+}
+
+void sim_hal_clock_stats(uint32_t *level_hz, uint64_t *level_us, uint32_t *levels, uint32_t *switches) {
+    sim_clock_account(hal.now_us);
+    for (uint32_t i = 0; i < hal.clk_level_count; i++) {
+        level_hz[i] = hal.clk_level_hz[i];
+        level_us[i] = hal.clk_level_us[i];
+    }
+    *levels = hal.clk_level_count;
+    *switches = hal.clk_switches;
+}
+
+float sim_hal_mcu_power_mw(void) {
+    sim_clock_account(hal.now_us);
+    if (hal.now_us == 0) {
+        return 0.0f;
+    }
+    double sys_mhz_us = 0.0;
+    for (uint32_t i = 0; i < hal.clk_level_count; i++) {
+        sys_mhz_us += hal.clk_level_hz[i] / 1e6 * (double)hal.clk_level_us[i];
+    }
+    double avg_sys_mhz = sys_mhz_us / (double)hal.now_us;
+    double avg_core_mhz = (hal.core_cycles[0] + hal.core_cycles[1]) / (double)hal.now_us;
+    double ma = SIM_I_BASE_MA + SIM_I_SYS_MA_PER_MHZ * avg_sys_mhz + SIM_I_CORE_MA_PER_MHZ * avg_core_mhz;
+    return (float)(SIM_SUPPLY_V * ma);
+}
+
+void __sev(void) {
+    hal.event[0] = true;
+    hal.event[1] = true;
+}
+
+void sim_hal_wfe_stats(int core, uint64_t *idle_us, uint32_t *wakeups) {
+    *idle_us = hal.wfe_idle_us[core];
+    *wakeups = hal.wfe_wakeups[core];
+}
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+bool stdio_usb_connected(void) {
+    return true;
+}
+
+// === TIMERS E WATCHDOG ===
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback,
+                            void *user_data, repeating_timer_t *out) {
+    for (int i = 0; i < SIM_MAX_TIMERS; i++) {
+        if (!hal.timers[i] || !hal.timers[i]->active) {
+            out->delay_us = delay_us;
+            out->callback = callback;
+            out->user_data = user_data;
+            out->next_us = hal.now_us + (uint64_t)(delay_us < 0 ? -delay_us : delay_us);
+            out->active = true;
+            out->core = (uint8_t)hal.core;
+            hal.timers[i] = out;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool cancel_repeating_timer(repeating_timer_t *timer) {
+    bool was_active = timer->active;
+    timer->active = false;
+    return was_active;
+}
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug) {
+    (void)pause_on_debug;
+    hal.watchdog_enabled = true;
+    hal.watchdog_timeout_us = delay_ms * 1000u;
+    hal.watchdog_last_us = hal.now_us;
+}
+
+void watchdog_update(void) {
+    hal.watchdog_last_us = hal.now_us;
+}
+
+bool watchdog_caused_reboot(void) {
+    return false;
+}
+
+uint32_t sim_hal_watchdog_resets(void) {
+    return hal.watchdog_resets;
+}
+
+// === Flash ===
+
+// O tempo de apagar/programar não passa no relógio virtual: o outro núcleo
+// estaria parado e a troca de corrotina no meio da operação não faz sentido
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE ||
+        flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+        fprintf(stderr, "sim_hal: flash_range_erase(0x%x, %zu) fora do alinhamento\n", flash_offs, count);
+        abort();
+    }
+    memset(sim_flash_memory + flash_offs, 0xFF, count);
+    hal.flash_erases += (uint32_t)(count / FLASH_SECTOR_SIZE);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE ||
+        flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+        fprintf(stderr, "sim_hal: flash_range_program(0x%x, %zu) fora do alinhamento\n", flash_offs, count);
+        abort();
+    }
+    // NOR: programar só leva bits de 1 para 0
+    for (size_t i = 0; i < count; i++) {
+        sim_flash_memory[flash_offs + i] &= data[i];
+    }
+    hal.flash_programs += (uint32_t)(count / FLASH_PAGE_SIZE);
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+    (void)enter_exit_timeout_ms;
+    func(param);
+    return PICO_OK;
+}
+
+bool flash_safe_execute_core_init(void) {
+    return true;
+}
+
+void sim_hal_flash_erase(void) {
+    memset(sim_flash_memory, 0xFF, sizeof(sim_flash_memory));
+}
+
+bool sim_hal_flash_load(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    size_t n = fread(sim_flash_memory, 1, sizeof(sim_flash_memory), f);
+    fclose(f);
+    return n == sizeof(sim_flash_memory);
+}
+
+bool sim_hal_flash_save(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    size_t n = fwrite(sim_flash_memory, 1, sizeof(sim_flash_memory), f);
+    return fclose(f) == 0 && n == sizeof(sim_flash_memory);
+}
+
+void sim_hal_flash_stats(uint32_t *erases, uint32_t *programs) {
+    *erases = hal.flash_erases;
+    *programs = hal.flash_programs;
+}
+
+// === DHT22 ===
+
+static sim_dht22_t *find_dht22(uint gpio) {
+    for (int i = 0; i < hal.dht_count; i++) {
+        if (hal.dht[i].gpio == gpio) {
+            return &hal.dht[i];
+        }
+    }
+    return NULL;
+}
+
+void sim_hal_dht22_attach(uint gpio) {
+    if (find_dht22(gpio) || hal.dht_count >= SIM_MAX_DHT22) {
+        return;
+    }
+    sim_dht22_t *dht = &hal.dht[hal.dht_count++];
+    memset(dht, 0, sizeof(*dht));
+    dht->gpio = gpio;
+    dht->temperature = 25.0f;
+    dht->humidity = 50.0f;
+    dht->responding = true;
+}
+
+// === HX711 ===
+
+static void hx711_clock(sim_hx711_t *hx, bool rising, uint64_t high_us) {
+    if (!rising) {
+        if (hx->reading && high_us > HX711_POWER_DOWN_US) {
+            // Conversor desligou no meio: volta com uma conversão nova
+            hx->reading = false;
+            hx->lost++;
+            hx->ready_us = hal.now_us + hx->period_us;
+        }
+        return;
+    }
+    if (!hx->reading) {
+        if (hal.now_us < hx->ready_us) {
+            return;                         // Sem dado pronto: pulso ignorado
+        }
+        int32_t noise = 0;
+        if (hx->noise) {
+            hal.noise_state = hal.noise_state * 1664525u + 1013904223u;
+            noise = (int32_t)((hal.noise_state >> 8) % (2u * hx->noise + 1u)) - hx->noise;
+        }
+        int32_t value = hx->counts + noise;
+        if (value > 0x7fffff) value = 0x7fffff;
+        if (value < -0x800000) value = -0x800000;
+        hx->word = value & 0xffffff;
+        hx->reading = true;
+        hx->bits = 0;
+    }
+    hx->bits++;
+    if (hx->bits <= 24) {
+        hx->out = (hx->word >> (24 - hx->bits)) & 1;
+        return;
+    }
+    // 25º pulso: fim da leitura, DOUT alto até a próxima conversão
+    hx->reading = false;
+    hx->samples++;
+    while (hx->ready_us <= hal.now_us) {
+        hx->ready_us += hx->period_us;
+    }
+}
+
+void sim_hal_hx711_attach(uint dout, uint sck, float rate_hz, uint16_t noise_counts) {
+    memset(&hal.hx711, 0, sizeof(hal.hx711));
+    hal.hx711.attached = true;
+    hal.hx711.dout = dout;
+    hal.hx711.sck = sck;
+    hal.hx711.period_us = (uint64_t)(1e6f / rate_hz);
+    hal.hx711.noise = noise_counts;
+    hal.hx711.ready_us = hal.hx711.period_us;
+}
+
+void sim_hal_hx711_set(int32_t counts) {
+    hal.hx711.counts = counts;
+}
+
+uint32_t sim_hal_hx711_samples(uint32_t *lost) {
+    *lost = hal.hx711.lost;
+    return hal.hx711.samples;
+}
+
+void sim_hal_dht22_set(uint gpio, float temperature, float humidity, bool responding) {
+    sim_dht22_t *dht = find_dht22(gpio);
+    if (dht) {
+        dht->temperature = temperature;
+        dht->humidity = humidity;
+        dht->responding = responding;
+    }
+}
+
+uint32_t sim_hal_dht22_frames(uint gpio) {
+    sim_dht22_t *dht = find_dht22(gpio);
+    return dht ? dht->frames : 0;
+}
+
+// Monta os tempos do quadro: cada segmento alterna nível, começando em alto
+static void dht22_start_frame(sim_dht22_t *dht, uint64_t start_us) {
+    uint8_t data[5];
+    int32_t hum_raw = (int32_t)(dht->humidity * 10.0f + 0.5f);
+    int32_t temp_raw = (int32_t)(dht->temperature * 10.0f + (dht->temperature >= 0 ? 0.5f : -0.5f));
+    uint16_t temp_bits = temp_raw < 0 ? (uint16_t)(0x8000 | (-temp_raw)) : (uint16_t)temp_raw;
+
+    data[0] = (uint8_t)(hum_raw >> 8);
+    data[1] = (uint8_t)hum_raw;
+    data[2] = (uint8_t)(temp_bits >> 8);
+    data[3] = (uint8_t)temp_bits;
+    data[4] = (uint8_t)(data[0] + data[1] + data[2] + data[3]);
+
+    uint32_t t = 0;
+    uint8_t n = 0;
+    dht->seg_end[n++] = t += 30;     // Pull-up após o host liberar
+    dht->seg_end[n++] = t += 80;     // Resposta baixa
+    dht->seg_end[n++] = t += 80;     // Resposta alta
+    for (int i = 0; i < 40; i++) {
+        bool one = data[i / 8] & (0x80 >> (i % 8));
+        dht->seg_end[n++] = t += 50;             // Início do bit (baixo)
+        dht->seg_end[n++] = t += one ? 70 : 26;  // Duração alta define o bit
+    }
+    dht->seg_end[n++] = t += 50;     // Fim de transmissão
+    dht->seg_count = n;
+    dht->cursor = 0;
+    dht->start_us = start_us;
+    dht->active = true;
+    dht->frames++;
+}
+
+static bool dht22_line_level(sim_dht22_t *dht) {
+    uint64_t elapsed = hal.now_us - dht->start_us;
+
+    while (dht->cursor < dht->seg_count && elapsed >= dht->seg_end[dht->cursor]) {
+        dht->cursor++;
+    }
+    if (dht->cursor >= dht->seg_count) {
+        dht->active = false;
+        return true;  // Linha volta ao repouso (pull-up)
+    }
+    // Segmentos pares são altos, ímpares são baixos
+    return (dht->cursor % 2) == 0;
+}
+
+// === GPIO ===
+
+void gpio_init(uint gpio) {
+    hal.gpio_out[gpio] = false;
+    hal.gpio_level[gpio] = false;
+}
+
+void gpio_set_function(uint gpio, gpio_function_t fn) {
+    (void)gpio;
+    (void)fn;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    bool was_out = hal.gpio_out[gpio];
+    hal.gpio_out[gpio] = out;
+
+    // Host soltou a linha depois do pulso de início do DHT22
+    sim_dht22_t *dht = find_dht22(gpio);
+    if (dht && was_out && !out && dht->responding &&
+        hal.gpio_rise_us[gpio] >= hal.gpio_fall_us[gpio] &&
+        hal.gpio_rise_us[gpio] - hal.gpio_fall_us[gpio] >= DHT22_MIN_START_LOW_US) {
+        dht22_start_frame(dht, hal.gpio_rise_us[gpio]);
+    }
+}
+
+void gpio_put(uint gpio, bool value) {
+    if (hal.hx711.attached && gpio == hal.hx711.sck && hal.gpio_level[gpio] != value) {
+        hx711_clock(&hal.hx711, value, value ? 0 : hal.now_us - hal.gpio_rise_us[gpio]);
+    }
+    if (hal.gpio_level[gpio] != value) {
+        if (value) {
+            hal.gpio_rise_us[gpio] = hal.now_us;
+        } else {
+            hal.gpio_fall_us[gpio] = hal.now_us;
+        }
+    }
+    hal.gpio_level[gpio] = value;
+}
+
+bool gpio_get(uint gpio) {
+    if (hal.gpio_out[gpio]) {
+        return hal.gpio_level[gpio];
+    }
+
+    sim_dht22_t *dht = find_dht22(gpio);
+    if (dht && dht->active) {
+        return dht22_line_level(dht);
+    }
+    if (hal.hx711.attached && gpio == hal.hx711.dout) {
+        return hal.hx711.reading ? hal.hx711.out : hal.now_us < hal.hx711.ready_us;
+    }
+
+    if (hal.gpio_input_set[gpio]) {
+        return hal.gpio_input[gpio];
+    }
+    return hal.gpio_pull_up[gpio];
+}
+
+void gpio_pull_up(uint gpio) {
+    hal.gpio_pull_up[gpio] = true;
+}
+
+void gpio_pull_down(uint gpio) {
+    hal.gpio_pull_up[gpio] = false;
+}
+
+void gpio_disable_pulls(uint gpio) {
+    hal.gpio_pull_up[gpio] = false;
+}
+
+void gpio_set_outover(uint gpio, uint value) {
+    uint slice = pwm_gpio_to_slice_num(gpio);
+    sim_pwm_advance_all(hal.now_us);
+    hal.pwm_forced_low[slice][pwm_gpio_to_channel(gpio)] = value == GPIO_OVERRIDE_LOW;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled,
+                                        gpio_irq_callback_t callback) {
+    if (enabled) {
+        hal.gpio_irq_mask[gpio] |= event_mask;
+    } else {
+        hal.gpio_irq_mask[gpio] &= ~event_mask;
+    }
+    hal.gpio_irq_callback = callback;
+    hal.gpio_irq_core = hal.core;
+}
+
+void sim_hal_set_gpio_input(uint gpio, bool level) {
+    bool before = gpio_get(gpio);
+    hal.gpio_input[gpio] = level;
+    hal.gpio_input_set[gpio] = true;
+
+    // Borda habilitada: interrupção no núcleo que registrou o callback
+    uint32_t events = 0;
+    if (before != level) {
+        events = hal.gpio_irq_mask[gpio] & (level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL);
+    }
+    if (events && hal.gpio_irq_callback) {
+        hal.gpio_irq_callback(gpio, events);
+        hal.event[hal.gpio_irq_core] = true;
+    }
+}
+
+// === PWM ===
+
+static double sim_pwm_count_us(uint slice) {
+    return 1e6 * hal.pwm_div[slice] / (double)hal.clk_hz[clk_sys];
+}
+
+static double sim_pwm_period_us(uint slice) {
+    return sim_pwm_count_us(slice) * ((double)hal.pwm_top[slice] + 1.0);
+}
+
+static float sim_pwm_fraction(uint slice, uint chan) {
+    if (hal.pwm_forced_low[slice][chan]) {
+        return 0.0f;
+    }
+    float f = (float)hal.pwm_level[slice][chan] / ((float)hal.pwm_top[slice] + 1.0f);
+    return f > 1.0f ? 1.0f : f;
+}
+
+// Contabiliza n períodos com o nível em vigor: tempo ligado e bordas (subida
+// no início se a saída estava baixa, descida no meio se o nível não cobre o período)
+static void sim_pwm_account(uint slice, double period_us, uint64_t n) {
+    for (uint chan = 0; chan < 2; chan++) {
+        float f = sim_pwm_fraction(slice, chan);
+        bool start_high = f > 0.0f;
+        bool full = f >= 1.0f;
+
+        hal.pwm_on_us[slice][chan] += f * period_us * (double)n;
+        if (start_high && !full) {
+            hal.pwm_edges[slice][chan] += 2.0 * (double)n - (hal.pwm_end_high[slice][chan] ? 1.0 : 0.0);
+        } else if (start_high != hal.pwm_end_high[slice][chan]) {
+            hal.pwm_edges[slice][chan] += 1.0;
+        }
+        hal.pwm_end_high[slice][chan] = full;
+    }
+    hal.pwm_span_us[slice] += period_us * (double)n;
+}
+
+static void sim_dma_trigger(uint channel);
+
+// Canal ocupado pacejado pelo wrap do slice (-1 = nenhum)
+static int sim_pwm_dma(uint slice) {
+    for (int c = 0; c < SIM_NUM_DMA_CHANNELS; c++) {
+        if (hal.dma[c].busy && hal.dma[c].cfg.dreq == DREQ_PWM_WRAP0 + slice) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+// Uma transferência do canal (32 bits) com destino no CC de um slice
+static void sim_dma_transfer_to_pwm(sim_dma_t *ch, uint slice) {
+    uint32_t value = *(const volatile uint32_t *)ch->hw.read_addr;
+    hal.pwm_pending[slice][0] = (uint16_t)(value & 0xffffu);
+    hal.pwm_pending[slice][1] = (uint16_t)(value >> 16);
+    if (ch->cfg.read_increment) {
+        ch->hw.read_addr += 4;
+    }
+    if (--ch->hw.transfer_count == 0) {
+        ch->busy = false;
+        uint self = (uint)(ch - hal.dma);
+        if (ch->cfg.chain_to != self) {
+            sim_dma_trigger(ch->cfg.chain_to);
+        }
+    }
+}
+
+// Avança o slice até 'now': a cada wrap o CC escrito passa a valer e o DMA
+// pacejado pelo slice faz uma transferência. Sem DMA os períodos iguais
+// seguidos são contabilizados de uma vez.
+static void sim_pwm_advance(uint slice, uint64_t now) {
+    if (hal.pwm_mode[slice] != PWM_DIV_FREE_RUNNING) {
+        // Contagem de bordas: uma por pulso nos modos de borda; no modo de
+        // nível o clock conta enquanto B está alto (onda quadrada: metade)
+        if (hal.pwm_enabled[slice] && now > hal.pwm_input_us[slice]) {
+            double rate = hal.pwm_mode[slice] == PWM_DIV_B_HIGH ?
+                          (hal.pwm_input_hz[slice] > 0.0 ? hal.clk_hz[clk_sys] * 0.5 : 0.0) :
+                          hal.pwm_input_hz[slice];
+            hal.pwm_input_ctr[slice] += rate * (double)(now - hal.pwm_input_us[slice]) / 1e6 /
+                                        hal.pwm_div[slice];
+        }
+        hal.pwm_input_us[slice] = now;
+        return;
+    }
+    if (!hal.pwm_enabled[slice]) {
+        return;
+    }
+    double period = sim_pwm_period_us(slice);
+    while (hal.pwm_wrap_us[slice] <= (double)now) {
+        hal.pwm_level[slice][0] = hal.pwm_pending[slice][0];
+        hal.pwm_level[slice][1] = hal.pwm_pending[slice][1];
+
+        int dma = sim_pwm_dma(slice);
+        if (dma < 0) {
+            uint64_t n = (uint64_t)(((double)now - hal.pwm_wrap_us[slice]) / period) + 1;
+            sim_pwm_account(slice, period, n);
+            hal.pwm_wrap_us[slice] += period * (double)n;
+            break;
+        }
+        sim_pwm_account(slice, period, 1);
+        sim_dma_transfer_to_pwm(&hal.dma[dma], slice);
+        hal.pwm_wrap_us[slice] += period;
+    }
+}
+
+static void sim_pwm_advance_all(uint64_t now) {
+    for (uint slice = 0; slice < SIM_NUM_PWM_SLICES; slice++) {
+        sim_pwm_advance(slice, now);
+    }
+}
+
+// Contador do slice agora (fracionário; slice já avançado até agora)
+static double sim_pwm_counter(uint slice) {
+    if (!hal.pwm_enabled[slice]) {
+        return hal.pwm_ctr[slice];
+    }
+    double c = (double)hal.pwm_top[slice] + 1.0 -
+               (hal.pwm_wrap_us[slice] - (double)hal.now_us) / sim_pwm_count_us(slice);
+    return c < 0.0 ? 0.0 : c;
+}
+
+// Reposiciona o próximo wrap para o contador c com o divisor e clock atuais
+static void sim_pwm_set_counter_at(uint slice, double c) {
+    if (!hal.pwm_enabled[slice]) {
+        hal.pwm_ctr[slice] = c;
+        return;
+    }
+    hal.pwm_wrap_us[slice] = (double)hal.now_us +
+                             ((double)hal.pwm_top[slice] + 1.0 - c) * sim_pwm_count_us(slice);
+}
+
+static void sim_pwm_enable(uint slice, bool enabled) {
+    sim_pwm_advance(slice, hal.now_us);
+    if (enabled == hal.pwm_enabled[slice]) {
+        return;
+    }
+    if (hal.pwm_mode[slice] != PWM_DIV_FREE_RUNNING) {
+        hal.pwm_enabled[slice] = enabled;
+        sim_pwm_hw.en = enabled ? (sim_pwm_hw.en | (1u << slice)) : (sim_pwm_hw.en & ~(1u << slice));
+        return;
+    }
+    double c = sim_pwm_counter(slice);
+    hal.pwm_enabled[slice] = enabled;
+    sim_pwm_set_counter_at(slice, c);
+    if (enabled) {
+        sim_pwm_hw.en |= 1u << slice;
+    } else {
+        sim_pwm_hw.en &= ~(1u << slice);
+    }
+}
+
+void pwm_init(uint slice_num, pwm_config *c, bool start) {
+    hal.pwm_top[slice_num] = c->top;
+    hal.pwm_div[slice_num] = c->clkdiv;
+    hal.pwm_level[slice_num][0] = 0;
+    hal.pwm_level[slice_num][1] = 0;
+    hal.pwm_pending[slice_num][0] = 0;
+    hal.pwm_pending[slice_num][1] = 0;
+    hal.pwm_enabled[slice_num] = false;
+    hal.pwm_ctr[slice_num] = 0.0;
+    hal.pwm_mode[slice_num] = (uint8_t)c->mode;
+    hal.pwm_input_ctr[slice_num] = 0.0;
+    hal.pwm_input_us[slice_num] = hal.now_us;
+    sim_pwm_hw.en &= ~(1u << slice_num);
+    if (start && c->mode != PWM_DIV_FREE_RUNNING) {
+        sim_pwm_enable(slice_num, true);
+    } else if (start) {
+        // Primeiro wrap logo na partida: o nível escrito já vale
+        sim_pwm_enable(slice_num, true);
+        hal.pwm_wrap_us[slice_num] = (double)hal.now_us;
+    }
+}
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level) {
+    sim_pwm_advance(slice_num, hal.now_us);
+    hal.pwm_pending[slice_num][chan] = level;
+    if (!hal.pwm_enabled[slice_num]) {
+        hal.pwm_level[slice_num][chan] = level;
+    }
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+    sim_pwm_enable(slice_num, enabled);
+}
+
+void pwm_set_mask_enabled(uint32_t mask) {
+    sim_pwm_advance_all(hal.now_us);
+    for (uint slice = 0; slice < SIM_NUM_PWM_SLICES; slice++) {
+        sim_pwm_enable(slice, (mask >> slice) & 1u);
+    }
+}
+
+void pwm_set_counter(uint slice_num, uint16_t c) {
+    sim_pwm_advance(slice_num, hal.now_us);
+    if (hal.pwm_mode[slice_num] != PWM_DIV_FREE_RUNNING) {
+        hal.pwm_input_ctr[slice_num] = (double)c;
+        return;
+    }
+    sim_pwm_set_counter_at(slice_num, (double)c);
+}
+
+uint16_t pwm_get_counter(uint slice_num) {
+    sim_pwm_advance(slice_num, hal.now_us);
+    if (hal.pwm_mode[slice_num] != PWM_DIV_FREE_RUNNING) {
+        // Passa de TOP e volta a zero como o contador do hardware
+        return (uint16_t)fmod(hal.pwm_input_ctr[slice_num], (double)hal.pwm_top[slice_num] + 1.0);
+    }
+    return (uint16_t)sim_pwm_counter(slice_num);
+}
+
+void sim_hal_set_gpio_pulses(uint gpio, float hz) {
+    uint slice = pwm_gpio_to_slice_num(gpio);
+    sim_pwm_advance(slice, hal.now_us);
+    if (pwm_gpio_to_channel(gpio) == PWM_CHAN_B) {
+        hal.pwm_input_hz[slice] = hz > 0.0f ? hz : 0.0;
+    }
+}
+
+// O divisor vale na hora: o contador segue de onde estava no ritmo novo
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract) {
+    sim_pwm_advance(slice_num, hal.now_us);
+    double c = sim_pwm_counter(slice_num);
+    hal.pwm_div[slice_num] = (float)integer + (float)fract / 16.0f;
+    sim_pwm_set_counter_at(slice_num, c);
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {
+    sim_pwm_advance(slice_num, hal.now_us);
+    hal.pwm_top[slice_num] = wrap;
+}
+
+float sim_hal_pwm_frequency(uint gpio) {
+    uint slice = pwm_gpio_to_slice_num(gpio);
+    return (float)hal.clk_hz[clk_sys] / (hal.pwm_div[slice] * ((float)hal.pwm_top[slice] + 1.0f));
+}
+
+float sim_hal_pwm_duty(uint gpio) {
+    uint slice = pwm_gpio_to_slice_num(gpio);
+    uint chan = pwm_gpio_to_channel(gpio);
+
+    if (!hal.pwm_enabled[slice]) {
+        return 0.0f;
+    }
+    sim_pwm_advance(slice, hal.now_us);
+
+    // Com o nível trocado pelo DMA a cada período vale a média desde a última
+    // chamada; com nível fixo, o nível atual (como antes)
+    float duty = sim_pwm_fraction(slice, chan);
+    if (sim_pwm_dma(slice) >= 0 && hal.pwm_span_us[slice] > 0.0) {
+        duty = (float)(hal.pwm_on_us[slice][chan] / hal.pwm_span_us[slice]);
+    }
+    hal.pwm_on_us[slice][0] = 0.0;
+    hal.pwm_on_us[slice][1] = 0.0;
+    hal.pwm_span_us[slice] = 0.0;
+    return duty;
+}
+
+// Sobreposição de duas janelas [a, a + wa) e [b, b + wb) no círculo do período
+static double sim_pwm_overlap(double a, double wa, double b, double wb, double period) {
+    double total = 0.0;
+    for (int shift = -1; shift <= 1; shift++) {
+        double lo = fmax(a, b + shift * period);
+        double hi = fmin(a + wa, b + shift * period + wb);
+        if (hi > lo) {
+            total += hi - lo;
+        }
+    }
+    return total;
+}
+
+void sim_hal_pwm_supply_current(const uint *gpios, const float *amps, uint count,
+                                float *peak, float *rms) {
+    double start[SIM_NUM_PWM_SLICES * 2];
+    double width[SIM_NUM_PWM_SLICES * 2];
+    double period = 0.0;
+    double tolerance = 0.0;
+    uint n = count < SIM_NUM_PWM_SLICES * 2 ? count : SIM_NUM_PWM_SLICES * 2;
+
+    // Janela ligada de cada pino no período: começa no wrap do slice
+    sim_pwm_advance_all(hal.now_us);
+    for (uint i = 0; i < n; i++) {
+        uint slice = pwm_gpio_to_slice_num(gpios[i]);
+        double p = sim_pwm_period_us(slice);
+        if (period == 0.0) {
+            period = p;
+            tolerance = 0.5 * sim_pwm_count_us(slice);
+        }
+        start[i] = fmod(hal.pwm_wrap_us[slice], p);
+        width[i] = hal.pwm_enabled[slice] ? sim_pwm_fraction(slice, pwm_gpio_to_channel(gpios[i])) * p : 0.0;
+    }
+
+    // Pico: a soma só sobe no início de uma janela; sobreposição menor que
+    // meia contagem é arredondamento, não pico. Quadrado médio: soma de
+    // I_i * I_k pela sobreposição de cada par.
+    double max_sum = 0.0;
+    double square = 0.0;
+    for (uint i = 0; i < n; i++) {
+        if (width[i] <= 0.0) {
+            continue;
+        }
+        double sum = 0.0;
+        for (uint k = 0; k < n; k++) {
+            double offset = fmod(start[i] - start[k] + 2.0 * period, period);
+            if (width[k] >= period || (width[k] > 0.0 && offset < width[k] - tolerance)) {
+                sum += amps[k];
+            }
+            if (width[k] > 0.0) {
+                square += (double)amps[i] * amps[k] *
+                          sim_pwm_overlap(start[i], width[i], start[k], width[k], period) / period;
+            }
+        }
+        if (sum > max_sum) {
+            max_sum = sum;
+        }
+    }
+    *peak = (float)max_sum;
+    *rms = (float)sqrt(square);
+}
+
+uint64_t sim_hal_pwm_edges(uint gpio) {
+    uint slice = pwm_gpio_to_slice_num(gpio);
+    sim_pwm_advance(slice, hal.now_us);
+    return (uint64_t)hal.pwm_edges[slice][pwm_gpio_to_channel(gpio)];
+}
+
+// === DMA ===
+
+int dma_claim_unused_channel(bool required) {
+    for (int c = 0; c < SIM_NUM_DMA_CHANNELS; c++) {
+        if (!hal.dma[c].claimed) {
+            hal.dma[c].claimed = true;
+            return c;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "sim_hal: no free DMA channel\n");
+        abort();
+    }
+    return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    dma_channel_config c = {
+        .size = DMA_SIZE_32,
+        .read_increment = true,
+        .write_increment = false,
+        .dreq = DREQ_FORCE,
+        .chain_to = channel
+    };
+    return c;
+}
+
+// Destino é o gatilho de endereço de leitura de outro canal? (-1 = não)
+static int sim_dma_trigger_target(uintptr_t write_addr) {
+    for (int c = 0; c < SIM_NUM_DMA_CHANNELS; c++) {
+        if (write_addr == (uintptr_t)&hal.dma[c].hw.al3_read_addr_trig) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+// Destino é o CC de um slice? (-1 = não)
+static int sim_dma_pwm_target(uintptr_t write_addr) {
+    for (int s = 0; s < SIM_NUM_PWM_SLICES; s++) {
+        if (write_addr == (uintptr_t)&sim_pwm_hw.slice[s].cc) {
+            return s;
+        }
+    }
+    return -1;
+}
+
+// Disparo: recarrega a contagem. Canais sem DREQ rodam tudo na hora (no
+// RP2040 levam alguns ciclos); os pacejados pelo PWM andam no wrap.
+static void sim_dma_trigger(uint channel) {
+    sim_dma_t *ch = &hal.dma[channel];
+    ch->hw.transfer_count = ch->reload_count;
+    ch->busy = ch->reload_count > 0;
+    if (ch->cfg.dreq != DREQ_FORCE) {
+        return;
+    }
+
+    while (ch->busy) {
+        int target = sim_dma_trigger_target(ch->hw.write_addr);
+        int slice = sim_dma_pwm_target(ch->hw.write_addr);
+        if (slice >= 0) {
+            sim_dma_transfer_to_pwm(ch, (uint)slice);
+            continue;
+        }
+        if (target >= 0) {
+            // Endereço de leitura (ponteiro) e disparo do outro canal
+            hal.dma[target].hw.read_addr = *(const volatile uintptr_t *)ch->hw.read_addr;
+        }
+        if (ch->cfg.read_increment) {
+            ch->hw.read_addr += target >= 0 ? sizeof(uintptr_t) : 4;
+        }
+        bool done = --ch->hw.transfer_count == 0;
+        if (done) {
+            ch->busy = false;
+        }
+        if (target >= 0) {
+            sim_dma_trigger((uint)target);
+        }
+        if (done && ch->cfg.chain_to != channel) {
+            sim_dma_trigger(ch->cfg.chain_to);
+        }
+    }
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+    sim_pwm_advance_all(hal.now_us);
+    sim_dma_t *ch = &hal.dma[channel];
+    ch->cfg = *config;
+    ch->hw.write_addr = (uintptr_t)write_addr;
+    ch->hw.read_addr = (uintptr_t)read_addr;
+    ch->reload_count = transfer_count;
+    ch->hw.transfer_count = transfer_count;
+    if (trigger) {
+        sim_dma_trigger(channel);
+    }
+}
+
+void dma_channel_start(uint channel) {
+    sim_pwm_advance_all(hal.now_us);
+    sim_dma_trigger(channel);
+}
+
+void dma_channel_abort(uint channel) {
+    sim_pwm_advance_all(hal.now_us);
+    hal.dma[channel].busy = false;
+}
+
+bool dma_channel_is_busy(uint channel) {
+    sim_pwm_advance_all(hal.now_us);
+    return hal.dma[channel].busy;
+}
+
+dma_channel_hw_t *dma_channel_hw_addr(uint channel) {
+    sim_pwm_advance_all(hal.now_us);
+    return &hal.dma[channel].hw;
+}
+
+// === ADC ===
+
+void adc_init(void) {
+}
+
+void adc_gpio_init(uint gpio) {
+    hal.gpio_out[gpio] = false;
+}
+
+void adc_select_input(uint input) {
+    hal.adc_input = input;
+}
+
+void sim_hal_set_adc_voltage(uint input, float volts) {
+    if (input < SIM_NUM_ADC_INPUTS) {
+        hal.adc_volts[input] = volts;
+        hal.adc_pwm_gpio[input] = -1;
+    }
+}
+
+void sim_hal_set_adc_pwm_voltage(uint input, uint gpio, float volts_off, float volts_on) {
+    if (input < SIM_NUM_ADC_INPUTS) {
+        hal.adc_volts[input] = volts_off;
+        hal.adc_pwm_volts_on[input] = volts_on;
+        hal.adc_pwm_gpio[input] = (int)gpio;
+    }
+}
+
+void sim_hal_set_adc_noise(uint16_t counts) {
+    hal.adc_noise = counts;
+}
+
+uint16_t adc_read(void) {
+    sim_advance_us(ADC_CONVERSION_US);
+
+    float volts = hal.adc_volts[hal.adc_input];
+    int gpio = hal.adc_pwm_gpio[hal.adc_input];
+    if (gpio >= 0) {
+        // Média do período em curso (a conversão é curta perto do período do
+        // PWM, mas as amostras de uma leitura caem em fases diferentes)
+        uint slice = pwm_gpio_to_slice_num((uint)gpio);
+        sim_pwm_advance(slice, hal.now_us);
+        float f = hal.pwm_enabled[slice] ? sim_pwm_fraction(slice, pwm_gpio_to_channel((uint)gpio)) : 0.0f;
+        volts += (hal.adc_pwm_volts_on[hal.adc_input] - volts) * f;
+    }
+    float counts = volts / ADC_VREF * (ADC_MAX_COUNTS + 1);
+    if (hal.adc_noise) {
+        // LCG determinístico: ruído uniforme em [-noise, +noise]
+        hal.noise_state = hal.noise_state * 1664525u + 1013904223u;
+        int32_t span = 2 * hal.adc_noise + 1;
+        counts += (float)((int32_t)((hal.noise_state >> 8) % (uint32_t)span) - hal.adc_noise);
+    }
+
+    if (counts < 0.0f) {
+        return 0;
+    }
+    if (counts > ADC_MAX_COUNTS) {
+        return ADC_MAX_COUNTS;
+    }
+    return (uint16_t)counts;
+}
+
+// === SPI ===
+
+uint spi_init(spi_inst_t *spi, uint baudrate) {
+    (void)spi;
+    hal.spi_baud = baudrate;
+    hal.spi_peri_hz = hal.clk_hz[clk_peri];
+    return baudrate;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len) {
+    (void)spi;
+    (void)src;
+    hal.spi_bytes += len;
+
+    // Display travado: a transferência só termina quando o barramento volta
+    if (hal.now_us >= hal.spi_stall_start_us && hal.now_us < hal.spi_stall_end_us) {
+        sim_advance_us(hal.spi_stall_end_us - hal.now_us);
+    }
+
+    // Tempo de barramento (8 bits por byte; o baud acompanha o clk_peri) ou
+    // da CPU alimentando a FIFO, o que for maior, mais o custo da chamada
+    if (hal.spi_baud) {
+        uint64_t baud = (uint64_t)hal.spi_baud * hal.clk_hz[clk_peri] / hal.spi_peri_hz;
+        uint64_t sys_hz = hal.clk_hz[clk_sys];
+        uint64_t wire_ns = (uint64_t)len * 8u * 1000000000u / baud;
+        uint64_t cpu_ns = (uint64_t)len * SIM_SPI_BYTE_CYCLES * 1000000000u / sys_hz;
+        hal.spi_ns_pending += SIM_SPI_CALL_CYCLES * 1000000000ull / sys_hz +
+                              (wire_ns > cpu_ns ? wire_ns : cpu_ns);
+        if (hal.spi_ns_pending >= 1000u) {
+            sim_advance_us(hal.spi_ns_pending / 1000u);
+            hal.spi_ns_pending %= 1000u;
+        }
+    }
+    return (int)len;
+}
+
+void sim_hal_spi_stall(uint64_t start_us, uint64_t duration_us) {
+    hal.spi_stall_start_us = start_us;
+    hal.spi_stall_end_us = start_us + duration_us;
+}
+
+uint64_t sim_hal_spi_bytes(void) {
+    return hal.spi_bytes;
+}
@@ -0,0 +1,168 @@
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include "pico/types.h"
+
+/**
+ * HAL simulada do RP2040 para o build de host
+ *
+ * Implementa os pedaços do Pico SDK usados pelo firmware (tempo, GPIO, PWM,
+ * ADC, SPI) sobre um relógio virtual. Cada espera do firmware (sleep_ms,
+ * sleep_us, SPI bloqueante, conversão do ADC) avança o relógio e chama o
+ * passo da planta, então 24 h de operação rodam em segundos.
+ *
+ * Todo o estado é thread-local: cada thread pode rodar uma simulação
+ * independente com o seu próprio relógio.
+ *
+ * multicore_launch_core1() roda o core1 como corrotina com relógio próprio:
+ * a cada espera executa o núcleo mais atrasado, então o tempo gasto em um
+ * (SPI do display, por exemplo) não atrasa o outro.
+ */
+
+typedef void (*sim_hal_step_fn)(void *ctx, uint64_t now_us);
+
+/**
+ * Reinicia relógio e periféricos (tempo zero, pinos soltos, PWM parado)
+ */
+void sim_hal_reset(void);
+
+/**
+ * Registra a função chamada a cada period_us de tempo virtual (passo da planta)
+ */
+void sim_hal_set_step_hook(sim_hal_step_fn fn, void *ctx, uint32_t period_us);
+
+/**
+ * Executa entry() (normalmente o main() do firmware) até duration_us de
+ * tempo virtual. O firmware nunca retorna, então a HAL encerra a execução
+ * na primeira espera após o fim do tempo.
+ *
+ * @return Tempo virtual final (us)
+ */
+uint64_t sim_hal_run(int (*entry)(void), uint64_t duration_us);
+
+/**
+ * Duty cycle (0-1) aplicado no pino, considerando slice, canal e wrap. Com o
+ * nível trocado pelo DMA a cada período, a média desde a chamada anterior.
+ */
+float sim_hal_pwm_duty(uint gpio);
+
+/**
+ * Tensão vista pela entrada do ADC (0-3.3V) e ruído em contagens (pico)
+ */
+void sim_hal_set_adc_voltage(uint input, float volts);
+
+/**
+ * Entrada do ADC que segue a saída de um pino PWM (ex: ACS712 do heater):
+ * volts_off com a saída baixa, volts_on com ela alta, proporcional ao nível
+ * do período em curso
+ */
+void sim_hal_set_adc_pwm_voltage(uint input, uint gpio, float volts_off, float volts_on);
+void sim_hal_set_adc_noise(uint16_t counts);
+
+/**
+ * Nível de um pino de entrada externo (ex: botão pressionado = false)
+ */
+void sim_hal_set_gpio_input(uint gpio, bool level);
+
+/**
+ * Onda quadrada externa no pino (ex: tacômetro de ventoinha, hz = pulsos/s;
+ * 0 = parado). Só o canal B de um slice em modo de contagem a enxerga.
+ */
+void sim_hal_set_gpio_pulses(uint gpio, float hz);
+
+/**
+ * Emulação do protocolo de um fio do DHT22 no pino informado.
+ * Os valores são entregues no próximo quadro pedido pelo firmware.
+ *
+ * @param responding false simula sensor desconectado (sem resposta)
+ */
+void sim_hal_dht22_attach(uint gpio);
+void sim_hal_dht22_set(uint gpio, float temperature, float humidity, bool responding);
+
+/**
+ * Emulação do HX711 (célula de carga) nos pinos DOUT/PD_SCK: conversão
+ * contínua a rate_hz, canal A ganho 128
+ * @param noise_counts Ruído somado a cada conversão (pico, contagens)
+ */
+void sim_hal_hx711_attach(uint dout, uint sck, float rate_hz, uint16_t noise_counts);
+void sim_hal_hx711_set(int32_t counts);
+
+/**
+ * Leituras completas do HX711 e as perdidas por PD_SCK alto demais
+ */
+uint32_t sim_hal_hx711_samples(uint32_t *lost);
+
+/**
+ * Trava o SPI no intervalo: a primeira transferência dentro dele só volta
+ * no fim (display travado segurando o núcleo que o atende)
+ */
+void sim_hal_spi_stall(uint64_t start_us, uint64_t duration_us);
+
+/**
+ * Contadores de tráfego para avaliar custo de display e leituras
+ */
+uint64_t sim_hal_spi_bytes(void);
+uint32_t sim_hal_dht22_frames(uint gpio);
+
+/**
+ * Vezes em que o watchdog venceu sem watchdog_update() (no RP2040, reinícios)
+ */
+uint32_t sim_hal_watchdog_resets(void);
+
+/**
+ * Flash todo apagado (chip novo). O conteúdo não é zerado pelo
+ * sim_hal_reset(): chamar antes da primeira execução que usa o flash.
+ */
+void sim_hal_flash_erase(void);
+
+/**
+ * Imagem do flash de 2 MB em arquivo (ex: checkpoint entre duas execuções,
+ * simulando uma queda de energia)
+ */
+bool sim_hal_flash_load(const char *path);
+bool sim_hal_flash_save(const char *path);
+
+/**
+ * Setores apagados e páginas programadas desde o reset
+ */
+void sim_hal_flash_stats(uint32_t *erases, uint32_t *programs);
+
+/**
+ * Tempo dormindo em WFE e quantas vezes o núcleo acordou dele
+ */
+void sim_hal_wfe_stats(int core, uint64_t *idle_us, uint32_t *wakeups);
+
+/**
+ * Frequência do PWM no pino com o clk_sys, divisor e TOP atuais (Hz)
+ */
+float sim_hal_pwm_frequency(uint gpio);
+
+/**
+ * Bordas (subidas + descidas) na saída PWM do pino desde o início
+ */
+uint64_t sim_hal_pwm_edges(uint gpio);
+
+/**
+ * Corrente da fonte que alimenta vários pinos PWM no período em curso, pela
+ * fase (wrap de cada slice) e nível de cada um. Os slices devem ter o mesmo
+ * período.
+ * @param amps Corrente de cada pino com a saída alta (A)
+ * @param peak Recebe o pico instantâneo da soma (A)
+ * @param rms Recebe o valor eficaz da soma no período (A)
+ */
+void sim_hal_pwm_supply_current(const uint *gpios, const float *amps, uint count,
+                                float *peak, float *rms);
+
+/**
+ * Tempo em cada frequência do clk_sys (até 8 níveis) e trocas de clock
+ */
+void sim_hal_clock_stats(uint32_t *level_hz, uint64_t *level_us, uint32_t *levels, uint32_t *switches);
+
+/**
+ * Consumo médio estimado do RP2040 (mW): parte fixa, parte proporcional ao
+ * clk_sys e ciclos dos núcleos fora do WFE. Modelo de ordem de grandeza,
+ * serve para comparar pontos de operação.
+ */
+float sim_hal_mcu_power_mw(void);
+
+#endif // SIM_HAL_H
@@ -0,0 +1,101 @@
+#include "thermal_plant.h"
+#include <math.h>
+
+#define LATENT_HEAT_J_PER_G 2260.0f    // Calor latente de vaporização da água
+#define AIR_HEAT_J_PER_M3K 1206.0f     // Calor específico volumétrico do ar (~1.2 kg/m³)
+
+void thermal_plant_default_params(thermal_plant_params_t *params) {
+    params->supply_voltage = 12.0f;
+    params->heater_resistance = 3.0f;      // 4 A / 48 W a 100%
+
+    params->ambient_temp = 25.0f;
+    params->ambient_rh = 60.0f;
+    params->block_capacity = 40.0f;        // ~45 g de alumínio
+    params->block_to_air = 1.2f;           // Com a ventoinha de circulação ligada
+    params->chamber_capacity = 1500.0f;
+    params->chamber_loss = 0.5f;
+    params->chamber_loss_slope = 0.008f;   // Convecção externa cresce com o delta
+    params->sensor_tau = 8.0f;
+
+    params->chamber_volume = 0.06f;        // 60 L
+    params->air_exchange = 1.0f / 1800.0f; // ~2 trocas de ar por hora (frestas)
+    params->vent_air_exchange = 0.002f;    // Ventoinha de 40 mm na saída restrita: ~0.4 m³/h a 100%
+    params->water_mass = 5.0f;             // 1 kg de filamento com 0.5% de umidade
+    params->drying_rate = 7e-5f;           // Constante de ~4 h a 45°C
+    params->model_moisture = true;
+}
+
+float thermal_plant_saturation_density(float temp_c) {
+    // Equação de Magnus (hPa) convertida para g/m³
+    float es = 6.112f * expf(17.62f * temp_c / (243.12f + temp_c));
+    return 216.7f * es / (273.15f + temp_c);
+}
+
+void thermal_plant_init(thermal_plant_t *plant, const thermal_plant_params_t *params) {
+    plant->p = *params;
+    plant->block_temp = params->ambient_temp;
+    plant->air_temp = params->ambient_temp;
+    plant->sensor_temp = params->ambient_temp;
+    plant->water_mass = params->water_mass;
+    plant->vapor_density = thermal_plant_saturation_density(params->ambient_temp) *
+                           params->ambient_rh / 100.0f;
+    plant->duty = 0.0f;
+    plant->vent_duty = 0.0f;
+    plant->energy_j = 0.0;
+    plant->time_s = 0.0;
+}
+
+float thermal_plant_heater_max_power(const thermal_plant_t *plant) {
+    return plant->p.supply_voltage * plant->p.supply_voltage / plant->p.heater_resistance;
+}
+
+float thermal_plant_heater_current(const thermal_plant_t *plant) {
+    return plant->duty * plant->p.supply_voltage / plant->p.heater_resistance;
+}
+
+float thermal_plant_relative_humidity(const thermal_plant_t *plant) {
+    float rh = 100.0f * plant->vapor_density / thermal_plant_saturation_density(plant->air_temp);
+    return rh > 100.0f ? 100.0f : rh;
+}
+
+void thermal_plant_step(thermal_plant_t *plant, float dt) {
+    const thermal_plant_params_t *p = &plant->p;
+
+    float heater_power = plant->duty * thermal_plant_heater_max_power(plant);
+
+    // Fluxos de calor
+    float q_block_air = p->block_to_air * (plant->block_temp - plant->air_temp);
+    float delta_amb = plant->air_temp - p->ambient_temp;
+    float loss_conductance = p->chamber_loss * (1.0f + p->chamber_loss_slope * fabsf(delta_amb));
+    float vent_exchange = p->vent_air_exchange * plant->vent_duty;
+    float q_loss = (loss_conductance + AIR_HEAT_J_PER_M3K * p->chamber_volume * vent_exchange) * delta_amb;
+
+    // Evaporação da água do filamento (dobra a cada 10°C, para perto da saturação)
+    float evaporation = 0.0f;
+    if (p->model_moisture) {
+        float rh_fraction = thermal_plant_relative_humidity(plant) / 100.0f;
+        evaporation = p->drying_rate * plant->water_mass *
+                      exp2f((plant->air_temp - 45.0f) / 10.0f) * (1.0f - rh_fraction);
+        if (evaporation * dt > plant->water_mass) {
+            evaporation = plant->water_mass / dt;
+        }
+    }
+    float q_latent = evaporation * LATENT_HEAT_J_PER_G;
+
+    plant->block_temp += (heater_power - q_block_air) / p->block_capacity * dt;
+    plant->air_temp += (q_block_air - q_loss - q_latent) / p->chamber_capacity * dt;
+
+    // Atraso do DHT22 (filtro de primeira ordem)
+    plant->sensor_temp += (plant->air_temp - plant->sensor_temp) * dt / (p->sensor_tau + dt);
+
+    // Balanço de vapor: evaporação entra, troca de ar com o ambiente (frestas + exaustão) sai
+    if (p->model_moisture) {
+        float ambient_vapor = thermal_plant_saturation_density(p->ambient_temp) * p->ambient_rh / 100.0f;
+        plant->water_mass -= evaporation * dt;
+        plant->vapor_density += (evaporation / p->chamber_volume -
+                                 (p->air_exchange + vent_exchange) * (plant->vapor_density - ambient_vapor)) * dt;
+    }
+
+    plant->energy_j += heater_power * dt;
+    plant->time_s += dt;
+}
@@ -0,0 +1,98 @@
+#ifndef THERMAL_PLANT_H
+#define THERMAL_PLANT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Modelo térmico da estufa usado pelo simulador de host
+ *
+ * Três massas térmicas em série:
+ * - Bloco do heater (hotend + dissipador): recebe a potência elétrica
+ * - Ar da câmara: recebe calor do bloco pela ventoinha de circulação
+ * - Ambiente: temperatura fixa, perdas crescem com o delta de temperatura
+ *
+ * O DHT22 é modelado como um filtro de primeira ordem sobre a temperatura
+ * do ar (atraso do encapsulamento) e o ACS712 como a corrente média do
+ * heater no período de amostragem. A umidade vem de um modelo simples de
+ * evaporação da água do filamento e troca de ar com o ambiente. A ventoinha
+ * de exaustão soma troca de ar proporcional ao duty, que leva vapor e calor
+ * sensível (ar ambiente aquecido até a temperatura da câmara).
+ */
+typedef struct {
+    // Parâmetros elétricos
+    float supply_voltage;           // Tensão da fonte do heater (V)
+    float heater_resistance;        // Resistência do hotend (ohm)
+
+    // Parâmetros térmicos
+    float ambient_temp;             // Temperatura ambiente (°C)
+    float ambient_rh;               // Umidade relativa ambiente (%)
+    float block_capacity;           // Capacidade térmica do bloco (J/K)
+    float block_to_air;             // Condutância bloco -> ar (W/K)
+    float chamber_capacity;         // Capacidade térmica do ar + paredes + carretel (J/K)
+    float chamber_loss;             // Condutância câmara -> ambiente a delta zero (W/K)
+    float chamber_loss_slope;       // Aumento relativo da condutância por K de delta
+    float sensor_tau;               // Constante de tempo do DHT22 (s)
+
+    // Parâmetros de umidade
+    float chamber_volume;           // Volume de ar da câmara (m³)
+    float air_exchange;             // Trocas de ar com o ambiente (1/s)
+    float vent_air_exchange;        // Trocas extras com a exaustão a 100% (1/s)
+    float water_mass;               // Água no filamento (g)
+    float drying_rate;              // Taxa de evaporação a 45°C (1/s)
+    bool model_moisture;            // false = só o modelo térmico (varreduras rápidas)
+} thermal_plant_params_t;
+
+typedef struct {
+    thermal_plant_params_t p;
+
+    // Estado
+    float block_temp;               // Temperatura do bloco do heater (°C)
+    float air_temp;                 // Temperatura real do ar da câmara (°C)
+    float sensor_temp;              // Temperatura vista pelo DHT22 (°C)
+    float water_mass;               // Água restante no filamento (g)
+    float vapor_density;            // Vapor na câmara (g/m³)
+    float duty;                     // Duty cycle aplicado ao heater (0-1)
+    float vent_duty;                // Duty cycle da exaustão (0-1)
+
+    // Acumuladores
+    double energy_j;                // Energia elétrica entregue ao heater (J)
+    double time_s;                  // Tempo simulado (s)
+} thermal_plant_t;
+
+/**
+ * Preenche os parâmetros padrão (estufa de ~60 L com hotend de 48 W)
+ */
+void thermal_plant_default_params(thermal_plant_params_t *params);
+
+/**
+ * Inicializa a planta em equilíbrio com o ambiente
+ */
+void thermal_plant_init(thermal_plant_t *plant, const thermal_plant_params_t *params);
+
+/**
+ * Avança a planta dt segundos com o duty cycle atual
+ */
+void thermal_plant_step(thermal_plant_t *plant, float dt);
+
+/**
+ * Potência elétrica do heater com 100% de duty cycle (W)
+ */
+float thermal_plant_heater_max_power(const thermal_plant_t *plant);
+
+/**
+ * Corrente média do heater com o duty cycle atual (A)
+ */
+float thermal_plant_heater_current(const thermal_plant_t *plant);
+
+/**
+ * Umidade relativa da câmara vista pelo DHT22 (%)
+ */
+float thermal_plant_relative_humidity(const thermal_plant_t *plant);
+
+/**
+ * Densidade de vapor de saturação (g/m³) na temperatura dada (°C)
+ */
+float thermal_plant_saturation_density(float temp_c);
+
+#endif // THERMAL_PLANT_H
@@ -15,6 +15,7 @@ static bool button_debounced = false;
 static bool button_was_pressed = false;
 static bool button_in_fast_mode = false;
 static uint32_t button_last_fast_increment = 0;
+static button_edge_callback_t edge_callback = NULL;
 
 // Inicialização do módulo de controle de botão
 void button_controller_init(void) {
@@ -35,6 +36,19 @@ void button_controller_init(void) {
     LOGI(TAG, "Initialized (Button: GPIO %d)", BUTTON_PIN);
 }
 
+static void button_gpio_irq(uint gpio, uint32_t events) {
+    (void)events;
+    if (gpio == BUTTON_PIN && edge_callback) {
+        edge_callback();
+    }
+}
+
+void button_controller_set_edge_callback(button_edge_callback_t callback) {
+    edge_callback = callback;
+    gpio_set_irq_enabled_with_callback(BUTTON_PIN, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE,
+                                       true, button_gpio_irq);
+}
+
 // Debouncing digital do botão
 static bool button_read_debounced(void) {
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
@@ -150,4 +164,31 @@ bool button_controller_update(dryer_data_t *data) {
     }
     
     return temp_changed;  // Retorna se houve mudança de temperatura
-}
\ No newline at end of file
+}
+
+uint32_t button_controller_next_update_ms(void) {
+    uint32_t current_time = to_ms_since_boot(get_absolute_time());
+    uint32_t elapsed;
+    
+    // Mudança ainda não confirmada pelo debounce
+    if (button_prev_state != button_debounced) {
+        elapsed = current_time - button_last_change;
+        return elapsed < BUTTON_DEBOUNCE_MS ? BUTTON_DEBOUNCE_MS - elapsed : 1;
+    }
+    
+    // Segurando: início do modo rápido ou próximo incremento
+    if (button_state && button_was_pressed) {
+        if (!button_in_fast_mode) {
+            elapsed = current_time - button_press_start;
+            return elapsed < BUTTON_HOLD_THRESHOLD_MS ? BUTTON_HOLD_THRESHOLD_MS - elapsed : 1;
+        }
+        elapsed = current_time - button_last_fast_increment;
+        return elapsed < BUTTON_FAST_REPEAT_MS ? BUTTON_FAST_REPEAT_MS - elapsed : 1;
+    }
+    
+    return 0;
+}
+
+bool button_controller_pressed(void) {
+    return !gpio_get(BUTTON_PIN);  // Pull-up: pressionado = baixo
+}
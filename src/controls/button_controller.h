@@ -16,8 +16,29 @@
 #define TEMP_STEP_SINGLE 1                 // Incremento simples (°C)
 #define TEMP_STEP_FAST 5                   // Incremento rápido quando segurando (°C)
 
+typedef void (*button_edge_callback_t)(void);
+
 // Funções públicas do módulo
 void button_controller_init(void);
 bool button_controller_update(dryer_data_t *data);
 
+/**
+ * Habilita a interrupção nas duas bordas do botão. O callback roda na
+ * interrupção (só deve acordar quem chama button_controller_update()).
+ */
+void button_controller_set_edge_callback(button_edge_callback_t callback);
+
+/**
+ * Quanto falta para button_controller_update() precisar rodar de novo sem
+ * nova borda: fim do debounce, início do modo rápido ou próximo incremento
+ * rápido.
+ * @return ms até a próxima atualização; 0 = parado, só a próxima borda importa
+ */
+uint32_t button_controller_next_update_ms(void);
+
+/**
+ * Nível do botão agora, sem debounce (seleção do perfil no boot)
+ */
+bool button_controller_pressed(void);
+
 #endif // BUTTON_CONTROLLER_H
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "cascade.h"
+#include "logger.h"
+
+#define TAG "Cascade"
+
+void cascade_init(cascade_t *cascade, float kp, float ki, float kd, uint32_t sample_time_ms,
+                  float block_temp_max, float block_delta_full) {
+    // Forma de velocidade: variações da demanda (feed-forward) passam sem salto.
+    // O alvo muda em degraus a cada 5 s (0.1°C do DHT22 vira ~2°C no bloco): P e D
+    // só sobre a medida (b = c = 0) para o degrau não virar um pico de PWM; a
+    // demanda já leva a saída para o novo nível.
+    pid_init(&cascade->inner, kp, ki, kd, 0.0f, 100.0f, sample_time_ms);
+    pid_set_form(&cascade->inner, PID_FORM_VELOCITY);
+    pid_set_setpoint_weights(&cascade->inner, 0.0f, 0.0f);
+
+    cascade->block_temp_max = block_temp_max;
+    cascade->block_delta_full = block_delta_full;
+    cascade->demand = 0.0f;
+    cascade->chamber_temp = 0.0f;
+    cascade->block_target = 0.0f;
+    cascade->block_temp = 0.0f;
+    cascade->block_valid = false;
+    cascade->cutoff = false;
+}
+
+void cascade_set_demand(cascade_t *cascade, float demand, float chamber_temp) {
+    cascade->demand = demand;
+    cascade->chamber_temp = chamber_temp;
+
+    float target = chamber_temp + demand / 100.0f * cascade->block_delta_full;
+    if (target > cascade->block_temp_max) {
+        target = cascade->block_temp_max;
+    }
+    cascade->block_target = target;
+
+    // A própria demanda é o PWM previsto para o alvo: o PI só corrige o desvio
+    pid_set_setpoint(&cascade->inner, target);
+    pid_set_feedforward(&cascade->inner, demand);
+}
+
+float cascade_update(cascade_t *cascade, float block_temp, bool block_valid) {
+    cascade->block_temp = block_temp;
+
+    if (!block_valid) {
+        // Sem NTC: demanda direto no PWM, como no controle sem cascata
+        if (cascade->block_valid) {
+            LOGW(TAG, "Block sensor lost, driving heater directly");
+            cascade->block_valid = false;
+            cascade->cutoff = false;
+        }
+        return cascade->demand;
+    }
+    if (!cascade->block_valid) {
+        LOGI(TAG, "Inner loop active (block %.1f°C, max %.0f°C)", block_temp, cascade->block_temp_max);
+        cascade->block_valid = true;
+        pid_preload(&cascade->inner, cascade->demand, block_temp);
+    }
+
+    // Limite do bloco independente da câmara (proteção contra DHT22 travado, ventoinha parada)
+    if (block_temp > cascade->block_temp_max + CASCADE_BLOCK_CUTOFF_MARGIN) {
+        if (!cascade->cutoff) {
+            LOGE(TAG, "BLOCK OVERTEMPERATURE: %.1f°C > %.0f°C, heater off",
+                 block_temp, cascade->block_temp_max + CASCADE_BLOCK_CUTOFF_MARGIN);
+            cascade->cutoff = true;
+        }
+    } else if (cascade->cutoff && block_temp < cascade->block_temp_max) {
+        LOGI(TAG, "Block temperature back to %.1f°C, heater enabled", block_temp);
+        cascade->cutoff = false;
+    }
+
+    if (cascade->cutoff || cascade->demand <= 0.0f) {
+        // Continuar a partir de 0% quando voltar a aquecer
+        pid_preload(&cascade->inner, 0.0f, block_temp);
+        return 0.0f;
+    }
+
+    return pid_compute(&cascade->inner, block_temp);
+}
+
+void cascade_reset(cascade_t *cascade) {
+    cascade->demand = 0.0f;
+    pid_set_feedforward(&cascade->inner, 0.0f);
+}
@@ -0,0 +1,77 @@
+#ifndef CASCADE_H
+#define CASCADE_H
+
+#include "pid_controller.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Controle em cascata: malha interna no bloco do heater
+ *
+ * A malha externa (PID da câmara, feed-forward e pré-aquecimento, a cada
+ * leitura do DHT22) continua calculando a demanda de calor em %. Em vez de ir
+ * direto para o PWM, a demanda vira um alvo de temperatura para o bloco:
+ *
+ *   alvo = temperatura da câmara + demanda / 100 * block_delta_full
+ *
+ * O calor entregue à câmara é proporcional a (bloco - câmara), então a
+ * demanda mantém o significado de "% do calor máximo" e os ganhos, o
+ * feed-forward e o pré-aquecimento da malha externa continuam valendo.
+ *
+ * A malha interna (PI sobre o NTC do bloco, numa tarefa de 100 ms)
+ * corrige em segundos o que a externa só veria minutos depois
+ * pelo DHT22: variação da tensão da fonte, da ventoinha, porta aberta.
+ * O alvo do bloco é limitado a block_temp_max e, acima dele mais
+ * CASCADE_BLOCK_CUTOFF_MARGIN, o heater é desligado independente da câmara.
+ *
+ * Sem leitura válida do NTC a demanda vai direto para o PWM (controle
+ * simples, como sem a cascata).
+ */
+
+#define CASCADE_BLOCK_CUTOFF_MARGIN 5.0f    // Corte do heater acima do alvo máximo (°C)
+
+typedef struct {
+    pid_controller_t inner;             // PI do bloco: alvo (°C) -> PWM (%)
+    float block_temp_max;               // Limite do alvo do bloco (°C)
+    float block_delta_full;             // Bloco - câmara em regime com 100% de PWM (°C)
+
+    float demand;                       // Demanda da malha externa (%)
+    float chamber_temp;                 // Temperatura da câmara usada no alvo (°C)
+    float block_target;                 // Alvo atual do bloco (°C)
+    float block_temp;                   // Última leitura do bloco (°C)
+    bool block_valid;                   // NTC respondendo (malha interna ativa)
+    bool cutoff;                        // Heater desligado por temperatura do bloco
+} cascade_t;
+
+/**
+ * Inicializa a cascata
+ * @param kp, ki, kd Ganhos da malha interna (% por °C do bloco)
+ * @param sample_time_ms Período da malha interna (ms)
+ * @param block_temp_max Temperatura máxima permitida como alvo do bloco (°C)
+ * @param block_delta_full Bloco - câmara em regime com 100% de PWM (°C)
+ */
+void cascade_init(cascade_t *cascade, float kp, float ki, float kd, uint32_t sample_time_ms,
+                  float block_temp_max, float block_delta_full);
+
+/**
+ * Atualiza a demanda da malha externa (a cada ciclo da malha externa)
+ * @param demand Saída da malha externa (%)
+ * @param chamber_temp Temperatura atual da câmara (°C)
+ */
+void cascade_set_demand(cascade_t *cascade, float demand, float chamber_temp);
+
+/**
+ * Executa a malha interna
+ * @param block_temp Temperatura do bloco (°C)
+ * @param block_valid false se o NTC falhou (a demanda vai direto para o PWM)
+ * @return Duty cycle do heater (%)
+ */
+float cascade_update(cascade_t *cascade, float block_temp, bool block_valid);
+
+/**
+ * Zera a demanda: heater desligado até a próxima cascade_set_demand()
+ * (sensor inseguro, overshoot crítico)
+ */
+void cascade_reset(cascade_t *cascade);
+
+#endif // CASCADE_H
@@ -0,0 +1,184 @@
+#include "drying_endpoint.h"
+#include "vent_control.h"
+#include "logger.h"
+#include <math.h>
+
+#define TAG "Drying"
+
+#define DRYING_STEP_H (DRYING_STEP_MS / 3600000.0f)
+
+static void reset_window(drying_endpoint_t *de) {
+    de->band_since = 0;
+    de->step_count = 0;
+    de->step_sum = 0.0f;
+    de->count = 0;
+    de->head = 0;
+    de->done_points = 0;
+    if (de->state == DRYING_TRACKING) {
+        de->state = DRYING_SETTLING;
+    }
+    if (de->state != DRYING_DONE) {
+        de->tau_h = 0.0f;
+        de->eta_s = -1;
+    }
+}
+
+void drying_endpoint_init(drying_endpoint_t *de, float setpoint) {
+    de->state = DRYING_SETTLING;
+    de->setpoint = setpoint;
+    de->tau_h = 0.0f;
+    de->eta_s = -1;
+    de->last_ms = 0;
+    de->rate_gph = 0.0f;
+    de->removed_g = 0.0f;
+    de->peak_rate_gph = 0.0f;
+    de->remaining_g = 0.0f;
+    de->plateau = false;
+    de->done_ms = 0;
+    reset_window(de);
+}
+
+// Regressão de ln(taxa) nos pontos da janela (x em horas, mais antigo primeiro)
+// @return Inclinação (1/h); *ln_last recebe a reta no ponto mais novo
+static float fit_window(const drying_endpoint_t *de, float *ln_last) {
+    uint8_t n = de->count;
+    uint8_t first = (uint8_t)((de->head + DRYING_WINDOW_POINTS - n) % DRYING_WINDOW_POINTS);
+    float x_mean = (n - 1) / 2.0f;
+    float y_mean = 0.0f;
+    for (uint8_t i = 0; i < n; i++) {
+        y_mean += de->window[(first + i) % DRYING_WINDOW_POINTS];
+    }
+    y_mean /= n;
+    float sxy = 0.0f;
+    float sxx = 0.0f;
+    for (uint8_t i = 0; i < n; i++) {
+        float dx = i - x_mean;
+        sxy += dx * (de->window[(first + i) % DRYING_WINDOW_POINTS] - y_mean);
+        sxx += dx * dx;
+    }
+    float slope = sxx > 0.0f ? sxy / sxx : 0.0f;
+    *ln_last = y_mean + slope * x_mean;
+    return slope / DRYING_STEP_H;
+}
+
+// Projeção com a janela atual; fim pela fração restante ou pelo patamar
+static bool project(drying_endpoint_t *de) {
+    float ln_last;
+    float k = fit_window(de, &ln_last);
+    float rate_now = expf(ln_last);
+
+    if (k < -1.0f / DRYING_PLATEAU_TAU_H) {
+        de->plateau = false;
+        de->tau_h = -1.0f / k;
+        de->remaining_g = rate_now * de->tau_h;
+        float target = DRYING_DONE_REMAINING * (de->removed_g + de->remaining_g);
+        if (de->remaining_g <= target) {
+            de->eta_s = 0;
+            return true;
+        }
+        de->eta_s = (int32_t)(de->tau_h * logf(de->remaining_g / target) * 3600.0f);
+        return false;
+    }
+
+    // Taxa parada: patamar baixo é fim, alto (a água ainda sai) fica sem projeção
+    de->tau_h = 0.0f;
+    de->remaining_g = 0.0f;
+    de->eta_s = -1;
+    de->plateau = rate_now <= DRYING_PLATEAU_FRACTION * de->peak_rate_gph ||
+                  rate_now <= DRYING_DRY_RATE_GPH;
+    return de->plateau;
+}
+
+static void push_point(drying_endpoint_t *de, float rate, uint32_t now_ms) {
+    if (rate > de->peak_rate_gph) {
+        de->peak_rate_gph = rate;
+    }
+    de->window[de->head] = logf(rate > DRYING_RATE_FLOOR_GPH ? rate : DRYING_RATE_FLOOR_GPH);
+    de->head = (uint8_t)((de->head + 1) % DRYING_WINDOW_POINTS);
+    if (de->count < DRYING_WINDOW_POINTS) {
+        de->count++;
+    }
+    if (de->count < DRYING_MIN_POINTS || de->state == DRYING_DONE) {
+        return;
+    }
+
+    if (!project(de)) {
+        de->done_points = 0;
+        de->state = DRYING_TRACKING;
+        return;
+    }
+    if (++de->done_points < DRYING_CONFIRM_POINTS) {
+        de->state = DRYING_TRACKING;
+        return;
+    }
+    de->state = DRYING_DONE;
+    de->done_ms = now_ms;
+    de->eta_s = 0;
+    LOGI(TAG, "Drying complete (%s): %.2f g/h, %.1f g removed, peak %.2f g/h",
+         de->plateau ? "plateau" : "projection", rate, de->removed_g, de->peak_rate_gph);
+}
+
+drying_state_t drying_endpoint_update(drying_endpoint_t *de, float temperature, float humidity,
+                                      float ambient_temp, float ambient_rh, float setpoint,
+                                      float vent_percent, bool sensor_safe, uint32_t now_ms) {
+    if (!sensor_safe) {
+        de->last_ms = 0;
+        return de->state;
+    }
+
+    if (setpoint != de->setpoint) {
+        if (de->state == DRYING_DONE) {
+            // Setpoint novo depois do fim: lote novo
+            LOGI(TAG, "New batch at %.0f°C", setpoint);
+            drying_endpoint_init(de, setpoint);
+        }
+        de->setpoint = setpoint;
+        reset_window(de);
+    }
+
+    // Taxa de saída da água: excesso de umidade absoluta x vazão
+    float excess = vent_absolute_humidity(temperature, humidity) -
+                   vent_absolute_humidity(ambient_temp, ambient_rh);
+    float rate = excess * (DRYING_LEAK_M3H + DRYING_VENT_M3H * vent_percent / 100.0f);
+    if (rate < 0.0f) {
+        rate = 0.0f;
+    }
+    if (de->last_ms) {
+        de->removed_g += rate * (float)(now_ms - de->last_ms) / 3600000.0f;
+    }
+    de->last_ms = now_ms;
+    de->rate_gph = rate;
+
+    // Só com a câmara assentada no setpoint
+    if (fabsf(temperature - setpoint) > DRYING_TEMP_BAND) {
+        if (de->band_since) {
+            reset_window(de);
+        }
+        return de->state;
+    }
+    if (!de->band_since) {
+        de->band_since = now_ms;
+        de->step_start = now_ms + DRYING_SETTLE_MS;
+    }
+    if ((int32_t)(now_ms - de->step_start) < 0) {
+        return de->state;
+    }
+    de->step_sum += rate;
+    de->step_count++;
+    if (now_ms - de->step_start >= DRYING_STEP_MS) {
+        push_point(de, de->step_sum / de->step_count, now_ms);
+        de->step_start = now_ms;
+        de->step_sum = 0.0f;
+        de->step_count = 0;
+    }
+    return de->state;
+}
+
+const char *drying_endpoint_state_name(drying_state_t state) {
+    switch (state) {
+        case DRYING_SETTLING: return "SETTLING";
+        case DRYING_TRACKING: return "TRACKING";
+        case DRYING_DONE: return "DONE";
+        default: return "?";
+    }
+}
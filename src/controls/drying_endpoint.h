@@ -0,0 +1,103 @@
+#ifndef DRYING_ENDPOINT_H
+#define DRYING_ENDPOINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Fim da secagem e tempo restante pela tendência da umidade
+ *
+ * A água que sai do filamento sai da câmara pelas frestas e pela exaustão:
+ * com a câmara em regime, a taxa de secagem é o excesso de umidade absoluta
+ * sobre o ambiente vezes a vazão de ar,
+ *
+ *   taxa (g/h) = (UA(câmara) - UA(ambiente)) * (DRYING_LEAK_M3H + DRYING_VENT_M3H * exaustão)
+ *
+ * A cada
+ * DRYING_STEP_MS a taxa média vai para uma janela deslizante e uma regressão
+ * de ln(taxa) dá o decaimento: a taxa cai como a água que resta,
+ * exp(-t / tau), então a água que ainda sai é taxa * tau e o tempo até
+ * sobrar DRYING_DONE_REMAINING do total (tirada + restante) é
+ *
+ *   ETA = tau * ln(restante / (DRYING_DONE_REMAINING * total))
+ *
+ * A vazão só escala a taxa: a fração e o ETA não dependem dela. Por isso a
+ * perda de massa da célula de carga não entra aqui: ela é a medida certa da
+ * água tirada, mas misturada com a taxa estimada quebraria essa escala, e a
+ * inclinação de 30 min dela é ruidosa demais para o logaritmo.
+ *
+ * Patamar: a taxa parou de cair (tau acima de DRYING_PLATEAU_TAU_H, o
+ * excesso vira o erro do ambiente padrão ou do DHT22) já abaixo de
+ * DRYING_PLATEAU_FRACTION do pico, ou sem água para tirar
+ * (DRYING_DRY_RATE_GPH): também é fim. O fim só vale confirmado em
+ * DRYING_CONFIRM_POINTS pontos seguidos.
+ *
+ * Degrau de setpoint, pré-aquecimento e quedas grandes da temperatura
+ * reiniciam a janela (a taxa muda com a temperatura, não com a água). Fim é
+ * travado até o próximo setpoint; um setpoint novo depois do fim é um lote
+ * novo.
+ */
+
+#define DRYING_LEAK_M3H 0.12f           // Frestas: ~2 trocas por hora de 60 L
+#define DRYING_VENT_M3H 0.43f           // Exaustão a 100% (ventoinha de 40 mm, saída restrita)
+#define DRYING_STEP_MS 60000            // Um ponto da janela por minuto
+#define DRYING_WINDOW_POINTS 60         // Janela da regressão (1 h)
+#define DRYING_MIN_POINTS 20            // Pontos para a primeira projeção
+#define DRYING_TEMP_BAND 2.0f           // Fora disso do setpoint a janela reinicia (°C)
+#define DRYING_SETTLE_MS 600000         // Na faixa por isso antes do primeiro ponto (umidade assentando)
+#define DRYING_DONE_REMAINING 0.1f      // Fim com 10% da água ainda no filamento
+#define DRYING_PLATEAU_TAU_H 24.0f      // Decaimento mais lento que isso: patamar
+#define DRYING_PLATEAU_FRACTION 0.25f   // Patamar só conta abaixo disso do pico
+#define DRYING_DRY_RATE_GPH 0.05f       // Abaixo disso não há o que secar
+#define DRYING_RATE_FLOOR_GPH 0.01f     // Piso da taxa no logaritmo
+#define DRYING_CONFIRM_POINTS 5         // Pontos seguidos indicando fim
+
+typedef enum {
+    DRYING_SETTLING = 0,                // Janela enchendo (ou temperatura fora da faixa)
+    DRYING_TRACKING,                    // Projeção valendo
+    DRYING_DONE
+} drying_state_t;
+
+typedef struct {
+    drying_state_t state;
+    float setpoint;                     // Setpoint da janela atual
+    uint32_t last_ms;                   // Última atualização (integral da taxa)
+    uint32_t band_since;                // Entrada na faixa do setpoint (0 = fora dela)
+
+    // Ponto em formação (média da taxa no passo)
+    uint32_t step_start;
+    float step_sum;
+    uint16_t step_count;
+
+    // Janela: ln(taxa) por ponto (anel)
+    float window[DRYING_WINDOW_POINTS];
+    uint8_t count;
+    uint8_t head;
+    uint8_t done_points;                // Pontos seguidos indicando fim
+
+    // Saídas
+    float rate_gph;                     // Última taxa de saída de água (g/h)
+    float removed_g;                    // Água tirada no lote (integral da taxa)
+    float peak_rate_gph;                // Maior ponto do lote
+    float tau_h;                        // Decaimento da taxa (0 = sem ajuste ou patamar)
+    float remaining_g;                  // Água que ainda sai pela projeção
+    int32_t eta_s;                      // Até o fim (-1 = sem projeção)
+    bool plateau;                       // Fim pelo patamar (não pela projeção)
+    uint32_t done_ms;                   // Fim detectado (0 = não)
+} drying_endpoint_t;
+
+void drying_endpoint_init(drying_endpoint_t *de, float setpoint);
+
+/**
+ * Uma leitura nova da câmara (depois da exaustão)
+ * @param vent_percent Duty da exaustão neste ciclo (%)
+ * @param sensor_safe false: leitura não confiável, nada muda
+ * @return Estado depois da leitura
+ */
+drying_state_t drying_endpoint_update(drying_endpoint_t *de, float temperature, float humidity,
+                                      float ambient_temp, float ambient_rh, float setpoint,
+                                      float vent_percent, bool sensor_safe, uint32_t now_ms);
+
+const char *drying_endpoint_state_name(drying_state_t state);
+
+#endif // DRYING_ENDPOINT_H
@@ -0,0 +1,225 @@
+#include "drying_profile.h"
+#include "logger.h"
+#include <math.h>
+#include <stddef.h>
+
+#define TAG "Profile"
+
+// Tabela dos perfis (índice = drying_profile_id_t). Patamares dentro de
+// TEMP_MIN-TEMP_MAX do botão; a última etapa guarda o filamento seco.
+static const drying_profile_def_t profiles[DRYING_PROFILE_COUNT] = {
+    [DRYING_PROFILE_MANUAL] = { "MANUAL", 0, { { 0 } } },
+    [DRYING_PROFILE_PLA] = { "PLA", 2, {
+        { 45.0f, 0.0f, 240, 360, true },
+        { 40.0f, 1.0f, 0, 0, false },
+    } },
+    [DRYING_PROFILE_PETG] = { "PETG", 2, {
+        { 65.0f, 0.0f, 240, 360, true },
+        { 45.0f, 1.0f, 0, 0, false },
+    } },
+    [DRYING_PROFILE_ABS] = { "ABS", 2, {
+        { 80.0f, 0.0f, 180, 360, true },
+        { 50.0f, 1.0f, 0, 0, false },
+    } },
+    // Náilon: água da superfície a 60°C antes de subir devagar (menos
+    // oxidação e bolhas), patamar longo a 80°C
+    [DRYING_PROFILE_PA] = { "PA", 3, {
+        { 60.0f, 0.0f, 60, 60, false },
+        { 80.0f, 0.5f, 360, 720, true },
+        { 50.0f, 1.0f, 0, 0, false },
+    } },
+    [DRYING_PROFILE_TPU] = { "TPU", 2, {
+        { 50.0f, 0.0f, 240, 480, true },
+        { 40.0f, 1.0f, 0, 0, false },
+    } },
+};
+
+const char *drying_profile_name(drying_profile_id_t id) {
+    return id < DRYING_PROFILE_COUNT ? profiles[id].name : "?";
+}
+
+const drying_profile_def_t *drying_profile_get(drying_profile_id_t id) {
+    return id < DRYING_PROFILE_COUNT ? &profiles[id] : NULL;
+}
+
+void drying_profile_init(drying_profile_t *pr) {
+    pr->id = DRYING_PROFILE_MANUAL;
+    pr->def = NULL;
+    pr->stage = 0;
+    pr->phase = PROFILE_PHASE_RAMP;
+    pr->stage_begun = false;
+    pr->setpoint = 0.0f;
+    pr->ramp_from = 0.0f;
+    pr->ramp_start_ms = 0;
+    pr->hold_ms = 0;
+    pr->last_ms = 0;
+    pr->saved_hold_ms = 0;
+    pr->checkpoint_due = false;
+}
+
+static void enter_stage(drying_profile_t *pr, uint8_t stage, drying_profile_phase_t phase, uint32_t hold_ms) {
+    pr->stage = stage;
+    pr->phase = phase;
+    pr->stage_begun = false;
+    pr->hold_ms = hold_ms;
+    pr->saved_hold_ms = hold_ms;
+    pr->last_ms = 0;
+    pr->checkpoint_due = true;
+}
+
+void drying_profile_start(drying_profile_t *pr, drying_profile_id_t id) {
+    if (id == DRYING_PROFILE_MANUAL || id >= DRYING_PROFILE_COUNT) {
+        drying_profile_cancel(pr);
+        return;
+    }
+    pr->id = id;
+    pr->def = &profiles[id];
+    enter_stage(pr, 0, PROFILE_PHASE_RAMP, 0);
+    LOGI(TAG, "%s started (%d stages)", pr->def->name, pr->def->stage_count);
+}
+
+bool drying_profile_resume(drying_profile_t *pr, const drying_profile_checkpoint_t *cp) {
+    if (cp->profile == DRYING_PROFILE_MANUAL || cp->profile >= DRYING_PROFILE_COUNT ||
+        cp->stage >= profiles[cp->profile].stage_count || cp->phase > PROFILE_PHASE_HOLD) {
+        return false;
+    }
+    pr->id = (drying_profile_id_t)cp->profile;
+    pr->def = &profiles[cp->profile];
+    enter_stage(pr, cp->stage, (drying_profile_phase_t)cp->phase, cp->hold_s * 1000u);
+    pr->checkpoint_due = false;
+    const drying_stage_t *st = &pr->def->stages[pr->stage];
+    if (st->max_minutes) {
+        LOGI(TAG, "%s resumed: stage %d/%d (%.0f°C), %lu of %u min held", pr->def->name, pr->stage + 1,
+             pr->def->stage_count, st->hold_temp, cp->hold_s / 60u, st->max_minutes);
+    } else {
+        LOGI(TAG, "%s resumed: stage %d/%d (%.0f°C, storage)", pr->def->name, pr->stage + 1,
+             pr->def->stage_count, st->hold_temp);
+    }
+    return true;
+}
+
+void drying_profile_cancel(drying_profile_t *pr) {
+    if (drying_profile_active(pr)) {
+        LOGI(TAG, "%s cancelled at stage %d/%d", pr->def->name, pr->stage + 1, pr->def->stage_count);
+        pr->checkpoint_due = true;
+    }
+    pr->id = DRYING_PROFILE_MANUAL;
+    pr->def = NULL;
+}
+
+// Etapa começa com a câmara onde está: degrau direto no patamar, rampa a
+// partir da temperatura atual. Um degrau para baixo da câmara quente vira
+// rampa (o setpoint não pode ficar mais que o limite de overshoot abaixo dela).
+static void begin_stage(drying_profile_t *pr, float temperature, uint32_t now_ms, bool *step) {
+    const drying_stage_t *st = &pr->def->stages[pr->stage];
+    pr->stage_begun = true;
+    pr->last_ms = now_ms;
+    bool step_ok = pr->phase == PROFILE_PHASE_HOLD || st->ramp_c_per_min <= 0.0f;
+    if (step_ok && temperature <= st->hold_temp + PROFILE_RAMP_LEAD) {
+        pr->phase = PROFILE_PHASE_HOLD;
+        pr->setpoint = st->hold_temp;
+        *step = true;
+        LOGI(TAG, "%s stage %d/%d: %.0f°C", pr->def->name, pr->stage + 1, pr->def->stage_count, st->hold_temp);
+        return;
+    }
+    pr->phase = PROFILE_PHASE_RAMP;
+    pr->ramp_from = temperature;
+    pr->ramp_start_ms = now_ms;
+    pr->setpoint = st->hold_temp > temperature ? floorf(temperature) : ceilf(temperature);
+    LOGI(TAG, "%s stage %d/%d: ramp %.1f°C/min from %.1f°C to %.0f°C", pr->def->name, pr->stage + 1,
+         pr->def->stage_count, st->ramp_c_per_min, temperature, st->hold_temp);
+}
+
+// Próximo passo da rampa: 1°C por vez, monotônico, no máximo PROFILE_RAMP_LEAD da câmara
+static void ramp(drying_profile_t *pr, float temperature, uint32_t now_ms) {
+    const drying_stage_t *st = &pr->def->stages[pr->stage];
+    // Sem taxa (degrau para baixo): só o limite da câmara
+    float travel = st->ramp_c_per_min > 0.0f ?
+                   st->ramp_c_per_min * (float)(now_ms - pr->ramp_start_ms) / 60000.0f : 1000.0f;
+    float target;
+    if (st->hold_temp >= pr->ramp_from) {
+        target = fminf(pr->ramp_from + travel, temperature + PROFILE_RAMP_LEAD);
+        target = fmaxf(floorf(target), pr->setpoint);
+        if (target >= st->hold_temp) {
+            target = st->hold_temp;
+            pr->phase = PROFILE_PHASE_HOLD;
+        }
+    } else {
+        target = fmaxf(pr->ramp_from - travel, temperature - PROFILE_RAMP_LEAD);
+        target = fminf(ceilf(target), pr->setpoint);
+        if (target <= st->hold_temp) {
+            target = st->hold_temp;
+            pr->phase = PROFILE_PHASE_HOLD;
+        }
+    }
+    pr->setpoint = target;
+    if (pr->phase == PROFILE_PHASE_HOLD) {
+        pr->checkpoint_due = true;
+    }
+}
+
+// Fim da etapa pelo tempo cumprido ou pela secagem (NULL = continua)
+static const char *stage_end(const drying_profile_t *pr, bool drying_done) {
+    const drying_stage_t *st = &pr->def->stages[pr->stage];
+    if (st->max_minutes == 0) {
+        return NULL;
+    }
+    if (pr->hold_ms >= st->max_minutes * 60000u) {
+        return "time";
+    }
+    if (st->end_on_dry && drying_done && pr->hold_ms >= st->min_minutes * 60000u) {
+        return "dry";
+    }
+    return NULL;
+}
+
+bool drying_profile_update(drying_profile_t *pr, float temperature, bool reading_valid,
+                           bool drying_done, uint32_t now_ms, bool *step) {
+    *step = false;
+    if (!drying_profile_active(pr) || !reading_valid) {
+        pr->last_ms = 0;
+        return false;
+    }
+    float before = pr->setpoint;
+    if (!pr->stage_begun) {
+        begin_stage(pr, temperature, now_ms, step);
+        return true;
+    }
+
+    if (pr->phase == PROFILE_PHASE_RAMP) {
+        ramp(pr, temperature, now_ms);
+    } else {
+        const drying_stage_t *st = &pr->def->stages[pr->stage];
+        if (pr->last_ms && fabsf(temperature - st->hold_temp) <= PROFILE_HOLD_BAND) {
+            pr->hold_ms += now_ms - pr->last_ms;
+        }
+        // Guarda sem fim: o tempo cumprido não importa para a continuação
+        if (st->max_minutes && pr->hold_ms - pr->saved_hold_ms >= PROFILE_CHECKPOINT_MS) {
+            pr->checkpoint_due = true;
+        }
+        const char *reason = stage_end(pr, drying_done);
+        if (reason) {
+            LOGI(TAG, "%s stage %d/%d done (%s) after %lu min", pr->def->name, pr->stage + 1,
+                 pr->def->stage_count, reason, pr->hold_ms / 60000u);
+            if (pr->stage + 1 >= pr->def->stage_count) {
+                LOGI(TAG, "%s finished, holding %.0f°C", pr->def->name, pr->setpoint);
+                drying_profile_cancel(pr);
+                return false;
+            }
+            enter_stage(pr, pr->stage + 1, PROFILE_PHASE_RAMP, 0);
+            begin_stage(pr, temperature, now_ms, step);
+        }
+    }
+    pr->last_ms = now_ms;
+    return pr->setpoint != before || *step;
+}
+
+void drying_profile_checkpoint(drying_profile_t *pr, drying_profile_checkpoint_t *cp) {
+    cp->profile = (uint8_t)pr->id;
+    cp->stage = pr->stage;
+    cp->phase = (uint8_t)pr->phase;
+    cp->reserved = 0;
+    cp->hold_s = pr->hold_ms / 1000u;
+    pr->saved_hold_ms = pr->hold_ms;
+    pr->checkpoint_due = false;
+}
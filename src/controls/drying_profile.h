@@ -0,0 +1,127 @@
+#ifndef DRYING_PROFILE_H
+#define DRYING_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Perfis de secagem por material: etapas com rampa, patamar e fim
+ *
+ * Cada etapa leva a câmara até o patamar (degrau com pré-aquecimento ou
+ * rampa em °C/min) e fica nele pelo tempo da etapa. O tempo só conta com a
+ * câmara dentro de PROFILE_HOLD_BAND do patamar: a porta aberta ou uma queda
+ * de energia não encurtam a secagem. A etapa termina em max_minutes ou,
+ * com end_on_dry, no fim da secagem detectado pelo drying_endpoint depois
+ * de min_minutes. Uma etapa com max_minutes = 0 não termina (guarda do
+ * filamento seco até o botão).
+ *
+ * Rampa: setpoint em passos de 1°C a partir da temperatura da câmara,
+ * nunca mais longe dela que PROFILE_RAMP_LEAD. Descendo, o heater fica
+ * desligado e a câmara esfria sozinha sem passar do limite de overshoot do
+ * supervisor.
+ *
+ * O progresso (etapa, fase e tempo já cumprido no patamar) vai para o
+ * checkpoint a cada mudança de etapa e a cada PROFILE_CHECKPOINT_MS de
+ * patamar; depois de uma queda de energia o perfil continua de onde parou
+ * (a rampa recomeça da temperatura da câmara, o patamar com pré-aquecimento).
+ */
+
+#define PROFILE_MAX_STAGES 4
+#define PROFILE_HOLD_BAND 2.0f          // Patamar só conta dentro disso (°C)
+#define PROFILE_RAMP_LEAD 2.0f          // Rampa no máximo isso à frente da câmara (°C)
+#define PROFILE_CHECKPOINT_MS 600000    // Checkpoint do patamar a cada 10 min cumpridos
+
+typedef enum {
+    DRYING_PROFILE_MANUAL = 0,          // Sem perfil: setpoint só pelo botão
+    DRYING_PROFILE_PLA,
+    DRYING_PROFILE_PETG,
+    DRYING_PROFILE_ABS,
+    DRYING_PROFILE_PA,
+    DRYING_PROFILE_TPU,
+    DRYING_PROFILE_COUNT
+} drying_profile_id_t;
+
+typedef enum {
+    PROFILE_PHASE_RAMP = 0,             // Indo até o patamar
+    PROFILE_PHASE_HOLD                  // No patamar, contando o tempo
+} drying_profile_phase_t;
+
+typedef struct {
+    float hold_temp;                    // Patamar (°C)
+    float ramp_c_per_min;               // Rampa até o patamar (°C/min), 0 = degrau com pré-aquecimento
+    uint16_t min_minutes;               // Patamar mínimo antes do fim pela secagem
+    uint16_t max_minutes;               // Fim pelo tempo; 0 = sem fim (guarda)
+    bool end_on_dry;                    // Fim da secagem (drying_endpoint) encerra depois do mínimo
+} drying_stage_t;
+
+typedef struct {
+    const char *name;
+    uint8_t stage_count;
+    drying_stage_t stages[PROFILE_MAX_STAGES];
+} drying_profile_def_t;
+
+// Progresso gravado no flash (um por câmara)
+typedef struct {
+    uint8_t profile;                    // drying_profile_id_t; MANUAL = nada a retomar
+    uint8_t stage;
+    uint8_t phase;                      // drying_profile_phase_t
+    uint8_t reserved;
+    uint32_t hold_s;                    // Patamar já cumprido na etapa (s)
+} drying_profile_checkpoint_t;
+
+typedef struct {
+    drying_profile_id_t id;
+    const drying_profile_def_t *def;    // NULL no manual
+    uint8_t stage;
+    drying_profile_phase_t phase;
+    bool stage_begun;                   // Etapa começa na primeira leitura válida
+    float setpoint;                     // Setpoint pedido pela etapa (°C)
+    float ramp_from;                    // Temperatura no início da rampa (°C)
+    uint32_t ramp_start_ms;
+    uint32_t hold_ms;                   // Patamar cumprido (dentro da faixa)
+    uint32_t last_ms;                   // Última leitura (integral do patamar, 0 = nenhuma)
+    uint32_t saved_hold_ms;             // hold_ms no último checkpoint
+    bool checkpoint_due;                // Mudança ainda não gravada
+} drying_profile_t;
+
+void drying_profile_init(drying_profile_t *pr);
+
+/**
+ * Começa o perfil na primeira etapa (MANUAL cancela o atual)
+ */
+void drying_profile_start(drying_profile_t *pr, drying_profile_id_t id);
+
+/**
+ * Continua do checkpoint gravado
+ * @return false se o checkpoint não vale para os perfis deste firmware
+ */
+bool drying_profile_resume(drying_profile_t *pr, const drying_profile_checkpoint_t *cp);
+
+/**
+ * Volta para o manual (botão); o setpoint atual fica
+ */
+void drying_profile_cancel(drying_profile_t *pr);
+
+/**
+ * Uma leitura nova da câmara (antes do controle)
+ * @param reading_valid Leitura real e segura do DHT22 (sem ela nada avança)
+ * @param drying_done Fim da secagem detectado no setpoint atual
+ * @param step Recebe true quando o setpoint novo é um degrau (pré-aquecimento)
+ * @return true se pr->setpoint mudou
+ */
+bool drying_profile_update(drying_profile_t *pr, float temperature, bool reading_valid,
+                           bool drying_done, uint32_t now_ms, bool *step);
+
+static inline bool drying_profile_active(const drying_profile_t *pr) {
+    return pr->id != DRYING_PROFILE_MANUAL;
+}
+
+/**
+ * Progresso para o flash; zera checkpoint_due
+ */
+void drying_profile_checkpoint(drying_profile_t *pr, drying_profile_checkpoint_t *cp);
+
+const char *drying_profile_name(drying_profile_id_t id);
+const drying_profile_def_t *drying_profile_get(drying_profile_id_t id);
+
+#endif // DRYING_PROFILE_H
@@ -0,0 +1,284 @@
+#include "eco_hold.h"
+#include "logger.h"
+#include <math.h>
+
+#define TAG "Eco"
+
+void eco_hold_init(eco_hold_t *eh, float band) {
+    eh->state = ECO_HOLD_OFF;
+    eh->band = band;
+    // Pico do ciclo a pelo menos ECO_HOLD_MARGIN da borda de cima
+    eh->swing = fminf(ECO_HOLD_SWING, 2.0f * (band - ECO_HOLD_MARGIN));
+    eh->setpoint = 0.0f;
+    eh->energy_measured = true;
+    eh->band_since = 0;
+    eh->ref_measuring = false;
+    eh->ref_start_ms = 0;
+    eh->ref_start_wh = 0.0;
+    eh->ref_start_ambient = 0.0f;
+    eh->ref_power_w = 0.0f;
+    eh->ref_delta = 0.0f;
+    eh->ref_end_ms = 0;
+    eh->loss_rate = 0.0f;
+    eh->lag_s = ECO_HOLD_LAG_DEFAULT_S;
+    eh->gain = 1.0f;
+    eh->pulse_start_ms = 0;
+    eh->pulse_ms = 0;
+    eh->trough = 0.0f;
+    eh->trough_ms = 0;
+    eh->peak = 0.0f;
+    eh->peak_ms = 0;
+    eh->rising = false;
+    eh->last_ms = 0;
+    eh->last_wh = 0.0;
+    eh->eco_ms = 0;
+    eh->eco_wh = 0.0;
+    eh->baseline_wh = 0.0;
+    eh->period_baseline_wh = 0.0;
+    eh->entry_temp = 0.0f;
+    eh->borrowed_wh = 0.0f;
+    eh->pulses = 0;
+    eh->exits = 0;
+}
+
+static float trough_target(const eco_hold_t *eh, float setpoint) {
+    return setpoint - eh->band + ECO_HOLD_MARGIN;
+}
+
+float eco_hold_center(const eco_hold_t *eh, float setpoint) {
+    return trough_target(eh, setpoint) + eh->swing / 2.0f;
+}
+
+// Fim de um trecho: o calor tirado da câmara passa a contar como gasto
+static void settle_borrowed(eco_hold_t *eh) {
+    eh->eco_wh += eh->borrowed_wh;
+    eh->borrowed_wh = 0.0f;
+    eh->state = ECO_HOLD_OFF;
+}
+
+static void leave(eco_hold_t *eh, const char *reason, float temperature) {
+    if (eco_hold_active(eh)) {
+        eh->exits++;
+        if (eh->energy_measured) {
+            LOGI(TAG, "Back to PID at %.1f°C: %s (~%.1f Wh saved so far, estimated)", temperature, reason,
+                 eco_hold_saved_wh(eh));
+        } else {
+            LOGI(TAG, "Back to PID at %.1f°C: %s", temperature, reason);
+        }
+    }
+    settle_borrowed(eh);
+}
+
+void eco_hold_abort(eco_hold_t *eh) {
+    settle_borrowed(eh);
+}
+
+// Fim da deriva: mede a perda e o resultado do pulso anterior, calcula o próximo
+static bool start_pulse(eco_hold_t *eh, float temperature, float hold_output, uint32_t now_ms) {
+    float drop = eh->peak - temperature;
+    float dt_s = (float)(now_ms - eh->peak_ms) / 1000.0f;
+    if (drop >= ECO_HOLD_MIN_DROP && dt_s > 0.0f) {
+        float rate = drop / dt_s;
+        eh->loss_rate = eh->loss_rate > 0.0f ? 0.5f * (eh->loss_rate + rate) : rate;
+    }
+    if (eh->pulses > 0 && eh->rising) {
+        // Subida observada x planejada; atraso até o fundo
+        float achieved = eh->peak - eh->trough;
+        if (achieved > ECO_HOLD_RISE_DETECT) {
+            // Meia correção por ciclo: a perda medida também muda com o pico
+            eh->gain *= sqrtf(fminf(fmaxf(eh->swing / achieved, 0.5f), 2.0f));
+            eh->gain = fminf(fmaxf(eh->gain, 0.5f), 2.0f);
+        }
+        float lag = (float)(eh->trough_ms - eh->pulse_start_ms) / 1000.0f;
+        eh->lag_s = 0.5f * (eh->lag_s + lag);
+    }
+    if (eh->loss_rate <= 0.0f) {
+        return false;
+    }
+
+    float f = fmaxf(hold_output, 1.0f) / 100.0f;
+    float pulse_s = eh->gain * eh->swing * f / (eh->loss_rate * (1.0f - f));
+    float pulse_ms = fminf(fmaxf(pulse_s * 1000.0f, (float)ECO_HOLD_PULSE_MIN_MS), (float)ECO_HOLD_PULSE_MAX_MS);
+    eh->pulse_ms = (uint32_t)pulse_ms;
+    eh->pulse_start_ms = now_ms;
+    eh->trough = temperature;
+    eh->trough_ms = now_ms;
+    eh->peak = temperature;
+    eh->peak_ms = now_ms;
+    eh->rising = false;
+    eh->pulses++;
+    eh->state = ECO_HOLD_PULSE;
+    LOGD(TAG, "Pulse %lu: %.0fs at %.1f°C (loss %.4f°C/s, hold %.0f%%, gain %.2f, lag %.0fs)",
+         eh->pulses, pulse_ms / 1000.0f, temperature, eh->loss_rate, hold_output, eh->gain, eh->lag_s);
+    return true;
+}
+
+// Fundo e pico do ciclo: o fundo até a subida começar, depois o pico
+static void track_cycle(eco_hold_t *eh, float temperature, uint32_t now_ms) {
+    if (!eh->rising) {
+        if (temperature < eh->trough) {
+            eh->trough = temperature;
+            eh->trough_ms = now_ms;
+        }
+        if (temperature >= eh->trough + ECO_HOLD_RISE_DETECT) {
+            eh->rising = true;
+            eh->peak = temperature;
+            eh->peak_ms = now_ms;
+        }
+    } else if (temperature > eh->peak) {
+        eh->peak = temperature;
+        eh->peak_ms = now_ms;
+    }
+}
+
+bool eco_hold_update(eco_hold_t *eh, float temperature, float setpoint, float ambient,
+                     float hold_output, double energy_wh, bool energy_measured,
+                     uint32_t now_ms, float *output) {
+    if (setpoint != eh->setpoint) {
+        leave(eh, "new setpoint", temperature);
+        eh->setpoint = setpoint;
+        eh->ref_power_w = 0.0f;
+    }
+    if (energy_measured != eh->energy_measured) {
+        // Referência e economia não misturam ACS712 e potência nominal
+        leave(eh, "energy source changed", temperature);
+        eh->energy_measured = energy_measured;
+        eh->ref_power_w = 0.0f;
+    }
+
+    // Energia medida x referência do PID no mesmo intervalo
+    uint32_t period_ms = eh->last_ms ? now_ms - eh->last_ms : 0;
+    if (eco_hold_active(eh) && period_ms) {
+        eh->eco_ms += period_ms;
+        eh->eco_wh += energy_wh - eh->last_wh;
+        if (eh->ref_power_w > 0.0f && eh->ref_delta > 1.0f) {
+            double baseline = (double)eh->ref_power_w * (setpoint - ambient) / eh->ref_delta *
+                              period_ms / 3600000.0;
+            eh->baseline_wh += baseline;
+            eh->period_baseline_wh += baseline;
+            // Capacidade térmica pela perda no centro do ciclo e a queda medida
+            if (eh->loss_rate > 0.0f) {
+                float capacity = eh->ref_power_w * (eco_hold_center(eh, setpoint) - ambient) /
+                                 eh->ref_delta / eh->loss_rate;
+                eh->borrowed_wh = capacity * (eh->entry_temp - temperature) / 3600.0f;
+            }
+        }
+    }
+    eh->last_ms = now_ms;
+    eh->last_wh = energy_wh;
+
+    switch (eh->state) {
+    case ECO_HOLD_OFF:
+        if (fabsf(temperature - setpoint) <= ECO_HOLD_REF_BAND) {
+            eh->state = ECO_HOLD_REFERENCE;
+            eh->band_since = now_ms;
+            eh->ref_measuring = false;
+        }
+        return false;
+
+    case ECO_HOLD_REFERENCE:
+        if (fabsf(temperature - setpoint) > ECO_HOLD_REF_BAND) {
+            eh->state = ECO_HOLD_OFF;
+            return false;
+        }
+        if (!eh->ref_measuring) {
+            if (now_ms - eh->band_since >= ECO_HOLD_SETTLE_MS) {
+                eh->ref_measuring = true;
+                eh->ref_start_ms = now_ms;
+                eh->ref_start_wh = energy_wh;
+                eh->ref_start_ambient = ambient;
+            }
+            return false;
+        }
+        if (now_ms - eh->ref_start_ms < ECO_HOLD_REFERENCE_MS) {
+            return false;
+        }
+        if (hold_output > ECO_HOLD_DUTY_MAX) {
+            // Heater quase sempre ligado: sem folga para pulsos, nova janela depois
+            eh->state = ECO_HOLD_OFF;
+            return false;
+        }
+        float ref_power = (float)((energy_wh - eh->ref_start_wh) * 3600000.0 / (now_ms - eh->ref_start_ms));
+        if (eh->ref_power_w > 0.0f) {
+            // Trecho anterior pela média das duas referências (a manutenção mudou entre elas)
+            eh->baseline_wh += eh->period_baseline_wh * (ref_power - eh->ref_power_w) / (2.0f * eh->ref_power_w);
+        }
+        eh->period_baseline_wh = 0.0;
+        eh->ref_power_w = ref_power;
+        eh->ref_delta = setpoint - (eh->ref_start_ambient + ambient) / 2.0f;
+        eh->ref_end_ms = now_ms;
+        LOGI(TAG, "Eco hold at %.0f°C: PID reference %.1f W (%s), cycling %.1f-%.1f°C", setpoint,
+             eh->ref_power_w, eco_hold_energy_source_name(eh->energy_measured),
+             trough_target(eh, setpoint), trough_target(eh, setpoint) + eh->swing);
+        // Primeira deriva desde o setpoint: a queda dela mede a perda
+        eh->state = ECO_HOLD_COAST;
+        eh->entry_temp = temperature;
+        eh->rising = true;
+        eh->peak = temperature;
+        eh->peak_ms = now_ms;
+        break;
+
+    case ECO_HOLD_COAST:
+    case ECO_HOLD_PULSE:
+        break;
+    }
+
+    if (temperature < setpoint - eh->band) {
+        leave(eh, "below band", temperature);
+        return false;
+    }
+    if (hold_output > ECO_HOLD_DUTY_MAX) {
+        leave(eh, "no heater headroom", temperature);
+        return false;
+    }
+    track_cycle(eh, temperature, now_ms);
+
+    if (eh->state == ECO_HOLD_COAST) {
+        // Pulso antes do fundo: a câmara ainda cai pelo atraso do bloco e do DHT22
+        float predicted = temperature - eh->loss_rate * eh->lag_s;
+        if (predicted > trough_target(eh, setpoint)) {
+            *output = 0.0f;
+            return true;
+        }
+        if (now_ms - eh->ref_end_ms >= ECO_HOLD_REFRESH_MS) {
+            // No fundo o PID volta ao setpoint para uma referência nova
+            if (eh->energy_measured) {
+                LOGI(TAG, "Refreshing the PID reference (~%.1f Wh saved so far, estimated)",
+                     eco_hold_saved_wh(eh));
+            } else {
+                LOGI(TAG, "Refreshing the PID reference");
+            }
+            settle_borrowed(eh);
+            return false;
+        }
+        if (!start_pulse(eh, temperature, hold_output, now_ms)) {
+            *output = 0.0f;
+            return true;
+        }
+    }
+
+    // Pulso: 100% até o tempo calculado (proporcional no último ciclo) ou o pico
+    uint32_t elapsed = now_ms - eh->pulse_start_ms;
+    if (elapsed >= eh->pulse_ms || temperature >= trough_target(eh, setpoint) + eh->swing) {
+        // Deriva: o pico ainda vem do calor guardado no bloco
+        eh->state = ECO_HOLD_COAST;
+        *output = 0.0f;
+        return true;
+    }
+    float remaining = (float)(eh->pulse_ms - elapsed);
+    *output = period_ms ? fminf(100.0f, 100.0f * remaining / (float)period_ms) : 100.0f;
+    return true;
+}
+
+const char *eco_hold_state_name(eco_hold_state_t state) {
+    switch (state) {
+    case ECO_HOLD_REFERENCE: return "REFERENCE";
+    case ECO_HOLD_COAST: return "COAST";
+    case ECO_HOLD_PULSE: return "PULSE";
+    default: return "OFF";
+    }
+}
+
+const char *eco_hold_energy_source_name(bool energy_measured) {
+    return energy_measured ? "ACS712" : "nominal";
+}
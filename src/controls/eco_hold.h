@@ -0,0 +1,154 @@
+#ifndef ECO_HOLD_H
+#define ECO_HOLD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Manutenção econômica (eco hold): pulsos de aquecimento dentro de uma faixa
+ *
+ * Com o material aceitando setpoint ± band, o PID segurando o centro gasta
+ * mais que o necessário: a perda cresce com setpoint - ambiente. O eco hold
+ * deixa a câmara oscilar na parte de baixo da faixa, entre
+ * setpoint - band + ECO_HOLD_MARGIN (fundo) e ECO_HOLD_SWING acima dele,
+ * com o heater desligado (deriva) ou em 100% (pulso):
+ *
+ * - deriva: a queda desde o pico mede a perda da câmara (°C/s); o pulso
+ *   começa quando a temperatura prevista um atraso à frente chega ao fundo
+ * - pulso: repõe a energia de um ciclo. Com f = manutenção prevista pelo
+ *   feed-forward (fração do heater) e r = perda medida, subir ECO_HOLD_SWING
+ *   em 100% leva swing * f / (r * (1 - f)); um ganho corrige pela subida
+ *   observada no ciclo anterior
+ *
+ * Antes de entrar, o PID segura o setpoint por ECO_HOLD_SETTLE_MS e mais
+ * ECO_HOLD_REFERENCE_MS: a energia do heater na segunda janela é a
+ * referência (potência do PID no setpoint, escalada por setpoint -
+ * ambiente). Durante o eco hold a energia medida é comparada com a
+ * referência no mesmo tempo: economia estimada, descontado o calor que a câmara
+ * perdeu descendo do setpoint (capacidade = perda / queda medida na
+ * deriva), que o PID repõe na volta. A manutenção cai ao longo da
+ * secagem (menos água evaporando), então a referência é medida de novo a
+ * cada ECO_HOLD_REFRESH_MS e o trecho entre duas referências usa a média
+ * delas; sem isso a economia sai inflada. Mesmo assim é uma estimativa: o
+ * ruído do PID nas janelas de referência (~0.2 W) pesa nas horas seguintes, e
+ * no simulador (12 h a 45°C) ela ficou de 4% a 34% acima da diferença real.
+ * Sem ACS712 (câmaras sem o sensor ou sensor desconectado) o chamador passa
+ * a energia nominal pelo duty: a referência continua (o log diz a fonte),
+ * mas economia pela potência nominal não é medida e nenhum log a informa.
+ * Trocar de fonte recomeça a referência.
+ *
+ * Sai para o PID com setpoint novo, temperatura abaixo da faixa (porta
+ * aberta) ou manutenção acima de ECO_HOLD_DUTY_MAX (sem folga para pulsos);
+ * volta depois de uma nova janela de referência.
+ */
+
+#define ECO_HOLD_REF_BAND 0.5f          // Referência: PID a menos disso do setpoint (°C)
+#define ECO_HOLD_SETTLE_MS 900000       // Na faixa por isso antes da referência (integral e feed-forward assentando)
+#define ECO_HOLD_REFERENCE_MS 900000    // Janela da referência (15 min)
+#define ECO_HOLD_REFRESH_MS 7200000     // Eco hold entre duas referências (2 h)
+#define ECO_HOLD_MARGIN 0.5f            // Fundo do ciclo acima da borda da faixa (precisão do DHT22, °C)
+#define ECO_HOLD_SWING 1.0f             // Subida planejada por pulso (°C)
+#define ECO_HOLD_RISE_DETECT 0.2f       // Subida acima do fundo que marca o fim da queda (°C)
+#define ECO_HOLD_MIN_DROP 0.3f          // Queda mínima na deriva para medir a perda (°C)
+#define ECO_HOLD_LAG_DEFAULT_S 60.0f    // Atraso pulso -> DHT22 antes da primeira medida (s)
+#define ECO_HOLD_PULSE_MIN_MS 5000
+#define ECO_HOLD_PULSE_MAX_MS 600000
+#define ECO_HOLD_DUTY_MAX 85.0f         // Manutenção acima disso: sem folga, fica no PID (%)
+
+typedef enum {
+    ECO_HOLD_OFF = 0,                   // PID no controle
+    ECO_HOLD_REFERENCE,                 // PID no setpoint medindo a referência
+    ECO_HOLD_COAST,                     // Heater desligado, câmara caindo
+    ECO_HOLD_PULSE                      // Heater em 100% pelo tempo calculado
+} eco_hold_state_t;
+
+typedef struct {
+    eco_hold_state_t state;
+    float band;                         // Faixa aceita em torno do setpoint (± °C)
+    float swing;                        // Subida por pulso (cabe na faixa)
+    float setpoint;
+    bool energy_measured;               // Energia do ACS712 (false = nominal pelo duty)
+
+    // Referência (PID no setpoint)
+    uint32_t band_since;                // Entrada na faixa da referência
+    bool ref_measuring;                 // Depois do assentamento, medindo
+    uint32_t ref_start_ms;
+    double ref_start_wh;
+    float ref_start_ambient;
+    float ref_power_w;                  // Potência média do PID no setpoint (W, 0 = sem medida)
+    float ref_delta;                    // Setpoint - ambiente na referência (°C)
+    uint32_t ref_end_ms;                // Fim da última referência
+
+    // Ciclo atual
+    float loss_rate;                    // Queda medida na deriva (°C/s, 0 = sem medida)
+    float lag_s;                        // Início do pulso -> fundo da temperatura (s)
+    float gain;                         // Correção do pulso pela subida observada
+    uint32_t pulse_start_ms;
+    uint32_t pulse_ms;                  // Duração do pulso atual
+    float trough;                       // Menor temperatura depois do início do pulso
+    uint32_t trough_ms;
+    float peak;                         // Maior temperatura depois da subida
+    uint32_t peak_ms;
+    bool rising;                        // Queda do pulso já acabou (medindo o pico)
+
+    // Contabilidade (só com o eco hold no controle)
+    uint32_t last_ms;
+    double last_wh;
+    uint32_t eco_ms;
+    double eco_wh;                      // Energia do heater no eco hold
+    double baseline_wh;                 // Referência do PID no mesmo tempo
+    double period_baseline_wh;          // Parte de baseline_wh com a referência atual
+    float entry_temp;                   // Temperatura na entrada (setpoint)
+    float borrowed_wh;                  // Calor tirado da câmara desde a entrada
+    uint32_t pulses;
+    uint32_t exits;
+} eco_hold_t;
+
+/**
+ * @param band Faixa aceita pelo material (± °C em torno do setpoint)
+ */
+void eco_hold_init(eco_hold_t *eh, float band);
+
+/**
+ * Um ciclo de controle com o PID habilitado (depois do pré-aquecimento)
+ *
+ * @param hold_output Manutenção prevista no centro do ciclo (%, feed-forward + exaustão)
+ * @param energy_wh Energia acumulada do heater (Wh)
+ * @param energy_measured energy_wh vem do ACS712; false = potência nominal pelo duty
+ * @param output Recebe a saída do heater quando o eco hold controla (%)
+ * @return true se a saída é do eco hold; false = PID (na saída o chamador
+ *         recarrega o PID)
+ */
+bool eco_hold_update(eco_hold_t *eh, float temperature, float setpoint, float ambient,
+                     float hold_output, double energy_wh, bool energy_measured,
+                     uint32_t now_ms, float *output);
+
+/**
+ * Volta para o PID sem contar como saída (sensor inseguro, corte, fim da secagem)
+ */
+void eco_hold_abort(eco_hold_t *eh);
+
+static inline bool eco_hold_active(const eco_hold_t *eh) {
+    return eh->state == ECO_HOLD_COAST || eh->state == ECO_HOLD_PULSE;
+}
+
+/**
+ * Centro do ciclo para o setpoint (alvo efetivo da câmara no eco hold)
+ */
+float eco_hold_center(const eco_hold_t *eh, float setpoint);
+
+/**
+ * Economia estimada contra a referência do PID (Wh); só vale com energy_measured
+ */
+static inline float eco_hold_saved_wh(const eco_hold_t *eh) {
+    return (float)(eh->baseline_wh - eh->eco_wh) - eh->borrowed_wh;
+}
+
+const char *eco_hold_state_name(eco_hold_state_t state);
+
+/**
+ * Fonte da energia da referência e da economia ("ACS712" ou "nominal")
+ */
+const char *eco_hold_energy_source_name(bool energy_measured);
+
+#endif // ECO_HOLD_H
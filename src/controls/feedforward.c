@@ -0,0 +1,125 @@
+#include "feedforward.h"
+#include "logger.h"
+#include <math.h>
+
+#define TAG "FeedFwd"
+
+// Posição do delta na tabela (índice inferior e fração até o próximo ponto)
+static void table_position(float delta, int *index, float *frac) {
+    float x = delta / FF_TABLE_STEP;
+    if (x < 0.0f) x = 0.0f;
+    if (x > (float)(FF_TABLE_SIZE - 1)) x = (float)(FF_TABLE_SIZE - 1);
+
+    int i = (int)x;
+    if (i >= FF_TABLE_SIZE - 1) i = FF_TABLE_SIZE - 2;
+    *index = i;
+    *frac = x - (float)i;
+}
+
+static float clamp_output(const feedforward_t *ff, float value) {
+    if (value > ff->output_max) return ff->output_max;
+    if (value < ff->output_min) return ff->output_min;
+    return value;
+}
+
+// Pontos ainda sem observação seguem proporcionalmente o ponto aprendido mais próximo
+static void extrapolate_unlearned(feedforward_t *ff) {
+    for (int j = 1; j < FF_TABLE_SIZE; j++) {
+        if (ff->samples[j] > 0) continue;
+
+        int nearest = -1;
+        for (int d = 1; d < FF_TABLE_SIZE && nearest < 0; d++) {
+            if (j - d >= 1 && ff->samples[j - d] > 0) nearest = j - d;
+            else if (j + d < FF_TABLE_SIZE && ff->samples[j + d] > 0) nearest = j + d;
+        }
+        if (nearest > 0) {
+            ff->table[j] = ff->table[nearest] * (float)j / (float)nearest;
+        }
+    }
+}
+
+void feedforward_init(feedforward_t *ff, float output_min, float output_max) {
+    ff->output_min = output_min;
+    ff->output_max = output_max;
+
+    for (int j = 0; j < FF_TABLE_SIZE; j++) {
+        ff->table[j] = FF_DEFAULT_PERCENT_PER_K * FF_TABLE_STEP * (float)j;
+        ff->samples[j] = 0;
+    }
+
+    ff->window_active = false;
+    ff->window_start = 0;
+    ff->window_last = 0;
+    ff->window_setpoint = 0.0f;
+    ff->window_output_sum = 0.0;
+    ff->updates = 0;
+}
+
+float feedforward_predict(const feedforward_t *ff, float setpoint, float ambient) {
+    float delta = setpoint - ambient;
+    if (delta <= 0.0f) {
+        return ff->output_min; // Setpoint abaixo do ambiente: nada a manter
+    }
+
+    int i;
+    float frac;
+    table_position(delta, &i, &frac);
+    float value = ff->table[i] + (ff->table[i + 1] - ff->table[i]) * frac;
+
+    // Além do último ponto: extrapolar com a inclinação do último trecho
+    float last_delta = FF_TABLE_STEP * (float)(FF_TABLE_SIZE - 1);
+    if (delta > last_delta) {
+        float slope = (ff->table[FF_TABLE_SIZE - 1] - ff->table[FF_TABLE_SIZE - 2]) / FF_TABLE_STEP;
+        value = ff->table[FF_TABLE_SIZE - 1] + slope * (delta - last_delta);
+    }
+
+    return clamp_output(ff, value);
+}
+
+bool feedforward_observe(feedforward_t *ff, float setpoint, float ambient,
+                         float temperature, float output, uint32_t now_ms) {
+    bool in_band = fabsf(temperature - setpoint) <= FF_STEADY_BAND;
+    bool saturated = (output <= ff->output_min) || (output >= ff->output_max);
+
+    if (!in_band || saturated || setpoint != ff->window_setpoint || !ff->window_active) {
+        // Fora de regime: recomeçar a janela (só conta a partir daqui)
+        ff->window_active = in_band && !saturated;
+        ff->window_start = now_ms;
+        ff->window_last = now_ms;
+        ff->window_setpoint = setpoint;
+        ff->window_output_sum = 0.0;
+        return false;
+    }
+
+    ff->window_output_sum += (double)output * (double)(now_ms - ff->window_last);
+    ff->window_last = now_ms;
+
+    uint32_t elapsed = now_ms - ff->window_start;
+    if (elapsed < FF_STEADY_TIME_MS) {
+        return false;
+    }
+
+    // Janela completa: média da saída = potência de manutenção observada
+    float observed = (float)(ff->window_output_sum / (double)elapsed);
+    float delta = setpoint - ambient;
+    float predicted = feedforward_predict(ff, setpoint, ambient);
+    float error = observed - predicted;
+
+    int i;
+    float frac;
+    table_position(delta, &i, &frac);
+    ff->table[i] += FF_LEARN_RATE * (1.0f - frac) * error;
+    ff->table[i + 1] += FF_LEARN_RATE * frac * error;
+    if (frac <= 0.75f && ff->samples[i] < 255) ff->samples[i]++;
+    if (frac >= 0.25f && ff->samples[i + 1] < 255) ff->samples[i + 1]++;
+    extrapolate_unlearned(ff);
+    ff->updates++;
+
+    LOGI(TAG, "Hold power at delta %.1f°C: observed %.1f%%, predicted %.1f%% (update #%lu)",
+         delta, observed, predicted, ff->updates);
+
+    // Continuar aprendendo com uma nova janela
+    ff->window_start = now_ms;
+    ff->window_output_sum = 0.0;
+    return true;
+}
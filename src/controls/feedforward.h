@@ -0,0 +1,71 @@
+#ifndef FEEDFORWARD_H
+#define FEEDFORWARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Feed-forward de potência de manutenção
+ *
+ * Prevê a saída (% de PWM) necessária para manter a câmara no setpoint a
+ * partir de delta = setpoint - ambiente. A previsão vem de uma tabela com
+ * pontos a cada FF_TABLE_STEP °C de delta, interpolada linearmente e
+ * inicializada com um modelo linear conservador (FF_DEFAULT_PERCENT_PER_K).
+ *
+ * Aprendizado online: quando a temperatura fica dentro de FF_STEADY_BAND
+ * do setpoint por FF_STEADY_TIME_MS sem saturar a saída, a média da saída
+ * nesse período é a potência real de manutenção para aquele delta e
+ * atualiza os dois pontos vizinhos da tabela (peso da interpolação).
+ */
+
+// Configurações do modelo
+#define FF_TABLE_SIZE 8                 // Pontos de delta: 0, 10, 20 ... 70 °C
+#define FF_TABLE_STEP 10.0f             // Espaçamento entre pontos (°C)
+#define FF_DEFAULT_PERCENT_PER_K 1.0f   // Modelo inicial (% por °C de delta, abaixo do real)
+#define FF_STEADY_BAND 0.5f             // Faixa em torno do setpoint considerada regime (°C)
+#define FF_STEADY_TIME_MS 600000        // Tempo em regime para uma observação (10 min)
+#define FF_LEARN_RATE 0.5f              // Peso de cada observação na tabela (0-1)
+
+typedef struct {
+    float table[FF_TABLE_SIZE];         // Potência de manutenção por ponto de delta (%)
+    uint8_t samples[FF_TABLE_SIZE];     // Observações aprendidas por ponto (satura em 255)
+    float output_min;
+    float output_max;
+
+    // Janela de regime em andamento
+    bool window_active;
+    uint32_t window_start;              // Início da janela (ms)
+    uint32_t window_last;               // Última observação (ms)
+    float window_setpoint;
+    double window_output_sum;           // Integral da saída na janela (% * ms)
+
+    uint32_t updates;                   // Total de atualizações da tabela
+} feedforward_t;
+
+/**
+ * Inicializa o modelo com a reta padrão (FF_DEFAULT_PERCENT_PER_K)
+ * @param ff Ponteiro para o modelo
+ * @param output_min Saída mínima (mesma do PID)
+ * @param output_max Saída máxima (mesma do PID)
+ */
+void feedforward_init(feedforward_t *ff, float output_min, float output_max);
+
+/**
+ * Potência prevista para manter o setpoint com a temperatura ambiente dada
+ * @return Saída prevista, limitada a [output_min, output_max]
+ */
+float feedforward_predict(const feedforward_t *ff, float setpoint, float ambient);
+
+/**
+ * Alimenta o aprendizado com o estado atual do controle
+ *
+ * Chamar a cada ciclo de controle com a saída aplicada. Fora de regime
+ * (erro grande, saída saturada ou setpoint alterado) a janela recomeça.
+ *
+ * @param now_ms Tempo atual (ms desde o boot)
+ * @return true se a tabela foi atualizada neste ciclo
+ */
+bool feedforward_observe(feedforward_t *ff, float setpoint, float ambient,
+                         float temperature, float output, uint32_t now_ms);
+
+#endif // FEEDFORWARD_H
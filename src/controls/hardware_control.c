@@ -3,14 +3,19 @@
 #include "pico/stdlib.h"
 #include "pico/time.h"
 #include "hardware/pwm.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "pico/critical_section.h"
 #include <stdio.h>
 
 #define TAG "HwCtrl"
 
 // Configuração do PWM
 #define PWM_FREQUENCY_HZ 5000    // 5 kHz - ideal para hotend
-#define PWM_WRAP_VALUE 12500     // Clock padrão (125MHz) / (2.0 * 5000Hz) = 12500
+#define PWM_COUNTER_MAX 65536u   // Contador de 16 bits
 #define PWM_ACTIVE_THRESHOLD 5.0f // PWM > 5% considera heater ativo
+#define PWM_FIXED_MIN_CLOCK_DIV 16 // DMA e zonas: TOP fixo cabe até clk_sys = PLL / 16
+#define VENT_PWM_FREQUENCY_HZ 25000 // Exaustão: acima da faixa audível
 
 // Pico W devices use a GPIO on the WIFI chip for the LED
 #ifdef CYW43_WL_GPIO_LED_PIN
@@ -24,7 +29,281 @@ static uint32_t last_led_update = 0;
 static bool led_state = false;
 static uint pwm_slice_num = 0;
 static uint pwm_channel = 0;
+static volatile uint32_t heater_inhibited = 0;  // Um bit por heater, escrito pela interrupção do supervisor
+static uint16_t pwm_wrap = 0;                   // TOP atual, derivado do clk_sys
+static float pwm_duty[HEATER_OUTPUTS_MAX];      // Último duty pedido pelo controle, por heater (%)
+static uint16_t pwm_level = 0;                  // Último nível escrito pelo controle
+static critical_section_t pwm_lock;             // Nível x reprogramação por troca de clock (outro núcleo)
+static volatile bool pwm_level_dirty = true;    // Registro mudou por fora (corte do supervisor)
+static uint32_t pwm_writes = 0;
+static uint32_t pwm_writes_skipped = 0;
+static volatile uint32_t heater_forced_low = 0; // Override do GPIO ativo (corte do supervisor), por heater
 
+// Modos com DMA: o canal de dados escreve uma palavra do padrão no CC a cada
+// wrap do PWM; no fim do padrão o canal de controle recarrega o endereço de
+// leitura com pattern_next e redispara o de dados. Uma palavra de guarda
+// separa os buffers: o endereço de leitura no fim de um não se confunde com
+// o início do outro.
+static heater_drive_t heater_drive = HEATER_DRIVE_PWM;
+static uint32_t pattern[2][HEATER_PATTERN_LENGTH + 1];
+static const uint32_t *volatile pattern_next;
+static uint32_t pattern_quanta = 0;             // Duty quantizado do padrão atual
+static uint16_t fixed_wrap = 0;                 // TOP fixo (modos com DMA e zonas)
+static uint32_t pwm_base_hz = 0;                // clk_sys na inicialização (PLL)
+static int dma_data_channel = -1;
+static int dma_ctrl_channel = -1;
+
+// Zonas: um slice por zona, a zona 0 é o HEATER_PIN. A fase de cada uma é o
+// deslocamento do contador do slice em relação ao da zona 0. Com câmaras cada
+// zona é o heater de uma câmara (zone_heater), com duty e bloqueio próprios.
+static uint8_t zone_count = 1;
+static uint8_t heater_count = 1;
+static uint8_t zone_heater[HEATER_ZONES_MAX];   // Heater dono de cada saída
+static uint zone_pin[HEATER_ZONES_MAX] = {HEATER_PIN};
+static uint zone_slice[HEATER_ZONES_MAX];
+static uint zone_chan[HEATER_ZONES_MAX];
+static heater_zones_t zones;
+static uint32_t zone_rephases = 0;
+
+// Ventoinhas de exaustão (uma por câmara), PWM simples com TOP derivado do clk_sys
+static uint8_t vent_count = 0;
+static uint vent_slice[VENT_OUTPUTS_MAX];
+static uint vent_chan[VENT_OUTPUTS_MAX];
+static float vent_duty[VENT_OUTPUTS_MAX];
+static uint16_t vent_wrap = 0;
+
+// Tacômetros: slices em modo de contagem (bordas de descida no canal B)
+static uint8_t tach_count = 0;
+static uint tach_slice[TACH_INPUTS_MAX];
+
+
+// Divisor (8.4, em 1/16) e TOP para a frequência com o clk_sys informado:
+// o menor divisor em que o período cabe no contador, para a maior resolução
+static void pwm_timing(uint32_t sys_hz, uint32_t freq_hz, uint32_t *div16, uint16_t *wrap) {
+    uint32_t counts = sys_hz / freq_hz;                     // Contagens por período com divisor 1
+    uint32_t div = (counts * 16u + PWM_COUNTER_MAX - 1u) / PWM_COUNTER_MAX;
+    if (div < 16u) {
+        div = 16u;
+    }
+    *div16 = div;
+    *wrap = (uint16_t)(counts * 16u / div - 1u);
+}
+
+static uint16_t pwm_duty_to_level(float duty_cycle_percent) {
+    return (uint16_t)((duty_cycle_percent / 100.0f) * pwm_wrap);
+}
+
+static bool drive_uses_dma(heater_drive_t drive) {
+    return drive != HEATER_DRIVE_PWM;
+}
+
+// Divisor (em 1/16) para PWM_FREQUENCY_HZ com o TOP fixo (modos com DMA e zonas)
+static uint32_t fixed_div16(uint32_t sys_hz) {
+    uint32_t period = (uint32_t)fixed_wrap + 1u;
+    uint32_t div = (uint32_t)(((uint64_t)sys_hz * 16u + (uint64_t)PWM_FREQUENCY_HZ * period / 2u) /
+                              ((uint64_t)PWM_FREQUENCY_HZ * period));
+    if (div < 16u) div = 16u;
+    if (div > 0xfffu) div = 0xfffu;
+    return div;
+}
+
+// Duty em unidades do padrão: contagens x 65536 (sigma-delta, a parte
+// fracionária vira o acumulador) ou contagens na janela inteira (burst)
+static uint32_t pattern_quantize(float duty_cycle_percent) {
+    float counts = (float)fixed_wrap + 1.0f;
+    if (heater_drive == HEATER_DRIVE_SIGMA_DELTA) {
+        return (uint32_t)(duty_cycle_percent / 100.0f * counts * 65536.0f);
+    }
+    return (uint32_t)(duty_cycle_percent / 100.0f * counts * HEATER_PATTERN_LENGTH + 0.5f);
+}
+
+// Monta um padrão: palavra inteira do CC, o heater no canal dele e o outro em 0
+static void pattern_build(uint32_t *buf, uint32_t quanta) {
+    uint32_t counts = (uint32_t)fixed_wrap + 1u;
+    uint32_t shift = pwm_channel ? 16u : 0u;
+
+    if (heater_drive == HEATER_DRIVE_SIGMA_DELTA) {
+        uint32_t base = quanta >> 16;
+        uint32_t frac = quanta & 0xffffu;
+        uint32_t acc = 0x8000u;
+        for (uint32_t i = 0; i < HEATER_PATTERN_LENGTH; i++) {
+            uint32_t level = base;
+            acc += frac;
+            if (acc >= 0x10000u) {
+                acc -= 0x10000u;
+                level++;
+            }
+            buf[i] = level << shift;
+        }
+    } else {
+        // Burst: períodos cheios (nível = TOP + 1, saída sempre alta), um
+        // parcial com o resto e depois desligado
+        uint32_t remaining = quanta;
+        for (uint32_t i = 0; i < HEATER_PATTERN_LENGTH; i++) {
+            uint32_t level = remaining >= counts ? counts : remaining;
+            remaining -= level;
+            buf[i] = level << shift;
+        }
+    }
+}
+
+// Buffer que o DMA está tocando (ou vai tocar, se acabou de chegar ao fim de um)
+static uint32_t pattern_playing(void) {
+    uintptr_t addr = dma_channel_hw_addr((uint)dma_data_channel)->read_addr;
+    for (uint32_t b = 0; b < 2; b++) {
+        if (addr >= (uintptr_t)&pattern[b][0] && addr < (uintptr_t)&pattern[b][HEATER_PATTERN_LENGTH]) {
+            return b;
+        }
+    }
+    return pattern_next == pattern[0] ? 0u : 1u;
+}
+
+// Padrão novo no buffer livre; o DMA passa para ele no fim do atual
+static void pattern_update(uint32_t quanta) {
+    uint32_t free_buf = pattern_playing() ^ 1u;
+    pattern_build(pattern[free_buf], quanta);
+    pattern_next = pattern[free_buf];
+    pattern_quanta = quanta;
+}
+
+static void pattern_start(void) {
+    uint32_t div16 = fixed_div16(clock_get_hz(clk_sys));
+    pwm_set_clkdiv_int_frac(pwm_slice_num, (uint8_t)(div16 >> 4), (uint8_t)(div16 & 0xf));
+    pwm_set_wrap(pwm_slice_num, fixed_wrap);
+
+    pattern_quanta = pattern_quantize(pwm_duty[0]);
+    pattern_build(pattern[0], pattern_quanta);
+    pattern_next = pattern[0];
+
+    dma_channel_config data = dma_channel_get_default_config((uint)dma_data_channel);
+    channel_config_set_transfer_data_size(&data, DMA_SIZE_32);
+    channel_config_set_read_increment(&data, true);
+    channel_config_set_write_increment(&data, false);
+    channel_config_set_dreq(&data, pwm_get_dreq(pwm_slice_num));
+    channel_config_set_chain_to(&data, (uint)dma_ctrl_channel);
+    dma_channel_configure((uint)dma_data_channel, &data, &pwm_hw->slice[pwm_slice_num].cc,
+                          pattern[0], HEATER_PATTERN_LENGTH, false);
+
+    dma_channel_config ctrl = dma_channel_get_default_config((uint)dma_ctrl_channel);
+    channel_config_set_transfer_data_size(&ctrl, DMA_SIZE_32);
+    channel_config_set_read_increment(&ctrl, false);
+    channel_config_set_write_increment(&ctrl, false);
+    dma_channel_configure((uint)dma_ctrl_channel, &ctrl,
+                          &dma_channel_hw_addr((uint)dma_data_channel)->al3_read_addr_trig,
+                          &pattern_next, 1, true);
+}
+
+static void pattern_stop(void) {
+    // Um canal pode redisparar o outro enquanto é abortado: repetir até os dois pararem
+    do {
+        dma_channel_abort((uint)dma_ctrl_channel);
+        dma_channel_abort((uint)dma_data_channel);
+    } while (dma_channel_is_busy((uint)dma_ctrl_channel) || dma_channel_is_busy((uint)dma_data_channel));
+}
+
+// Divisor para o TOP fixo em todos os slices das zonas
+static void zones_set_clkdiv(uint32_t sys_hz) {
+    uint32_t div16 = fixed_div16(sys_hz);
+    for (uint8_t k = 0; k < zone_count; k++) {
+        pwm_set_clkdiv_int_frac(zone_slice[k], (uint8_t)(div16 >> 4), (uint8_t)(div16 & 0xf));
+    }
+}
+
+static uint32_t zones_slice_mask(void) {
+    uint32_t mask = 0;
+    for (uint8_t k = 0; k < zone_count; k++) {
+        mask |= 1u << zone_slice[k];
+    }
+    return mask;
+}
+
+static void zones_set_override(uint8_t heater, enum gpio_override value) {
+    for (uint8_t k = 0; k < zone_count; k++) {
+        if (zone_heater[k] == heater) {
+            gpio_set_outover(zone_pin[k], value);
+        }
+    }
+}
+
+static void zones_set_levels_zero(uint8_t heater) {
+    for (uint8_t k = 0; k < zone_count; k++) {
+        if (zone_heater[k] == heater) {
+            pwm_set_chan_level(zone_slice[k], zone_chan[k], 0);
+        }
+    }
+}
+
+// Duty do último plano nas saídas do heater, ponderado pela corrente (%): o
+// que o ACS712 na linha desse heater vê
+static float zones_heater_duty(uint8_t heater) {
+    float weighted = 0.0f;
+    float total = 0.0f;
+    for (uint8_t k = 0; k < zone_count; k++) {
+        if (zone_heater[k] == heater) {
+            weighted += (float)zones.level[k] * zones.current_a[k];
+            total += zones.current_a[k];
+        }
+    }
+    return total > 0.0f ? 100.0f * weighted / (total * (float)zones.counts) : 0.0f;
+}
+
+// Níveis do plano nos slices. Com fase nova os slices param, recebem nível
+// (com o slice parado vale na hora) e contador, e partem juntos no mesmo
+// ciclo: a zona k chega ao início da janela phase[k] contagens depois da 0.
+// O período em curso é cortado uma vez, sem efeito na média.
+static void zones_apply(bool rephase) {
+    if (!rephase) {
+        for (uint8_t k = 0; k < zone_count; k++) {
+            pwm_set_chan_level(zone_slice[k], zone_chan[k], zones.level[k]);
+        }
+        return;
+    }
+    uint32_t mask = zones_slice_mask();
+    uint32_t counts = (uint32_t)fixed_wrap + 1u;
+    pwm_set_mask_enabled(pwm_hw->en & ~mask);
+    for (uint8_t k = 0; k < zone_count; k++) {
+        pwm_set_chan_level(zone_slice[k], zone_chan[k], zones.level[k]);
+        pwm_set_counter(zone_slice[k], (uint16_t)((counts - zones.phase[k]) % counts));
+    }
+    pwm_set_mask_enabled(pwm_hw->en | mask);
+    zone_rephases++;
+}
+
+// Cada zona com o duty pedido ao seu heater (o mesmo em todas as zonas de um
+// heater só; 0 nos bloqueados, que liberam o orçamento para os outros);
+// escreve só o que mudou no plano
+static void zones_write(void) {
+    float requested[HEATER_ZONES_MAX];
+    uint16_t old_level[HEATER_ZONES_MAX];
+    uint16_t old_phase[HEATER_ZONES_MAX];
+    for (uint8_t k = 0; k < zone_count; k++) {
+        requested[k] = (heater_inhibited & (1u << zone_heater[k])) ? 0.0f : pwm_duty[zone_heater[k]];
+        old_level[k] = zones.level[k];
+        old_phase[k] = zones.phase[k];
+    }
+    heater_zones_plan(&zones, requested, (uint32_t)fixed_wrap + 1u);
+    
+    bool same_level = true;
+    bool same_phase = true;
+    for (uint8_t k = 0; k < zone_count; k++) {
+        same_level = same_level && zones.level[k] == old_level[k];
+        same_phase = same_phase && zones.phase[k] == old_phase[k];
+    }
+    if (same_level && same_phase && !pwm_level_dirty) {
+        pwm_writes_skipped++;
+        return;
+    }
+    pwm_level_dirty = false;
+    zones_apply(!same_phase);
+    pwm_writes++;
+    // O supervisor pode ter bloqueado algum heater durante o plano: refazer o corte
+    for (uint8_t h = 0; h < heater_count; h++) {
+        if (heater_inhibited & (1u << h)) {
+            zones_set_levels_zero(h);
+            pwm_level_dirty = true;
+        }
+    }
+}
 
 // Inicialização do módulo de controle de hardware
 void hardware_control_init(void) {
@@ -34,15 +313,21 @@ void hardware_control_init(void) {
     // Descobrir qual slice PWM está conectado ao HEATER_PIN
     pwm_slice_num = pwm_gpio_to_slice_num(HEATER_PIN);
     pwm_channel = pwm_gpio_to_channel(HEATER_PIN);
+    zone_slice[0] = pwm_slice_num;
+    zone_chan[0] = pwm_channel;
     
     // Configurar PWM
     pwm_config config = pwm_get_default_config();
     
-    // Configurar divisor de clock para obter a frequência desejada
-    // Clock base = 125MHz, queremos 5kHz
-    // div = 125MHz / (wrap * freq) = 125MHz / (12500 * 5kHz) = 2.0
-    pwm_config_set_clkdiv(&config, 2.0f);
-    pwm_config_set_wrap(&config, PWM_WRAP_VALUE);
+    // Divisor e TOP a partir do clk_sys atual (125 MHz: divisor 1, TOP 24999)
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    pwm_base_hz = sys_hz;
+    fixed_wrap = (uint16_t)(pwm_base_hz / PWM_FIXED_MIN_CLOCK_DIV / PWM_FREQUENCY_HZ - 1u);
+    uint32_t div16;
+    pwm_timing(sys_hz, PWM_FREQUENCY_HZ, &div16, &pwm_wrap);
+    pwm_config_set_clkdiv_int_frac(&config, (uint8_t)(div16 >> 4), (uint8_t)(div16 & 0xf));
+    pwm_config_set_wrap(&config, pwm_wrap);
+    critical_section_init(&pwm_lock);
     
     // Aplicar configuração
     pwm_init(pwm_slice_num, &config, true);
@@ -50,16 +335,235 @@ void hardware_control_init(void) {
     // Estado inicial seguro (0% duty cycle)
     pwm_set_chan_level(pwm_slice_num, pwm_channel, 0);
     
+    // Canais para os modos com DMA (sigma-delta e burst)
+    dma_data_channel = dma_claim_unused_channel(true);
+    dma_ctrl_channel = dma_claim_unused_channel(true);
+    
     // Reset variáveis do LED
     last_led_update = 0;
     led_state = false;
     
-    LOGI(TAG, "Initialized (Heater PWM: GPIO %d, Slice %d, Channel %d, Freq: %d Hz)", 
-         HEATER_PIN, pwm_slice_num, pwm_channel, PWM_FREQUENCY_HZ);
+    LOGI(TAG, "Initialized (Heater PWM: GPIO %d, Slice %d, Channel %d, Freq: %d Hz, clk_sys %lu MHz, TOP %u)", 
+         HEATER_PIN, pwm_slice_num, pwm_channel, PWM_FREQUENCY_HZ, sys_hz / 1000000u, pwm_wrap);
+}
+
+// Saídas em slices diferentes com TOP fixo; per_heater: uma saída por heater
+// (câmaras), senão todas do heater 0 (zonas)
+static void outputs_init(const uint8_t *pins, const float *current_a, uint8_t count,
+                         float budget_a, bool stagger, bool per_heater) {
+    const char *what = per_heater ? "Chamber heaters" : "Heater zones";
+    if (count > HEATER_ZONES_MAX) {
+        count = HEATER_ZONES_MAX;
+    }
+    if (count < 2 || drive_uses_dma(heater_drive)) {
+        LOGW(TAG, "%s need at least 2 outputs and PWM drive, keeping a single heater", what);
+        return;
+    }
+    for (uint8_t k = 0; k < count; k++) {
+        for (uint8_t j = 0; j < k; j++) {
+            if (pwm_gpio_to_slice_num(pins[k]) == pwm_gpio_to_slice_num(pins[j])) {
+                LOGE(TAG, "%s: GPIO %d shares PWM slice %d with GPIO %d, keeping a single heater",
+                     what, pins[k], pwm_gpio_to_slice_num(pins[k]), pins[j]);
+                return;
+            }
+        }
+    }
+    
+    critical_section_enter_blocking(&pwm_lock);
+    // Todos os slices com o TOP fixo e parados até a partida conjunta
+    zone_count = count;
+    heater_count = per_heater ? count : 1;
+    for (uint8_t k = 0; k < count; k++) {
+        zone_pin[k] = pins[k];
+        zone_heater[k] = per_heater ? k : 0;
+        pwm_duty[k] = 0.0f;
+        zone_slice[k] = pwm_gpio_to_slice_num(pins[k]);
+        zone_chan[k] = pwm_gpio_to_channel(pins[k]);
+        gpio_set_function(pins[k], GPIO_FUNC_PWM);
+        pwm_config config = pwm_get_default_config();
+        pwm_config_set_wrap(&config, fixed_wrap);
+        pwm_init(zone_slice[k], &config, false);
+    }
+    pwm_slice_num = zone_slice[0];
+    pwm_channel = zone_chan[0];
+    pwm_wrap = fixed_wrap;
+    pwm_level = 0;
+    zones_set_clkdiv(clock_get_hz(clk_sys));
+    heater_zones_init(&zones, current_a, count, budget_a, stagger);
+    heater_zones_plan(&zones, (const float[HEATER_ZONES_MAX]){0}, (uint32_t)fixed_wrap + 1u);
+    zones_apply(true);
+    pwm_level_dirty = true;
+    critical_section_exit(&pwm_lock);
+    
+    LOGI(TAG, "%s: %d outputs, TOP %u, PSU peak budget %.2fA, phase stagger %s",
+         what, count, fixed_wrap, budget_a, stagger ? "on" : "off");
+    float total_a = 0.0f;
+    for (uint8_t k = 0; k < count; k++) {
+        total_a += current_a[k];
+    }
+    if (!stagger && budget_a < total_a) {
+        LOGW(TAG, "Aligned outputs need %.2fA together, budget %.2fA keeps the heaters off", total_a, budget_a);
+    }
+}
+
+void hardware_control_heater_zones_init(const uint8_t *pins, const float *current_a, uint8_t count,
+                                        float budget_a, bool stagger) {
+    outputs_init(pins, current_a, count, budget_a, stagger, false);
+}
+
+void hardware_control_heaters_init(const uint8_t *pins, const float *current_a, uint8_t count,
+                                   float budget_a, bool stagger) {
+    outputs_init(pins, current_a, count, budget_a, stagger, true);
+}
+
+bool hardware_control_heater_zones_stats(heater_zones_t *out, uint32_t *rephases) {
+    if (zone_count < 2) {
+        return false;
+    }
+    critical_section_enter_blocking(&pwm_lock);
+    *out = zones;
+    *rephases = zone_rephases;
+    critical_section_exit(&pwm_lock);
+    return true;
+}
+
+// Divisor, TOP e níveis das ventoinhas para o clk_sys atual (com pwm_lock)
+static void vents_set_timing(uint32_t sys_hz) {
+    uint32_t div16;
+    pwm_timing(sys_hz, VENT_PWM_FREQUENCY_HZ, &div16, &vent_wrap);
+    for (uint8_t v = 0; v < vent_count; v++) {
+        pwm_set_clkdiv_int_frac(vent_slice[v], (uint8_t)(div16 >> 4), (uint8_t)(div16 & 0xf));
+        pwm_set_wrap(vent_slice[v], vent_wrap);
+        pwm_set_chan_level(vent_slice[v], vent_chan[v], (uint16_t)(vent_duty[v] / 100.0f * vent_wrap));
+    }
+}
+
+void hardware_control_vent_init(const uint8_t *pins, uint8_t count) {
+    if (count > VENT_OUTPUTS_MAX) {
+        count = VENT_OUTPUTS_MAX;
+    }
+    critical_section_enter_blocking(&pwm_lock);
+    vent_count = 0;
+    for (uint8_t v = 0; v < count; v++) {
+        // O slice de um heater tem TOP, fase e padrão próprios: não dá para dividir
+        uint slice = pwm_gpio_to_slice_num(pins[v]);
+        bool shared = false;
+        for (uint8_t k = 0; k < zone_count; k++) {
+            shared = shared || zone_slice[k] == slice;
+        }
+        if (shared) {
+            LOGE(TAG, "Vent GPIO %d shares PWM slice %d with a heater, vents disabled", pins[v], slice);
+            vent_count = 0;
+            break;
+        }
+        vent_slice[v] = slice;
+        vent_chan[v] = pwm_gpio_to_channel(pins[v]);
+        vent_duty[v] = 0.0f;
+        gpio_set_function(pins[v], GPIO_FUNC_PWM);
+        pwm_set_enabled(slice, true);
+        vent_count = v + 1;
+    }
+    vents_set_timing(clock_get_hz(clk_sys));
+    critical_section_exit(&pwm_lock);
+    if (vent_count) {
+        LOGI(TAG, "Vent fans: %d outputs from GPIO %d, %d Hz, TOP %u",
+             vent_count, pins[0], VENT_PWM_FREQUENCY_HZ, vent_wrap);
+    }
+}
+
+void hardware_control_vent_pwm(uint8_t vent, float duty_percent) {
+    if (vent >= vent_count) {
+        return;
+    }
+    if (duty_percent < 0.0f) duty_percent = 0.0f;
+    if (duty_percent > 100.0f) duty_percent = 100.0f;
+    critical_section_enter_blocking(&pwm_lock);
+    if (duty_percent != vent_duty[vent]) {
+        vent_duty[vent] = duty_percent;
+        pwm_set_chan_level(vent_slice[vent], vent_chan[vent], (uint16_t)(duty_percent / 100.0f * vent_wrap));
+    }
+    critical_section_exit(&pwm_lock);
+}
+
+int hardware_control_tach_init(uint8_t pin) {
+    uint slice = pwm_gpio_to_slice_num(pin);
+    if (tach_count >= TACH_INPUTS_MAX || pwm_gpio_to_channel(pin) != PWM_CHAN_B) {
+        LOGE(TAG, "Tach GPIO %d is not a free PWM B input, fan monitoring disabled", pin);
+        return -1;
+    }
+    // O slice inteiro passa a contar: não dá para dividir com uma saída
+    bool shared = false;
+    for (uint8_t k = 0; k < zone_count; k++) {
+        shared = shared || zone_slice[k] == slice;
+    }
+    for (uint8_t v = 0; v < vent_count; v++) {
+        shared = shared || vent_slice[v] == slice;
+    }
+    if (shared) {
+        LOGE(TAG, "Tach GPIO %d shares PWM slice %d with an output, fan monitoring disabled", pin, slice);
+        return -1;
+    }
+
+    // Ventoinhas de PC: saída em coletor aberto, pull-up interno
+    gpio_set_function(pin, GPIO_FUNC_PWM);
+    gpio_pull_up(pin);
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_clkdiv_mode(&config, PWM_DIV_B_FALLING);
+    pwm_config_set_clkdiv(&config, 1.0f);
+    pwm_init(slice, &config, true);
+
+    tach_slice[tach_count] = slice;
+    LOGI(TAG, "Fan tach on GPIO %d (PWM slice %d counting edges)", pin, slice);
+    return tach_count++;
+}
+
+void hardware_control_tach_read(int tach, uint16_t *edges, uint64_t *time_us) {
+    *edges = pwm_get_counter(tach_slice[tach]);
+    *time_us = time_us_64();
+}
+
+void hardware_control_pwm_clock_changed(void) {
+    uint32_t div16;
+    uint16_t wrap;
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    pwm_timing(sys_hz, PWM_FREQUENCY_HZ, &div16, &wrap);
+    
+    critical_section_enter_blocking(&pwm_lock);
+    vents_set_timing(sys_hz);
+    if (zone_count > 1) {
+        // TOP fixo: o divisor muda em todos os slices, contadores (fases) seguem
+        zones_set_clkdiv(sys_hz);
+        critical_section_exit(&pwm_lock);
+        return;
+    }
+    if (drive_uses_dma(heater_drive)) {
+        // TOP fixo e padrão em contagens: só o divisor acompanha o clock
+        div16 = fixed_div16(sys_hz);
+        pwm_set_clkdiv_int_frac(pwm_slice_num, (uint8_t)(div16 >> 4), (uint8_t)(div16 & 0xf));
+        critical_section_exit(&pwm_lock);
+        return;
+    }
+    // TOP e nível têm buffer duplo e só valem no próximo wrap; o divisor vale
+    // na hora. O período em curso termina com TOP e nível antigos, então a
+    // razão (o duty) é mantida e só a duração desse período muda.
+    pwm_set_clkdiv_int_frac(pwm_slice_num, (uint8_t)(div16 >> 4), (uint8_t)(div16 & 0xf));
+    pwm_set_wrap(pwm_slice_num, wrap);
+    pwm_wrap = wrap;
+    pwm_level = pwm_duty_to_level(pwm_duty[0]);
+    pwm_set_chan_level(pwm_slice_num, pwm_channel, pwm_level);
+    pwm_level_dirty = false;
+    if (heater_inhibited & 1u) {
+        pwm_set_chan_level(pwm_slice_num, pwm_channel, 0);
+        pwm_level_dirty = true;
+    }
+    critical_section_exit(&pwm_lock);
 }
 
 // Controle do aquecedor com PWM
-void hardware_control_heater_pwm(float duty_cycle_percent) {
+void hardware_control_heater_pwm(uint8_t heater, float duty_cycle_percent) {
+    if (heater >= heater_count) {
+        return;
+    }
     // Garantir que duty_cycle está no range válido (0-100%)
     if (duty_cycle_percent < 0.0f) {
         LOGW(TAG, "Duty cycle abaixo de 0%%, ajustando para 0%%");
@@ -69,26 +573,222 @@ void hardware_control_heater_pwm(float duty_cycle_percent) {
         duty_cycle_percent = 100.0f;
     }
     
-    // Converter percentual para nível PWM
-    uint16_t level = (uint16_t)((duty_cycle_percent / 100.0f) * PWM_WRAP_VALUE);
+    uint32_t bit = 1u << heater;
+    critical_section_enter_blocking(&pwm_lock);
+    pwm_duty[heater] = duty_cycle_percent;
+    
+    if (drive_uses_dma(heater_drive)) {
+        uint32_t quanta = pattern_quantize(duty_cycle_percent);
+        if (quanta == pattern_quanta && !pwm_level_dirty) {
+            pwm_writes_skipped++;
+        } else {
+            pwm_level_dirty = false;
+            pattern_update(quanta);
+            pwm_writes++;
+        }
+        // Supervisor liberou: o padrão já tem o duty novo, soltar o pino
+        if ((heater_forced_low & bit) && !(heater_inhibited & bit)) {
+            heater_forced_low &= ~bit;
+            gpio_set_outover(HEATER_PIN, GPIO_OVERRIDE_NORMAL);
+        }
+        critical_section_exit(&pwm_lock);
+        return;
+    }
+    
+    // Converter percentual para nível PWM (TOP do clk_sys atual)
+    uint16_t level = pwm_duty_to_level(duty_cycle_percent);
+    
+    if (zone_count > 1) {
+        zones_write();
+    } else if (level == pwm_level && !pwm_level_dirty) {
+        // Mesmo nível já está no registro: nada a escrever
+        pwm_writes_skipped++;
+    } else {
+        // Aplicar ao PWM
+        pwm_level_dirty = false;
+        pwm_level = level;
+        pwm_set_chan_level(pwm_slice_num, pwm_channel, level);
+        pwm_writes++;
+
+        // O supervisor pode ter bloqueado entre o cálculo e a escrita: refazer o corte
+        if (heater_inhibited & bit) {
+            pwm_set_chan_level(pwm_slice_num, pwm_channel, 0);
+            pwm_level_dirty = true;
+        }
+    }
+    if ((heater_forced_low & bit) && !(heater_inhibited & bit)) {
+        heater_forced_low &= ~bit;
+        zones_set_override(heater, GPIO_OVERRIDE_NORMAL);
+    }
+    critical_section_exit(&pwm_lock);
+}
+
+void hardware_control_heater_inhibit(uint8_t heater, bool inhibit) {
+    uint32_t bit = 1u << heater;
+    if (!inhibit) {
+        heater_inhibited &= ~bit;
+        return;
+    }
+    heater_inhibited |= bit;
+    // Override primeiro: corta na hora, mesmo com o DMA reescrevendo o CC
+    zones_set_override(heater, GPIO_OVERRIDE_LOW);
+    heater_forced_low |= bit;
+    zones_set_levels_zero(heater);
+    pwm_level_dirty = true;
+}
+
+void hardware_control_set_heater_drive(heater_drive_t drive) {
+    if (zone_count > 1 && drive_uses_dma(drive)) {
+        LOGW(TAG, "Heater drive %s needs a single heater zone, keeping PWM",
+             hardware_control_heater_drive_name(drive));
+        return;
+    }
+    critical_section_enter_blocking(&pwm_lock);
+    if (drive == heater_drive) {
+        critical_section_exit(&pwm_lock);
+        return;
+    }
+    if (drive_uses_dma(heater_drive)) {
+        pattern_stop();
+    }
+    heater_drive = drive;
+    
+    if (drive_uses_dma(drive)) {
+        pattern_start();
+    } else {
+        uint32_t div16;
+        pwm_timing(clock_get_hz(clk_sys), PWM_FREQUENCY_HZ, &div16, &pwm_wrap);
+        pwm_set_clkdiv_int_frac(pwm_slice_num, (uint8_t)(div16 >> 4), (uint8_t)(div16 & 0xf));
+        pwm_set_wrap(pwm_slice_num, pwm_wrap);
+        bool inhibited = heater_inhibited & 1u;
+        pwm_level = pwm_duty_to_level(pwm_duty[0]);
+        pwm_set_chan_level(pwm_slice_num, pwm_channel, inhibited ? 0 : pwm_level);
+        pwm_level_dirty = inhibited;
+    }
+    critical_section_exit(&pwm_lock);
     
-    // Aplicar ao PWM
-    pwm_set_chan_level(pwm_slice_num, pwm_channel, level);
+    LOGI(TAG, "Heater drive: %s (TOP %u)", hardware_control_heater_drive_name(drive),
+         drive_uses_dma(drive) ? fixed_wrap : pwm_wrap);
+}
+
+heater_drive_t hardware_control_get_heater_drive(void) {
+    return heater_drive;
+}
+
+const char *hardware_control_heater_drive_name(heater_drive_t drive) {
+    switch (drive) {
+        case HEATER_DRIVE_SIGMA_DELTA: return "sigma-delta";
+        case HEATER_DRIVE_BURST: return "burst";
+        default: return "PWM";
+    }
+}
+
+// Posição atual: entrada do padrão em vigor no pino. A palavra escrita por
+// último no CC só vale no próximo wrap, então a ativa é a anterior a ela; logo
+// depois da recarga as ativas ainda são as duas últimas da volta anterior
+// (índices -2 e -1).
+static void pattern_position(heater_window_t *pos) {
+    uintptr_t addr = dma_channel_hw_addr((uint)dma_data_channel)->read_addr;
+    uint32_t b = addr >= (uintptr_t)&pattern[1][0] ? 1u : 0u;
+    pos->buffer = (uint8_t)b;
+    pos->index = (int16_t)((addr - (uintptr_t)&pattern[b][0]) / sizeof(uint32_t)) - 2;
+}
+
+// Soma e menor nível das entradas from..to (to < from: nada). Índice negativo
+// é a volta anterior, aproximada pelo mesmo buffer (só erra logo após uma
+// troca de padrão).
+static uint32_t pattern_sum(uint32_t b, int32_t from, int32_t to, uint32_t *min_level) {
+    uint32_t shift = pwm_channel ? 16u : 0u;
+    uint32_t sum = 0;
+    for (int32_t i = from; i <= to; i++) {
+        int32_t e = i < 0 ? i + HEATER_PATTERN_LENGTH : i;
+        uint32_t level = (pattern[b][e] >> shift) & 0xffffu;
+        sum += level;
+        if (level < *min_level) {
+            *min_level = level;
+        }
+    }
+    return sum;
+}
+
+void hardware_control_heater_window_begin(uint8_t heater, heater_window_t *window) {
+    (void)heater;   // Padrão com DMA só com um heater
+    window->buffer = 0;
+    window->index = 0;
+    if (drive_uses_dma(heater_drive)) {
+        pattern_position(window);
+    }
+}
+
+float hardware_control_heater_window_duty(uint8_t heater, const heater_window_t *window, float *duty_min) {
+    uint32_t bit = 1u << heater;
+    if ((heater_forced_low & bit) || (heater_inhibited & bit)) {
+        *duty_min = 0.0f;
+        return 0.0f;
+    }
+    if (zone_count > 1) {
+        // ACS712 na linha do heater: média das suas zonas pela corrente de cada uma
+        *duty_min = zones_heater_duty(heater);
+        return *duty_min;
+    }
+    if (!drive_uses_dma(heater_drive)) {
+        *duty_min = 100.0f * (float)pwm_level / ((float)pwm_wrap + 1.0f);
+        return *duty_min;
+    }
+    
+    // Média das entradas que passaram pelo pino na janela (curta: no máximo
+    // uma volta do padrão)
+    heater_window_t now;
+    pattern_position(&now);
+    uint32_t sum;
+    uint32_t min_level = UINT32_MAX;
+    int32_t periods;
+    if (now.buffer == window->buffer && now.index >= window->index) {
+        sum = pattern_sum(now.buffer, window->index, now.index, &min_level);
+        periods = now.index - window->index + 1;
+    } else {
+        // Fim da volta de window->buffer, depois o começo da seguinte (se a
+        // ativa ainda é uma das duas últimas da anterior, só a primeira parte)
+        int32_t end = now.index >= 0 ? HEATER_PATTERN_LENGTH - 1 : HEATER_PATTERN_LENGTH + now.index;
+        sum = pattern_sum(window->buffer, window->index, end, &min_level) +
+              pattern_sum(now.buffer, 0, now.index, &min_level);
+        periods = end - window->index + 1 + (now.index >= 0 ? now.index + 1 : 0);
+    }
+    if (periods <= 0) {
+        *duty_min = 0.0f;
+        return 0.0f;
+    }
+    
+    // O primeiro e o último período só entram em parte na medida, então a
+    // média pode errar em até um período de cada lado; o menor nível da
+    // janela vale de qualquer jeito
+    float counts = (float)fixed_wrap + 1.0f;
+    *duty_min = 100.0f * (float)min_level / counts;
+    return 100.0f * (float)sum / ((float)periods * counts);
+}
+
+bool hardware_control_heater_inhibited(uint8_t heater) {
+    return (heater_inhibited & (1u << heater)) != 0;
+}
+
+void hardware_control_pwm_write_stats(uint32_t *writes, uint32_t *skipped) {
+    *writes = pwm_writes;
+    *skipped = pwm_writes_skipped;
 }
 
 // Controle do aquecedor (compatibilidade - deprecated)
 void hardware_control_heater(bool enable) {
     // Converte bool para PWM: true = 100%, false = 0%
     LOGW(TAG, "hardware_control_heater() is deprecated, use hardware_control_heater_pwm()");
-    hardware_control_heater_pwm(enable ? 100.0f : 0.0f);
+    hardware_control_heater_pwm(0, enable ? 100.0f : 0.0f);
 }
 
 
 
 // Atualizar PWM do heater baseado no duty cycle calculado
-void hardware_control_update_pwm(dryer_data_t *data, bool sensor_safe, float pid_output) {
-    if (!sensor_safe) {
-        // Modo segurança - PWM sempre 0%
+void hardware_control_update_pwm(uint8_t heater, dryer_data_t *data, bool sensor_safe, float pid_output) {
+    if (!sensor_safe || hardware_control_heater_inhibited(heater)) {
+        // Modo segurança ou supervisor bloqueou - PWM sempre 0%
         data->pwm_percent = 0.0;
     } else {
         // Usar saída do PID diretamente
@@ -96,7 +796,12 @@ void hardware_control_update_pwm(dryer_data_t *data, bool sensor_safe, float pid
     }
     
     // Aplicar o duty cycle ao hardware
-    hardware_control_heater_pwm(data->pwm_percent);
+    hardware_control_heater_pwm(heater, data->pwm_percent);
+    
+    // Com zonas ou câmaras o orçamento de pico pode entregar menos que o pedido
+    if (zone_count > 1) {
+        data->pwm_percent = zones_heater_duty(heater);
+    }
 }
 
 // Verifica se o heater está ativo baseado no PWM atual
@@ -105,14 +810,14 @@ bool hardware_control_heater_is_active(float pwm_percent) {
 }
 
 // Controle do LED de status com diferentes padrões
-void hardware_control_led_status(bool sensor_safe, float pwm_percent) {
+uint32_t hardware_control_led_status(bool sensor_safe, float pwm_percent) {
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
     
     // Verificar se heater está ativo
     bool heater_active = hardware_control_heater_is_active(pwm_percent);
     
     // Determinar intervalo baseado no estado
-    int led_interval;
+    uint32_t led_interval;
     if (!sensor_safe) {
         // DHT22 falhou - pisca muito rápido (ALERTA)
         led_interval = 100;
@@ -124,11 +829,15 @@ void hardware_control_led_status(bool sensor_safe, float pwm_percent) {
         led_interval = 1000;
     }
     
-    if (current_time - last_led_update >= led_interval) {
+    uint32_t elapsed = current_time - last_led_update;
+    if (elapsed >= led_interval) {
         last_led_update = current_time;
         led_state = !led_state;
         hardware_control_set_led(led_state);
+        elapsed = 0;
     }
+    
+    return led_interval - elapsed;
 }
 
 // Inicialização do LED onboard
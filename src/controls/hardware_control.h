@@ -2,19 +2,169 @@
 #define HARDWARE_CONTROL_H
 
 #include "display_interface.h"
+#include "heater_zones.h"
 #include <stdint.h>
 #include <stdbool.h>
 
 // Pinos de controle de hardware
 #define HEATER_PIN 27           // GPIO para controle do hotend
 
+/**
+ * Acionamento do heater
+ *
+ * - PWM: nível escrito pela CPU a cada mudança de duty (5 kHz, TOP derivado
+ *   do clk_sys, nível truncado para a contagem inteira)
+ * - SIGMA_DELTA: o nível de cada período vem de um padrão de
+ *   HEATER_PATTERN_LENGTH períodos em RAM, trocado pelo DMA no wrap do PWM.
+ *   O resto fracionário do duty é distribuído entre os períodos (sigma-delta
+ *   de primeira ordem): média exata em ~1/780000 em vez de 1 contagem.
+ * - BURST: o mesmo padrão com os períodos cheios no início e o resto
+ *   desligado (burst-fire de ~100 ms): 2 bordas por janela em vez de 2 por
+ *   período, perda de chaveamento do MOSFET centenas de vezes menor. Só
+ *   para carga resistiva com inércia térmica (o heater).
+ *
+ * Nos modos com DMA o TOP é fixo (dimensionado para o menor clk_sys) e uma
+ * troca de clock só muda o divisor; a CPU só reescreve o padrão quando o duty
+ * muda, no buffer que não está tocando.
+ *
+ * Com o heater dividido em zonas (hardware_control_heater_zones_init) só há
+ * PWM, um slice por zona, todos com o mesmo TOP fixo: a fase de cada zona é o
+ * deslocamento do contador do seu slice, que uma troca de clock não altera.
+ *
+ * Várias câmaras (hardware_control_heaters_init): um heater independente por
+ * câmara, cada um numa saída como as zonas (mesma fonte, fases e orçamento de
+ * pico), mas com duty e bloqueio próprios. As funções por heater recebem o
+ * índice (0 = HEATER_PIN, o único sem câmaras).
+ */
+typedef enum {
+    HEATER_DRIVE_PWM = 0,
+    HEATER_DRIVE_SIGMA_DELTA,
+    HEATER_DRIVE_BURST
+} heater_drive_t;
+
+#define HEATER_PATTERN_LENGTH 500       // Períodos por padrão (100 ms a 5 kHz)
+#define HEATER_OUTPUTS_MAX HEATER_ZONES_MAX  // Heaters independentes (câmaras)
+#define VENT_OUTPUTS_MAX HEATER_OUTPUTS_MAX  // Ventoinhas de exaustão (uma por câmara)
+#define TACH_INPUTS_MAX HEATER_OUTPUTS_MAX   // Tacômetros de ventoinha (um por câmara)
+
+/**
+ * Posição do acionamento no início de uma medida (ex: janela do ACS712)
+ */
+typedef struct {
+    uint8_t buffer;
+    int16_t index;
+} heater_window_t;
+
 // Funções públicas do módulo
 void hardware_control_init(void);
 void hardware_control_heater(bool enable);  // Deprecated - usar hardware_control_heater_pwm
-void hardware_control_heater_pwm(float duty_cycle_percent);
-void hardware_control_update_pwm(dryer_data_t *data, bool sensor_safe, float pid_output);
+void hardware_control_heater_pwm(uint8_t heater, float duty_cycle_percent);
+void hardware_control_update_pwm(uint8_t heater, dryer_data_t *data, bool sensor_safe, float pid_output);
 bool hardware_control_heater_is_active(float pwm_percent);
-void hardware_control_led_status(bool sensor_safe, float pwm_percent);
+
+/**
+ * Divide o heater em zonas na mesma fonte, uma saída PWM por zona em slices
+ * diferentes (pins[0] normalmente é o HEATER_PIN). O duty pedido vale para
+ * todas; heater_zones escolhe nível e fase de cada uma dentro do orçamento de
+ * pico. Chamar depois de hardware_control_init(), com acionamento PWM.
+ * @param current_a Corrente de cada zona a 100% (A)
+ * @param budget_a Pico de corrente permitido na fonte (A)
+ * @param stagger Defasar as janelas (false: todas na borda do período)
+ */
+void hardware_control_heater_zones_init(const uint8_t *pins, const float *current_a, uint8_t count,
+                                        float budget_a, bool stagger);
+
+/**
+ * Um heater independente por pino (uma câmara cada), em slices diferentes
+ * (pins[0] normalmente é o HEATER_PIN). Cada heater tem o seu duty e o seu
+ * bloqueio; heater_zones defasa as janelas e mantém o pico da fonte comum
+ * no orçamento. Chamar depois de hardware_control_init(), com acionamento PWM.
+ * @param current_a Corrente de cada heater a 100% (A)
+ * @param budget_a Pico de corrente permitido na fonte (A)
+ * @param stagger Defasar as janelas (false: todas na borda do período)
+ */
+void hardware_control_heaters_init(const uint8_t *pins, const float *current_a, uint8_t count,
+                                   float budget_a, bool stagger);
+
+/**
+ * Cópia do último plano das zonas (pico estimado, cortes pelo orçamento) e
+ * quantas vezes os contadores foram reposicionados para mudar as fases
+ * (zonas ou um heater por câmara)
+ * @return false com uma saída só
+ */
+bool hardware_control_heater_zones_stats(heater_zones_t *zones, uint32_t *rephases);
+
+/**
+ * Troca o modo de acionamento do heater mantendo o duty pedido (com zonas
+ * ou câmaras, só PWM)
+ */
+void hardware_control_set_heater_drive(heater_drive_t drive);
+heater_drive_t hardware_control_get_heater_drive(void);
+const char *hardware_control_heater_drive_name(heater_drive_t drive);
+
+/**
+ * Duty aplicado de fato entre hardware_control_heater_window_begin() e agora
+ * (%). Nos modos com DMA o nível muda a cada período: uma medida curta vê só
+ * parte do padrão, não o duty pedido.
+ * @param duty_min Recebe o menor nível de um período da janela (%): mínimo
+ *        garantido mesmo com os períodos das bordas cobertos só em parte;
+ *        igual ao retorno quando o nível não mudou na janela
+ */
+void hardware_control_heater_window_begin(uint8_t heater, heater_window_t *window);
+float hardware_control_heater_window_duty(uint8_t heater, const heater_window_t *window, float *duty_min);
+
+/**
+ * Bloqueia o heater em 0% (supervisor de segurança). Seguro em interrupção:
+ * força a saída do pino em nível baixo (override do GPIO, vale também com o
+ * DMA trocando o nível) e, enquanto bloqueado, qualquer duty pedido é
+ * ignorado. Depois do desbloqueio o próximo duty pedido libera o pino.
+ */
+void hardware_control_heater_inhibit(uint8_t heater, bool inhibit);
+bool hardware_control_heater_inhibited(uint8_t heater);
+
+/**
+ * Ventoinhas de exaustão (índice = câmara): PWM de 25 kHz em slices sem
+ * heater (dois canais do mesmo slice servem, a frequência é a mesma).
+ * Chamar depois da inicialização dos heaters; acompanham as trocas de clock.
+ */
+void hardware_control_vent_init(const uint8_t *pins, uint8_t count);
+void hardware_control_vent_pwm(uint8_t vent, float duty_percent);
+
+/**
+ * Tacômetro de ventoinha: o slice do pino em modo de contagem, o contador
+ * avança a cada borda de descida no canal B sem passar pela CPU. Só GPIO
+ * ímpar (canal B) num slice sem heater nem exaustão; o divisor fica em 1
+ * (troca de clock não afeta a contagem).
+ * Chamar depois de hardware_control_vent_init().
+ * @return Índice do tacômetro ou -1 se o pino não serve
+ */
+int hardware_control_tach_init(uint8_t pin);
+
+/**
+ * Contador de bordas (16 bits, dá a volta) e o instante da leitura (us desde
+ * o boot), lidos juntos
+ */
+void hardware_control_tach_read(int tach, uint16_t *edges, uint64_t *time_us);
+
+/**
+ * Reprograma divisor, TOP e nível do PWM do heater para o clk_sys atual
+ * (chamar logo depois de cada troca de clock, de qualquer núcleo). O duty
+ * pedido é mantido, inclusive no período em que a troca acontece.
+ */
+void hardware_control_pwm_clock_changed(void);
+
+/**
+ * Escritas no registro do PWM (ou padrões reescritos, nos modos com DMA) e
+ * pedidos ignorados por repetir o nível atual
+ */
+void hardware_control_pwm_write_stats(uint32_t *writes, uint32_t *skipped);
+
+/**
+ * Pisca o LED de status conforme o estado (rápido: sensor falhou; moderado:
+ * aquecendo; lento: normal)
+ * @return ms até a próxima troca do LED (para agendar a próxima chamada)
+ */
+uint32_t hardware_control_led_status(bool sensor_safe, float pwm_percent);
 
 // Funções do LED onboard
 int hardware_control_led_init(void);
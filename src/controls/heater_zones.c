@@ -0,0 +1,130 @@
+#include "heater_zones.h"
+
+void heater_zones_init(heater_zones_t *zones, const float *current_a, uint8_t count,
+                       float budget_a, bool stagger) {
+    if (count > HEATER_ZONES_MAX) {
+        count = HEATER_ZONES_MAX;
+    }
+    zones->count = count;
+    zones->budget_a = budget_a;
+    zones->stagger = stagger;
+    for (uint8_t k = 0; k < HEATER_ZONES_MAX; k++) {
+        zones->current_a[k] = k < count ? current_a[k] : 0.0f;
+        zones->level[k] = 0;
+        zones->phase[k] = 0;
+    }
+    zones->counts = 1;
+    zones->peak_a = 0.0f;
+    zones->peak_aligned_a = 0.0f;
+    zones->scale = 1.0f;
+    zones->max_peak_a = 0.0f;
+    zones->max_peak_aligned_a = 0.0f;
+    zones->plans = 0;
+    zones->limited = 0;
+}
+
+// Níveis para os duties pedidos x fator e janelas enfileiradas: cada zona
+// começa onde a anterior terminou (módulo o período)
+static void layout(const heater_zones_t *zones, const float *requested, float scale, uint32_t counts,
+                   uint16_t *level, uint16_t *phase) {
+    uint32_t start = 0;
+    for (uint8_t k = 0; k < zones->count; k++) {
+        float duty = requested[k] * scale;
+        uint32_t l = duty <= 0.0f ? 0u : (uint32_t)(duty / 100.0f * (float)counts);
+        if (l > counts) {
+            l = counts;
+        }
+        level[k] = (uint16_t)l;
+        phase[k] = zones->stagger ? (uint16_t)start : 0u;
+        start = (start + l) % counts;
+    }
+}
+
+// Janela [phase, phase + level) do período cobre a contagem t?
+static bool window_covers(uint32_t phase, uint32_t level, uint32_t t, uint32_t counts) {
+    if (level == 0) {
+        return false;
+    }
+    if (level >= counts) {
+        return true;
+    }
+    return (t + counts - phase) % counts < level;
+}
+
+// Pico: a corrente só sobe no início de alguma janela, basta olhar ali
+static float peak_current(const heater_zones_t *zones, const uint16_t *level, const uint16_t *phase,
+                          uint32_t counts) {
+    float peak = 0.0f;
+    for (uint8_t i = 0; i < zones->count; i++) {
+        if (level[i] == 0) {
+            continue;
+        }
+        float sum = 0.0f;
+        for (uint8_t k = 0; k < zones->count; k++) {
+            if (window_covers(phase[k], level[k], phase[i], counts)) {
+                sum += zones->current_a[k];
+            }
+        }
+        if (sum > peak) {
+            peak = sum;
+        }
+    }
+    return peak;
+}
+
+void heater_zones_plan(heater_zones_t *zones, const float *requested, uint32_t counts) {
+    uint16_t level[HEATER_ZONES_MAX];
+    uint16_t phase[HEATER_ZONES_MAX];
+    float scale = 1.0f;
+
+    layout(zones, requested, 1.0f, counts, level, phase);
+    float peak = peak_current(zones, level, phase, counts);
+    if (peak > zones->budget_a) {
+        // Maior fator que cabe no orçamento (o pico não diminui com o fator)
+        float lo = 0.0f;
+        float hi = 1.0f;
+        for (int i = 0; i < HEATER_ZONES_SEARCH_STEPS; i++) {
+            float mid = 0.5f * (lo + hi);
+            layout(zones, requested, mid, counts, level, phase);
+            if (peak_current(zones, level, phase, counts) <= zones->budget_a) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        scale = lo;
+        layout(zones, requested, scale, counts, level, phase);
+        peak = peak_current(zones, level, phase, counts);
+        zones->limited++;
+    }
+
+    float aligned = 0.0f;
+    for (uint8_t k = 0; k < zones->count; k++) {
+        zones->level[k] = level[k];
+        zones->phase[k] = phase[k];
+        if (level[k] > 0) {
+            aligned += zones->current_a[k];
+        }
+    }
+    zones->counts = counts;
+    zones->scale = scale;
+    zones->peak_a = peak;
+    zones->peak_aligned_a = aligned;
+    if (peak > zones->max_peak_a) {
+        zones->max_peak_a = peak;
+    }
+    if (aligned > zones->max_peak_aligned_a) {
+        zones->max_peak_aligned_a = aligned;
+    }
+    zones->plans++;
+}
+
+float heater_zones_total_duty(const heater_zones_t *zones) {
+    float weighted = 0.0f;
+    float total = 0.0f;
+    for (uint8_t k = 0; k < zones->count; k++) {
+        weighted += (float)zones->level[k] * zones->current_a[k];
+        total += zones->current_a[k];
+    }
+    return total > 0.0f ? 100.0f * weighted / (total * (float)zones->counts) : 0.0f;
+}
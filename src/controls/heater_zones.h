@@ -0,0 +1,72 @@
+#ifndef HEATER_ZONES_H
+#define HEATER_ZONES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Vários heaters na mesma fonte: fase das janelas PWM e orçamento de pico
+ *
+ * Com um slice PWM por heater e todos partindo da mesma borda, a fonte vê a
+ * soma das correntes no início de cada período. Aqui cada zona ganha um
+ * deslocamento de fase: as janelas ligadas são enfileiradas no período (a
+ * zona k começa onde a k-1 termina, voltando ao início quando passa do fim),
+ * então só se sobrepõem quando a soma dos duties passa de 100%.
+ *
+ * Tudo em contagens do PWM (nível e início da janela, como nos slices): o
+ * pico é exato para as janelas escolhidas (varredura pelos inícios das
+ * janelas), sem sobreposição por arredondamento. Se passa do orçamento, os
+ * duties pedidos são reduzidos na mesma proporção (busca binária no fator)
+ * até caber: todas as zonas perdem a mesma fração da potência pedida.
+ *
+ * Só cálculo: quem aplica nível e fase nos slices é o hardware_control.
+ */
+
+#define HEATER_ZONES_MAX 4
+#define HEATER_ZONES_SEARCH_STEPS 12    // Busca do fator de redução (resolução 1/4096)
+
+typedef struct {
+    // Configuração
+    uint8_t count;
+    float current_a[HEATER_ZONES_MAX];  // Corrente de cada zona a 100% (A)
+    float budget_a;                     // Pico de corrente permitido na fonte (A)
+    bool stagger;                       // false = todas na mesma borda (comparação)
+
+    // Último plano
+    uint32_t counts;                    // Contagens por período (TOP + 1)
+    uint16_t level[HEATER_ZONES_MAX];   // Nível aplicado por zona (counts = sempre ligada)
+    uint16_t phase[HEATER_ZONES_MAX];   // Início da janela ligada (contagens)
+    float peak_a;                       // Pico com as fases escolhidas (A)
+    float peak_aligned_a;               // Pico se todas ligassem na mesma borda (A)
+    float scale;                        // Fração do duty pedido aplicada (1 = sem corte)
+
+    // Estatísticas
+    float max_peak_a;
+    float max_peak_aligned_a;
+    uint32_t plans;
+    uint32_t limited;                   // Planos em que o orçamento reduziu o duty
+} heater_zones_t;
+
+/**
+ * @param current_a Corrente de cada zona a 100% (A)
+ * @param count Número de zonas (até HEATER_ZONES_MAX)
+ * @param budget_a Pico permitido na fonte (A)
+ * @param stagger Defasar as janelas (false: todas na borda do período)
+ */
+void heater_zones_init(heater_zones_t *zones, const float *current_a, uint8_t count,
+                       float budget_a, bool stagger);
+
+/**
+ * Nível e fase de cada zona para os duties pedidos, dentro do orçamento
+ * @param requested Duty pedido por zona (%)
+ * @param counts Contagens por período do PWM (TOP + 1)
+ */
+void heater_zones_plan(heater_zones_t *zones, const float *requested, uint32_t counts);
+
+/**
+ * Duty médio do último plano ponderado pela corrente de cada zona (%): o que
+ * o ACS712 na linha da fonte vê em relação à corrente total
+ */
+float heater_zones_total_duty(const heater_zones_t *zones);
+
+#endif // HEATER_ZONES_H
@@ -0,0 +1,292 @@
+#include "mpc_controller.h"
+#include "logger.h"
+#include "pico/time.h"
+#include <math.h>
+
+#define TAG "MPC"
+
+// Forma discreta do modelo no período de controle
+static void model_discretize(mpc_controller_t *mpc) {
+    float ts = (float)mpc->sample_time / 1000.0f;
+    mpc->a = expf(-ts / mpc->model.tau_s);
+    mpc->b = mpc->model.gain * (1.0f - mpc->a);
+
+    int steps = (int)(mpc->model.dead_s / ts + 0.5f);
+    if (steps > MPC_MAX_DEAD_STEPS) steps = MPC_MAX_DEAD_STEPS;
+    mpc->dead_steps = (uint8_t)steps;
+}
+
+static void identification_clear(mpc_controller_t *mpc, float y, uint32_t now_ms) {
+    mpc->id_start = now_ms;
+    mpc->id_y_start = y;
+    mpc->id_u_sum = 0.0f;
+    mpc->id_u_count = 0;
+    mpc->id_count = 0;
+}
+
+// Fecha uma amostra de identificação e atualiza os candidatos de tempo morto
+static void identification_update(mpc_controller_t *mpc, float y, uint32_t now_ms) {
+    mpc->id_u_sum += mpc->last_output;
+    mpc->id_u_count++;
+    if (now_ms - mpc->id_start < MPC_ID_PERIOD_MS) {
+        return;
+    }
+
+    // Saída média da amostra que terminou: id_u[d] = u(k - d)
+    for (int d = MPC_ID_DELAYS - 1; d > 0; d--) {
+        mpc->id_u[d] = mpc->id_u[d - 1];
+    }
+    mpc->id_u[0] = mpc->id_u_sum / (float)mpc->id_u_count;
+    if (mpc->id_count < MPC_ID_DELAYS) {
+        mpc->id_count++;
+    }
+
+    // y(k+1) - y(k) = alpha * (K * u(k - d) - y(k)), alpha = 1 - exp(-Tid / tau)
+    float y_prev = mpc->id_y_start;
+    float dy = y - y_prev;
+    float ts_id = (float)(now_ms - mpc->id_start) / 1000.0f;
+    float alpha_prior = 1.0f - expf(-ts_id / mpc->model.tau_s);
+
+    int best = -1;
+    for (int d = 0; d < mpc->id_count; d++) {
+        float phi = mpc->model.gain * mpc->id_u[d] - y_prev;
+        float alpha = mpc->id_s_pp[d] > 0.0f ? mpc->id_s_py[d] / mpc->id_s_pp[d] : alpha_prior;
+        float e = dy - alpha * phi;
+
+        mpc->id_err[d] = MPC_ID_FORGETTING * mpc->id_err[d] + e * e;
+        mpc->id_s_pp[d] = MPC_ID_FORGETTING * mpc->id_s_pp[d] + phi * phi;
+        mpc->id_s_py[d] = MPC_ID_FORGETTING * mpc->id_s_py[d] + phi * dy;
+
+        if (mpc->id_s_pp[d] >= MPC_ID_MIN_EXCITATION &&
+            (best < 0 || mpc->id_err[d] < mpc->id_err[best])) {
+            best = d;
+        }
+    }
+
+    mpc->id_start = now_ms;
+    mpc->id_y_start = y;
+    mpc->id_u_sum = 0.0f;
+    mpc->id_u_count = 0;
+
+    if (best < 0) {
+        return; // Pouca excitação ainda: manter o modelo atual
+    }
+
+    float alpha = mpc->id_s_py[best] / mpc->id_s_pp[best];
+    if (alpha <= 0.0f || alpha >= 1.0f) {
+        return;
+    }
+    float tau = -ts_id / logf(1.0f - alpha);
+    if (tau < MPC_TAU_MIN_S || tau > MPC_TAU_MAX_S) {
+        return;
+    }
+
+    float dead = (float)best * ts_id;
+    bool dead_changed = fabsf(dead - mpc->model.dead_s) > 1.0f;
+    mpc->model.tau_s = tau;
+    mpc->model.dead_s = dead;
+    model_discretize(mpc);
+    mpc->id_updates++;
+
+    if (dead_changed || mpc->id_updates == 1) {
+        LOGI(TAG, "Model identified: K=%.2f°C/%%, tau=%.0fs, dead time=%.0fs",
+             mpc->model.gain, mpc->model.tau_s, mpc->model.dead_s);
+    }
+}
+
+void mpc_init(mpc_controller_t *mpc, float output_min, float output_max, uint32_t sample_time_ms,
+              float horizon_s, float move_s, float ref_time_s) {
+    mpc->output_min = output_min;
+    mpc->output_max = output_max;
+    mpc->sample_time = sample_time_ms;
+
+    float ts = (float)sample_time_ms / 1000.0f;
+    int steps = (int)(horizon_s / ts + 0.5f);
+    if (steps < 1) steps = 1;
+    if (steps > 255) steps = 255;
+    mpc->horizon = (uint16_t)steps;
+    steps = (int)(move_s / ts + 0.5f);
+    if (steps < 1) steps = 1;
+    mpc->move_steps = (uint16_t)steps;
+    mpc->ref_decay = ref_time_s > 0.0f ? expf(-ts / ref_time_s) : 0.0f;
+
+    mpc->move_weight = 0.0f;
+    mpc->overshoot_max = 1.0f;
+    mpc->setpoint = 0.0f;
+
+    for (int d = 0; d < MPC_ID_DELAYS; d++) {
+        mpc->id_u[d] = 0.0f;
+        mpc->id_s_pp[d] = 0.0f;
+        mpc->id_s_py[d] = 0.0f;
+        mpc->id_err[d] = 0.0f;
+    }
+    mpc->id_updates = 0;
+
+    // Modelo neutro até mpc_set_model()
+    mpc_set_model(mpc, 1.0f, 1800.0f, 0.0f);
+    mpc_reset(mpc);
+}
+
+void mpc_set_model(mpc_controller_t *mpc, float gain, float tau_s, float dead_s) {
+    mpc->model.gain = gain;
+    mpc->model.tau_s = tau_s;
+    mpc->model.dead_s = dead_s;
+    model_discretize(mpc);
+}
+
+void mpc_set_gain(mpc_controller_t *mpc, float gain) {
+    if (gain <= 0.0f) {
+        return;
+    }
+    mpc->model.gain = gain;
+    mpc->b = gain * (1.0f - mpc->a);
+}
+
+void mpc_set_weights(mpc_controller_t *mpc, float move_weight, float overshoot_max) {
+    mpc->move_weight = move_weight > 0.0f ? move_weight : 0.0f;
+    mpc->overshoot_max = overshoot_max;
+}
+
+void mpc_set_setpoint(mpc_controller_t *mpc, float setpoint) {
+    mpc->setpoint = setpoint;
+}
+
+// Iteração da predição: y(j) = livre(j) + g(j) * u + h(j) * u_hold, onde u vale
+// pelos primeiros move_steps passos e u_hold (manutenção do setpoint) depois
+typedef struct {
+    uint16_t j;
+    float x_free;                       // Resposta livre do modelo (entradas já aplicadas)
+    float a_pow;                        // a^(j - d)
+    float a_pow_hold;                   // a^(j - d - move_steps)
+} prediction_t;
+
+static void prediction_start(const mpc_controller_t *mpc, prediction_t *p) {
+    p->j = 0;
+    p->x_free = mpc->x;
+    p->a_pow = 1.0f;
+    p->a_pow_hold = 1.0f;
+}
+
+static void prediction_step(const mpc_controller_t *mpc, prediction_t *p,
+                            float *free_j, float *g, float *h) {
+    uint8_t d = mpc->dead_steps;
+    p->j++;
+
+    float u_past = (p->j <= d) ? mpc->u_hist[d - p->j] : 0.0f;
+    p->x_free = mpc->a * p->x_free + mpc->b * u_past;
+    *free_j = p->x_free + mpc->disturbance;
+    *g = 0.0f;
+    *h = 0.0f;
+
+    // Dentro do tempo morto a saída de agora ainda não tem efeito
+    if (p->j <= d) {
+        return;
+    }
+    float gain = mpc->model.gain;
+    p->a_pow *= mpc->a;
+    if (p->j - d <= mpc->move_steps) {
+        *g = gain * (1.0f - p->a_pow);
+    } else {
+        p->a_pow_hold *= mpc->a;
+        *g = gain * (p->a_pow_hold - p->a_pow);
+        *h = gain * (1.0f - p->a_pow_hold);
+    }
+}
+
+float mpc_compute(mpc_controller_t *mpc, float temperature, float ambient) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if (!mpc->first_sample && now - mpc->last_time < mpc->sample_time) {
+        return mpc->last_output;
+    }
+    mpc->last_time = now;
+
+    float y0 = temperature - ambient;
+    float y_sp = mpc->setpoint - ambient;
+    float y_max = mpc->setpoint + mpc->overshoot_max - ambient;
+
+    if (mpc->first_sample) {
+        // Modelo interno parte da medida, sem entradas anteriores
+        mpc->x = y0;
+        for (int i = 0; i <= MPC_MAX_DEAD_STEPS; i++) {
+            mpc->u_hist[i] = 0.0f;
+        }
+        mpc->last_output = 0.0f;
+        identification_clear(mpc, y0, now);
+        mpc->first_sample = false;
+    } else {
+        identification_update(mpc, y0, now);
+        mpc->x = mpc->a * mpc->x + mpc->b * mpc->u_hist[mpc->dead_steps];
+    }
+    mpc->disturbance = y0 - mpc->x;
+
+    // Saída de manutenção do setpoint pelo modelo (depois do bloco de movimento)
+    float u_hold = (y_sp - mpc->disturbance) / mpc->model.gain;
+    if (u_hold > mpc->output_max) u_hold = mpc->output_max;
+    if (u_hold < mpc->output_min) u_hold = mpc->output_min;
+
+    // Mínimos quadrados do erro para a trajetória de referência + restrição de overshoot
+    prediction_t p;
+    prediction_start(mpc, &p);
+    float ref_pow = 1.0f;
+    float sum_gg = 0.0f;
+    float sum_ge = 0.0f;
+    float u_upper = mpc->output_max;
+
+    for (uint16_t j = 1; j <= mpc->horizon; j++) {
+        float free_j, g, h;
+        prediction_step(mpc, &p, &free_j, &g, &h);
+        free_j += h * u_hold;
+        ref_pow *= mpc->ref_decay;
+        if (g <= 0.0f) {
+            continue;
+        }
+
+        float ref = y_sp - (y_sp - y0) * ref_pow;
+        sum_gg += g * g;
+        sum_ge += g * (ref - free_j);
+
+        // Restrição de overshoot: livre(j) + g(j) * u <= y_max
+        float bound = (y_max - free_j) / g;
+        if (bound < u_upper) {
+            u_upper = bound;
+        }
+    }
+
+    // Ótimo sem restrição (com penalidade na variação), depois as restrições:
+    // com um grau de liberdade o problema é convexo em u e basta limitar
+    float u = mpc->last_output;
+    if (sum_gg > 0.0f) {
+        float w = mpc->move_weight * sum_gg;
+        u = (sum_ge + w * mpc->last_output) / (sum_gg + w);
+    }
+    if (u > u_upper) u = u_upper;
+    if (u > mpc->output_max) u = mpc->output_max;
+    if (u < mpc->output_min) u = mpc->output_min;
+
+    // Pico previsto com a saída escolhida (diagnóstico)
+    prediction_start(mpc, &p);
+    mpc->predicted_peak = temperature;
+    for (uint16_t j = 1; j <= mpc->horizon; j++) {
+        float free_j, g, h;
+        prediction_step(mpc, &p, &free_j, &g, &h);
+        float y_j = free_j + g * u + h * u_hold + ambient;
+        if (y_j > mpc->predicted_peak) {
+            mpc->predicted_peak = y_j;
+        }
+    }
+
+    for (int i = MPC_MAX_DEAD_STEPS; i > 0; i--) {
+        mpc->u_hist[i] = mpc->u_hist[i - 1];
+    }
+    mpc->u_hist[0] = u;
+    mpc->last_output = u;
+    return u;
+}
+
+void mpc_reset(mpc_controller_t *mpc) {
+    mpc->first_sample = true;
+    mpc->disturbance = 0.0f;
+    mpc->predicted_peak = 0.0f;
+    mpc->last_output = 0.0f;
+    mpc->last_time = to_ms_since_boot(get_absolute_time());
+}
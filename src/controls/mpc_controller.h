@@ -0,0 +1,142 @@
+#ifndef MPC_CONTROLLER_H
+#define MPC_CONTROLLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Controle preditivo (MPC) com identificação online do modelo
+ *
+ * Alternativa ao PID. A câmara é modelada como primeira ordem com tempo
+ * morto (FOPDT), em graus acima do ambiente:
+ *
+ *   tau * dy/dt = -y + K * u(t - theta)
+ *
+ * - K (°C por %): ganho de regime, vem da potência de manutenção aprendida
+ *   pelo feed-forward (K = (setpoint - ambiente) / potência de manutenção)
+ * - tau e theta: identificados online pela operação registrada. A cada
+ *   MPC_ID_PERIOD_MS a variação da temperatura é regredida (mínimos
+ *   quadrados recursivos com esquecimento) contra K * u(k - d) - y(k) para
+ *   cada candidato de tempo morto d; vence o de menor erro de predição.
+ *   O pré-aquecimento em 100% após o boot é o degrau que mais informa.
+ *
+ * A cada ciclo o MPC prevê a temperatura nos próximos horizon passos:
+ * resposta livre das entradas já aplicadas, mais a saída u mantida por
+ * move_steps passos e depois a potência de manutenção do setpoint, mais o
+ * desvio atual entre medida e modelo (sem erro de regime). Escolhe u
+ * minimizando o erro para uma trajetória de referência exponencial até o
+ * setpoint. Com um único grau de liberdade o problema com restrições tem
+ * solução exata: o ótimo sem restrição limitado a 0-100% e ao maior u cuja
+ * previsão não passa de setpoint + overshoot_max em nenhum passo.
+ *
+ * Custo por ciclo: dois laços de horizon passos com ~10 operações de float
+ * cada, sem exp()/log() fora da troca de modelo (~2 ms no M0+ com o
+ * horizonte de 180 passos, folgado mesmo a 1 Hz).
+ */
+
+// Identificação do modelo
+#define MPC_MAX_DEAD_STEPS 40           // Tempo morto máximo em passos de controle
+#define MPC_ID_PERIOD_MS 15000          // Período de amostragem da identificação
+#define MPC_ID_DELAYS 9                 // Candidatos de tempo morto: 0, 15 ... 120 s
+#define MPC_ID_FORGETTING 0.999f        // Esquecimento por amostra (~4 h de memória)
+#define MPC_ID_MIN_EXCITATION 500.0f    // Soma mínima do regressor² (°C²) para confiar na estimativa
+#define MPC_TAU_MIN_S 120.0f            // Faixa aceita para a constante de tempo
+#define MPC_TAU_MAX_S 20000.0f
+
+/**
+ * Modelo de primeira ordem com tempo morto
+ */
+typedef struct {
+    float gain;                         // Ganho de regime (°C por %)
+    float tau_s;                        // Constante de tempo (s)
+    float dead_s;                       // Tempo morto (s)
+} fopdt_model_t;
+
+typedef struct {
+    // Configuração
+    float output_min;
+    float output_max;
+    uint32_t sample_time;               // Período de controle (ms)
+    uint16_t horizon;                   // Horizonte de predição (passos)
+    uint16_t move_steps;                // Passos em que a saída escolhida vale na predição
+    float ref_decay;                    // Decaimento da trajetória de referência por passo
+    float move_weight;                  // Peso da variação da saída (relativo, 0 = nenhum)
+    float overshoot_max;                // Restrição: previsão <= setpoint + overshoot_max (°C)
+    float setpoint;
+
+    // Modelo atual e sua forma discreta no período de controle
+    fopdt_model_t model;
+    float a;                            // exp(-Ts / tau)
+    float b;                            // K * (1 - a)
+    uint8_t dead_steps;
+
+    // Estado do modelo interno
+    float x;                            // Saída do modelo (°C acima do ambiente)
+    float u_hist[MPC_MAX_DEAD_STEPS + 1]; // Saídas aplicadas: u_hist[i] = u(k - 1 - i)
+    float disturbance;                  // Medida - modelo (°C)
+    float last_output;
+    float predicted_peak;               // Maior temperatura prevista com a saída escolhida (°C)
+    bool first_sample;
+    uint32_t last_time;
+
+    // Identificação (amostras de MPC_ID_PERIOD_MS)
+    uint32_t id_start;                  // Início da amostra atual (ms)
+    float id_y_start;                   // Temperatura no início da amostra (°C acima do ambiente)
+    float id_u_sum;                     // Soma das saídas na amostra
+    uint16_t id_u_count;
+    float id_u[MPC_ID_DELAYS];          // Saída média das últimas amostras (id_u[0] = mais recente)
+    uint8_t id_count;                   // Amostras válidas em id_u
+    float id_s_pp[MPC_ID_DELAYS];       // Soma de regressor² por candidato
+    float id_s_py[MPC_ID_DELAYS];       // Soma de regressor * variação
+    float id_err[MPC_ID_DELAYS];        // Erro de predição acumulado
+    uint32_t id_updates;                // Modelos aceitos
+} mpc_controller_t;
+
+/**
+ * Inicializa o MPC com o modelo padrão
+ *
+ * @param output_min Saída mínima (ex: 0%)
+ * @param output_max Saída máxima (ex: 100%)
+ * @param sample_time_ms Período de controle (ms), intervalo entre as chamadas de mpc_compute()
+ * @param horizon_s Horizonte de predição (s), limitado a 255 passos
+ * @param move_s Duração da saída escolhida na predição (s); depois vale a manutenção
+ * @param ref_time_s Constante de tempo da trajetória de referência (s); 0 = degrau
+ */
+void mpc_init(mpc_controller_t *mpc, float output_min, float output_max, uint32_t sample_time_ms,
+              float horizon_s, float move_s, float ref_time_s);
+
+/**
+ * Define o modelo (valores iniciais antes da identificação)
+ */
+void mpc_set_model(mpc_controller_t *mpc, float gain, float tau_s, float dead_s);
+
+/**
+ * Atualiza o ganho de regime do modelo (°C por %), ex: a partir do feed-forward
+ */
+void mpc_set_gain(mpc_controller_t *mpc, float gain);
+
+/**
+ * Define o peso da variação da saída e a restrição de overshoot
+ * @param move_weight 0 = sem penalidade; 1 = variação pesa tanto quanto o erro
+ * @param overshoot_max Máximo permitido acima do setpoint na predição (°C)
+ */
+void mpc_set_weights(mpc_controller_t *mpc, float move_weight, float overshoot_max);
+
+void mpc_set_setpoint(mpc_controller_t *mpc, float setpoint);
+
+/**
+ * Calcula a saída (chamar a cada sample_time)
+ * @param temperature Temperatura da câmara (°C)
+ * @param ambient Temperatura ambiente (°C)
+ * @return Saída (% de PWM)
+ */
+float mpc_compute(mpc_controller_t *mpc, float temperature, float ambient);
+
+/**
+ * Reinicia o modelo interno na próxima chamada (heater ficou desligado fora
+ * do controle do MPC: sensor inseguro, overshoot crítico). O modelo
+ * identificado é mantido.
+ */
+void mpc_reset(mpc_controller_t *mpc);
+
+#endif // MPC_CONTROLLER_H
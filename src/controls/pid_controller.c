@@ -25,24 +25,206 @@ void pid_init(pid_controller_t *pid, float kp, float ki, float kd,
     pid->last_pv = 0.0f;
     pid->integral = 0.0f;
     pid->last_output = 0.0f;
+    pid->feedforward = 0.0f;
+    pid->last_setpoint = 0.0f;
+    pid->d_state = 0.0f;
+    pid->first_sample = true;
     pid->enabled = true;
     
+    // Padrão: PID clássico (erro completo no P, derivativo sobre PV sem filtro)
+    pid->b = 1.0f;
+    pid->c = 0.0f;
+    pid->n = 0.0f;
+    pid->form = PID_FORM_POSITIONAL;
+    
     // Resetar termos de debug
     pid->debug_p_term = 0.0f;
     pid->debug_i_term = 0.0f;
     pid->debug_d_term = 0.0f;
+    pid->debug_ff_term = 0.0f;
+    
+    // Sem tabela de ganhos: ganhos fixos
+    pid->schedule_len = 0;
 }
 
 void pid_set_setpoint(pid_controller_t *pid, float setpoint) {
     pid->setpoint = setpoint;
+    
+    // Gain scheduling: ganhos acompanham o setpoint
+    float kp, ki, kd;
+    if (pid_gain_schedule_lookup(pid, setpoint, &kp, &ki, &kd)) {
+        pid_set_tunings(pid, kp, ki, kd);
+    }
 }
 
 void pid_set_tunings(pid_controller_t *pid, float kp, float ki, float kd) {
+    // Bumpless: a última saída (FF + P + I + D) não muda com os ganhos novos.
+    // P é recalculado no último setpoint e PV, o estado do D é reescalado e
+    // a diferença dos dois vai para o integral
+    float i_term = pid->ki * pid->integral;
+    if (!pid->first_sample) {
+        float p_new = kp * (pid->b * pid->last_setpoint - pid->last_pv);
+        float d_new = pid->kd > 0.0f ? pid->d_state * kd / pid->kd : 0.0f;
+        i_term += (pid->debug_p_term - p_new) + (pid->d_state - d_new);
+        
+        // Forma de velocidade: próximos incrementos a partir dos termos novos
+        pid->debug_p_term = p_new;
+        pid->debug_d_term = d_new;
+        pid->d_state = d_new;
+    }
+    
+    if (ki > 0.0f) {
+        pid->integral = i_term / ki;
+        if (pid->form == PID_FORM_POSITIONAL) {
+            if (pid->integral > pid->integral_max) {
+                pid->integral = pid->integral_max;
+            } else if (pid->integral < -pid->integral_max) {
+                pid->integral = -pid->integral_max;
+            }
+        }
+    } else {
+        pid->integral = 0.0f;
+    }
+    pid->debug_i_term = ki * pid->integral;
+    
     pid->kp = kp;
     pid->ki = ki;
     pid->kd = kd;
 }
 
+bool pid_set_gain_schedule(pid_controller_t *pid, const pid_gain_entry_t *table, uint8_t count) {
+    if (count > PID_GAIN_SCHEDULE_MAX) {
+        return false;
+    }
+    
+    pid->schedule_len = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        pid_gain_schedule_update(pid, table[i].setpoint, table[i].kp, table[i].ki, table[i].kd);
+    }
+    return true;
+}
+
+bool pid_gain_schedule_update(pid_controller_t *pid, float setpoint, float kp, float ki, float kd) {
+    // Procurar posição (tabela ordenada por setpoint)
+    uint8_t pos = 0;
+    while (pos < pid->schedule_len && pid->schedule[pos].setpoint < setpoint) {
+        pos++;
+    }
+    
+    bool replace = pos < pid->schedule_len && fabsf(pid->schedule[pos].setpoint - setpoint) < 0.01f;
+    if (!replace) {
+        if (pid->schedule_len >= PID_GAIN_SCHEDULE_MAX) {
+            return false;
+        }
+        // Abrir espaço para a nova entrada
+        for (uint8_t i = pid->schedule_len; i > pos; i--) {
+            pid->schedule[i] = pid->schedule[i - 1];
+        }
+        pid->schedule_len++;
+    }
+    
+    pid->schedule[pos].setpoint = setpoint;
+    pid->schedule[pos].kp = kp;
+    pid->schedule[pos].ki = ki;
+    pid->schedule[pos].kd = kd;
+    
+    // Reaplicar ganhos do setpoint atual com a tabela nova
+    float new_kp, new_ki, new_kd;
+    pid_gain_schedule_lookup(pid, pid->setpoint, &new_kp, &new_ki, &new_kd);
+    pid_set_tunings(pid, new_kp, new_ki, new_kd);
+    return true;
+}
+
+bool pid_gain_schedule_lookup(const pid_controller_t *pid, float setpoint,
+                              float *kp, float *ki, float *kd) {
+    if (pid->schedule_len == 0) {
+        return false;
+    }
+    
+    const pid_gain_entry_t *first = &pid->schedule[0];
+    const pid_gain_entry_t *last = &pid->schedule[pid->schedule_len - 1];
+    
+    // Fora da faixa: entrada mais próxima
+    if (setpoint <= first->setpoint) {
+        *kp = first->kp;
+        *ki = first->ki;
+        *kd = first->kd;
+        return true;
+    }
+    if (setpoint >= last->setpoint) {
+        *kp = last->kp;
+        *ki = last->ki;
+        *kd = last->kd;
+        return true;
+    }
+    
+    // Interpolação linear entre as duas entradas vizinhas
+    uint8_t i = 1;
+    while (pid->schedule[i].setpoint < setpoint) {
+        i++;
+    }
+    const pid_gain_entry_t *lo = &pid->schedule[i - 1];
+    const pid_gain_entry_t *hi = &pid->schedule[i];
+    float t = (setpoint - lo->setpoint) / (hi->setpoint - lo->setpoint);
+    
+    *kp = lo->kp + (hi->kp - lo->kp) * t;
+    *ki = lo->ki + (hi->ki - lo->ki) * t;
+    *kd = lo->kd + (hi->kd - lo->kd) * t;
+    return true;
+}
+
+void pid_set_setpoint_weights(pid_controller_t *pid, float b, float c) {
+    pid->b = b;
+    pid->c = c;
+}
+
+void pid_set_derivative_filter(pid_controller_t *pid, float n) {
+    pid->n = n > 0.0f ? n : 0.0f;
+}
+
+void pid_set_form(pid_controller_t *pid, pid_form_t form) {
+    // O integral equivalente é mantido nas duas formas: basta trocar. Só a
+    // posicional tem o limite do anti-windup
+    if (form == PID_FORM_POSITIONAL) {
+        if (pid->integral > pid->integral_max) {
+            pid->integral = pid->integral_max;
+        } else if (pid->integral < -pid->integral_max) {
+            pid->integral = -pid->integral_max;
+        }
+    }
+    pid->form = form;
+}
+
+void pid_set_feedforward(pid_controller_t *pid, float feedforward) {
+    pid->feedforward = feedforward;
+}
+
+void pid_preload(pid_controller_t *pid, float output, float current_value) {
+    // Sem derivativo na primeira amostra: última PV = PV atual
+    float p_term = pid->kp * (pid->b * pid->setpoint - current_value);
+    float residual = output - pid->feedforward - p_term;
+    
+    pid->integral = (pid->ki > 0.0f) ? residual / pid->ki : 0.0f;
+    if (pid->integral > pid->integral_max) {
+        pid->integral = pid->integral_max;
+    } else if (pid->integral < -pid->integral_max) {
+        pid->integral = -pid->integral_max;
+    }
+    
+    pid->last_pv = current_value;
+    pid->last_setpoint = pid->setpoint;
+    pid->last_output = output;
+    pid->last_time = to_ms_since_boot(get_absolute_time());
+    
+    // Referência para a forma de velocidade continuar desta saída
+    pid->d_state = 0.0f;
+    pid->first_sample = false;
+    pid->debug_p_term = p_term;
+    pid->debug_i_term = pid->ki * pid->integral;
+    pid->debug_d_term = 0.0f;
+    pid->debug_ff_term = pid->feedforward;
+}
+
 float pid_compute(pid_controller_t *pid, float current_value) {
     if (!pid->enabled) {
         return 0.0f;
@@ -69,61 +251,101 @@ float pid_compute(pid_controller_t *pid, float current_value) {
     }
     
     // === TERMO PROPORCIONAL ===
-    // Resposta imediata proporcional ao erro
-    float p_term = pid->kp * error;
+    // Resposta imediata proporcional ao erro (setpoint com peso b)
+    float p_term = pid->kp * (pid->b * pid->setpoint - current_value);
 
     // === TERMO DERIVATIVO ===
-    float derivative = (current_value - pid->last_pv) / dt;
-    float d_term = -pid->kd * derivative;
+    // Derivada de (c * setpoint - PV) com filtro de primeira ordem (Tf = Kd / (Kp * N)),
+    // discretizado por Euler para trás: Tf * dD/dt + D = Kd * de/dt
+    float d_term = 0.0f;
+    if (!pid->first_sample) {
+        float d_error = (pid->c * pid->setpoint - current_value) -
+                        (pid->c * pid->last_setpoint - pid->last_pv);
+        float tf = (pid->n > 0.0f && pid->kp > 0.0f) ? pid->kd / (pid->kp * pid->n) : 0.0f;
+        d_term = (tf * pid->d_state + pid->kd * d_error) / (tf + dt);
+    }
     
-    // === TERMO INTEGRAL ===
-    // Acumula o erro ao longo do tempo (elimina erro residual)
-    float i_term = pid->ki * pid->integral;
+    // === FEED-FORWARD ===
+    // Potência prevista para o setpoint (o integral corrige só o resíduo)
+    float ff_term = pid->feedforward;
     
-    // Cálculo preliminar da saída antes de atualizar o integral
-    float tentative_output = p_term + i_term + d_term;
+    float i_term;
+    float output;
     
-    if (!((tentative_output >= pid->output_max && error > 0) ||
-          (tentative_output < pid->output_min && error < 0))) {
-        // Atualiza o termo integral somente se não estiver saturado
-        pid->integral += error * dt;
+    if (pid->form == PID_FORM_VELOCITY && !pid->first_sample) {
+        // === FORMA DE VELOCIDADE ===
+        // Incremento sobre a última saída, que já está limitada: na saturação
+        // o integral não acumula (anti-windup embutido)
+        float delta = (ff_term - pid->debug_ff_term) + (p_term - pid->debug_p_term) +
+                      pid->ki * error * dt + (d_term - pid->debug_d_term);
+        output = pid->last_output + delta;
         
-        // Anti-windup: limitar o termo integral
-        if (pid->integral > pid->integral_max) {
-            pid->integral = pid->integral_max;
-        } else if (pid->integral < -pid->integral_max) {
-            pid->integral = -pid->integral_max;
+        if (output > pid->output_max) {
+            output = pid->output_max;
+        } else if (output < pid->output_min) {
+            output = pid->output_min;
         }
+        
+        // Integral equivalente, para voltar à forma posicional sem salto
+        i_term = output - ff_term - p_term - d_term;
+        pid->integral = (pid->ki > 0.0f) ? i_term / pid->ki : 0.0f;
+    } else {
+        // === TERMO INTEGRAL ===
+        // Acumula o erro ao longo do tempo (elimina erro residual)
         i_term = pid->ki * pid->integral;
-    }
-    
-    // === SAÍDA FINAL ===
-    float output = p_term + i_term + d_term;
-    
-    // Aplicar limites de saída
-    if (output > pid->output_max) {
-        output = pid->output_max;
-    } else if (output < pid->output_min) {
-        output = pid->output_min;
+        
+        // Cálculo preliminar da saída antes de atualizar o integral
+        float tentative_output = ff_term + p_term + i_term + d_term;
+        
+        if (!((tentative_output >= pid->output_max && error > 0) ||
+              (tentative_output < pid->output_min && error < 0))) {
+            // Atualiza o termo integral somente se não estiver saturado
+            pid->integral += error * dt;
+            
+            // Anti-windup: limitar o termo integral
+            if (pid->integral > pid->integral_max) {
+                pid->integral = pid->integral_max;
+            } else if (pid->integral < -pid->integral_max) {
+                pid->integral = -pid->integral_max;
+            }
+            i_term = pid->ki * pid->integral;
+        }
+        
+        // === SAÍDA FINAL ===
+        output = ff_term + p_term + i_term + d_term;
+        
+        // Aplicar limites de saída
+        if (output > pid->output_max) {
+            output = pid->output_max;
+        } else if (output < pid->output_min) {
+            output = pid->output_min;
+        }
     }
     
     // Salva estados
     pid->last_output = output;
     pid->last_pv = current_value;
+    pid->last_setpoint = pid->setpoint;
+    pid->d_state = d_term;
+    pid->first_sample = false;
     pid->debug_p_term = p_term;
     pid->debug_i_term = i_term;
     pid->debug_d_term = d_term;
+    pid->debug_ff_term = ff_term;
 
     return output;
 }
 
 void pid_reset(pid_controller_t *pid) {
     pid->integral = 0.0f;
+    pid->d_state = 0.0f;
+    pid->first_sample = true;
     pid->last_time = to_ms_since_boot(get_absolute_time());
     
     pid->debug_p_term = 0.0f;
     pid->debug_i_term = 0.0f;
     pid->debug_d_term = 0.0f;
+    pid->debug_ff_term = 0.0f;
 }
 
 void pid_enable(pid_controller_t *pid, bool enable) {
@@ -149,3 +371,7 @@ float pid_get_d_term(pid_controller_t *pid) {
     (void)pid; // Unused
     return pid->debug_d_term;
 }
+
+float pid_get_ff_term(pid_controller_t *pid) {
+    return pid->debug_ff_term;
+}
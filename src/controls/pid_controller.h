@@ -4,6 +4,35 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#define PID_GAIN_SCHEDULE_MAX 8     // Máximo de entradas na tabela de ganhos
+
+/**
+ * Forma de cálculo do PID
+ * 
+ * - Posicional: saída = FF + P + I + D, integral condicional (anti-windup)
+ * - Velocidade: saída = saída anterior + variação de FF, P, I e D. Como a
+ *   saída anterior já está limitada, o integral não acumula na saturação
+ *   (anti-windup embutido) e trocar ganhos não acumula erro.
+ */
+typedef enum {
+    PID_FORM_POSITIONAL = 0,
+    PID_FORM_VELOCITY
+} pid_form_t;
+
+/**
+ * Entrada da tabela de ganhos por setpoint (gain scheduling)
+ * 
+ * A perda de calor e o ganho da planta mudam bastante entre 45°C (PLA) e
+ * 80°C (PC/nylon), então cada faixa de setpoint tem os seus ganhos.
+ * Entre duas entradas os ganhos são interpolados linearmente.
+ */
+typedef struct {
+    float setpoint;             // Setpoint em que os ganhos foram ajustados (°C)
+    float kp;
+    float ki;
+    float kd;
+} pid_gain_entry_t;
+
 /**
  * Estrutura do controlador PID
  * 
@@ -30,16 +59,31 @@ typedef struct {
     float integral;             // Acumulador do termo integral
     float last_output;          // Última saída calculada
     float last_pv;             // Último valor do processo
+    float feedforward;          // Termo de feed-forward somado à saída (ex: potência de manutenção)
+    float last_setpoint;        // Setpoint da última execução (derivativo com peso c)
+    float d_state;              // Termo derivativo filtrado da última execução
+    bool first_sample;          // Primeira execução após init/reset (sem derivativo)
+    
+    // Dois graus de liberdade e filtro do derivativo
+    float b;                    // Peso do setpoint no termo P (1 = erro completo)
+    float c;                    // Peso do setpoint no termo D (0 = derivativo sobre PV)
+    float n;                    // Filtro do derivativo: Tf = Kd / (Kp * N); 0 = sem filtro
+    pid_form_t form;            // Posicional ou velocidade
 
     // Variáveis para debug/tunning    
     float debug_p_term;
     float debug_i_term;
     float debug_d_term;
+    float debug_ff_term;
     
     // Controle de tempo
     uint32_t last_time;         // Timestamp da última execução (ms)
     uint32_t sample_time;       // Intervalo entre cálculos (ms)
     
+    // Tabela de ganhos por setpoint (ordenada por setpoint, vazia = ganhos fixos)
+    pid_gain_entry_t schedule[PID_GAIN_SCHEDULE_MAX];
+    uint8_t schedule_len;
+    
     // Estado
     bool enabled;               // PID habilitado ou desabilitado
 } pid_controller_t;
@@ -60,6 +104,7 @@ void pid_init(pid_controller_t *pid, float kp, float ki, float kd,
 
 /**
  * Define o setpoint (valor alvo) do PID
+ * Se houver tabela de ganhos, aplica os ganhos interpolados para o novo setpoint
  * 
  * @param pid Ponteiro para a estrutura do PID
  * @param setpoint Novo valor alvo (ex: temperatura desejada em °C)
@@ -70,6 +115,13 @@ void pid_set_setpoint(pid_controller_t *pid, float setpoint);
  * Atualiza os ganhos do PID em tempo de execução
  * Útil para tunning/ajuste fino dos parâmetros
  * 
+ * A troca é "bumpless": depois do primeiro cálculo, P é refeito com o
+ * último setpoint e PV, o estado do D é reescalado por kd novo / kd antigo
+ * e a diferença dos dois entra no integral, então a saída seguinte só muda
+ * pelo que mudou na entrada. Com ki = 0 o integral é zerado (na forma
+ * posicional o salto não é compensado), e na forma posicional o integral
+ * continua limitado a ±integral_max.
+ * 
  * @param pid Ponteiro para a estrutura do PID
  * @param kp Novo ganho proporcional
  * @param ki Novo ganho integral
@@ -77,6 +129,98 @@ void pid_set_setpoint(pid_controller_t *pid, float setpoint);
  */
 void pid_set_tunings(pid_controller_t *pid, float kp, float ki, float kd);
 
+/**
+ * Carrega a tabela de ganhos por setpoint (gain scheduling)
+ * As entradas são copiadas e ordenadas; os ganhos do setpoint atual são
+ * aplicados imediatamente. count = 0 desativa a tabela (ganhos ficam fixos).
+ * 
+ * @param pid Ponteiro para a estrutura do PID
+ * @param table Entradas (setpoint, kp, ki, kd), em qualquer ordem
+ * @param count Número de entradas (máximo PID_GAIN_SCHEDULE_MAX)
+ * @return false se count excede PID_GAIN_SCHEDULE_MAX
+ */
+bool pid_set_gain_schedule(pid_controller_t *pid, const pid_gain_entry_t *table, uint8_t count);
+
+/**
+ * Insere ou substitui a entrada de um setpoint na tabela de ganhos
+ * Usado para gravar o resultado de um autotune naquele setpoint.
+ * 
+ * @return false se a tabela está cheia
+ */
+bool pid_gain_schedule_update(pid_controller_t *pid, float setpoint, float kp, float ki, float kd);
+
+/**
+ * Calcula os ganhos interpolados da tabela para um setpoint qualquer
+ * Fora da faixa da tabela usa a entrada mais próxima.
+ * 
+ * @return false se a tabela está vazia (ganhos não alterados)
+ */
+bool pid_gain_schedule_lookup(const pid_controller_t *pid, float setpoint,
+                              float *kp, float *ki, float *kd);
+
+/**
+ * Define os pesos do setpoint (PID com dois graus de liberdade)
+ * 
+ * P = Kp * (b * setpoint - PV), D = Kd * d(c * setpoint - PV)/dt.
+ * O integral sempre usa o erro completo, então o regime não muda. Com b < 1
+ * a resposta a degraus de setpoint fica mais suave sem mudar a rejeição de
+ * perturbações. Padrão: b = 1, c = 0 (derivativo sobre PV, sem "kick").
+ * 
+ * @param pid Ponteiro para a estrutura do PID
+ * @param b Peso no termo proporcional (0-1)
+ * @param c Peso no termo derivativo (0-1)
+ */
+void pid_set_setpoint_weights(pid_controller_t *pid, float b, float c);
+
+/**
+ * Define o filtro de primeira ordem do termo derivativo
+ * 
+ * Constante de tempo Tf = Td / N com Td = Kd / Kp. Atenua os degraus de
+ * 0.1°C do DHT22 que sem filtro viram picos no termo D. Valores típicos
+ * de N: 2 a 20. N <= 0 desativa o filtro (derivada pura).
+ * 
+ * @param pid Ponteiro para a estrutura do PID
+ * @param n Fator N do filtro
+ */
+void pid_set_derivative_filter(pid_controller_t *pid, float n);
+
+/**
+ * Seleciona a forma posicional ou de velocidade (incremental)
+ * As duas formas guardam o mesmo integral (ki * integral = termo I), então
+ * a troca só muda a forma. A de velocidade não limita o integral; voltando
+ * para a posicional ele é limitado a ±integral_max aqui, e a troca só é
+ * sem salto com o integral dentro desse limite.
+ * 
+ * @param pid Ponteiro para a estrutura do PID
+ * @param form PID_FORM_POSITIONAL ou PID_FORM_VELOCITY
+ */
+void pid_set_form(pid_controller_t *pid, pid_form_t form);
+
+/**
+ * Define o termo de feed-forward somado à saída em pid_compute()
+ * 
+ * Usado para a potência prevista para manter o setpoint: o integral só
+ * precisa corrigir o erro do modelo em vez de acumular toda a potência.
+ * O anti-windup considera a saída total (feed-forward + PID).
+ * 
+ * @param pid Ponteiro para a estrutura do PID
+ * @param feedforward Valor na mesma unidade da saída (ex: % de PWM)
+ */
+void pid_set_feedforward(pid_controller_t *pid, float feedforward);
+
+/**
+ * Pré-carrega o estado para o PID assumir sem salto na saída (bumpless)
+ * 
+ * Ajusta o integral para que, com o erro e o feed-forward atuais, a saída
+ * seja exatamente a informada. Usado na passagem do pré-aquecimento para
+ * o PID. O próximo cálculo acontece após um sample_time completo.
+ * 
+ * @param pid Ponteiro para a estrutura do PID
+ * @param output Saída em que o PID deve continuar (ex: potência de manutenção)
+ * @param current_value Valor atual do processo
+ */
+void pid_preload(pid_controller_t *pid, float output, float current_value);
+
 /**
  * Calcula a saída do PID baseado no valor atual (process variable)
  * 
@@ -121,4 +265,9 @@ float pid_get_i_term(pid_controller_t *pid);
  */
 float pid_get_d_term(pid_controller_t *pid);
 
+/**
+ * Retorna o termo de feed-forward usado no último cálculo (para debug/tunning)
+ */
+float pid_get_ff_term(pid_controller_t *pid);
+
 #endif // PID_CONTROLLER_H
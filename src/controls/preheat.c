@@ -0,0 +1,162 @@
+#include "preheat.h"
+#include "logger.h"
+
+#define TAG "Preheat"
+
+static void history_clear(preheat_t *ph) {
+    ph->count = 0;
+    ph->head = 0;
+}
+
+static void history_push(preheat_t *ph, float temperature, uint32_t now_ms) {
+    ph->temps[ph->head] = temperature;
+    ph->times[ph->head] = now_ms;
+    ph->head = (ph->head + 1) % PREHEAT_RATE_WINDOW;
+    if (ph->count < PREHEAT_RATE_WINDOW) {
+        ph->count++;
+    }
+}
+
+// Regressão linear temperatura x tempo: inclinação (°C/s) e valor ajustado agora
+static bool history_fit(const preheat_t *ph, uint32_t now_ms, float *slope, float *value_now) {
+    if (ph->count < 3) {
+        return false;
+    }
+
+    // Tempos relativos ao instante atual para manter a precisão em float
+    float sum_t = 0.0f, sum_y = 0.0f, sum_tt = 0.0f, sum_ty = 0.0f;
+    for (uint8_t i = 0; i < ph->count; i++) {
+        float t = -(float)(now_ms - ph->times[i]) / 1000.0f;
+        float y = ph->temps[i];
+        sum_t += t;
+        sum_y += y;
+        sum_tt += t * t;
+        sum_ty += t * y;
+    }
+
+    float n = (float)ph->count;
+    float denom = n * sum_tt - sum_t * sum_t;
+    if (denom <= 0.0f) {
+        return false;
+    }
+
+    *slope = (n * sum_ty - sum_t * sum_y) / denom;
+    *value_now = (sum_y - *slope * sum_t) / n; // Intercepto em t = 0 (agora)
+    return true;
+}
+
+void preheat_init(preheat_t *ph, float power_cap) {
+    ph->state = PREHEAT_IDLE;
+    ph->power_cap = power_cap;
+    ph->setpoint = 0.0f;
+    history_clear(ph);
+    ph->phase_start = 0;
+    ph->start_temp = 0.0f;
+    ph->rate = 0.0f;
+    ph->max_rate = 0.0f;
+    ph->lag_s = PREHEAT_LAG_DEFAULT_S;
+    ph->predicted_peak = 0.0f;
+    ph->settle_output = 0.0f;
+}
+
+void preheat_start(preheat_t *ph, float setpoint) {
+    // Ajustes em sequência pelo botão durante o boost não reiniciam a curva de reação
+    if (ph->state != PREHEAT_BOOST) {
+        ph->state = PREHEAT_ARMED;
+    }
+    ph->setpoint = setpoint;
+}
+
+void preheat_abort(preheat_t *ph) {
+    if (ph->state != PREHEAT_IDLE) {
+        LOGW(TAG, "Preheat aborted");
+    }
+    ph->state = PREHEAT_IDLE;
+}
+
+bool preheat_active(const preheat_t *ph) {
+    return ph->state != PREHEAT_IDLE;
+}
+
+float preheat_update(preheat_t *ph, float temperature, float hold_output,
+                     uint32_t now_ms, bool *handoff) {
+    *handoff = false;
+
+    if (ph->state == PREHEAT_ARMED) {
+        if (ph->setpoint - temperature < PREHEAT_MIN_DELTA) {
+            // Perto do alvo (ou acima dele): o PID resolve sozinho a partir do reset
+            ph->state = PREHEAT_IDLE;
+            return hold_output;
+        }
+
+        ph->state = PREHEAT_BOOST;
+        ph->phase_start = now_ms;
+        ph->start_temp = temperature;
+        ph->rate = 0.0f;
+        ph->max_rate = 0.0f;
+        ph->lag_s = PREHEAT_LAG_DEFAULT_S;
+        history_clear(ph);
+        LOGI(TAG, "Boost started: %.1f°C -> %.1f°C at %.0f%%",
+             temperature, ph->setpoint, ph->power_cap);
+    }
+
+    history_push(ph, temperature, now_ms);
+    float fitted = temperature;
+    if (!history_fit(ph, now_ms, &ph->rate, &fitted)) {
+        ph->rate = 0.0f;
+    }
+    float elapsed_s = (float)(now_ms - ph->phase_start) / 1000.0f;
+
+    if (ph->state == PREHEAT_BOOST) {
+        // Tempo morto pela tangente no ponto de maior taxa da curva de reação
+        if (ph->rate > ph->max_rate && ph->rate > PREHEAT_MIN_RATE) {
+            ph->max_rate = ph->rate;
+            float lag = elapsed_s - (fitted - ph->start_temp) / ph->rate;
+            if (lag < 0.0f) lag = 0.0f;
+            if (lag > PREHEAT_LAG_MAX_S) lag = PREHEAT_LAG_MAX_S;
+            ph->lag_s = lag;
+        }
+
+        float coast = ph->rate > 0.0f ? ph->rate * ph->lag_s : 0.0f;
+        ph->predicted_peak = fitted + coast;
+
+        bool stop = ph->predicted_peak >= ph->setpoint - PREHEAT_STOP_MARGIN ||
+                    temperature >= ph->setpoint - PREHEAT_STOP_MARGIN;
+        bool timeout = (now_ms - ph->phase_start) >= PREHEAT_BOOST_MAX_MS;
+
+        if (!stop && !timeout) {
+            return ph->power_cap;
+        }
+
+        // Potência de manutenção pela curva de reação: perto do ambiente a taxa
+        // máxima mede a capacidade térmica (C = P / taxa_max), aqui a perda é
+        // P - C * taxa. Subestima um pouco, assim como o modelo de feed-forward.
+        ph->settle_output = hold_output;
+        if (ph->max_rate > PREHEAT_MIN_RATE && ph->rate > 0.0f) {
+            float curve_output = ph->power_cap * (1.0f - ph->rate / ph->max_rate);
+            if (curve_output > ph->settle_output) {
+                ph->settle_output = curve_output;
+            }
+        }
+        
+        LOGI(TAG, "Boost done after %.0fs at %.1f°C (rate %.3f°C/s, lag %.0fs, peak %.1f°C)%s",
+             elapsed_s, temperature, ph->rate, ph->lag_s, ph->predicted_peak,
+             timeout ? " [timeout]" : "");
+        ph->state = PREHEAT_SETTLE;
+        ph->phase_start = now_ms;
+        return ph->settle_output;
+    }
+
+    // PREHEAT_SETTLE: manter a potência de manutenção enquanto a inércia se esgota
+    bool settled = (now_ms - ph->phase_start) >= PREHEAT_SETTLE_MIN_MS &&
+                   ph->rate <= PREHEAT_SETTLE_RATE;
+    bool reached = temperature >= ph->setpoint;
+    bool timeout = (now_ms - ph->phase_start) >= PREHEAT_SETTLE_MAX_MS;
+
+    if (settled || reached || timeout) {
+        LOGI(TAG, "Handoff to PID at %.1f°C (output %.1f%%)", temperature, ph->settle_output);
+        ph->state = PREHEAT_IDLE;
+        *handoff = true;
+    }
+    return ph->settle_output;
+}
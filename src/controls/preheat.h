@@ -0,0 +1,104 @@
+#ifndef PREHEAT_H
+#define PREHEAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Pré-aquecimento com potência máxima e passagem sem salto para o PID
+ *
+ * Depois do boot e de cada mudança de setpoint para cima, o heater fica na
+ * potência máxima (ou no limite configurado) até o ponto de parada previsto:
+ *
+ *   temperatura + taxa * atraso >= setpoint - PREHEAT_STOP_MARGIN
+ *
+ * - taxa: regressão linear das últimas PREHEAT_RATE_WINDOW leituras (°C/s)
+ * - atraso: tempo morto da curva de reação (tangente no ponto de maior taxa,
+ *   como no método de Ziegler-Nichols), que soma a inércia do bloco do
+ *   heater e do DHT22. É o quanto a câmara ainda sobe depois do corte.
+ *
+ * Depois do boost vem a acomodação: saída na potência de manutenção (a maior
+ * entre a prevista pelo feed-forward e a medida pela própria curva de
+ * reação) até a temperatura parar de subir. Então o PID assume com o integral pré-carregado
+ * (pid_preload) para continuar exatamente na mesma saída.
+ */
+
+// Configurações do pré-aquecimento
+#define PREHEAT_MIN_DELTA 3.0f          // Só faz boost se faltar mais que isso (°C)
+#define PREHEAT_RATE_WINDOW 24          // Leituras na regressão da taxa (24 x 2.5 s = 60 s)
+#define PREHEAT_MIN_RATE 0.002f         // Taxa mínima para estimar o atraso (°C/s)
+#define PREHEAT_LAG_DEFAULT_S 60.0f     // Atraso assumido antes da primeira estimativa (s)
+#define PREHEAT_LAG_MAX_S 600.0f        // Limite da estimativa do atraso (s)
+#define PREHEAT_STOP_MARGIN 0.2f        // Margem abaixo do setpoint no ponto de parada (°C)
+#define PREHEAT_SETTLE_RATE 0.001f      // Fim da acomodação: taxa abaixo disso (°C/s)
+#define PREHEAT_SETTLE_MIN_MS 60000     // Acomodação mínima: janela da taxa só com a acomodação
+#define PREHEAT_SETTLE_MAX_MS 900000    // Acomodação máxima (15 min)
+#define PREHEAT_BOOST_MAX_MS 7200000    // Boost máximo (2 h) mesmo sem atingir o alvo
+
+typedef enum {
+    PREHEAT_IDLE = 0,       // Sem pré-aquecimento: PID no controle
+    PREHEAT_ARMED,          // Aguardando a primeira leitura para decidir
+    PREHEAT_BOOST,          // Potência máxima até o ponto de parada previsto
+    PREHEAT_SETTLE          // Potência de manutenção até a temperatura estabilizar
+} preheat_state_t;
+
+typedef struct {
+    preheat_state_t state;
+    float power_cap;                    // Saída durante o boost (%)
+    float setpoint;
+
+    // Histórico para a regressão da taxa
+    float temps[PREHEAT_RATE_WINDOW];
+    uint32_t times[PREHEAT_RATE_WINDOW];
+    uint8_t count;
+    uint8_t head;
+
+    // Curva de reação do boost atual
+    uint32_t phase_start;               // Início da fase atual (ms)
+    float start_temp;                   // Temperatura no início do boost (°C)
+    float rate;                         // Taxa de aquecimento atual (°C/s)
+    float max_rate;                     // Maior taxa observada no boost (°C/s)
+    float lag_s;                        // Atraso estimado (s)
+    float predicted_peak;               // Pico previsto se cortar agora (°C)
+    float settle_output;                // Saída na acomodação e no handoff (%)
+} preheat_t;
+
+/**
+ * Inicializa o pré-aquecimento (parado)
+ * @param power_cap Saída aplicada durante o boost (ex: 100%)
+ */
+void preheat_init(preheat_t *ph, float power_cap);
+
+/**
+ * Arma o pré-aquecimento para um novo setpoint (boot ou mudança de alvo)
+ *
+ * A decisão de fazer boost fica para a próxima leitura em preheat_update():
+ * se faltar menos que PREHEAT_MIN_DELTA o PID assume direto.
+ */
+void preheat_start(preheat_t *ph, float setpoint);
+
+/**
+ * Cancela o pré-aquecimento (sensor inseguro, overshoot crítico)
+ */
+void preheat_abort(preheat_t *ph);
+
+/**
+ * Retorna true enquanto o pré-aquecimento controla a saída
+ */
+bool preheat_active(const preheat_t *ph);
+
+/**
+ * Executa um ciclo do pré-aquecimento
+ *
+ * @param temperature Temperatura atual da câmara (°C)
+ * @param hold_output Potência de manutenção prevista para o setpoint (%)
+ * @param now_ms Tempo atual (ms desde o boot)
+ * @param handoff Recebe true no ciclo em que o PID deve assumir; a saída
+ *                retornada é a que o PID deve continuar (pid_preload)
+ * @return Saída a aplicar neste ciclo (%). Quando o pré-aquecimento termina
+ *         sem handoff (alvo perto ou abaixo) o chamador deve usar o PID.
+ */
+float preheat_update(preheat_t *ph, float temperature, float hold_output,
+                     uint32_t now_ms, bool *handoff);
+
+#endif // PREHEAT_H
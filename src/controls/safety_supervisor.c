@@ -0,0 +1,261 @@
+#include "safety_supervisor.h"
+#include "hardware_control.h"
+#include "sensor_manager.h"
+#include "logger.h"
+#include "pico/time.h"
+#include "hardware/watchdog.h"
+#include "hardware/sync.h"
+
+#define TAG "Safety"
+
+// Estado de uma câmara. Campos voláteis: escritos pelo loop principal, lidos
+// na interrupção (32 bits: sem leitura rasgada)
+typedef struct {
+    volatile uint32_t temp_valid_us;             // Instante da última leitura válida
+    volatile float temperature_c;
+    volatile uint32_t temp_posted_us;            // Instante em que temperature_c foi publicada
+    volatile float setpoint_c;
+    volatile bool current_fault;
+    volatile uint32_t current_fault_us;          // Amostra que completou a sequência incoerente
+    volatile bool runaway_fault;
+    volatile uint32_t runaway_fault_us;
+    volatile bool fan_fault;
+    volatile uint32_t fan_fault_us;
+    
+    uint32_t current_bad_samples;
+    bool current_fault_open;                     // Falha de corrente por heater aberto (travada)
+} safety_chamber_t;
+
+static safety_chamber_t chambers[SAFETY_CHAMBERS_MAX];
+static uint8_t chamber_count;
+static volatile uint32_t heartbeat_us;
+static float overshoot_limit_c;
+
+// Estado da interrupção
+static repeating_timer_t supervisor_timer;
+static volatile safety_supervisor_stats_t stats;
+static volatile safety_fault_callback_t fault_callback;
+
+// Instante em que a falha passou a existir ou 0 se não existe.
+// Falhas por prazo (temperatura velha, heartbeat) existem desde o fim do prazo.
+static uint32_t fault_onset(const safety_chamber_t *ch, uint32_t active, uint32_t mask, uint32_t now) {
+    switch (mask) {
+    case SAFETY_FAULT_TEMP_STALE:
+        if (now - ch->temp_valid_us > SAFETY_TEMP_MAX_AGE_MS * 1000u) {
+            return ch->temp_valid_us + SAFETY_TEMP_MAX_AGE_MS * 1000u;
+        }
+        return 0;
+    case SAFETY_FAULT_OVERSHOOT: {
+        // Histerese: uma vez em falha só libera abaixo de limite - histerese
+        float limit = ch->setpoint_c + overshoot_limit_c;
+        if (active & SAFETY_FAULT_OVERSHOOT) {
+            limit -= SAFETY_OVERSHOOT_HYSTERESIS;
+        }
+        return ch->temperature_c > limit ? ch->temp_posted_us : 0;
+    }
+    case SAFETY_FAULT_CURRENT:
+        return ch->current_fault ? ch->current_fault_us : 0;
+    case SAFETY_FAULT_RUNAWAY:
+        return ch->runaway_fault ? ch->runaway_fault_us : 0;
+    case SAFETY_FAULT_FAN:
+        return ch->fan_fault ? ch->fan_fault_us : 0;
+    case SAFETY_FAULT_HEARTBEAT:
+        if (now - heartbeat_us > SAFETY_HEARTBEAT_TIMEOUT_MS * 1000u) {
+            return heartbeat_us + SAFETY_HEARTBEAT_TIMEOUT_MS * 1000u;
+        }
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+// Uma câmara: corta ou libera o heater dela
+static uint32_t supervise_chamber(uint8_t c, uint32_t now) {
+    static const uint32_t checks[] = {
+        SAFETY_FAULT_TEMP_STALE, SAFETY_FAULT_OVERSHOOT, SAFETY_FAULT_CURRENT, SAFETY_FAULT_HEARTBEAT,
+        SAFETY_FAULT_RUNAWAY, SAFETY_FAULT_FAN
+    };
+    const safety_chamber_t *ch = &chambers[c];
+    uint32_t active = stats.chamber_faults[c];
+    uint32_t faults = 0;
+    uint32_t earliest_onset = 0;
+    bool has_onset = false;
+
+    for (unsigned i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+        uint32_t onset = fault_onset(ch, active, checks[i], now);
+        if (onset == 0) {
+            continue;
+        }
+        faults |= checks[i];
+        // Só falhas novas contam para a latência
+        if (!(active & checks[i]) && (!has_onset || (int32_t)(onset - earliest_onset) < 0)) {
+            earliest_onset = onset;
+            has_onset = true;
+        }
+    }
+
+    if (faults) {
+        hardware_control_heater_inhibit(c, true);
+        if (!active) {
+            stats.trips++;
+        }
+        if (has_onset) {
+            uint32_t latency = time_us_32() - earliest_onset;
+            stats.last_latency_us = latency;
+            if (latency > stats.max_latency_us) {
+                stats.max_latency_us = latency;
+            }
+        }
+    } else if (active) {
+        hardware_control_heater_inhibit(c, false);
+    }
+    stats.chamber_faults[c] = faults;
+    return faults;
+}
+
+// Interrupção do timer: nada de log nem de espera aqui
+static bool supervisor_tick(repeating_timer_t *rt) {
+    (void)rt;
+    uint32_t now = time_us_32();
+    uint32_t faults = 0;
+    bool changed = false;
+
+    for (uint8_t c = 0; c < chamber_count; c++) {
+        uint32_t before = stats.chamber_faults[c];
+        uint32_t after = supervise_chamber(c, now);
+        changed = changed || after != before;
+        faults |= after;
+    }
+    stats.faults = faults;
+    if (changed && fault_callback) {
+        fault_callback(faults);
+    }
+    stats.ticks++;
+
+    // Watchdog só com o loop principal vivo
+    if (!(faults & SAFETY_FAULT_HEARTBEAT)) {
+        watchdog_update();
+    }
+    return true;
+}
+
+void safety_supervisor_set_fault_callback(safety_fault_callback_t callback) {
+    fault_callback = callback;
+}
+
+void safety_supervisor_init(const float *setpoints, uint8_t count, float overshoot_limit) {
+    uint32_t now = time_us_32();
+    if (count > SAFETY_CHAMBERS_MAX) {
+        count = SAFETY_CHAMBERS_MAX;
+    }
+    heartbeat_us = now;
+    overshoot_limit_c = overshoot_limit;
+    for (uint8_t c = 0; c < count; c++) {
+        safety_chamber_t *ch = &chambers[c];
+        ch->temp_valid_us = now;     // Prazo da primeira leitura conta a partir daqui
+        ch->temperature_c = 0.0f;
+        ch->temp_posted_us = now;
+        ch->setpoint_c = setpoints[c];
+        ch->current_fault = false;
+        ch->current_fault_open = false;
+        ch->current_bad_samples = 0;
+        ch->runaway_fault = false;
+        ch->fan_fault = false;
+    }
+    for (uint8_t c = 0; c < SAFETY_CHAMBERS_MAX; c++) {
+        stats.chamber_faults[c] = 0;
+    }
+    chamber_count = count;
+
+    stats.faults = 0;
+    stats.trips = 0;
+    stats.ticks = 0;
+    stats.last_latency_us = 0;
+    stats.max_latency_us = 0;
+
+    if (watchdog_caused_reboot()) {
+        LOGW(TAG, "Rebooted by watchdog (main loop stopped)");
+    }
+    watchdog_enable(SAFETY_WATCHDOG_TIMEOUT_MS, true);
+
+    // Período negativo: intervalo contado do início de cada callback (sem deriva)
+    if (!add_repeating_timer_ms(-SAFETY_SUPERVISOR_PERIOD_MS, supervisor_tick, NULL, &supervisor_timer)) {
+        LOGE(TAG, "No timer slot for the safety supervisor");
+        return;
+    }
+    LOGI(TAG, "Supervisor running at %d Hz (watchdog %d ms)",
+         1000 / SAFETY_SUPERVISOR_PERIOD_MS, SAFETY_WATCHDOG_TIMEOUT_MS);
+}
+
+void safety_supervisor_heartbeat(void) {
+    heartbeat_us = time_us_32();
+}
+
+void safety_supervisor_post_temperature(uint8_t chamber, float temperature) {
+    safety_chamber_t *ch = &chambers[chamber];
+    // O tick de 20 Hz roda no mesmo core: sem IRQ no meio, ele nunca vê a
+    // temperatura nova com o instante antigo (ou o contrário)
+    uint32_t irq = save_and_disable_interrupts();
+    uint32_t now = time_us_32();
+    ch->temperature_c = temperature;
+    ch->temp_posted_us = now;
+    ch->temp_valid_us = now;
+    restore_interrupts(irq);
+}
+
+void safety_supervisor_set_setpoint(uint8_t chamber, float setpoint) {
+    chambers[chamber].setpoint_c = setpoint;
+}
+
+void safety_supervisor_post_current(uint8_t chamber, float power_w, float duty_percent) {
+    safety_chamber_t *ch = &chambers[chamber];
+    // MOSFET em curto (corrente sem comando) ou heater aberto (comando sem corrente)
+    bool shorted = duty_percent <= 0.0f && power_w > SAFETY_IDLE_POWER_MAX_W;
+    bool open = duty_percent >= SAFETY_ACTIVE_DUTY_MIN && power_w < ACS712_MIN_ENERGY_THRESHOLD;
+
+    if (ch->current_fault) {
+        // Heater aberto fica travado até reiniciar: com o corte não há como
+        // testar de novo (duty 0 sem corrente é sempre coerente)
+        if (!ch->current_fault_open && !shorted) {
+            ch->current_fault = false;
+            ch->current_bad_samples = 0;
+        }
+        return;
+    }
+    if (!shorted && !open) {
+        ch->current_bad_samples = 0;
+        return;
+    }
+    if (++ch->current_bad_samples >= SAFETY_CURRENT_FAULT_SAMPLES) {
+        ch->current_fault_open = open;
+        ch->current_fault_us = time_us_32();
+        ch->current_fault = true;
+    }
+}
+
+void safety_supervisor_post_runaway(uint8_t chamber) {
+    safety_chamber_t *ch = &chambers[chamber];
+    if (!ch->runaway_fault) {
+        ch->runaway_fault_us = time_us_32();
+        ch->runaway_fault = true;
+    }
+}
+
+void safety_supervisor_post_fan(uint8_t chamber, bool stalled) {
+    safety_chamber_t *ch = &chambers[chamber];
+    if (stalled && !ch->fan_fault) {
+        ch->fan_fault_us = time_us_32();
+    }
+    ch->fan_fault = stalled;
+}
+
+void safety_supervisor_get_stats(safety_supervisor_stats_t *out) {
+    out->faults = stats.faults;
+    for (uint8_t c = 0; c < SAFETY_CHAMBERS_MAX; c++) {
+        out->chamber_faults[c] = stats.chamber_faults[c];
+    }
+    out->trips = stats.trips;
+    out->ticks = stats.ticks;
+    out->last_latency_us = stats.last_latency_us;
+    out->max_latency_us = stats.max_latency_us;
+}
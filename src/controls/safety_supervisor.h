@@ -0,0 +1,134 @@
+#ifndef SAFETY_SUPERVISOR_H
+#define SAFETY_SUPERVISOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Supervisor de segurança independente do loop principal
+ *
+ * Roda na interrupção de um timer repetitivo (SAFETY_SUPERVISOR_PERIOD_MS),
+ * então continua atuando mesmo com o loop principal preso numa transferência
+ * SPI ou numa espera do DHT22. A cada tick verifica:
+ *
+ * - temperatura velha: nenhuma leitura válida há SAFETY_TEMP_MAX_AGE_MS
+ * - overshoot: temperatura > setpoint + overshoot_limit
+ * - corrente x duty: heater consumindo com PWM em 0 (MOSFET em curto) ou
+ *   sem corrente com PWM alto (heater aberto), por algumas amostras seguidas.
+ *   Heater aberto trava o corte até reiniciar.
+ * - heartbeat: o loop principal não chamou safety_supervisor_heartbeat()
+ *   há SAFETY_HEARTBEAT_TIMEOUT_MS
+ * - thermal runaway: avisado pelo detector (thermal_runaway), travado até
+ *   reiniciar
+ * - ventoinha de circulação parada: avisado pelo tacômetro (fan_tach); sem
+ *   circulação o bloco superaquece longe do DHT22. Libera quando ela volta
+ *   a girar (a medida não depende do heater, ao contrário do heater aberto)
+ *
+ * Com qualquer falha o PWM do heater vai a 0 na própria interrupção
+ * (hardware_control_heater_inhibit) e fica bloqueado até todas as falhas
+ * sumirem.
+ *
+ * Várias câmaras: temperatura, setpoint, corrente e runaway são por câmara
+ * (índice = heater da câmara no hardware_control) e uma falha corta só o
+ * heater dela. O heartbeat é do loop principal, comum a todas: sem ele
+ * todos os heaters são cortados.
+ *
+ * A latência entre o instante em que a falha passou a existir e o
+ * corte é medida e o pior caso fica registrado.
+ *
+ * Watchdog do RP2040: alimentado pela interrupção só enquanto o loop
+ * principal dá sinal de vida. Se o loop trava (ou a própria interrupção
+ * para), o chip reinicia em SAFETY_WATCHDOG_TIMEOUT_MS e o PWM volta
+ * desligado. As outras falhas não reiniciam: o corte já resolve e um
+ * reinício só esconderia o problema.
+ */
+
+#define SAFETY_SUPERVISOR_PERIOD_MS 50         // Tick do supervisor (20 Hz)
+#define SAFETY_TEMP_MAX_AGE_MS 10000           // Idade máxima da última leitura válida do DHT22
+#define SAFETY_OVERSHOOT_HYSTERESIS 1.0f       // Volta a liberar abaixo de limite - histerese (°C)
+// Gravar o checkpoint (flash_store) mascara as interrupções do núcleo 0 dentro
+// do flash_safe_execute: sem tick do supervisor e sem heartbeat enquanto o
+// flash do Pico (W25Q16JV) apaga um setor, 45 ms típico e 400 ms no pior
+// caso (~1 ms só programando uma página). Um corte pedido nessa janela sai
+// com esse atraso (entra no pior caso de latência) e o heater segue no último
+// duty, o que não muda a temperatura da câmara. A tarefa de checkpoint dá um
+// heartbeat logo antes de gravar: os 400 ms cabem no prazo abaixo.
+#define SAFETY_HEARTBEAT_TIMEOUT_MS 500        // Loop principal sem sinal de vida
+#define SAFETY_WATCHDOG_TIMEOUT_MS 2000        // Reinício após o loop principal parar
+#define SAFETY_IDLE_POWER_MAX_W 5.0f           // Potência máxima com PWM em 0 (W)
+#define SAFETY_ACTIVE_DUTY_MIN 20.0f           // PWM a partir do qual deve haver corrente (%)
+#define SAFETY_CURRENT_FAULT_SAMPLES 3         // Amostras seguidas de corrente incoerente
+#define SAFETY_CHAMBERS_MAX 4                  // Câmaras supervisionadas
+
+// Falhas (máscara de bits)
+#define SAFETY_FAULT_TEMP_STALE   (1u << 0)
+#define SAFETY_FAULT_OVERSHOOT    (1u << 1)
+#define SAFETY_FAULT_CURRENT      (1u << 2)
+#define SAFETY_FAULT_HEARTBEAT    (1u << 3)
+#define SAFETY_FAULT_RUNAWAY      (1u << 4)
+#define SAFETY_FAULT_FAN          (1u << 5)
+
+typedef struct {
+    uint32_t faults;                   // Falhas ativas em qualquer câmara (SAFETY_FAULT_*)
+    uint32_t chamber_faults[SAFETY_CHAMBERS_MAX]; // Falhas ativas por câmara
+    uint32_t trips;                    // Vezes em que um heater foi cortado (todas as câmaras)
+    uint32_t ticks;
+    uint32_t last_latency_us;          // Falha -> corte no último disparo
+    uint32_t max_latency_us;           // Pior caso já visto
+} safety_supervisor_stats_t;
+
+typedef void (*safety_fault_callback_t)(uint32_t faults);
+
+/**
+ * Inicia o timer do supervisor e o watchdog. Chamar quando o loop principal
+ * estiver prestes a começar (o heartbeat passa a ser cobrado).
+ * @param setpoints Temperatura alvo inicial de cada câmara (°C)
+ * @param count Número de câmaras (até SAFETY_CHAMBERS_MAX)
+ * @param overshoot_limit Máximo acima do setpoint antes do corte (°C)
+ */
+void safety_supervisor_init(const float *setpoints, uint8_t count, float overshoot_limit);
+
+/**
+ * Sinal de vida do loop principal (a cada iteração)
+ */
+void safety_supervisor_heartbeat(void);
+
+/**
+ * Nova leitura válida da temperatura da câmara
+ */
+void safety_supervisor_post_temperature(uint8_t chamber, float temperature);
+
+void safety_supervisor_set_setpoint(uint8_t chamber, float setpoint);
+
+/**
+ * Nova medida do ACS712 com o duty aplicado durante a medida
+ * @param power_w Potência medida (W)
+ * @param duty_percent Duty cycle do heater no momento da medida (%)
+ */
+void safety_supervisor_post_current(uint8_t chamber, float power_w, float duty_percent);
+
+/**
+ * Thermal runaway confirmado: corta o heater no próximo tick e trava o corte
+ */
+void safety_supervisor_post_runaway(uint8_t chamber);
+
+/**
+ * Nova amostra do tacômetro da ventoinha de circulação
+ * @param stalled true enquanto a ventoinha está parada (corta o heater)
+ */
+void safety_supervisor_post_fan(uint8_t chamber, bool stalled);
+
+/**
+ * Registra o callback chamado quando as falhas de alguma câmara mudam
+ * (recebe a união das falhas de todas as câmaras). Serve para acordar quem
+ * registra no log sem polling. Roda dentro da interrupção do supervisor:
+ * nada de log nem de espera dentro dele.
+ */
+void safety_supervisor_set_fault_callback(safety_fault_callback_t callback);
+
+/**
+ * Cópia das falhas ativas e estatísticas
+ */
+void safety_supervisor_get_stats(safety_supervisor_stats_t *stats);
+
+#endif // SAFETY_SUPERVISOR_H
@@ -0,0 +1,133 @@
+#include "thermal_runaway.h"
+#include "logger.h"
+
+#define TAG "Runaway"
+
+void thermal_runaway_init(thermal_runaway_t *tr, float heat_capacity, uint32_t window_ms, uint32_t lag_ms) {
+    tr->heat_capacity = heat_capacity;
+    tr->window_ms = window_ms;
+    tr->lag_ms = lag_ms;
+    tr->min_expected_rise = 0.5f;
+    tr->trip_ratio = 0.35f;
+    tr->clear_ratio = 0.6f;
+    tr->confirm_ms = 10000;
+
+    tr->state = RUNAWAY_STATE_NORMAL;
+    tr->suspect_since = 0;
+    tr->expected_rise = 0.0f;
+    tr->observed_rise = 0.0f;
+    tr->trips = 0;
+    thermal_runaway_clear_history(tr);
+}
+
+void thermal_runaway_set_thresholds(thermal_runaway_t *tr, float min_expected_rise,
+                                    float trip_ratio, float clear_ratio, uint32_t confirm_ms) {
+    tr->min_expected_rise = min_expected_rise;
+    tr->trip_ratio = trip_ratio;
+    tr->clear_ratio = clear_ratio > trip_ratio ? clear_ratio : trip_ratio;
+    tr->confirm_ms = confirm_ms;
+}
+
+void thermal_runaway_clear_history(thermal_runaway_t *tr) {
+    tr->count = 0;
+    tr->head = 0;
+    if (tr->state == RUNAWAY_STATE_SUSPECT) {
+        tr->state = RUNAWAY_STATE_NORMAL;
+    }
+}
+
+// Índice da i-ésima leitura mais antiga do anel
+static uint8_t sample_index(const thermal_runaway_t *tr, uint8_t i) {
+    return (uint8_t)((tr->head + RUNAWAY_MAX_SAMPLES - tr->count + i) % RUNAWAY_MAX_SAMPLES);
+}
+
+// Subidas esperada e observada; false se o histórico ainda não cobre janela + atraso
+// ou a energia líquida é pequena demais perto da bruta
+static bool window_evaluate(thermal_runaway_t *tr, uint32_t now_ms, float temperature) {
+    uint32_t span = tr->window_ms + tr->lag_ms;
+    if (tr->count < 2 || now_ms - tr->times[sample_index(tr, 0)] < span) {
+        return false;
+    }
+
+    float energy_j = 0.0f;
+    float gross_energy_j = 0.0f;
+    bool have_start = false;
+    float start_temp = temperature;
+
+    for (uint8_t i = 0; i + 1 < tr->count; i++) {
+        uint8_t idx = sample_index(tr, i);
+        uint32_t age = now_ms - tr->times[idx];
+
+        // Potência de cada leitura vale até a seguinte, recortada à janela deslocada
+        uint32_t next_age = now_ms - tr->times[sample_index(tr, i + 1)];
+        uint32_t from = age < span ? age : span;
+        uint32_t to = next_age > tr->lag_ms ? next_age : tr->lag_ms;
+        if (from > to) {
+            float dt_s = (float)(from - to) / 1000.0f;
+            energy_j += (tr->power[idx] - tr->loss[idx]) * dt_s;
+            gross_energy_j += tr->power[idx] * dt_s;
+        }
+
+        // Primeira leitura dentro da janela observada
+        if (!have_start && age <= tr->window_ms) {
+            start_temp = tr->temps[idx];
+            have_start = true;
+        }
+    }
+
+    tr->expected_rise = energy_j / tr->heat_capacity;
+    tr->observed_rise = temperature - start_temp;
+    return have_start && energy_j >= RUNAWAY_MIN_NET_FRACTION * gross_energy_j;
+}
+
+thermal_runaway_state_t thermal_runaway_update(thermal_runaway_t *tr, float temperature,
+                                               float heater_power_w, float loss_power_w, uint32_t now_ms) {
+    tr->times[tr->head] = now_ms;
+    tr->temps[tr->head] = temperature;
+    tr->power[tr->head] = heater_power_w;
+    tr->loss[tr->head] = loss_power_w;
+    tr->head = (tr->head + 1) % RUNAWAY_MAX_SAMPLES;
+    if (tr->count < RUNAWAY_MAX_SAMPLES) {
+        tr->count++;
+    }
+
+    if (tr->state == RUNAWAY_STATE_TRIPPED) {
+        return tr->state;
+    }
+    if (!window_evaluate(tr, now_ms, temperature) || tr->expected_rise < tr->min_expected_rise) {
+        // Sem energia suficiente para julgar
+        tr->state = RUNAWAY_STATE_NORMAL;
+        return tr->state;
+    }
+
+    float ratio = tr->observed_rise / tr->expected_rise;
+    switch (tr->state) {
+    case RUNAWAY_STATE_NORMAL:
+        if (ratio < tr->trip_ratio) {
+            tr->state = RUNAWAY_STATE_SUSPECT;
+            tr->suspect_since = now_ms;
+            LOGW(TAG, "Heating slower than expected: +%.2f°C of +%.2f°C in %lus",
+                 tr->observed_rise, tr->expected_rise, tr->window_ms / 1000u);
+        }
+        break;
+    case RUNAWAY_STATE_SUSPECT:
+        if (ratio >= tr->clear_ratio) {
+            tr->state = RUNAWAY_STATE_NORMAL;
+            LOGI(TAG, "Heating rate back to normal (+%.2f°C of +%.2f°C)",
+                 tr->observed_rise, tr->expected_rise);
+        } else if (now_ms - tr->suspect_since >= tr->confirm_ms) {
+            tr->state = RUNAWAY_STATE_TRIPPED;
+            tr->trips++;
+            LOGE(TAG, "THERMAL RUNAWAY: +%.2f°C observed for +%.2f°C expected, heater latched off",
+                 tr->observed_rise, tr->expected_rise);
+        }
+        break;
+    default:
+        break;
+    }
+    return tr->state;
+}
+
+bool thermal_runaway_tripped(const thermal_runaway_t *tr) {
+    return tr->state == RUNAWAY_STATE_TRIPPED;
+}
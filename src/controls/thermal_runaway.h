@@ -0,0 +1,107 @@
+#ifndef THERMAL_RUNAWAY_H
+#define THERMAL_RUNAWAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Detecção de thermal runaway pela taxa de aquecimento esperada
+ *
+ * A cada leitura compara a subida observada da temperatura com a subida
+ * que a energia aplicada deveria causar. Energia líquida é a potência do
+ * heater menos a perda da câmara na temperatura medida (potência de
+ * manutenção), integrada numa janela deslocada pelo atraso bloco -> ar ->
+ * sensor:
+ *
+ *   esperado = soma((P - perda) * dt, [t - atraso - janela, t - atraso]) / C
+ *   observado = T(t) - T(t - janela)
+ *
+ * Pega o que a proteção de overshoot não vê: sensor que caiu do carretel
+ * (heater a 100% e a leitura parada) ou heater que consome mas não aquece
+ * a câmara (ventoinha parada, bloco solto).
+ *
+ * Máquina de estados com histerese:
+ * - NORMAL: observado >= trip_ratio * esperado (ou pouca energia para julgar:
+ *   esperado < min_expected_rise ou líquida < RUNAWAY_MIN_NET_FRACTION da bruta)
+ * - SUSPECT: abaixo de trip_ratio; volta a NORMAL só com observado >=
+ *   clear_ratio * esperado ou sem energia para julgar
+ * - TRIPPED: SUSPECT por confirm_ms seguidos; travado até reiniciar
+ *
+ * C é uma capacidade térmica efetiva conservadora (maior que a real deixa
+ * o esperado menor e evita falso positivo).
+ */
+
+#define RUNAWAY_MAX_SAMPLES 64          // Leituras na janela + atraso (64 x 2.5 s = 160 s)
+#define RUNAWAY_MIN_NET_FRACTION 0.5f   // Só julga com energia líquida >= metade da bruta:
+                                        // perto da potência de manutenção o erro do modelo de perda domina
+
+typedef enum {
+    RUNAWAY_STATE_NORMAL = 0,
+    RUNAWAY_STATE_SUSPECT,
+    RUNAWAY_STATE_TRIPPED
+} thermal_runaway_state_t;
+
+typedef struct {
+    // Configuração
+    float heat_capacity;                // Capacidade térmica efetiva da câmara (J/K)
+    uint32_t window_ms;                 // Janela da subida observada
+    uint32_t lag_ms;                    // Atraso entre energia aplicada e subida no sensor
+    float min_expected_rise;            // Abaixo disso não há energia para julgar (°C)
+    float trip_ratio;                   // Observado/esperado abaixo disso: suspeito
+    float clear_ratio;                  // Observado/esperado para sair de suspeito
+    uint32_t confirm_ms;                // Tempo suspeito até disparar
+
+    // Histórico (anel)
+    uint32_t times[RUNAWAY_MAX_SAMPLES];
+    float temps[RUNAWAY_MAX_SAMPLES];
+    float power[RUNAWAY_MAX_SAMPLES];   // Potência do heater na leitura (W)
+    float loss[RUNAWAY_MAX_SAMPLES];    // Perda da câmara na leitura (W)
+    uint8_t count;
+    uint8_t head;
+
+    thermal_runaway_state_t state;
+    uint32_t suspect_since;             // Início do estado suspeito (ms)
+    float expected_rise;                // Última avaliação (°C), diagnóstico
+    float observed_rise;
+    uint32_t trips;
+} thermal_runaway_t;
+
+/**
+ * Inicializa o detector (NORMAL, histórico vazio)
+ * @param heat_capacity Capacidade térmica efetiva da câmara (J/K)
+ * @param window_ms Janela da subida observada (ms)
+ * @param lag_ms Atraso entre energia aplicada e subida no sensor (ms)
+ */
+void thermal_runaway_init(thermal_runaway_t *tr, float heat_capacity, uint32_t window_ms, uint32_t lag_ms);
+
+/**
+ * Define os limiares da máquina de estados
+ * @param min_expected_rise Subida esperada mínima para julgar (°C)
+ * @param trip_ratio Razão observado/esperado que torna suspeito
+ * @param clear_ratio Razão para voltar a NORMAL (> trip_ratio: histerese)
+ * @param confirm_ms Tempo suspeito até disparar (ms)
+ */
+void thermal_runaway_set_thresholds(thermal_runaway_t *tr, float min_expected_rise,
+                                    float trip_ratio, float clear_ratio, uint32_t confirm_ms);
+
+/**
+ * Registra uma leitura nova e avalia a janela
+ *
+ * @param temperature Temperatura da câmara (°C)
+ * @param heater_power_w Potência do heater durante a leitura (W)
+ * @param loss_power_w Perda da câmara na temperatura atual (W)
+ * @param now_ms Instante da leitura (ms desde o boot)
+ * @return Estado depois da avaliação
+ */
+thermal_runaway_state_t thermal_runaway_update(thermal_runaway_t *tr, float temperature,
+                                               float heater_power_w, float loss_power_w, uint32_t now_ms);
+
+/**
+ * Descarta o histórico (leituras interrompidas: sensor inseguro). Um
+ * disparo continua travado.
+ */
+void thermal_runaway_clear_history(thermal_runaway_t *tr);
+
+bool thermal_runaway_tripped(const thermal_runaway_t *tr);
+
+#endif // THERMAL_RUNAWAY_H
@@ -0,0 +1,164 @@
+#include "vent_control.h"
+#include "logger.h"
+#include <math.h>
+
+#define TAG "Vent"
+
+#define VENT_MAX_STEP_S 10.0f           // Maior passo da rampa entre duas leituras (s)
+
+static void set_state(vent_control_t *vc, vent_state_t state, uint32_t now_ms) {
+    if (vc->state == VENT_PURGE) {
+        vc->purge_ms += now_ms - vc->state_since;
+    }
+    vc->state = state;
+    vc->state_since = now_ms;
+}
+
+// Duty que ainda cabe na folga do heater: a saída sem a exaustão mais a
+// perda prevista não passa de VENT_HEATER_HEADROOM
+static float headroom_duty(const vent_control_t *vc, float temperature, float ambient_temp,
+                           float heater_output) {
+    float full_loss = VENT_LOSS_W_PER_K * (temperature - ambient_temp) / vc->heater_power_w * 100.0f;
+    if (full_loss <= 0.0f) {
+        return 100.0f;
+    }
+    float base_output = heater_output - vent_control_feedforward(vc, temperature, ambient_temp);
+    return (VENT_HEATER_HEADROOM - base_output) / full_loss * 100.0f;
+}
+
+// Duty da purga pelo excesso de umidade (mínimo em que a ventoinha gira até 100%)
+static float purge_duty(float excess_rh) {
+    float fraction = (excess_rh - VENT_PURGE_OFF_RH) / (VENT_PURGE_FULL_RH - VENT_PURGE_OFF_RH);
+    if (fraction < 0.0f) fraction = 0.0f;
+    if (fraction > 1.0f) fraction = 1.0f;
+    return VENT_DUTY_MIN + (100.0f - VENT_DUTY_MIN) * fraction;
+}
+
+void vent_control_init(vent_control_t *vc, float overshoot_limit, float heater_power_w) {
+    vc->overshoot_limit = overshoot_limit;
+    vc->heater_power_w = heater_power_w;
+    vc->state = VENT_RECIRCULATE;
+    vc->state_since = 0;
+    vc->last_ms = 0;
+    vc->band_since = 0;
+    vc->duty = 0.0f;
+    vc->excess_rh = 0.0f;
+    vc->purges = 0;
+    vc->dip_aborts = 0;
+    vc->purge_ms = 0;
+}
+
+float vent_absolute_humidity(float temperature, float relative_humidity) {
+    // Equação de Magnus (hPa) convertida para g/m³
+    float es = 6.112f * expf(17.62f * temperature / (243.12f + temperature));
+    return 216.7f * es * relative_humidity / 100.0f / (273.15f + temperature);
+}
+
+float vent_control_update(vent_control_t *vc, float temperature, float humidity,
+                          float ambient_temp, float ambient_rh, float setpoint,
+                          float heater_output, bool sensor_safe, uint32_t now_ms) {
+    float dt_s = vc->last_ms ? (float)(now_ms - vc->last_ms) / 1000.0f : 0.0f;
+    if (dt_s > VENT_MAX_STEP_S) {
+        dt_s = VENT_MAX_STEP_S;
+    }
+    vc->last_ms = now_ms;
+
+    // Sem leitura confiável não há o que decidir: exaustão parada
+    if (!sensor_safe) {
+        if (vc->state != VENT_RECIRCULATE) {
+            set_state(vc, VENT_RECIRCULATE, now_ms);
+        }
+        vc->duty = 0.0f;
+        return vc->duty;
+    }
+
+    // Ar de fora aquecido até a câmara: mesma água, umidade relativa menor
+    float inlet_rh = vent_absolute_humidity(ambient_temp, ambient_rh) /
+                     vent_absolute_humidity(temperature, 100.0f) * 100.0f;
+    vc->excess_rh = humidity - inlet_rh;
+    float room_duty = headroom_duty(vc, temperature, ambient_temp, heater_output);
+    bool held = now_ms - vc->state_since >= VENT_MIN_STATE_MS;
+    if (fabsf(temperature - setpoint) > VENT_TEMP_BAND) {
+        vc->band_since = 0;
+    } else if (vc->band_since == 0) {
+        vc->band_since = now_ms ? now_ms : 1;
+    }
+
+    if (temperature > setpoint + vc->overshoot_limit) {
+        if (vc->state != VENT_COOL) {
+            LOGW(TAG, "Overshoot %.1f°C: exhausting at full speed", temperature);
+            set_state(vc, VENT_COOL, now_ms);
+        }
+    } else if (vc->state == VENT_COOL) {
+        if (temperature <= setpoint + vc->overshoot_limit - VENT_TEMP_BAND) {
+            set_state(vc, VENT_RECIRCULATE, now_ms);
+        }
+    } else if (vc->state == VENT_RECIRCULATE) {
+        bool settled = vc->band_since != 0 && now_ms - vc->band_since >= VENT_SETTLE_MS;
+        bool ready = settled && room_duty >= VENT_DUTY_MIN;
+        if (held && ready && vc->excess_rh >= VENT_PURGE_ON_RH) {
+            LOGI(TAG, "Purge started: chamber %.1f%% RH, %.1f%% over heated ambient air",
+                 humidity, vc->excess_rh);
+            set_state(vc, VENT_PURGE, now_ms);
+            vc->purges++;
+        }
+    } else if (temperature < setpoint - VENT_DIP_MAX || room_duty < VENT_DUTY_MIN) {
+        // Purga custando mais calor que o heater repõe: para já, sem esperar o tempo mínimo
+        LOGI(TAG, "Purge stopped: %s", temperature < setpoint - VENT_DIP_MAX ?
+             "chamber temperature dipped" : "no heater headroom");
+        set_state(vc, VENT_RECIRCULATE, now_ms);
+        vc->dip_aborts++;
+        vc->duty = 0.0f;                // Sem rampa: o heater já está atrás
+    } else if (held && vc->excess_rh <= VENT_PURGE_OFF_RH) {
+        LOGI(TAG, "Purge finished: %.1f%% RH over heated ambient air, recirculating", vc->excess_rh);
+        set_state(vc, VENT_RECIRCULATE, now_ms);
+    }
+
+    switch (vc->state) {
+    case VENT_COOL:
+        vc->duty = 100.0f;
+        break;
+    case VENT_PURGE: {
+        // Rampa até o duty pela umidade, limitado pela folga do heater
+        float target = purge_duty(vc->excess_rh);
+        if (target > room_duty) {
+            target = room_duty;
+        }
+        float step = VENT_RAMP_PERCENT_PER_S * dt_s;
+        if (vc->duty < VENT_DUTY_MIN) {
+            vc->duty = VENT_DUTY_MIN;
+        } else if (vc->duty + step < target) {
+            vc->duty += step;
+        } else if (vc->duty - step > target) {
+            vc->duty -= step;
+        } else {
+            vc->duty = target;
+        }
+        break;
+    }
+    default:
+        // Desce pela mesma rampa (o PID perde a compensação aos poucos) até parar
+        vc->duty -= VENT_RAMP_PERCENT_PER_S * dt_s;
+        if (vc->duty < VENT_DUTY_MIN) {
+            vc->duty = 0.0f;
+        }
+        break;
+    }
+    return vc->duty;
+}
+
+float vent_control_feedforward(const vent_control_t *vc, float temperature, float ambient_temp) {
+    float delta = temperature - ambient_temp;
+    if (delta <= 0.0f || vc->heater_power_w <= 0.0f) {
+        return 0.0f;
+    }
+    return VENT_LOSS_W_PER_K * vc->duty / 100.0f * delta / vc->heater_power_w * 100.0f;
+}
+
+const char *vent_control_state_name(vent_state_t state) {
+    switch (state) {
+    case VENT_PURGE: return "PURGE";
+    case VENT_COOL: return "COOL";
+    default: return "RECIRC";
+    }
+}
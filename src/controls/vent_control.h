@@ -0,0 +1,106 @@
+#ifndef VENT_CONTROL_H
+#define VENT_CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Ventoinha de exaustão: purga do ar úmido x recirculação
+ *
+ * O filamento seca mais rápido com a câmara seca: a evaporação cai com a
+ * umidade relativa. Trocar o ar só adianta se o ar de fora tem menos água
+ * (umidade absoluta, g/m³ pela equação de Magnus), e o ganho é o quanto a
+ * umidade relativa cai: o ar ambiente que entra, aquecido até a temperatura
+ * da câmara, fica com UR_entrada = UA(ambiente) / UA_saturação(câmara), e
+ *
+ *   excesso = UR(câmara) - UR_entrada
+ *
+ * é o máximo que a purga tira. O mesmo excesso em g/m³ vale bem menos a
+ * 80°C que a 45°C, e purgar sem ganho de secagem só gasta calor.
+ *
+ * - RECIRCULATE: exaustão parada, o calor fica na câmara
+ * - PURGE: excesso >= VENT_PURGE_ON_RH com a câmara já assentada no setpoint
+ *   (VENT_SETTLE_MS dentro de VENT_TEMP_BAND) e folga no heater; volta a recircular com
+ *   excesso <= VENT_PURGE_OFF_RH. Tempo mínimo em cada estado contra
+ *   liga-desliga.
+ * - COOL: temperatura acima de setpoint + overshoot_limit, exaustão cheia
+ *   para tirar calor (o heater já está cortado)
+ *
+ * Coordenação com o PID: a purga entra em rampa (VENT_RAMP_PERCENT_PER_S),
+ * a perda de calor prevista para o duty atual vai para o feed-forward do PID
+ * (vent_control_feedforward) e a purga para na hora se a temperatura cai
+ * mais que VENT_DIP_MAX ou o heater satura. Sem isso cada purga seria um
+ * degrau de perda que o integral só compensa depois da queda.
+ */
+
+// Decisão pelo excesso de umidade relativa sobre o ar de fora aquecido
+#define VENT_PURGE_ON_RH 9.0f           // Excesso para purgar (pontos de %)
+#define VENT_PURGE_OFF_RH 3.0f          // Excesso abaixo do qual volta a recircular
+#define VENT_PURGE_FULL_RH 25.0f        // Excesso com exaustão a 100%
+#define VENT_MIN_STATE_MS 60000         // Tempo mínimo em purga ou recirculação
+
+// Coordenação com o heater
+#define VENT_TEMP_BAND 1.0f             // Só purga com a câmara a menos disso do setpoint (°C)
+#define VENT_SETTLE_MS 300000           // ... por este tempo (fim do pré-aquecimento e do degrau)
+#define VENT_DIP_MAX 1.5f               // Queda abaixo do setpoint que interrompe a purga (°C)
+#define VENT_HEATER_HEADROOM 85.0f      // Saída do heater acima disso: sem folga para purgar (%)
+#define VENT_RAMP_PERCENT_PER_S 0.5f    // Rampa da exaustão (0 -> 100% em 200 s)
+#define VENT_DUTY_MIN 30.0f             // Abaixo disso a ventoinha não gira (%)
+#define VENT_LOSS_W_PER_K 0.15f         // Calor levado pelo ar a 100% por °C acima do ambiente (W/K)
+
+typedef enum {
+    VENT_RECIRCULATE = 0,
+    VENT_PURGE,
+    VENT_COOL
+} vent_state_t;
+
+typedef struct {
+    // Configuração
+    float overshoot_limit;              // Acima de setpoint + isso: COOL (°C)
+    float heater_power_w;               // Potência do heater a 100% (W)
+
+    // Estado
+    vent_state_t state;
+    uint32_t state_since;               // Entrada no estado atual (ms)
+    uint32_t last_ms;                   // Última atualização (rampa)
+    uint32_t band_since;                // Entrada na faixa do setpoint (0 = fora dela)
+    float duty;                         // Duty aplicado à exaustão (%)
+    float excess_rh;                    // Último excesso de umidade relativa (pontos de %)
+
+    // Estatísticas
+    uint32_t purges;
+    uint32_t dip_aborts;                // Purgas interrompidas pela queda de temperatura ou saturação
+    uint64_t purge_ms;                  // Tempo total em purga
+} vent_control_t;
+
+/**
+ * @param overshoot_limit Máximo acima do setpoint (mesmo do corte do heater, °C)
+ * @param heater_power_w Potência nominal do heater (converte a perda em % do PID)
+ */
+void vent_control_init(vent_control_t *vc, float overshoot_limit, float heater_power_w);
+
+/**
+ * Um ciclo da política (a cada leitura nova, depois do PID)
+ * @param humidity Umidade relativa da câmara (%)
+ * @param ambient_rh Umidade relativa do ambiente (%), medida ou padrão
+ * @param heater_output Saída do controle neste ciclo (%)
+ * @param sensor_safe false: sem leitura confiável, exaustão parada
+ * @return Duty da exaustão (%)
+ */
+float vent_control_update(vent_control_t *vc, float temperature, float humidity,
+                          float ambient_temp, float ambient_rh, float setpoint,
+                          float heater_output, bool sensor_safe, uint32_t now_ms);
+
+/**
+ * Saída extra do heater que repõe o calor levado pela exaustão no duty atual (%)
+ */
+float vent_control_feedforward(const vent_control_t *vc, float temperature, float ambient_temp);
+
+/**
+ * Umidade absoluta (g/m³) pela temperatura (°C) e umidade relativa (%)
+ */
+float vent_absolute_humidity(float temperature, float relative_humidity);
+
+const char *vent_control_state_name(vent_state_t state);
+
+#endif // VENT_CONTROL_H
@@ -1,5 +1,7 @@
 #include "display_interface.h"
 #include "hardware_control.h"
+#include "drying_endpoint.h"
+#include "drying_profile.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
@@ -20,7 +22,6 @@ void draw_static_interface(void) {
     st7789_draw_string(10, 55, "TEMPERATURA", YELLOW, BLACK);
     st7789_draw_string(15, 70, "Atual:", WHITE, BLACK);
     st7789_draw_string(15, 85, "Alvo:", WHITE, BLACK);
-    st7789_draw_string(160, 85, "(BTN)", GREEN, BLACK);
     
     // Moldura da barra de temperatura
     st7789_fill_rect(14, 99, 202, 10, WHITE);  // Moldura externa
@@ -111,6 +112,32 @@ void update_humidity_display(float humidity, float prev_humidity) {
     }
 }
 
+// Massa do carretel e taxa de perda (célula de carga), à direita da umidade
+void update_spool_display(float mass_g, float rate_gph, bool valid, bool rate_valid,
+                          float prev_mass_g, float prev_rate_gph, bool prev_valid, bool prev_rate_valid) {
+    char buffer[32];
+    
+    if (valid != prev_valid || (valid && mass_g != prev_mass_g)) {
+        st7789_fill_rect(130, 125, 100, 8, BLACK);
+        if (valid) {
+            sprintf(buffer, "%.1fg", mass_g);
+            st7789_draw_string(130, 125, buffer, WHITE, BLACK);
+        }
+    }
+    
+    bool show_rate = valid && rate_valid;
+    bool prev_show_rate = prev_valid && prev_rate_valid;
+    if (show_rate != prev_show_rate || (show_rate && rate_gph != prev_rate_gph)) {
+        st7789_fill_rect(130, 140, 100, 8, BLACK);
+        if (show_rate) {
+            sprintf(buffer, "%.1fg/h", -rate_gph);
+            st7789_draw_string(130, 140, buffer, YELLOW, BLACK);
+        } else if (valid) {
+            st7789_draw_string(130, 140, "--g/h", GRAY, BLACK);
+        }
+    }
+}
+
 // Atualiza apenas os valores de energia
 void update_energy_display(float current, float total, float prev_current, float prev_total,
                           bool disconnected, bool prev_disconnected) {
@@ -181,7 +208,7 @@ void update_status_display(float pwm_percent, float prev_pwm) {
 // Atualiza estatísticas do sistema (falhas do sensor e eventos unsafe)
 void update_statistics_display(uint32_t sensor_failures, uint32_t unsafe_events,
                               uint32_t prev_failures, uint32_t prev_unsafe,
-                              bool heater_failure, bool prev_heater_failure) {
+                              const char *failure, const char *prev_failure) {
     char buffer[16];
     
     // Atualizar contador de falhas do sensor
@@ -198,15 +225,61 @@ void update_statistics_display(uint32_t sensor_failures, uint32_t unsafe_events,
         st7789_draw_string(190, 265, buffer, (unsafe_events > 0) ? RED : WHITE, BLACK);
     }
     
-    // Mostrar [HEATER FAIL] abaixo de UNSAFE se houver falha
-    if (heater_failure != prev_heater_failure) {
+    // Mostrar a falha do aquecimento ou da ventoinha abaixo de UNSAFE
+    if (failure != prev_failure) {
         st7789_fill_rect(120, 280, 120, 8, BLACK);  // Limpar área
-        if (heater_failure) {
-            st7789_draw_string(125, 280, "HEATER FAILED", RED, BLACK);
+        if (failure) {
+            st7789_draw_string(125, 280, failure, RED, BLACK);
         }
     }
 }
 
+// Tempo restante da secagem na linha abaixo do PWM
+void update_drying_display(uint8_t state, int32_t eta_s, uint8_t prev_state, int32_t prev_eta_s) {
+    // Resolução de minutos: redesenha só quando o minuto muda
+    if (state == prev_state && (state != DRYING_TRACKING || eta_s / 60 == prev_eta_s / 60)) {
+        return;
+    }
+    char buffer[16];
+    st7789_fill_rect(15, 280, 100, 8, BLACK);
+    if (state == DRYING_DONE) {
+        st7789_draw_string(15, 280, "SECO", GREEN, BLACK);
+    } else if (state == DRYING_TRACKING && eta_s >= 0) {
+        uint32_t minutes = (uint32_t)(eta_s + 59) / 60;
+        sprintf(buffer, "ETA %luh%02lu", minutes / 60, minutes % 60);
+        st7789_draw_string(15, 280, buffer, CYAN, BLACK);
+    } else {
+        st7789_draw_string(15, 280, "ETA --", GRAY, BLACK);
+    }
+}
+
+// Perfil ao lado do alvo (o alvo segue o perfil; "(BTN)" = ajuste pelo botão)
+void update_profile_display(uint8_t profile, uint8_t stage, uint8_t stages,
+                            uint8_t prev_profile, uint8_t prev_stage) {
+    if (profile == prev_profile && stage == prev_stage) {
+        return;
+    }
+    st7789_fill_rect(160, 85, 80, 8, BLACK);
+    if (profile == DRYING_PROFILE_MANUAL) {
+        st7789_draw_string(160, 85, "(BTN)", GREEN, BLACK);
+        return;
+    }
+    char buffer[16];
+    sprintf(buffer, "%s %d/%d", drying_profile_name((drying_profile_id_t)profile), stage + 1, stages);
+    st7789_draw_string(160, 85, buffer, YELLOW, BLACK);
+}
+
+// Falha exibida na linha de estatísticas (NULL = nenhuma); heater antes da ventoinha
+static const char *failure_text(const dryer_data_t *data) {
+    if (data->heater_failure || data->thermal_runaway) {
+        return "HEATER FAILED";
+    }
+    if (data->fan_failure) {
+        return "FAN FAILED";
+    }
+    return data->fan_degraded ? "FAN DEGRADED" : NULL;
+}
+
 // Atualiza uptime com formato inteligente para longos períodos
 void update_uptime_display(uint32_t uptime, uint32_t prev_uptime) {
     if (uptime != prev_uptime) {
@@ -233,6 +306,17 @@ void update_uptime_display(uint32_t uptime, uint32_t prev_uptime) {
     }
 }
 
+// Câmara exibida no cabeçalho (várias câmaras no mesmo display)
+void update_chamber_display(uint8_t chamber, uint8_t count) {
+    if (count < 2) {
+        return;
+    }
+    char buffer[16];
+    sprintf(buffer, "CAMARA %d/%d", chamber + 1, count);
+    st7789_fill_rect(70, 25, 100, 8, BLACK);
+    st7789_draw_string(70, 25, buffer, CYAN, BLACK);
+}
+
 // Tela completa de erro crítico
 void display_critical_error_screen(void) {
     // Tela vermelha de emergência
@@ -276,8 +360,15 @@ void update_interface_smart(dryer_data_t *data, dryer_data_t *prev_data) {
     update_temperature_display(data->temperature, data->temp_target, 
                              prev_data->temperature, prev_data->temp_target);
     
+    update_profile_display(data->profile, data->profile_stage, data->profile_stages,
+                           prev_data->profile, prev_data->profile_stage);
+    
     update_humidity_display(data->humidity, prev_data->humidity);
     
+    update_spool_display(data->spool_mass_g, data->mass_loss_rate_gph, data->spool_valid, data->mass_rate_valid,
+                         prev_data->spool_mass_g, prev_data->mass_loss_rate_gph, prev_data->spool_valid,
+                         prev_data->mass_rate_valid);
+    
     update_energy_display(data->energy_current, data->energy_total,
                          prev_data->energy_current, prev_data->energy_total,
                          data->acs712_disconnected, prev_data->acs712_disconnected);
@@ -286,9 +377,12 @@ void update_interface_smart(dryer_data_t *data, dryer_data_t *prev_data) {
     
     update_uptime_display(data->uptime, prev_data->uptime);
     
+    update_drying_display(data->drying_state, data->drying_eta_s,
+                          prev_data->drying_state, prev_data->drying_eta_s);
+    
     update_statistics_display(data->total_sensor_failures, data->total_unsafe_events,
                              prev_data->total_sensor_failures, prev_data->total_unsafe_events,
-                             data->heater_failure, prev_data->heater_failure);
+                             failure_text(data), failure_text(prev_data));
 }
 
 // Tela de inicialização
@@ -299,6 +393,14 @@ void display_init_screen(void) {
     st7789_draw_string(40, 150, "Aquecendo sistema", WHITE, BLACK);
 }
 
+// Seleção do perfil no boot: soltar o botão escolhe o nome mostrado
+void display_profile_select(const char *name) {
+    st7789_fill_rect(0, 90, DISPLAY_WIDTH, 80, BLACK);
+    st7789_draw_string(70, 100, "PERFIL:", WHITE, BLACK);
+    st7789_draw_string(70, 120, name, YELLOW, BLACK);
+    st7789_draw_string(20, 150, "Solte o botao p/ usar", GRAY, BLACK);
+}
+
 // Teste de caracteres
 void display_test_characters(void) {
     st7789_fill_color(BLACK);
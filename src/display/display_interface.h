@@ -18,8 +18,33 @@ typedef struct {
     uint32_t total_sensor_failures;  // Total de falhas de leitura do sensor
     uint32_t total_unsafe_events;    // Total de entradas em modo unsafe
     bool heater_failure;             // Falha detectada no sistema de aquecimento
+    bool thermal_runaway;            // Heater travado desligado pelo detector de runaway
     bool acs712_disconnected;        // Sensor ACS712 desconectado (sistema pode operar sem ele)
     char dht_status[64];      // Última mensagem de erro do sensor
+    float ambient_temperature;       // Temperatura ambiente (°C), medida ou padrão
+    bool ambient_valid;              // Temperatura ambiente veio do sensor
+    float ambient_humidity;          // Umidade ambiente (%), medida ou padrão
+    float vent_percent;              // Duty da exaustão (0-100%)
+    uint8_t vent_state;              // vent_state_t da exaustão
+    float fan_rpm;                   // RPM da ventoinha de circulação (0 sem tacômetro)
+    bool fan_failure;                // Ventoinha de circulação parada (heater cortado)
+    bool fan_degraded;               // Ventoinha girando bem abaixo da referência
+    bool spool_valid;                // Célula de carga com leitura recente
+    float spool_mass_g;              // Massa sobre a plataforma (g)
+    float spool_mass_lost_g;         // Perdida desde o início da sessão (g)
+    float mass_loss_rate_gph;        // Perda de massa (g/h, positiva = secando)
+    bool mass_rate_valid;            // Taxa de perda já calculada
+    uint8_t drying_state;            // drying_state_t do fim da secagem
+    float drying_rate_gph;           // Saída de água estimada (g/h)
+    float drying_removed_g;          // Água tirada no lote (g)
+    int32_t drying_eta_s;            // Tempo até o fim (s, -1 = sem projeção)
+    uint8_t profile;                 // drying_profile_id_t (0 = manual)
+    uint8_t profile_stage;           // Etapa atual (0 = primeira)
+    uint8_t profile_stages;          // Etapas do perfil
+    uint8_t profile_phase;           // drying_profile_phase_t da etapa
+    bool profile_waiting;            // Etapa esperando a primeira leitura válida
+    float profile_setpoint;          // Setpoint pedido pela etapa (°C)
+    uint32_t profile_hold_min;       // Patamar cumprido na etapa (min)
 } dryer_data_t;
 
 // Funções públicas do módulo de interface
@@ -35,9 +60,39 @@ void update_energy_display(float current, float total, float prev_current, float
                           bool disconnected, bool prev_disconnected);
 void update_statistics_display(uint32_t sensor_failures, uint32_t unsafe_events,
                               uint32_t prev_failures, uint32_t prev_unsafe,
-                              bool heater_failure, bool prev_heater_failure);
+                              const char *failure, const char *prev_failure);
 void update_status_display(float pwm_percent, float prev_pwm);
 void update_uptime_display(uint32_t uptime, uint32_t prev_uptime);
+
+/**
+ * Massa do carretel e taxa de perda ao lado da umidade (só com célula de carga)
+ * @param valid Sem leitura válida a área fica vazia
+ */
+void update_spool_display(float mass_g, float rate_gph, bool valid, bool rate_valid,
+                          float prev_mass_g, float prev_rate_gph, bool prev_valid, bool prev_rate_valid);
+
+/**
+ * Tempo restante da secagem abaixo do status ("SECO" no fim, "--" sem projeção)
+ */
+void update_drying_display(uint8_t state, int32_t eta_s, uint8_t prev_state, int32_t prev_eta_s);
+
+/**
+ * Perfil ao lado do alvo: "(BTN)" no manual, nome e etapa ("PA 2/3") com perfil
+ */
+void update_profile_display(uint8_t profile, uint8_t stage, uint8_t stages,
+                            uint8_t prev_profile, uint8_t prev_stage);
+
+/**
+ * Seleção do perfil no boot (botão segurado): nome do perfil mostrado agora
+ */
+void display_profile_select(const char *name);
+
+/**
+ * Câmara exibida no cabeçalho ("CAMARA n/N" no lugar da versão)
+ * @param chamber Índice da câmara (0 = primeira)
+ * @param count Número de câmaras; com uma só o cabeçalho não muda
+ */
+void update_chamber_display(uint8_t chamber, uint8_t count);
 void display_critical_error_screen(void);
 
 #endif // DISPLAY_INTERFACE_H
\ No newline at end of file
@@ -0,0 +1,223 @@
+#ifndef DRYER_CONFIG_H
+#define DRYER_CONFIG_H
+
+// Configurações principais do sistema
+// (compartilhadas entre o firmware e o simulador de host em sim/)
+#define UPDATE_INTERVAL_MS 5000        // Display e log a cada 5 segundos
+#define TEMP_TARGET_DEFAULT 45         // Temperatura alvo padrão (°C)
+#define TEMP_OVERSHOOT_LIMIT 3.0f      // Limite de overshoot crítico (°C)
+
+// Núcleo 0: sensores, controle, PWM, botão e LED; núcleo 1: display, log e
+// estatísticas. Definir como 0 para rodar tudo no núcleo 0 (comparação no simulador)
+#ifndef DUAL_CORE_ENABLED
+#define DUAL_CORE_ENABLED 1
+#endif
+
+// Escala dinâmica do clock: clk_sys = PLL / CLOCK_IDLE_DIV em espera e
+// PLL / CLOCK_BOOST_DIV durante atualizações do display e cálculo do MPC.
+// Definir como 0 para rodar fixo em 125 MHz (comparação no simulador)
+#ifndef CLOCK_SCALING_ENABLED
+#define CLOCK_SCALING_ENABLED 1
+#endif
+#ifndef CLOCK_IDLE_DIV
+#define CLOCK_IDLE_DIV 4               // 31.25 MHz
+#endif
+#ifndef CLOCK_BOOST_DIV
+#define CLOCK_BOOST_DIV 1              // 125 MHz
+#endif
+
+// Acionamento do heater (heater_drive_t): HEATER_DRIVE_PWM, HEATER_DRIVE_SIGMA_DELTA
+// (resolução fina perto do setpoint) ou HEATER_DRIVE_BURST (poucas bordas no
+// MOSFET). Pode ser trocado em operação (hardware_control_set_heater_drive).
+#ifndef HEATER_DRIVE_DEFAULT
+#define HEATER_DRIVE_DEFAULT HEATER_DRIVE_PWM
+#endif
+
+// Heater dividido em zonas na mesma fonte de 12 V, uma saída PWM por zona (o
+// primeiro pino é o HEATER_PIN). Janelas ligadas defasadas e pico de corrente
+// limitado ao orçamento (heater_zones). Só com acionamento PWM.
+#ifndef HEATER_ZONE_COUNT
+#define HEATER_ZONE_COUNT 1
+#endif
+#define HEATER_ZONE_PINS {HEATER_PIN, 2, 4, 6}  // Slices 5, 1, 2 e 3
+#define HEATER_SUPPLY_VOLTAGE 12.0f
+#define HEATER_ZONE_CURRENT_A (HEATER_NOMINAL_POWER_W / HEATER_SUPPLY_VOLTAGE / HEATER_ZONE_COUNT)
+#ifndef HEATER_PEAK_CURRENT_BUDGET_A
+#define HEATER_PEAK_CURRENT_BUDGET_A (HEATER_NOMINAL_POWER_W / HEATER_SUPPLY_VOLTAGE * CHAMBER_COUNT) // Sem corte
+#endif
+// Definir como 0 para ligar todas as zonas na mesma borda (comparação no simulador)
+#ifndef HEATER_ZONE_STAGGER_ENABLED
+#define HEATER_ZONE_STAGGER_ENABLED 1
+#endif
+
+// Várias câmaras independentes no mesmo RP2040: DHT22, heater, PID, setpoint e
+// segurança próprios, tudo por instância. Uma linha da tabela por câmara:
+// { DHT22, heater, ACS712, NTC do bloco, exaustão, tacômetro }. Os heaters ficam em slices PWM
+// diferentes e dividem a fonte como as zonas (fases e HEATER_PEAK_CURRENT_BUDGET_A).
+// O ADC só tem os GPIO 26-28 e o 27 é o heater da primeira câmara: ACS712 e NTC
+// só nela, as outras rodam como com o ACS712 desconectado. Nelas o supervisor
+// não tem SAFETY_FAULT_CURRENT: MOSFET em curto (heater ligado com 0% de duty)
+// ou heater aberto não são detectados, só o overshoot e o thermal runaway
+// cortam (o boot avisa no log). O DHT22 ambiente
+// (AMBIENT_SENSOR_ENABLED) é lido pela primeira e vale para todas.
+#ifndef CHAMBER_COUNT
+#define CHAMBER_COUNT 1
+#endif
+#define CHAMBER_TABLE { \
+    { DHT22_PIN, HEATER_PIN, ENERGY_SENSOR_PIN, BLOCK_NTC_PIN, 12, FAN_TACH_PIN }, \
+    { 7, 2, SENSOR_PIN_NONE, SENSOR_PIN_NONE, 13, SENSOR_PIN_NONE }, \
+    { 8, 4, SENSOR_PIN_NONE, SENSOR_PIN_NONE, 14, SENSOR_PIN_NONE }, \
+    { 0, 6, SENSOR_PIN_NONE, SENSOR_PIN_NONE, 1, SENSOR_PIN_NONE }, \
+}
+// Ventoinha de exaustão por câmara (vent_control): purga o ar úmido e
+// recircula quando o ambiente não tem ar mais seco. GPIO na última coluna
+// da CHAMBER_TABLE, slices 6, 6, 7 e 0 (nenhum divide slice com heater/zona).
+// Tacômetro da ventoinha de circulação (fan_tach) só na primeira câmara: o
+// contador precisa de um slice inteiro e com quatro câmaras e exaustão só o
+// slice 4 sobra (GPIO 9, canal B; o DHT22 da quarta câmara fica no GPIO 0).
+// Definir como 0 para a exaustão parada (comparação no simulador)
+#ifndef VENT_ENABLED
+#define VENT_ENABLED 1
+#endif
+// Fim da secagem (drying_endpoint): tempo restante pela tendência da umidade
+// no display; com 1 o heater para sozinho no fim (até um setpoint novo)
+#ifndef DRYING_AUTO_STOP
+#define DRYING_AUTO_STOP 0
+#endif
+// Perfis de secagem (drying_profile): com o botão segurado no boot o display
+// passa pelos perfis a cada PROFILE_SELECT_STEP_MS e soltar escolhe o
+// mostrado (MANUAL = só o botão). O progresso fica no flash e continua
+// depois de uma queda de energia. DRYING_PROFILE_DEFAULT: perfil do primeiro
+// boot (sem checkpoint no flash).
+#ifndef DRYING_PROFILE_DEFAULT
+#define DRYING_PROFILE_DEFAULT DRYING_PROFILE_MANUAL
+#endif
+#define PROFILE_SELECT_STEP_MS 1500
+// Manutenção econômica (eco_hold): no setpoint, o heater passa a pulsos em
+// 100% calculados pela perda medida da câmara, mantendo a temperatura na
+// parte de baixo de setpoint ± ECO_HOLD_BAND (o que o material aceita).
+// A economia contra a potência do PID no setpoint (ACS712) vai para o log.
+// Só com o PID (o MPC segura o setpoint como antes)
+#ifndef ECO_HOLD_ENABLED
+#define ECO_HOLD_ENABLED 0
+#endif
+#ifndef ECO_HOLD_BAND
+#define ECO_HOLD_BAND 2.0f
+#endif
+#define CHAMBER_DISPLAY_CYCLE_MS 10000  // Display passa para a próxima câmara
+#define CHAMBER_DISPLAY_HOLD_MS 30000   // Depois do botão o display fica na câmara ajustada
+#if CHAMBER_COUNT > 1 && HEATER_ZONE_COUNT > 1
+#error "Heater zones and multiple chambers share the same PWM outputs"
+#endif
+
+// Tarefas do escalonador: período e prazo (ms)
+// O controle não tem período: roda a cada leitura nova da tarefa de sensores.
+// Botão e LED também não: interrupção de borda do botão e alarme da próxima
+// troca do LED (scheduler_notify_in), sem polling entre eventos.
+#define SENSOR_TASK_PERIOD_MS 2500     // DHT22 + ACS712 (DHT22 exige 2 s entre leituras)
+#define SENSOR_TASK_DEADLINE_MS 100    // Leitura do DHT22 leva ~5 ms
+#define CONTROL_TASK_DEADLINE_MS 50    // Da leitura nova até o PWM atualizado
+#define BUTTON_TASK_DEADLINE_MS 20     // Da borda (ou fim do debounce) até o setpoint novo
+#define CASCADE_TASK_DEADLINE_MS 20
+#define LOAD_CELL_TASK_PERIOD_MS 50    // HX711 a 10 SPS: duas consultas por conversão
+#define LOAD_CELL_TASK_DEADLINE_MS 10  // Leitura de 25 bits leva ~50 us
+#define UI_TASK_PERIOD_MS UPDATE_INTERVAL_MS
+#define UI_SETPOINT_DEADLINE_MS 50    // Do botão até o novo setpoint no display
+#define LOG_TASK_PERIOD_MS UPDATE_INTERVAL_MS
+#define SCHEDULER_STATS_PERIOD_MS 600000 // Overruns e jitter no log a cada 10 min
+
+// Disparo por evento (send-on-delta): PID, display e log só rodam quando as entradas
+// mudam pelo menos o delta ou passou o intervalo máximo. Definir como 0 para rodar
+// em todo ciclo (comparação no simulador); a segurança nunca é pulada
+#ifndef EVENT_TRIGGER_ENABLED
+#define EVENT_TRIGGER_ENABLED 1
+#endif
+#define CONTROL_EVENT_DELTA_TEMP 0.15f // PID: temperatura (°C); leituras andam de 0.1 em 0.1
+#define CONTROL_EVENT_MAX_MS 15000     // PID: recálculo mínimo (o integral usa o dt medido)
+#define UI_EVENT_DELTA_TEMP 0.15f      // Display e log: temperatura (°C)
+#define UI_EVENT_DELTA_HUMIDITY 1.0f   // Display e log: umidade (%)
+#define UI_EVENT_DELTA_POWER 1.0f      // Display e log: potência (W)
+#define UI_EVENT_DELTA_PWM 2.0f        // Display e log: PWM (%)
+#define UI_EVENT_MAX_MS 30000          // Display: atualização mínima
+#define LOG_EVENT_MAX_MS 60000         // Log: uma linha pelo menos a cada minuto
+
+// Configurações do PID
+#define PID_KP 32.0f                   // Ganho proporcional
+#define PID_KI 0.05f                   // Ganho integral
+#define PID_KD 5.0f                    // Ganho derivativo
+#define PID_OUTPUT_MIN 0.0f            // PWM mínimo (0%)
+#define PID_OUTPUT_MAX 100.0f          // PWM máximo (100%)
+#define PID_SAMPLE_TIME_MS 1000        // Calcular PID a cada 1 segundo
+
+// Estrutura do PID (dois graus de liberdade e filtro do derivativo)
+#define PID_SETPOINT_WEIGHT_B 1.0f     // Peso do setpoint no P (1 = PID clássico)
+#define PID_SETPOINT_WEIGHT_C 0.0f     // Peso do setpoint no D (0 = derivativo sobre PV)
+#define PID_DERIVATIVE_FILTER_N 0.5f   // Filtro do D: Tf = Kd / (Kp * N), até ~1 ciclo de controle
+#define PID_VELOCITY_FORM 1            // Forma de velocidade: anti-windup sem limite do integral
+
+// Tabela de ganhos por setpoint { setpoint, Kp, Ki, Kd } (gain scheduling)
+// Entre as entradas os ganhos são interpolados; fora da faixa vale a mais próxima.
+// Gerada com: sim/pid_sweep --lhs 3000 --setpoints 45,60,80 --emit-schedule --kd 10:10,
+// com a estrutura acima (b=1, c=0, N=0.5, forma de velocidade) e PID a cada
+// SENSOR_TASK_PERIOD_MS. A varredura não simula feed-forward nem pré-aquecimento.
+// Kd fica fixo: com o filtro N=0.5 o D é pequeno e o custo em cada setpoint varia
+// menos de 0.1% entre Kd 0 e 50, então o Kd livre só seguia o ruído da busca
+// (27.9 a 45°C, 0.9 a 80°C). Kp e Ki variam pouco pelo mesmo motivo.
+#define PID_GAIN_SCHEDULE { \
+    { 45.0f, 54.670f, 0.4236f, 10.000f }, \
+    { 60.0f, 52.083f, 0.3634f, 10.000f }, \
+    { 80.0f, 59.439f, 0.4877f, 10.000f }, \
+}
+
+// Feed-forward da potência de manutenção (setpoint - ambiente, aprendido online)
+// Definir como 0 para comparar com o PID puro no simulador
+#ifndef FEEDFORWARD_ENABLED
+#define FEEDFORWARD_ENABLED 1
+#endif
+
+// Pré-aquecimento com potência máxima após boot e aumento de setpoint
+// Definir como 0 para comparar com o PID partindo do zero no simulador
+#ifndef PREHEAT_ENABLED
+#define PREHEAT_ENABLED 1
+#endif
+#define PREHEAT_POWER_MAX 100.0f       // Saída durante o boost (%)
+
+// Controle preditivo (MPC) no lugar do PID, com modelo FOPDT identificado online
+// O ganho do modelo vem do feed-forward; o pré-aquecimento não é usado (o MPC faz o boost)
+#ifndef MPC_ENABLED
+#define MPC_ENABLED 0
+#endif
+#define MPC_SAMPLE_TIME_MS (2 * SENSOR_TASK_PERIOD_MS) // Um cálculo a cada duas leituras
+#define MPC_HORIZON_S 900.0f           // Horizonte de predição (s)
+#define MPC_MOVE_S 30.0f               // Saída escolhida vale por isso na predição, depois a manutenção (s)
+#define MPC_REF_TIME_S 0.0f            // Trajetória de referência até o setpoint (s), 0 = degrau
+#define MPC_MOVE_WEIGHT 4.0f           // Penalidade da variação da saída (relativa)
+#define MPC_OVERSHOOT_MAX 0.5f         // Restrição da predição acima do setpoint (°C), < TEMP_OVERSHOOT_LIMIT
+#define MPC_TAU_DEFAULT_S 2400.0f      // Modelo inicial: constante de tempo da câmara (s)
+#define MPC_DEAD_DEFAULT_S 45.0f       // Modelo inicial: bloco do heater + DHT22 (s)
+
+// Controle em cascata: a saída do PID da câmara vira o alvo do bloco do heater,
+// regulado por uma malha interna sobre o NTC do bloco a cada 100 ms (10 Hz)
+// Definir como 1 com o NTC instalado no bloco (BLOCK_NTC_PIN)
+#ifndef CASCADE_ENABLED
+#define CASCADE_ENABLED 0
+#endif
+#define CASCADE_KP 16.0f               // % de PWM por °C de erro do bloco
+#define CASCADE_KI 0.5f                // Constante de tempo do bloco ~33 s (Ki = Kp / tau)
+#define CASCADE_KD 0.0f
+#define CASCADE_SAMPLE_TIME_MS 100     // Período da tarefa da malha interna
+#define CASCADE_BLOCK_TEMP_MAX 125.0f  // Alvo máximo do bloco (°C), corte 5°C acima
+#define CASCADE_BLOCK_DELTA_FULL 40.0f // Bloco - câmara com 100% (48 W / 1.2 W/K)
+
+// Thermal runaway: subida observada x subida esperada pela energia aplicada
+#define HEATER_NOMINAL_POWER_W 48.0f   // Potência do heater a 100% (12 V / 3 ohm), sem o ACS712
+#define RUNAWAY_HEAT_CAPACITY 2000.0f  // Capacidade térmica efetiva da câmara (J/K), acima da real
+#define RUNAWAY_WINDOW_MS 60000        // Janela da subida observada
+#define RUNAWAY_LAG_MS 45000           // Atraso bloco -> ar -> DHT22 (janela + atraso <= 160 s)
+#define RUNAWAY_LOSS_MARGIN 1.5f       // Perda = manutenção do feed-forward na temperatura atual x margem
+#define RUNAWAY_MIN_EXPECTED_RISE 0.5f // Subida esperada mínima para julgar (°C)
+#define RUNAWAY_TRIP_RATIO 0.35f       // Observado abaixo de 35% do esperado: suspeito
+#define RUNAWAY_CLEAR_RATIO 0.6f       // Volta ao normal acima de 60% (histerese)
+#define RUNAWAY_CONFIRM_MS 10000       // Suspeito por 10 s seguidos: corte travado
+
+#endif // DRYER_CONFIG_H
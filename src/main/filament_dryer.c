@@ -24,34 +24,91 @@
 #include "sensor_manager.h"
 #include "hardware_control.h"
 #include "pid_controller.h"
+#include "feedforward.h"
+#include "preheat.h"
+#include "cascade.h"
+#include "mpc_controller.h"
+#include "safety_supervisor.h"
+#include "thermal_runaway.h"
+#include "vent_control.h"
+#include "drying_endpoint.h"
+#include "drying_profile.h"
+#include "eco_hold.h"
 #include "logger.h"
+#include "scheduler.h"
+#include "seqlock.h"
+#include "send_on_delta.h"
+#include "clock_scaling.h"
+#include "flash_store.h"
+#include "dryer_config.h"
 #include "pico/time.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
 #include <stdio.h>
 #include <string.h>
 
 #define TAG "Main"
 
-// Configurações principais do sistema
-#define UPDATE_INTERVAL_MS 5000        // Atualiza a cada 5 segundos
-#define TEMP_TARGET_DEFAULT 45         // Temperatura alvo padrão (°C)
-#define TEMP_OVERSHOOT_LIMIT 3.0f      // Limite de overshoot crítico (°C)
+// Pinos de uma câmara (linha da CHAMBER_TABLE)
+typedef struct {
+    uint8_t dht22_pin;
+    uint8_t heater_pin;
+    uint8_t energy_pin;         // ACS712 ou SENSOR_PIN_NONE
+    uint8_t ntc_pin;            // NTC do bloco ou SENSOR_PIN_NONE
+    uint8_t vent_pin;           // Ventoinha de exaustão (PWM)
+    uint8_t tach_pin;           // Tacômetro da ventoinha de circulação ou SENSOR_PIN_NONE
+} chamber_config_t;
 
-// Configurações do PID
-#define PID_KP 32.0f                   // Ganho proporcional
-#define PID_KI 0.05f                   // Ganho integral
-#define PID_KD 5f                      // Ganho derivativo
-#define PID_OUTPUT_MIN 0.0f            // PWM mínimo (0%)
-#define PID_OUTPUT_MAX 100.0f          // PWM máximo (100%)
-#define PID_SAMPLE_TIME_MS 1000        // Calcular PID a cada 1 segundo
+static const chamber_config_t chamber_table[] = CHAMBER_TABLE;
+_Static_assert(CHAMBER_COUNT >= 1 && CHAMBER_COUNT <= sizeof(chamber_table) / sizeof(chamber_table[0]) &&
+               CHAMBER_COUNT <= SAFETY_CHAMBERS_MAX, "CHAMBER_COUNT must match a CHAMBER_TABLE row");
+
+// Registro do checkpoint no flash: perfil escolhido no boot e progresso de cada câmara
+typedef struct {
+    uint8_t selected;                   // drying_profile_id_t escolhido no boot
+    uint8_t chamber_count;              // Checkpoint de outra configuração não vale
+    uint16_t reserved;
+    drying_profile_checkpoint_t chamber[CHAMBER_COUNT];
+} dryer_checkpoint_t;
+
+_Static_assert(sizeof(dryer_checkpoint_t) <= FLASH_STORE_MAX_DATA, "checkpoint must fit one flash record");
 
 // Inicialização de todos os módulos do sistema
 void system_init(void) {
     // Módulos de hardware
     hardware_control_init();
+#if HEATER_ZONE_COUNT > 1
+    static const uint8_t zone_pins[] = HEATER_ZONE_PINS;
+    float zone_current[HEATER_ZONE_COUNT];
+    for (int i = 0; i < HEATER_ZONE_COUNT; i++) {
+        zone_current[i] = HEATER_ZONE_CURRENT_A;
+    }
+    hardware_control_heater_zones_init(zone_pins, zone_current, HEATER_ZONE_COUNT,
+                                       HEATER_PEAK_CURRENT_BUDGET_A, HEATER_ZONE_STAGGER_ENABLED);
+#endif
+#if CHAMBER_COUNT > 1
+    // Um heater por câmara, na ordem da tabela (índice do heater = índice da câmara)
+    uint8_t heater_pins[CHAMBER_COUNT];
+    float heater_current[CHAMBER_COUNT];
+    for (int i = 0; i < CHAMBER_COUNT; i++) {
+        heater_pins[i] = chamber_table[i].heater_pin;
+        heater_current[i] = HEATER_NOMINAL_POWER_W / HEATER_SUPPLY_VOLTAGE;
+    }
+    hardware_control_heaters_init(heater_pins, heater_current, CHAMBER_COUNT,
+                                  HEATER_PEAK_CURRENT_BUDGET_A, HEATER_ZONE_STAGGER_ENABLED);
+#endif
+    hardware_control_set_heater_drive(HEATER_DRIVE_DEFAULT);
+#if VENT_ENABLED
+    // Uma exaustão por câmara (índice da ventoinha = índice da câmara)
+    uint8_t vent_pins[CHAMBER_COUNT];
+    for (int i = 0; i < CHAMBER_COUNT; i++) {
+        vent_pins[i] = chamber_table[i].vent_pin;
+    }
+    hardware_control_vent_init(vent_pins, CHAMBER_COUNT);
+#endif
     
     // Módulos de entrada
     button_controller_init();
-    sensor_manager_init();
     
     // Display
     LOGI(TAG, "Initializing display...");
@@ -73,39 +130,1057 @@ static void process_sensor_data(sensor_data_t *sensor_data, dryer_data_t *dryer_
     dryer_data->total_sensor_failures += sensor_data->sensor_failure_event ? 1 : 0;
     dryer_data->total_unsafe_events += sensor_data->unsafe_event ? 1 : 0;
     strcpy(dryer_data->dht_status, sensor_data->dht_status);
+    dryer_data->ambient_temperature = sensor_data->ambient_temperature;
+    dryer_data->ambient_valid = sensor_data->ambient_valid;
+    dryer_data->ambient_humidity = sensor_data->ambient_humidity;
+    dryer_data->fan_rpm = sensor_data->fan_monitored ? sensor_data->fan_rpm : 0.0f;
+    dryer_data->fan_failure = sensor_data->fan_failure;
+    dryer_data->fan_degraded = sensor_data->fan_degraded;
+    dryer_data->spool_valid = sensor_data->spool_valid;
+    dryer_data->spool_mass_g = sensor_data->spool_mass_g;
+    dryer_data->spool_mass_lost_g = sensor_data->spool_mass_lost_g;
+    dryer_data->mass_loss_rate_gph = sensor_data->mass_loss_rate_gph;
+    dryer_data->mass_rate_valid = sensor_data->mass_rate_valid;
 }
 
-int main() {
-    // Variáveis para controlar atualizações
-    uint32_t last_update = 0;
-    uint32_t start_time = to_ms_since_boot(get_absolute_time());
+// Contadores dos módulos para o log de estatísticas (cópia do núcleo 0 para o 1)
+typedef struct {
+    vent_state_t vent_state;
+    float vent_duty;
+    float vent_excess_rh;
+    uint32_t vent_purges;
+    uint32_t vent_dip_aborts;
+    uint32_t vent_purge_s;
+    bool fan_tach;                      // Exaustão com tacômetro
+    float fan_rpm;
+    float fan_baseline_rpm;
+    uint32_t fan_stalls;
+    uint32_t fan_degradations;
+    drying_state_t drying_state;
+    float drying_rate_gph;
+    float drying_peak_rate_gph;
+    float drying_removed_g;
+    float drying_tau_h;
+    float drying_remaining_g;
+    int32_t drying_eta_s;               // -1 = sem estimativa
+#if ECO_HOLD_ENABLED && !MPC_ENABLED
+    eco_hold_state_t eco_state;
+    bool eco_energy_measured;
+    uint32_t eco_pulses;
+    float eco_loss_rate;
+    float eco_lag_s;
+    float eco_hours;
+    float eco_wh;
+    float eco_baseline_wh;
+    float eco_saved_wh;
+    uint32_t eco_exits;
+#endif
+#if LOAD_CELL_ENABLED
+    float load_cell_counts;             // Contagens filtradas do HX711
+    uint32_t load_cell_samples;
+    float load_cell_mass_g;
+    float load_cell_lost_g;
+    float load_cell_rate_gph;
+    bool load_cell_rate_valid;
+#endif
+} chamber_stats_t;
 
-    stdio_init_all();
-    absolute_time_t deadline = make_timeout_time_ms(5000);
-    while (!stdio_usb_connected() && !time_reached(deadline)) {
-        sleep_ms(10); // Aguarda estabilizar USB
-    }  
+// Uma câmara: sensores, controladores e dados próprios (índice = heater no hardware_control)
+typedef struct {
+    uint8_t index;
+    sensor_manager_t sensors;
+
+    // Núcleo 0 (sensores, controle, PWM, botão): único escritor de data
+    dryer_data_t data;
+    sensor_data_t sensor_data;
+
+    pid_controller_t pid;
+    feedforward_t feedforward;
+    preheat_t preheat;
+    mpc_controller_t mpc;
+    cascade_t cascade;
+    thermal_runaway_t runaway;
+    vent_control_t vent;
+    drying_endpoint_t drying;
+    drying_profile_t profile;
+    eco_hold_t eco;
+    double heater_wh;                   // Energia do heater para o eco hold (ACS712 ou nominal pelo duty)
+    send_on_delta_t control_trigger;    // PID só com entrada nova (núcleo 0)
+
+    // Cópia de data publicada para o núcleo 1 (display e log)
+    seqlock_t snapshot_lock;
+    dryer_data_t snapshot;
+
+    // Contadores publicados para o log de estatísticas (núcleo 1)
+    seqlock_t stats_lock;
+    chamber_stats_t stats;
+
+    send_on_delta_t log_trigger;        // Linha de log só com mudança (núcleo 1)
+} dryer_chamber_t;
+
+// Estado compartilhado pelas tarefas
+typedef struct {
+    dryer_chamber_t chamber[CHAMBER_COUNT];
+    uint32_t start_time;
+
+    // Núcleo 1: duas cópias alternadas, a exibida e a nova (sem copiar uma na outra)
+    dryer_data_t ui_view[2];
+    uint8_t ui_shown;                   // Índice da cópia que está no display
+    volatile uint8_t ui_chamber;        // Câmara no display (e no botão); escrita pelo núcleo 1
+    uint32_t ui_chamber_since;          // Quando o display passou para ela (ms)
+    volatile uint32_t button_ms;        // Último ajuste pelo botão (ms, núcleo 0)
+    bool error_screen_displayed;
+    send_on_delta_t ui_trigger;         // Display só com mudança visível (núcleo 1)
+
+    scheduler_t scheduler;              // Tarefas do núcleo 0
+    scheduler_t scheduler_core1;        // Tarefas do núcleo 1
+    scheduler_t *scheduler_ui;          // Onde ficam as tarefas de display e log
+    int control_task;
+    int button_task;
+    int led_task;
+    int setpoint_display_task;
+    int safety_log_task;
+    int checkpoint_task;
+
+    // Checkpoint dos perfis no flash (núcleo 0) e contadores publicados para o núcleo 1
+    flash_store_t flash;
+    seqlock_t checkpoint_lock;
+    flash_store_stats_t checkpoint_stats;
+    uint8_t profile_selected;           // drying_profile_id_t escolhido no boot
+} dryer_app_t;
+
+// Estado da estufa (estático: fora da pilha, compartilhado pelas tarefas e núcleos)
+static dryer_app_t app;
+
+// Publica data para o núcleo 1 sem nunca esperar por ele
+static void snapshot_publish(dryer_chamber_t *ch) {
+    seqlock_write_begin(&ch->snapshot_lock);
+    ch->snapshot = ch->data;
+    seqlock_write_end(&ch->snapshot_lock);
+}
+
+// Cópia consistente da última publicação (repete se o núcleo 0 escreveu no meio)
+static void snapshot_read(dryer_chamber_t *ch, dryer_data_t *out) {
+    uint32_t seq;
+    do {
+        seq = seqlock_read_begin(&ch->snapshot_lock);
+        *out = ch->snapshot;
+    } while (seqlock_read_retry(&ch->snapshot_lock, seq));
+}
+
+// Publica os contadores dos módulos (escritos pelo núcleo 0) para o log de estatísticas
+static void stats_publish(dryer_chamber_t *ch) {
+    seqlock_write_begin(&ch->stats_lock);
+    ch->stats.vent_state = ch->vent.state;
+    ch->stats.vent_duty = ch->vent.duty;
+    ch->stats.vent_excess_rh = ch->vent.excess_rh;
+    ch->stats.vent_purges = ch->vent.purges;
+    ch->stats.vent_dip_aborts = ch->vent.dip_aborts;
+    ch->stats.vent_purge_s = (uint32_t)(ch->vent.purge_ms / 1000u);
+    ch->stats.fan_tach = ch->sensors.config.tach_pin != SENSOR_PIN_NONE;
+    ch->stats.fan_rpm = ch->sensors.fan.sample.rpm;
+    ch->stats.fan_baseline_rpm = ch->sensors.fan.baseline_rpm;
+    ch->stats.fan_stalls = ch->sensors.fan.stalls;
+    ch->stats.fan_degradations = ch->sensors.fan.degradations;
+    ch->stats.drying_state = ch->drying.state;
+    ch->stats.drying_rate_gph = ch->drying.rate_gph;
+    ch->stats.drying_peak_rate_gph = ch->drying.peak_rate_gph;
+    ch->stats.drying_removed_g = ch->drying.removed_g;
+    ch->stats.drying_tau_h = ch->drying.tau_h;
+    ch->stats.drying_remaining_g = ch->drying.remaining_g;
+    ch->stats.drying_eta_s = ch->drying.eta_s;
+#if ECO_HOLD_ENABLED && !MPC_ENABLED
+    ch->stats.eco_state = ch->eco.state;
+    ch->stats.eco_energy_measured = ch->eco.energy_measured;
+    ch->stats.eco_pulses = ch->eco.pulses;
+    ch->stats.eco_loss_rate = ch->eco.loss_rate;
+    ch->stats.eco_lag_s = ch->eco.lag_s;
+    ch->stats.eco_hours = ch->eco.eco_ms / 3600000.0f;
+    ch->stats.eco_wh = (float)ch->eco.eco_wh;
+    ch->stats.eco_baseline_wh = (float)ch->eco.baseline_wh;
+    ch->stats.eco_saved_wh = eco_hold_saved_wh(&ch->eco);
+    ch->stats.eco_exits = ch->eco.exits;
+#endif
+#if LOAD_CELL_ENABLED
+    const load_cell_t *lc = &ch->sensors.load_cell;
+    ch->stats.load_cell_counts = load_cell_raw_counts(lc);
+    ch->stats.load_cell_samples = lc->samples;
+    ch->stats.load_cell_mass_g = lc->mass_g;
+    ch->stats.load_cell_lost_g = lc->start_mass_g - lc->mass_g;
+    ch->stats.load_cell_rate_gph = lc->loss_rate_gph;
+    ch->stats.load_cell_rate_valid = lc->rate_valid;
+#endif
+    seqlock_write_end(&ch->stats_lock);
+}
+
+static void stats_read(dryer_chamber_t *ch, chamber_stats_t *out) {
+    uint32_t seq;
+    do {
+        seq = seqlock_read_begin(&ch->stats_lock);
+        *out = ch->stats;
+    } while (seqlock_read_retry(&ch->stats_lock, seq));
+}
+
+// Marca das linhas de log com várias câmaras ("" com uma só)
+static const char *chamber_tag(const dryer_chamber_t *ch) {
+    static const char *const tags[] = { " [1]", " [2]", " [3]", " [4]" };
+    return CHAMBER_COUNT > 1 ? tags[ch->index] : "";
+}
+
+// Estado discreto exibido (flags e contadores) como uma entrada do send-on-delta:
+// qualquer mudança dispara
+static float status_code(const dryer_data_t *d) {
+    uint32_t flags = (d->sensor_safe ? 1u : 0u) | (d->heater_failure ? 2u : 0u) |
+                     (d->thermal_runaway ? 4u : 0u) | (d->acs712_disconnected ? 8u : 0u) |
+                     ((uint32_t)d->vent_state << 4) | (d->fan_failure ? 64u : 0u) |
+                     (d->fan_degraded ? 128u : 0u) | ((uint32_t)d->profile << 8) |
+                     ((uint32_t)d->profile_stage << 11);
+    return (float)(flags + 16384u * (d->total_sensor_failures + d->total_unsafe_events));
+}
+
+// Configura os disparos por evento; sem EVENT_TRIGGER_ENABLED os deltas são 0
+// (todo ciclo roda) e os contadores continuam valendo para comparação
+static void event_triggers_init(dryer_app_t *app) {
+    static const char *const control_names[] = { "control[1]", "control[2]", "control[3]", "control[4]" };
+    static const char *const log_names[] = { "log[1]", "log[2]", "log[3]", "log[4]" };
+    float on = EVENT_TRIGGER_ENABLED ? 1.0f : 0.0f;
     
-    printf("\n=== ESTUFA DE FILAMENTOS v2.0 ===\n");
-    LOGI(TAG, "Starting system...");
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        send_on_delta_t *control = &app->chamber[c].control_trigger;
+        send_on_delta_init(control, CHAMBER_COUNT > 1 ? control_names[c] : "control", CONTROL_EVENT_MAX_MS);
+        send_on_delta_add_input(control, on * CONTROL_EVENT_DELTA_TEMP);  // Temperatura
+        send_on_delta_add_input(control, on * 0.5f);                      // Setpoint
+        send_on_delta_add_input(control, on * CONTROL_EVENT_DELTA_TEMP);  // Ambiente
+        send_on_delta_add_input(control, on * 0.5f);                      // Compensação da exaustão (%)
+    }
     
-    // Initialize the onboard LED
-    int rc = hardware_control_led_init();
-    if (rc != 0) {
-        LOGE(TAG, "Failed to initialize LED");
+    // Display (câmara exibida) e log de cada câmara
+    for (int i = 0; i <= CHAMBER_COUNT; i++) {
+        send_on_delta_t *trig = i == 0 ? &app->ui_trigger : &app->chamber[i - 1].log_trigger;
+        const char *name = i == 0 ? "ui" : CHAMBER_COUNT > 1 ? log_names[i - 1] : "log";
+        send_on_delta_init(trig, name, i == 0 ? UI_EVENT_MAX_MS : LOG_EVENT_MAX_MS);
+        send_on_delta_add_input(trig, on * UI_EVENT_DELTA_TEMP);       // Temperatura
+        send_on_delta_add_input(trig, on * UI_EVENT_DELTA_HUMIDITY);   // Umidade
+        send_on_delta_add_input(trig, on * UI_EVENT_DELTA_POWER);      // Potência
+        send_on_delta_add_input(trig, on * UI_EVENT_DELTA_PWM);        // PWM
+        send_on_delta_add_input(trig, on * 0.5f);                      // Setpoint
+        send_on_delta_add_input(trig, on * 0.5f);                      // Flags e contadores
     }
+    // Display mostra também energia acumulada e uptime em minutos
+    send_on_delta_add_input(&app->ui_trigger, on * 0.1f);              // Energia (Wh)
+    send_on_delta_add_input(&app->ui_trigger, on * 0.5f);              // Uptime (min)
+}
+
+// Entradas comuns de display e log, na ordem de event_triggers_init()
+static void event_inputs(const dryer_data_t *d, float *inputs) {
+    inputs[0] = d->temperature;
+    inputs[1] = d->humidity;
+    inputs[2] = d->energy_current;
+    inputs[3] = d->pwm_percent;
+    inputs[4] = d->temp_target;
+    inputs[5] = status_code(d);
+    inputs[6] = d->energy_total;
+    inputs[7] = (float)(d->uptime / 60u);
+}
+
+// Tarefa de sensores: DHT22, ambiente e ACS712 de cada câmara; libera o controle a cada leitura
+static void sensors_update_chamber(dryer_app_t *app, dryer_chamber_t *ch, uint32_t current_time) {
+    dryer_data_t *dryer_data = &ch->data;
     
-    // Inicializar todos os módulos do sistema
-    system_init();
+    // Atualizar tempo de funcionamento
+    dryer_data->uptime = (current_time - app->start_time) / 1000;
+    
+    // Ler todos os sensores de uma vez usando o módulo sensor_manager
+    float duty_during_read = hardware_control_heater_inhibited(ch->index) ? 0.0f : dryer_data->pwm_percent;
+    uint32_t last_valid_read = ch->sensor_data.last_read_time;
+    sensor_manager_update(&ch->sensors, &ch->sensor_data, duty_during_read);
+    
+    // O DHT22 ambiente fica na primeira câmara e vale para todas
+    if (ch->index > 0) {
+        ch->sensor_data.ambient_temperature = app->chamber[0].sensor_data.ambient_temperature;
+        ch->sensor_data.ambient_valid = app->chamber[0].sensor_data.ambient_valid;
+        ch->sensor_data.ambient_humidity = app->chamber[0].sensor_data.ambient_humidity;
+    }
+    
+    // Supervisor de segurança: só leituras novas renovam a temperatura
+    if (ch->sensor_data.last_read_time != last_valid_read) {
+        safety_supervisor_post_temperature(ch->index, ch->sensor_data.temperature);
+    }
+    if (!ch->sensor_data.acs712_disconnected) {
+        // Medida e duty da mesma janela (com burst o duty pedido não vale nela)
+        safety_supervisor_post_current(ch->index, ch->sensor_data.energy_read, ch->sensor_data.heater_duty_read);
+    }
+    if (ch->sensor_data.fan_monitored) {
+        safety_supervisor_post_fan(ch->index, ch->sensor_data.fan_failure);
+    }
+    
+    // Thermal runaway: potência medida (ou nominal pelo duty) contra a subida da leitura
+    if (!ch->sensor_data.sensor_safe) {
+        thermal_runaway_clear_history(&ch->runaway);
+    } else if (ch->sensor_data.last_read_time != last_valid_read) {
+        float heater_power = ch->sensor_data.acs712_disconnected ?
+                             duty_during_read / 100.0f * HEATER_NOMINAL_POWER_W :
+                             ch->sensor_data.energy_current;
+        float loss_percent = feedforward_predict(&ch->feedforward, ch->sensor_data.temperature,
+                                                 ch->sensor_data.ambient_temperature) +
+                             vent_control_feedforward(&ch->vent, ch->sensor_data.temperature,
+                                                      ch->sensor_data.ambient_temperature);
+        float loss_power = loss_percent / 100.0f * HEATER_NOMINAL_POWER_W * RUNAWAY_LOSS_MARGIN;
+        thermal_runaway_update(&ch->runaway, ch->sensor_data.temperature, heater_power, loss_power,
+                               ch->sensor_data.last_read_time);
+        if (thermal_runaway_tripped(&ch->runaway) && !dryer_data->thermal_runaway) {
+            safety_supervisor_post_runaway(ch->index);
+            dryer_data->thermal_runaway = true;
+        }
+    }
+    
+    // Processar dados dos sensores e atualizar dryer_data
+    process_sensor_data(&ch->sensor_data, dryer_data);
+    
+    // Acumular energia total (aproximação simples)
+    dryer_data->energy_total += (dryer_data->energy_current * SENSOR_TASK_PERIOD_MS) / 3600000.0; // Wh
+#if ECO_HOLD_ENABLED
+    // Eco hold: sem ACS712 (câmaras sem o sensor ou desconectado) a energia
+    // sai da potência nominal pelo duty, como no thermal runaway
+    float heater_power = dryer_data->acs712_disconnected ?
+                         duty_during_read / 100.0f * HEATER_NOMINAL_POWER_W : dryer_data->energy_current;
+    ch->heater_wh += (heater_power * SENSOR_TASK_PERIOD_MS) / 3600000.0;
+#endif
+}
+
+static void task_sensors(void *ctx) {
+    dryer_app_t *app = ctx;
+    uint32_t current_time = to_ms_since_boot(get_absolute_time());
+    
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        sensors_update_chamber(app, &app->chamber[c], current_time);
+    }
+    
+    scheduler_notify(&app->scheduler, app->control_task);
+    scheduler_notify(&app->scheduler, app->led_task);   // Pisca acompanha o estado novo
+}
+
+// Setpoint novo em todos os controladores da câmara (botão ou perfil). Degrau:
+// PID do zero e pré-aquecimento; passo de rampa: o PID segue sem reset.
+static void chamber_set_target(dryer_chamber_t *ch, float setpoint, bool step) {
+    ch->data.temp_target = setpoint;
+    pid_set_setpoint(&ch->pid, setpoint);
+    mpc_set_setpoint(&ch->mpc, setpoint);
+    safety_supervisor_set_setpoint(ch->index, setpoint);
+    if (step) {
+        pid_reset(&ch->pid);
+#if PREHEAT_ENABLED && !MPC_ENABLED
+        preheat_start(&ch->preheat, setpoint);
+#endif
+    } else {
+        preheat_abort(&ch->preheat);
+    }
+}
+
+// Perfil de secagem: setpoint da etapa antes do controle (só com leitura real)
+static void profile_update_chamber(dryer_chamber_t *ch, uint32_t current_time) {
+    dryer_data_t *dryer_data = &ch->data;
+    bool step;
+    bool reading_valid = dryer_data->sensor_safe && ch->sensor_data.last_read_time != 0;
+    if (drying_profile_update(&ch->profile, dryer_data->temperature, reading_valid,
+                              ch->drying.state == DRYING_DONE, current_time, &step)) {
+        chamber_set_target(ch, ch->profile.setpoint, step);
+        LOGD(TAG, "Profile%s setpoint %.0f°C%s", chamber_tag(ch), ch->profile.setpoint, step ? " (step)" : "");
+    }
+    dryer_data->profile = (uint8_t)ch->profile.id;
+    dryer_data->profile_stage = ch->profile.stage;
+    dryer_data->profile_stages = ch->profile.def ? ch->profile.def->stage_count : 0;
+    dryer_data->profile_phase = (uint8_t)ch->profile.phase;
+    dryer_data->profile_waiting = !ch->profile.stage_begun;
+    dryer_data->profile_setpoint = ch->profile.setpoint;
+    dryer_data->profile_hold_min = ch->profile.hold_ms / 60000u;
+}
+
+// Controle de uma câmara: PID (ou MPC/pré-aquecimento) e PWM do heater dela
+static void control_chamber(dryer_chamber_t *ch, uint32_t current_time) {
+    dryer_data_t *dryer_data = &ch->data;
+    
+    profile_update_chamber(ch, current_time);
+    
+    // PROTEÇÃO CRÍTICA: Verificar overshoot perigoso
+    bool overshoot_critical = false;
+    if (dryer_data->temperature > (dryer_data->temp_target + TEMP_OVERSHOOT_LIMIT)) {
+        overshoot_critical = true;
+        LOGE(TAG, "CRITICAL OVERSHOOT%s: Temp %.1f°C > Target %.0f°C + %.0f°C!", chamber_tag(ch),
+             dryer_data->temperature, dryer_data->temp_target, TEMP_OVERSHOOT_LIMIT);
+    }
+    
+    // Calor levado pela exaustão no duty atual: o PID já sai compensado e o
+    // modelo de manutenção aprende só as perdas da câmara fechada
+    float vent_ff = vent_control_feedforward(&ch->vent, dryer_data->temperature,
+                                             dryer_data->ambient_temperature);
+    
+    // Fim da secagem com DRYING_AUTO_STOP: heater parado até um setpoint novo
+    // (com perfil o fim só encerra a etapa; o perfil decide o próximo setpoint)
+    bool drying_stop = DRYING_AUTO_STOP && ch->drying.state == DRYING_DONE &&
+                       !drying_profile_active(&ch->profile);
+    
+    // Calcular saída do PID (desabilitar se overshoot crítico, runaway ou fim da secagem)
+    float pid_output = 0.0f;
+    if (dryer_data->sensor_safe && !overshoot_critical && !dryer_data->thermal_runaway && !drying_stop) {
+        float hold_output = feedforward_predict(&ch->feedforward, dryer_data->temp_target,
+                                                dryer_data->ambient_temperature);
+#if MPC_ENABLED
+        // Ganho de regime do modelo pela potência de manutenção aprendida
+        if (hold_output > 0.0f) {
+            mpc_set_gain(&ch->mpc, (dryer_data->temp_target - dryer_data->ambient_temperature) / hold_output);
+        }
+        clock_scaling_boost();
+        pid_output = mpc_compute(&ch->mpc, dryer_data->temperature, dryer_data->ambient_temperature);
+        clock_scaling_release();
+        LOGD(TAG, "MPC%s: out %.1f%% peak %.2f°C dist %+.2f°C (tau %.0fs, dead %.0fs)", chamber_tag(ch),
+             pid_output, ch->mpc.predicted_peak, ch->mpc.disturbance,
+             ch->mpc.model.tau_s, ch->mpc.model.dead_s);
+#else
+#if FEEDFORWARD_ENABLED
+        pid_set_feedforward(&ch->pid, hold_output + vent_ff);
+#else
+        pid_set_feedforward(&ch->pid, vent_ff);
+#endif
+        // Pré-aquecimento controla a saída até passar para o PID sem salto
+        // (só decide o boost com uma leitura real do DHT22, não com o valor inicial)
+        bool handoff = false;
+        if (preheat_active(&ch->preheat) && ch->sensor_data.last_read_time != 0) {
+            pid_output = preheat_update(&ch->preheat, dryer_data->temperature, hold_output,
+                                        current_time, &handoff);
+            if (handoff) {
+                pid_preload(&ch->pid, pid_output, dryer_data->temperature);
+                send_on_delta_force(&ch->control_trigger);
+            }
+        }
+        bool eco = false;
+#if ECO_HOLD_ENABLED
+        // Eco hold no lugar do PID depois da referência; na saída o PID
+        // continua da potência de manutenção
+        if (!preheat_active(&ch->preheat) && !handoff && ch->sensor_data.last_read_time != 0) {
+            bool was_eco = eco_hold_active(&ch->eco);
+            float eco_hold_output = feedforward_predict(&ch->feedforward,
+                                                        eco_hold_center(&ch->eco, dryer_data->temp_target),
+                                                        dryer_data->ambient_temperature) + vent_ff;
+            eco = eco_hold_update(&ch->eco, dryer_data->temperature, dryer_data->temp_target,
+                                  dryer_data->ambient_temperature, eco_hold_output,
+                                  ch->heater_wh, !dryer_data->acs712_disconnected,
+                                  current_time, &pid_output);
+            if (was_eco && !eco) {
+                pid_preload(&ch->pid, hold_output + vent_ff, dryer_data->temperature);
+                send_on_delta_force(&ch->control_trigger);
+            }
+        }
+#endif
+        if (!preheat_active(&ch->preheat) && !handoff && !eco) {
+            // Send-on-delta: sem entrada nova a saída anterior continua (o dt medido
+            // pelo PID cobre os ciclos pulados no próximo cálculo)
+            float inputs[] = { dryer_data->temperature, dryer_data->temp_target,
+                               dryer_data->ambient_temperature, vent_ff };
+            if (send_on_delta_check(&ch->control_trigger, inputs, current_time)) {
+                pid_output = pid_compute(&ch->pid, dryer_data->temperature);
+            } else {
+                pid_output = ch->pid.last_output;
+            }
+        }
+#endif
+    } else {
+        // Sensor não seguro, overshoot crítico, runaway ou fim: resetar PID e forçar PWM = 0
+        pid_reset(&ch->pid);
+        preheat_abort(&ch->preheat);
+        eco_hold_abort(&ch->eco);
+        mpc_reset(&ch->mpc);
+        cascade_reset(&ch->cascade);
+        send_on_delta_force(&ch->control_trigger);
+        pid_output = 0.0f;
+        
+        if (overshoot_critical) {
+            LOGW(TAG, "Heater%s disabled due to critical overshoot", chamber_tag(ch));
+        }
+    }
+    
+#if CASCADE_ENABLED
+    // Saída do PID vira o alvo do bloco; o PWM sai da malha interna (task_cascade)
+    cascade_set_demand(&ch->cascade, pid_output, dryer_data->temperature);
+    float applied_output = pid_output;
+    LOGD(TAG, "Cascade%s: demand %.1f%% block %.1f°C -> %.1f°C%s", chamber_tag(ch), pid_output,
+         ch->cascade.block_temp, ch->cascade.block_target, ch->cascade.block_valid ? "" : " [no NTC]");
+#else
+    // Atualizar PWM com saída do PID
+    hardware_control_update_pwm(ch->index, dryer_data, dryer_data->sensor_safe, pid_output);
+    float applied_output = dryer_data->pwm_percent;
+#endif
+    
+    // Aprender a potência de manutenção com a saída efetivamente aplicada
+    feedforward_observe(&ch->feedforward, dryer_data->temp_target, dryer_data->ambient_temperature,
+                        dryer_data->temperature, applied_output - vent_ff, current_time);
+    
+#if VENT_ENABLED
+    // Exaustão depois do heater: decide com a saída deste ciclo (folga para purgar).
+    // No eco hold vale o centro do ciclo e a média dos pulsos, não o pulso
+    float vent_target = dryer_data->temp_target;
+    float vent_output = pid_output;
+    if (eco_hold_active(&ch->eco)) {
+        vent_target = eco_hold_center(&ch->eco, dryer_data->temp_target);
+        vent_output = feedforward_predict(&ch->feedforward, vent_target, dryer_data->ambient_temperature) + vent_ff;
+    }
+    dryer_data->vent_percent = vent_control_update(&ch->vent, dryer_data->temperature, dryer_data->humidity,
+                                                   dryer_data->ambient_temperature, dryer_data->ambient_humidity,
+                                                   vent_target, vent_output,
+                                                   dryer_data->sensor_safe, current_time);
+    dryer_data->vent_state = (uint8_t)ch->vent.state;
+    hardware_control_vent_pwm(ch->index, dryer_data->vent_percent);
+#endif
+    
+    // Fim da secagem e tempo restante pela umidade
+    drying_state_t drying_before = ch->drying.state;
+    dryer_data->drying_state = (uint8_t)drying_endpoint_update(
+        &ch->drying, dryer_data->temperature, dryer_data->humidity, dryer_data->ambient_temperature,
+        dryer_data->ambient_humidity, dryer_data->temp_target, dryer_data->vent_percent,
+        dryer_data->sensor_safe, current_time);
+    dryer_data->drying_rate_gph = ch->drying.rate_gph;
+    dryer_data->drying_removed_g = ch->drying.removed_g;
+    dryer_data->drying_eta_s = ch->drying.eta_s;
+    if (DRYING_AUTO_STOP && drying_before != DRYING_DONE && ch->drying.state == DRYING_DONE &&
+        !drying_profile_active(&ch->profile)) {
+        LOGW(TAG, "Heater%s stopped: drying complete (change the setpoint for a new batch)", chamber_tag(ch));
+    }
+    
+    snapshot_publish(ch);
+    stats_publish(ch);
+}
+
+// Tarefa de controle: roda a cada leitura nova (evento da tarefa de sensores)
+static void task_control(void *ctx) {
+    dryer_app_t *app = ctx;
+    uint32_t current_time = to_ms_since_boot(get_absolute_time());
+    
+    bool checkpoint_due = false;
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        control_chamber(&app->chamber[c], current_time);
+        checkpoint_due = checkpoint_due || app->chamber[c].profile.checkpoint_due;
+    }
+    if (checkpoint_due) {
+        scheduler_notify(&app->scheduler, app->checkpoint_task);
+    }
+}
+
+// Publica os contadores do flash para o log de estatísticas
+static void checkpoint_stats_publish(dryer_app_t *app) {
+    seqlock_write_begin(&app->checkpoint_lock);
+    app->checkpoint_stats = app->flash.stats;
+    seqlock_write_end(&app->checkpoint_lock);
+}
+
+// Grava o progresso dos perfis no flash (prioridade baixa: a gravação para os
+// dois núcleos por até ~50 ms, depois do controle deste ciclo)
+static void task_checkpoint(void *ctx) {
+    dryer_app_t *app = ctx;
+    dryer_checkpoint_t cp = {
+        .selected = app->profile_selected,
+        .chamber_count = CHAMBER_COUNT,
+        .reserved = 0,
+    };
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        drying_profile_checkpoint(&app->chamber[c].profile, &cp.chamber[c]);
+    }
+    // O apagamento deixa o núcleo 0 sem interrupções: prazo do heartbeat inteiro para ele
+    safety_supervisor_heartbeat();
+    flash_store_save(&app->flash, &cp, sizeof(cp));
+    checkpoint_stats_publish(app);
+}
+
+#if CASCADE_ENABLED
+// Malha interna: PWM pelo NTC do bloco (câmaras sem NTC seguem a demanda do PID)
+static void task_cascade(void *ctx) {
+    dryer_app_t *app = ctx;
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        dryer_chamber_t *ch = &app->chamber[c];
+        float block_temp;
+        bool block_valid = sensor_manager_read_block_temp(&ch->sensors, &block_temp);
+        float heater_duty = cascade_update(&ch->cascade, block_temp, block_valid);
+        hardware_control_update_pwm(ch->index, &ch->data, ch->data.sensor_safe, heater_duty);
+    }
+}
+#endif
+
+#if LOAD_CELL_ENABLED
+// Célula de carga: lê o HX711 acima da taxa de conversão (filtro e regressão
+// no load_cell); o resultado entra nos dados pela tarefa de sensores
+static void task_load_cell(void *ctx) {
+    dryer_app_t *app = ctx;
+    sensor_manager_sample_load_cell(&app->chamber[0].sensors);
+}
+#endif
+
+// Interrupção de borda do botão: acorda a tarefa do botão
+static void button_edge_irq(void) {
+    scheduler_notify(&app.scheduler, app.button_task);
+}
+
+// Botão de ajuste de temperatura: roda na borda e, enquanto houver debounce
+// ou o botão estiver seguro, no instante pedido pelo button_controller.
+// Ajusta a câmara que está no display.
+static void task_button(void *ctx) {
+    dryer_app_t *app = ctx;
+    dryer_chamber_t *ch = &app->chamber[app->ui_chamber];
+    dryer_data_t *dryer_data = &ch->data;
+    
+    bool changed = button_controller_update(dryer_data);
+    uint32_t next_ms = button_controller_next_update_ms();
+    if (next_ms) {
+        scheduler_notify_in(&app->scheduler, app->button_task, next_ms);
+    }
+    
+    // Se temperatura alvo mudou, atualizar display imediatamente E atualizar PID
+    if (!changed) {
+        return;
+    }
+    app->button_ms = to_ms_since_boot(get_absolute_time());
+    LOGI(TAG, "Target temperature%s changed to %.0f°C", chamber_tag(ch), dryer_data->temp_target);
+    
+    // Ajuste pelo botão assume a câmara: perfil cancelado (e gravado)
+    if (drying_profile_active(&ch->profile)) {
+        drying_profile_cancel(&ch->profile);
+        dryer_data->profile = DRYING_PROFILE_MANUAL;
+        dryer_data->profile_stages = 0;
+        scheduler_notify(&app->scheduler, app->checkpoint_task);
+    }
+    
+    // Atualizar setpoint do PID (ganhos acompanham a tabela)
+    chamber_set_target(ch, dryer_data->temp_target, true);
+    LOGD(TAG, "PID gains for %.0f°C: Kp=%.1f, Ki=%.3f, Kd=%.1f",
+         dryer_data->temp_target, ch->pid.kp, ch->pid.ki, ch->pid.kd);
+
+    // Atualizar display imediatamente (sem esperar a próxima atualização)
+    snapshot_publish(ch);
+    scheduler_notify(app->scheduler_ui, app->setpoint_display_task);
+}
+
+// Núcleo 1: novo setpoint no display logo após o botão
+static void task_setpoint_display(void *ctx) {
+    dryer_app_t *app = ctx;
+    const dryer_data_t *shown = &app->ui_view[app->ui_shown];
+    dryer_data_t view;
+    snapshot_read(&app->chamber[app->ui_chamber], &view);
+    clock_scaling_boost();
+    update_temperature_display(view.temperature, view.temp_target,
+                                shown->temperature, shown->temp_target);
+    clock_scaling_release();
+}
+
+// Núcleo 1: com várias câmaras o display passa para a próxima a cada
+// CHAMBER_DISPLAY_CYCLE_MS, menos logo depois de um ajuste pelo botão
+// (a câmara ajustada fica na tela). true quando trocou.
+static bool ui_rotate_chamber(dryer_app_t *app, uint32_t now) {
+    if (CHAMBER_COUNT < 2) {
+        return false;
+    }
+    uint32_t button_ms = app->button_ms;
+    if (button_ms && now - button_ms < CHAMBER_DISPLAY_HOLD_MS) {
+        app->ui_chamber_since = now;
+        return false;
+    }
+    if (now - app->ui_chamber_since < CHAMBER_DISPLAY_CYCLE_MS) {
+        return false;
+    }
+    app->ui_chamber = (uint8_t)((app->ui_chamber + 1) % CHAMBER_COUNT);
+    app->ui_chamber_since = now;
+    return true;
+}
+
+// Valores "exibidos" que diferem de data em todos os campos: a próxima
+// atualização inteligente redesenha a tela inteira (troca de câmara)
+static void ui_force_refresh(const dryer_data_t *data, dryer_data_t *prev_data) {
+    prev_data->temperature = -1000.0f;
+    prev_data->temp_target = -1000.0f;
+    prev_data->humidity = -1.0f;
+    prev_data->energy_current = -1.0f;
+    prev_data->acs712_disconnected = !data->acs712_disconnected;
+    prev_data->pwm_percent = hardware_control_heater_is_active(data->pwm_percent) ? 0.0f : 100.0f;
+    prev_data->uptime = data->uptime + 1;
+    prev_data->total_sensor_failures = -1;
+    prev_data->total_unsafe_events = -1;
+    prev_data->heater_failure = !(data->heater_failure || data->thermal_runaway);
+    prev_data->thermal_runaway = false;
+    prev_data->fan_failure = false;
+    prev_data->fan_degraded = false;
+    prev_data->spool_valid = !data->spool_valid;
+    prev_data->spool_mass_g = -1.0f;
+    prev_data->mass_rate_valid = !data->mass_rate_valid;
+    prev_data->drying_state = 0xFF;
+    prev_data->profile = 0xFF;
+}
+
+// Núcleo 1: atualização inteligente ou tela de erro conforme o sensor
+static void task_ui(void *ctx) {
+    dryer_app_t *app = ctx;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    bool switched = ui_rotate_chamber(app, now);
+    dryer_data_t *prev_data = &app->ui_view[app->ui_shown];
+    dryer_data_t *dryer_data = &app->ui_view[app->ui_shown ^ 1];
+    snapshot_read(&app->chamber[app->ui_chamber], dryer_data);
+    if (switched) {
+        ui_force_refresh(dryer_data, prev_data);
+        send_on_delta_force(&app->ui_trigger);
+    }
+    
+    // Nada visível mudou: sem SPI (a cópia exibida continua a mesma)
+    float inputs[SEND_ON_DELTA_MAX_INPUTS];
+    event_inputs(dryer_data, inputs);
+    if (!send_on_delta_check(&app->ui_trigger, inputs, now)) {
+        return;
+    }
+    
+    // Gerenciamento de tela baseado no status do sensor (SPI pela CPU: clock máximo)
+    clock_scaling_boost();
+    if (!dryer_data->sensor_safe && !app->error_screen_displayed) {
+        // Sensor falhou - mostrar tela de erro crítica
+        display_critical_error_screen();
+        app->error_screen_displayed = true;
+        LOGE(TAG, "CRITICAL: Error screen displayed - Sensor failed!");
+    } else if (dryer_data->sensor_safe && app->error_screen_displayed) {
+        // Sensor recuperou - voltar à interface normal
+        draw_static_interface();
+        update_chamber_display(app->ui_chamber, CHAMBER_COUNT);
+        app->error_screen_displayed = false;
+        // Forçar atualização completa
+        prev_data->temp_target = 39;
+        prev_data->pwm_percent = -1;
+        prev_data->total_sensor_failures = -1;
+        prev_data->total_unsafe_events = -1;
+        prev_data->drying_state = 0xFF;
+        prev_data->profile = 0xFF;
+        update_interface_smart(dryer_data, prev_data);
+        LOGI(TAG, "Main interface restored - Sensor recovered");
+    } else if (dryer_data->sensor_safe && !app->error_screen_displayed) {
+        // Operação normal - atualizar interface normalmente
+        if (switched) {
+            update_chamber_display(app->ui_chamber, CHAMBER_COUNT);
+        }
+        update_interface_smart(dryer_data, prev_data);
+    }
+    // Se sensor falhou E tela já está exibida, não fazer nada (manter tela de erro)
+    clock_scaling_release();
+    
+    // A cópia nova passa a ser a exibida (troca de índice, sem copiar)
+    app->ui_shown ^= 1;
+}
+
+// LED de status usando módulo hardware_control: acorda só na próxima troca
+// (várias câmaras: seguro só com todas seguras, pisca pelo maior PWM)
+static void task_led(void *ctx) {
+    dryer_app_t *app = ctx;
+    bool sensor_safe = true;
+    float pwm_percent = 0.0f;
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        sensor_safe = sensor_safe && app->chamber[c].data.sensor_safe;
+        if (app->chamber[c].data.pwm_percent > pwm_percent) {
+            pwm_percent = app->chamber[c].data.pwm_percent;
+        }
+    }
+    uint32_t next_ms = hardware_control_led_status(sensor_safe, pwm_percent);
+    scheduler_notify_in(&app->scheduler, app->led_task, next_ms);
+}
+
+// Núcleo 1: log no serial com status de segurança e PWM (uma linha por câmara)
+static void task_log(void *ctx) {
+    dryer_app_t *app = ctx;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        dryer_chamber_t *ch = &app->chamber[c];
+        dryer_data_t view;
+        snapshot_read(ch, &view);
+        const dryer_data_t *dryer_data = &view;
+        
+        float inputs[SEND_ON_DELTA_MAX_INPUTS];
+        event_inputs(dryer_data, inputs);
+        if (!send_on_delta_check(&ch->log_trigger, inputs, now)) {
+            continue;
+        }
+        const char* safety_status = dryer_data->sensor_safe ? "SAFE" : "UNSAFE";
+        const char* heater_status = dryer_data->thermal_runaway ? "[RUNAWAY]" :
+                                    dryer_data->heater_failure ? "[HEATER FAIL]" :
+                                    dryer_data->fan_failure ? "[FAN FAIL]" :
+                                    dryer_data->fan_degraded ? "[FAN DEGRADED]" : "";
+        bool heater_active = hardware_control_heater_is_active(dryer_data->pwm_percent);
+        LOGI(TAG, "T:%.1f°C H:%.1f%% E:%.2fW Target:%.0f°C Heater:%s(%.0f%%) Vent:%s(%.0f%%) [%s]%s%s",
+               dryer_data->temperature, dryer_data->humidity, dryer_data->energy_current,
+               dryer_data->temp_target,
+               heater_active ? "ON" : "OFF", dryer_data->pwm_percent,
+               vent_control_state_name((vent_state_t)dryer_data->vent_state), dryer_data->vent_percent,
+               safety_status, heater_status, chamber_tag(ch));
+    }
+}
+
+// Núcleo 1: estatísticas dos escalonadores (overruns, jitter e latência por tarefa)
+static void task_stats(void *ctx) {
+    dryer_app_t *app = ctx;
+    LOGI(TAG, "Core 0 tasks:");
+    scheduler_log_stats(&app->scheduler);
+#if DUAL_CORE_ENABLED
+    LOGI(TAG, "Core 1 tasks:");
+    scheduler_log_stats(&app->scheduler_core1);
+#endif
+    LOGI(TAG, "Event-triggered cycles:");
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        send_on_delta_log_stats(&app->chamber[c].control_trigger);
+    }
+    send_on_delta_log_stats(&app->ui_trigger);
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        send_on_delta_log_stats(&app->chamber[c].log_trigger);
+    }
+    uint32_t pwm_writes, pwm_skipped;
+    hardware_control_pwm_write_stats(&pwm_writes, &pwm_skipped);
+    LOGI(TAG, "Heater drive %s: PWM register/pattern writes %lu, unchanged level skipped %lu",
+         hardware_control_heater_drive_name(hardware_control_get_heater_drive()), pwm_writes, pwm_skipped);
+#if HEATER_ZONE_COUNT > 1 || CHAMBER_COUNT > 1
+    heater_zones_t zones;
+    uint32_t rephases;
+    hardware_control_heater_zones_stats(&zones, &rephases);
+    LOGI(TAG, "Heater %s: %d, PSU peak %.2fA now / %.2fA max (%.2fA max if aligned), budget %.2fA, "
+         "limited %lu of %lu plans, rephased %lu", CHAMBER_COUNT > 1 ? "outputs" : "zones",
+         zones.count, zones.peak_a, zones.max_peak_a, zones.max_peak_aligned_a, zones.budget_a,
+         zones.limited, zones.plans, rephases);
+#endif
+    // Módulos do núcleo 0: só pela cópia publicada
+    chamber_stats_t stats[CHAMBER_COUNT];
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        stats_read(&app->chamber[c], &stats[c]);
+    }
+#if VENT_ENABLED
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        LOGI(TAG, "Vent%s: %s %.0f%%, excess %.1f%% RH, %lu purges (%lu stopped by dip/headroom), "
+             "purging %lu s total", chamber_tag(&app->chamber[c]), vent_control_state_name(stats[c].vent_state),
+             stats[c].vent_duty, stats[c].vent_excess_rh, stats[c].vent_purges, stats[c].vent_dip_aborts,
+             stats[c].vent_purge_s);
+    }
+#endif
+    
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        if (stats[c].fan_tach) {
+            LOGI(TAG, "Fan%s: %.0f RPM (baseline %.0f), %lu stalls, %lu degradations",
+                 chamber_tag(&app->chamber[c]), stats[c].fan_rpm, stats[c].fan_baseline_rpm,
+                 stats[c].fan_stalls, stats[c].fan_degradations);
+        }
+    }
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        LOGI(TAG, "Drying%s: %s, %.2f g/h (peak %.2f), %.1f g removed, tau %.1f h, %.1f g left, ETA %ld min",
+             chamber_tag(&app->chamber[c]), drying_endpoint_state_name(stats[c].drying_state),
+             stats[c].drying_rate_gph, stats[c].drying_peak_rate_gph, stats[c].drying_removed_g,
+             stats[c].drying_tau_h, stats[c].drying_remaining_g,
+             stats[c].drying_eta_s < 0 ? -1L : (long)(stats[c].drying_eta_s / 60));
+    }
+    // Perfil pela cópia publicada (o botão no núcleo 0 pode cancelar no meio)
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        dryer_data_t view;
+        snapshot_read(&app->chamber[c], &view);
+        if (view.profile != DRYING_PROFILE_MANUAL) {
+            LOGI(TAG, "Profile%s: %s stage %d/%d %s, setpoint %.0f°C, held %lu min",
+                 chamber_tag(&app->chamber[c]), drying_profile_name((drying_profile_id_t)view.profile),
+                 view.profile_stage + 1, view.profile_stages,
+                 view.profile_waiting ? "waiting" : view.profile_phase == PROFILE_PHASE_RAMP ? "ramp" : "hold",
+                 view.profile_setpoint, view.profile_hold_min);
+        }
+    }
+#if ECO_HOLD_ENABLED && !MPC_ENABLED
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        const chamber_stats_t *st = &stats[c];
+        if (!st->eco_energy_measured) {
+            // Pela potência nominal a economia não é medida: nada de número
+            LOGI(TAG, "Eco hold%s: %s, %lu pulses (loss %.4f°C/s, lag %.0f s), %.2f h, "
+                 "savings not measured (%s power), %lu exits", chamber_tag(&app->chamber[c]),
+                 eco_hold_state_name(st->eco_state), st->eco_pulses, st->eco_loss_rate, st->eco_lag_s,
+                 st->eco_hours, eco_hold_energy_source_name(false), st->eco_exits);
+            continue;
+        }
+        LOGI(TAG, "Eco hold%s: %s, %lu pulses (loss %.4f°C/s, lag %.0f s), %.2f h, %.1f Wh vs %.1f Wh "
+             "PID reference (%s): ~%.1f Wh saved (%.1f%%, estimated), %lu exits", chamber_tag(&app->chamber[c]),
+             eco_hold_state_name(st->eco_state), st->eco_pulses, st->eco_loss_rate, st->eco_lag_s,
+             st->eco_hours, st->eco_wh, st->eco_baseline_wh, eco_hold_energy_source_name(true),
+             st->eco_saved_wh, st->eco_baseline_wh > 0.0f ? 100.0f * st->eco_saved_wh / st->eco_baseline_wh : 0.0f,
+             st->eco_exits);
+    }
+#endif
+    flash_store_stats_t checkpoint;
+    uint32_t seq;
+    do {
+        seq = seqlock_read_begin(&app->checkpoint_lock);
+        checkpoint = app->checkpoint_stats;
+    } while (seqlock_read_retry(&app->checkpoint_lock, seq));
+    LOGI(TAG, "Checkpoint: %lu writes, %lu erases, %lu failures, longest %lu us",
+         checkpoint.writes, checkpoint.erases, checkpoint.failures, checkpoint.max_us);
+#if LOAD_CELL_ENABLED
+    LOGI(TAG, "Load cell: %.0f raw counts, %lu samples, %.1f g (%.1f g lost), loss %.2f g/h%s",
+         stats[0].load_cell_counts, stats[0].load_cell_samples, stats[0].load_cell_mass_g,
+         stats[0].load_cell_lost_g, stats[0].load_cell_rate_gph,
+         stats[0].load_cell_rate_valid ? "" : " (not yet)");
+#endif
+    
+    safety_supervisor_stats_t safety;
+    safety_supervisor_get_stats(&safety);
+    LOGI(TAG, "Safety: %lu trips, fault->cutoff max %luus, faults 0x%lx",
+         safety.trips, safety.max_latency_us, safety.faults);
+#if CLOCK_SCALING_ENABLED
+    clock_scaling_stats_t clk;
+    clock_scaling_get_stats(&clk);
+    uint64_t uptime_us = time_us_64();
+    LOGI(TAG, "Clock: %lu MHz idle, %lu MHz boost, %lu switches, boosted %.2f%%, longest boost %luus",
+         clk.idle_hz / 1000000u, clk.boost_hz / 1000000u, clk.switches,
+         uptime_us ? 100.0 * (double)clk.boost_us / (double)uptime_us : 0.0, clk.max_boost_us);
+#endif
+}
+
+// Interrupção do supervisor: falhas mudaram, acordar a tarefa que registra no log
+static void safety_fault_irq(uint32_t faults) {
+    (void)faults;
+    scheduler_notify(app.scheduler_ui, app.safety_log_task);
+}
+
+// Núcleo 1: registra as mudanças de falha do supervisor (a interrupção não loga)
+static void task_safety_log(void *ctx) {
+    static uint32_t logged_faults[CHAMBER_COUNT];
+    dryer_app_t *app = ctx;
+    safety_supervisor_stats_t safety;
+    safety_supervisor_get_stats(&safety);
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        uint32_t faults = safety.chamber_faults[c];
+        if (faults == logged_faults[c]) {
+            continue;
+        }
+        if (faults) {
+            LOGE(TAG, "SAFETY CUTOFF%s: faults 0x%lx (%s%s%s%s%s%s), heater cut in %luus",
+                 chamber_tag(&app->chamber[c]), faults,
+                 (faults & SAFETY_FAULT_TEMP_STALE) ? "stale temp " : "",
+                 (faults & SAFETY_FAULT_OVERSHOOT) ? "overshoot " : "",
+                 (faults & SAFETY_FAULT_CURRENT) ? "current " : "",
+                 (faults & SAFETY_FAULT_HEARTBEAT) ? "heartbeat " : "",
+                 (faults & SAFETY_FAULT_RUNAWAY) ? "runaway " : "",
+                 (faults & SAFETY_FAULT_FAN) ? "fan " : "",
+                 safety.last_latency_us);
+        } else {
+            LOGI(TAG, "Safety faults%s cleared, heater released", chamber_tag(&app->chamber[c]));
+        }
+        logged_faults[c] = faults;
+    }
+}
+
+#if DUAL_CORE_ENABLED
+// Núcleo 1: display, log e estatísticas; pode travar no SPI ou no USB sem
+// atrasar o controle no núcleo 0
+static void core1_main(void) {
+    // Gravação do checkpoint no núcleo 0 para este núcleo na RAM
+    flash_safe_execute_core_init();
+    LOGI(TAG, "Core 1 started (%d tasks)", app.scheduler_core1.task_count);
+    while (true) {
+        scheduler_dispatch(&app.scheduler_core1);
+    }
+}
+#endif
+
+// Sensores, controladores e dados iniciais de uma câmara (linha index da CHAMBER_TABLE)
+static void chamber_init(dryer_chamber_t *ch, uint8_t index) {
+    const chamber_config_t *row = &chamber_table[index];
+    ch->index = index;
+    
+    // Sensores da câmara; o DHT22 ambiente e a célula de carga ficam na primeira
+    sensor_manager_config_t sensors = {
+        .dht22_pin = row->dht22_pin,
+        .energy_pin = row->energy_pin,
+        .ntc_pin = row->ntc_pin,
+        .tach_pin = row->tach_pin,
+        .ambient_pin = (index == 0 && AMBIENT_SENSOR_ENABLED) ? AMBIENT_DHT22_PIN : SENSOR_PIN_NONE,
+        .load_cell_dout_pin = (index == 0 && LOAD_CELL_ENABLED) ? LOAD_CELL_DOUT_PIN : SENSOR_PIN_NONE,
+        .load_cell_sck_pin = LOAD_CELL_SCK_PIN,
+        .heater = index,
+    };
+    sensor_manager_init(&ch->sensors, &sensors);
+    if (row->energy_pin == SENSOR_PIN_NONE) {
+        // Sem ACS712 o supervisor não vê corrente: só temperatura, overshoot e runaway cortam
+        LOGW(TAG, "Chamber%s has no ACS712: a shorted MOSFET or open heater is not detected "
+             "(overshoot and thermal runaway still cut the heater)", chamber_tag(ch));
+    }
     
     // Inicializar controlador PID
-    pid_controller_t pid;
-    pid_init(&pid, PID_KP, PID_KI, PID_KD, PID_OUTPUT_MIN, PID_OUTPUT_MAX, PID_SAMPLE_TIME_MS);
-    pid_set_setpoint(&pid, TEMP_TARGET_DEFAULT);
-    LOGI(TAG, "PID initialized (Kp=%.1f, Ki=%.2f, Kd=%.1f)", PID_KP, PID_KI, PID_KD);
+    pid_controller_t *pid = &ch->pid;
+    pid_init(pid, PID_KP, PID_KI, PID_KD, PID_OUTPUT_MIN, PID_OUTPUT_MAX, PID_SAMPLE_TIME_MS);
+    pid_set_setpoint_weights(pid, PID_SETPOINT_WEIGHT_B, PID_SETPOINT_WEIGHT_C);
+    pid_set_derivative_filter(pid, PID_DERIVATIVE_FILTER_N);
+    pid_set_form(pid, PID_VELOCITY_FORM ? PID_FORM_VELOCITY : PID_FORM_POSITIONAL);
+    
+    // Ganhos por faixa de setpoint (aplicados a cada pid_set_setpoint)
+    static const pid_gain_entry_t gain_schedule[] = PID_GAIN_SCHEDULE;
+    pid_set_gain_schedule(pid, gain_schedule, sizeof(gain_schedule) / sizeof(gain_schedule[0]));
+    
+    pid_set_setpoint(pid, TEMP_TARGET_DEFAULT);
+    if (index == 0) {
+        LOGI(TAG, "PID initialized (Kp=%.1f, Ki=%.2f, Kd=%.1f, %d scheduled gain sets)",
+             pid->kp, pid->ki, pid->kd, pid->schedule_len);
+    }
+    
+    // Modelo de potência de manutenção (feed-forward do PID)
+    feedforward_init(&ch->feedforward, PID_OUTPUT_MIN, PID_OUTPUT_MAX);
+    
+    // Pré-aquecimento até o ponto de parada previsto, depois o PID assume
+    preheat_init(&ch->preheat, PREHEAT_POWER_MAX);
+#if PREHEAT_ENABLED && !MPC_ENABLED
+    preheat_start(&ch->preheat, TEMP_TARGET_DEFAULT);
+#endif
+    
+    // Controle preditivo (alternativa ao PID)
+    mpc_init(&ch->mpc, PID_OUTPUT_MIN, PID_OUTPUT_MAX, MPC_SAMPLE_TIME_MS, MPC_HORIZON_S,
+             MPC_MOVE_S, MPC_REF_TIME_S);
+    mpc_set_model(&ch->mpc, 1.0f / FF_DEFAULT_PERCENT_PER_K, MPC_TAU_DEFAULT_S, MPC_DEAD_DEFAULT_S);
+    mpc_set_weights(&ch->mpc, MPC_MOVE_WEIGHT, MPC_OVERSHOOT_MAX);
+    mpc_set_setpoint(&ch->mpc, TEMP_TARGET_DEFAULT);
+#if MPC_ENABLED
+    if (index == 0) {
+        LOGI(TAG, "MPC enabled (horizon %.0fs, overshoot constraint %.1f°C)", MPC_HORIZON_S, MPC_OVERSHOOT_MAX);
+    }
+#endif
+    
+    // Malha interna do bloco do heater (saída do PID vira alvo do bloco)
+    cascade_init(&ch->cascade, CASCADE_KP, CASCADE_KI, CASCADE_KD, CASCADE_SAMPLE_TIME_MS,
+                 CASCADE_BLOCK_TEMP_MAX, CASCADE_BLOCK_DELTA_FULL);
+#if CASCADE_ENABLED
+    if (index == 0) {
+        LOGI(TAG, "Cascade control enabled (block max %.0f°C)", CASCADE_BLOCK_TEMP_MAX);
+    }
+#endif
+    
+    // Detector de thermal runaway (energia aplicada x subida da temperatura)
+    thermal_runaway_init(&ch->runaway, RUNAWAY_HEAT_CAPACITY, RUNAWAY_WINDOW_MS, RUNAWAY_LAG_MS);
+    thermal_runaway_set_thresholds(&ch->runaway, RUNAWAY_MIN_EXPECTED_RISE, RUNAWAY_TRIP_RATIO,
+                                   RUNAWAY_CLEAR_RATIO, RUNAWAY_CONFIRM_MS);
+    
+    // Exaustão: purga pela umidade absoluta, coordenada com o heater
+    vent_control_init(&ch->vent, TEMP_OVERSHOOT_LIMIT, HEATER_NOMINAL_POWER_W);
+#if VENT_ENABLED
+    if (index == 0) {
+        LOGI(TAG, "Vent control enabled (purge above %.0f%% RH over heated ambient air)", VENT_PURGE_ON_RH);
+    }
+#endif
+    
+    // Fim da secagem pela tendência da umidade
+    drying_endpoint_init(&ch->drying, TEMP_TARGET_DEFAULT);
+    drying_profile_init(&ch->profile);
+#if DRYING_AUTO_STOP
+    if (index == 0) {
+        LOGI(TAG, "Drying auto-stop enabled (%.0f%% of the water left)", DRYING_DONE_REMAINING * 100.0f);
+    }
+#endif
+    
+    // Manutenção econômica por pulsos dentro da faixa do material
+    eco_hold_init(&ch->eco, ECO_HOLD_BAND);
+    ch->heater_wh = 0.0;
+#if ECO_HOLD_ENABLED && !MPC_ENABLED
+    if (index == 0) {
+        LOGI(TAG, "Eco hold enabled (setpoint +/- %.1f°C)", ECO_HOLD_BAND);
+    }
+#endif
     
     // Inicializar dados da estufa
-    dryer_data_t dryer_data = {
+    ch->data = (dryer_data_t){
         .temperature = 10.0,
         .humidity = 50.0,
         .temp_target = TEMP_TARGET_DEFAULT,
@@ -117,11 +1192,139 @@ int main() {
         .total_sensor_failures = 0,
         .total_unsafe_events = 0,
         .heater_failure = false,
+        .thermal_runaway = false,
         .acs712_disconnected = false,
-        .dht_status = "Nenhum erro"
+        .dht_status = "Nenhum erro",
+        .ambient_temperature = AMBIENT_TEMP_DEFAULT,
+        .ambient_valid = false,
+        .ambient_humidity = AMBIENT_RH_DEFAULT,
+        .vent_percent = 0.0f,
+        .vent_state = VENT_RECIRCULATE,
+        .fan_rpm = 0.0f,
+        .fan_failure = false,
+        .fan_degraded = false,
+        .spool_valid = false,
+        .spool_mass_g = 0.0f,
+        .spool_mass_lost_g = 0.0f,
+        .mass_loss_rate_gph = 0.0f,
+        .mass_rate_valid = false,
+        .drying_state = DRYING_SETTLING,
+        .drying_rate_gph = 0.0f,
+        .drying_removed_g = 0.0f,
+        .drying_eta_s = -1,
+        .profile = DRYING_PROFILE_MANUAL,
+        .profile_stage = 0,
+        .profile_stages = 0,
+        .profile_phase = PROFILE_PHASE_RAMP,
+        .profile_waiting = false,
+        .profile_setpoint = 0.0f,
+        .profile_hold_min = 0
     };
     
-    LOGI(TAG, "System started (Target: %.0f°C)", dryer_data.temp_target);
+    seqlock_init(&ch->snapshot_lock);
+    snapshot_publish(ch);
+    seqlock_init(&ch->stats_lock);
+    stats_publish(ch);
+}
+
+// Seleção do perfil no boot: com o botão segurado o display passa pelos
+// perfis a cada PROFILE_SELECT_STEP_MS (PLA primeiro, MANUAL por último) e
+// soltar escolhe o mostrado
+// @return Perfil escolhido; -1 sem o botão segurado ou com ele preso
+static int boot_profile_select(void) {
+    if (!button_controller_pressed()) {
+        return -1;
+    }
+    LOGI(TAG, "Button held at boot: profile selection");
+    uint32_t start = to_ms_since_boot(get_absolute_time());
+    int shown = -1;
+    while (true) {
+        uint32_t step = (to_ms_since_boot(get_absolute_time()) - start) / PROFILE_SELECT_STEP_MS;
+        if (step >= 2 * DRYING_PROFILE_COUNT) {
+            LOGW(TAG, "Button stuck during profile selection, keeping the checkpoint");
+            return -1;
+        }
+        int id = (int)((DRYING_PROFILE_PLA + step) % DRYING_PROFILE_COUNT);
+        if (id != shown) {
+            display_profile_select(drying_profile_name((drying_profile_id_t)id));
+            shown = id;
+        }
+        // Soltar vale depois do debounce
+        if (!button_controller_pressed()) {
+            sleep_ms(BUTTON_DEBOUNCE_MS);
+            if (!button_controller_pressed()) {
+                LOGI(TAG, "Profile selected: %s", drying_profile_name((drying_profile_id_t)shown));
+                return shown;
+            }
+        }
+        sleep_ms(20);
+    }
+}
+
+// Perfis no boot: o escolhido com o botão começa do zero em todas as
+// câmaras; sem escolha o checkpoint do flash continua de onde parou
+static void boot_profiles(dryer_app_t *app) {
+    flash_store_init(&app->flash);
+    seqlock_init(&app->checkpoint_lock);
+    checkpoint_stats_publish(app);
+    int selected = boot_profile_select();
+    if (selected >= 0) {
+        app->profile_selected = (uint8_t)selected;
+        for (int c = 0; c < CHAMBER_COUNT; c++) {
+            drying_profile_start(&app->chamber[c].profile, (drying_profile_id_t)selected);
+            app->chamber[c].profile.checkpoint_due = true;  // MANUAL também substitui o checkpoint
+        }
+        return;
+    }
+    
+    dryer_checkpoint_t cp;
+    if (!flash_store_load(&app->flash, &cp, sizeof(cp)) || cp.chamber_count != CHAMBER_COUNT) {
+        app->profile_selected = DRYING_PROFILE_DEFAULT;
+        for (int c = 0; c < CHAMBER_COUNT; c++) {
+            drying_profile_start(&app->chamber[c].profile, DRYING_PROFILE_DEFAULT);
+        }
+        return;
+    }
+    app->profile_selected = cp.selected;
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        drying_profile_resume(&app->chamber[c].profile, &cp.chamber[c]);
+    }
+}
+
+int main() {
+    app.start_time = to_ms_since_boot(get_absolute_time());
+
+    stdio_init_all();
+    absolute_time_t deadline = make_timeout_time_ms(5000);
+    while (!stdio_usb_connected() && !time_reached(deadline)) {
+        sleep_ms(10); // Aguarda estabilizar USB
+    }  
+    
+    printf("\n=== ESTUFA DE FILAMENTOS v2.0 ===\n");
+    LOGI(TAG, "Starting system...");
+    
+    // Initialize the onboard LED
+    int rc = hardware_control_led_init();
+    if (rc != 0) {
+        LOGE(TAG, "Failed to initialize LED");
+    }
+    
+    // Inicializar todos os módulos do sistema
+    system_init();
+    
+    // Câmaras: sensores, PID/MPC/cascata, runaway e dados
+    float setpoints[CHAMBER_COUNT];
+    for (int c = 0; c < CHAMBER_COUNT; c++) {
+        chamber_init(&app.chamber[c], (uint8_t)c);
+        setpoints[c] = app.chamber[c].data.temp_target;
+    }
+    dryer_data_t *data = &app.chamber[0].data;
+    
+    if (CHAMBER_COUNT > 1) {
+        LOGI(TAG, "System started (%d chambers, target: %.0f°C)", CHAMBER_COUNT, data->temp_target);
+    } else {
+        LOGI(TAG, "System started (Target: %.0f°C)", data->temp_target);
+    }
     
     // Tela de inicialização normal
     LOGI(TAG, "Starting initialization screen...");
@@ -129,129 +1332,98 @@ int main() {
     LOGI(TAG, "Initialization screen completed, waiting 3s...");
     sleep_ms(3000);
     
+    // Perfil de secagem: escolha pelo botão ou continuação do checkpoint
+    boot_profiles(&app);
+    
     // Desenhar interface estática uma única vez
     LOGI(TAG, "Drawing static interface...");
     draw_static_interface();
+    update_chamber_display(0, CHAMBER_COUNT);
     LOGI(TAG, "Static interface drawn");
     
     // Estrutura para guardar valores anteriores
-    dryer_data_t prev_data = dryer_data;
-    prev_data.temp_target = dryer_data.temp_target - 1.0; // Forçar atualização inicial
-    prev_data.total_sensor_failures = -1; // Forçar atualização inicial
-    prev_data.total_unsafe_events = -1; // Forçar atualização inicial
+    dryer_data_t *prev_data = &app.ui_view[app.ui_shown];
+    *prev_data = *data;
+    prev_data->temp_target = data->temp_target - 1.0; // Forçar atualização inicial
+    prev_data->total_sensor_failures = -1; // Forçar atualização inicial
+    prev_data->total_unsafe_events = -1; // Forçar atualização inicial
+    prev_data->drying_state = 0xFF; // Forçar atualização inicial
+    prev_data->profile = 0xFF; // Forçar atualização inicial
     
     // Controle de tela de erro
-    static bool error_screen_displayed = false;
+    app.error_screen_displayed = false;
+    app.ui_chamber = 0;
+    app.ui_chamber_since = to_ms_since_boot(get_absolute_time());
     
-    LOGI(TAG, "Initial target temperature: %.0f°C", dryer_data.temp_target);
+    LOGI(TAG, "Initial target temperature: %.0f°C", data->temp_target);
     
     LOGD(TAG, "Updating initial interface...");
-    update_interface_smart(&dryer_data, &prev_data);
+    update_interface_smart(data, prev_data);
+    *prev_data = *data;
     LOGD(TAG, "Initial interface updated");
     
-    LOGI(TAG, "Entering main loop...");
+    // Controle, display e log por evento (send-on-delta)
+    event_triggers_init(&app);
+    
+    // Tarefas: cada uma no seu período, prazo e prioridade. Com DUAL_CORE_ENABLED
+    // display, log e estatísticas vão para o núcleo 1. Sensores e controle
+    // percorrem todas as câmaras.
+    scheduler_t *sched = &app.scheduler;
+    scheduler_init(sched);
+#if DUAL_CORE_ENABLED
+    app.scheduler_ui = &app.scheduler_core1;
+    scheduler_init(app.scheduler_ui);
+#else
+    app.scheduler_ui = sched;
+#endif
+    scheduler_t *sched_ui = app.scheduler_ui;
+#if CASCADE_ENABLED
+    scheduler_add_task(sched, "cascade", task_cascade, &app, CASCADE_SAMPLE_TIME_MS,
+                       CASCADE_TASK_DEADLINE_MS, SCHEDULER_PRIORITY_CRITICAL);
+#endif
+#if LOAD_CELL_ENABLED
+    scheduler_add_task(sched, "loadcell", task_load_cell, &app, LOAD_CELL_TASK_PERIOD_MS,
+                       LOAD_CELL_TASK_DEADLINE_MS, SCHEDULER_PRIORITY_NORMAL);
+#endif
+    app.control_task = scheduler_add_task(sched, "control", task_control, &app, 0,
+                                          CONTROL_TASK_DEADLINE_MS, SCHEDULER_PRIORITY_CRITICAL);
+    scheduler_add_task(sched, "sensors", task_sensors, &app, SENSOR_TASK_PERIOD_MS,
+                       SENSOR_TASK_DEADLINE_MS, SCHEDULER_PRIORITY_HIGH);
+    app.button_task = scheduler_add_task(sched, "button", task_button, &app, 0,
+                                         BUTTON_TASK_DEADLINE_MS, SCHEDULER_PRIORITY_HIGH);
+    app.led_task = scheduler_add_task(sched, "led", task_led, &app, 0, 0, SCHEDULER_PRIORITY_NORMAL);
+    app.checkpoint_task = scheduler_add_task(sched, "checkpoint", task_checkpoint, &app, 0, 0,
+                                             SCHEDULER_PRIORITY_LOW);
+    // Primeira leitura do botão (pode já estar pressionado) e primeira troca do LED
+    scheduler_notify(sched, app.button_task);
+    scheduler_notify(sched, app.led_task);
+    button_controller_set_edge_callback(button_edge_irq);
+    
+    app.setpoint_display_task = scheduler_add_task(sched_ui, "setpoint", task_setpoint_display, &app, 0,
+                                                   UI_SETPOINT_DEADLINE_MS, SCHEDULER_PRIORITY_HIGH);
+    scheduler_add_task(sched_ui, "ui", task_ui, &app, UI_TASK_PERIOD_MS, 0, SCHEDULER_PRIORITY_NORMAL);
+    scheduler_add_task(sched_ui, "log", task_log, &app, LOG_TASK_PERIOD_MS, 0, SCHEDULER_PRIORITY_LOW);
+    scheduler_add_task(sched_ui, "stats", task_stats, &app, SCHEDULER_STATS_PERIOD_MS, 0,
+                       SCHEDULER_PRIORITY_LOW);
+    app.safety_log_task = scheduler_add_task(sched_ui, "safety", task_safety_log, &app, 0, 0,
+                                             SCHEDULER_PRIORITY_LOW);
+    
+#if CLOCK_SCALING_ENABLED
+    // Daqui em diante clk_sys baixo; o PWM do heater acompanha cada troca
+    clock_scaling_init(CLOCK_IDLE_DIV, CLOCK_BOOST_DIV, hardware_control_pwm_clock_changed);
+#endif
+    
+#if DUAL_CORE_ENABLED
+    multicore_launch_core1(core1_main);
+#endif
+    LOGI(TAG, "Entering main loop (%d tasks)...", sched->task_count);
+    
+    // Supervisor por interrupção + watchdog: a partir daqui o loop tem que dar sinal de vida
+    safety_supervisor_set_fault_callback(safety_fault_irq);
+    safety_supervisor_init(setpoints, CHAMBER_COUNT, TEMP_OVERSHOOT_LIMIT);
     
     while (true) {
-        uint32_t current_time = to_ms_since_boot(get_absolute_time());
-        
-        // Atualiza dados a cada UPDATE_INTERVAL_MS
-        if (current_time - last_update >= UPDATE_INTERVAL_MS) {
-            last_update = current_time;
-            
-            // Salvar valores anteriores
-            prev_data = dryer_data;
-            
-            // Atualizar tempo de funcionamento
-            dryer_data.uptime = (current_time - start_time) / 1000;
-            
-            // Ler todos os sensores de uma vez usando o módulo sensor_manager
-            sensor_data_t sensor_data;
-            bool heater_active = hardware_control_heater_is_active(dryer_data.pwm_percent);
-            sensor_manager_update(&sensor_data, heater_active);
-            
-            // Processar dados dos sensores e atualizar dryer_data
-            process_sensor_data(&sensor_data, &dryer_data);
-            
-            // Acumular energia total (aproximação simples)
-            dryer_data.energy_total += (dryer_data.energy_current * UPDATE_INTERVAL_MS) / 3600000.0; // Wh
-            
-            // PROTEÇÃO CRÍTICA: Verificar overshoot perigoso
-            bool overshoot_critical = false;
-            if (dryer_data.temperature > (dryer_data.temp_target + TEMP_OVERSHOOT_LIMIT)) {
-                overshoot_critical = true;
-                LOGE(TAG, "CRITICAL OVERSHOOT: Temp %.1f°C > Target %.0f°C + %.0f°C!",
-                     dryer_data.temperature, dryer_data.temp_target, TEMP_OVERSHOOT_LIMIT);
-            }
-            
-            // Calcular saída do PID (desabilitar se overshoot crítico)
-            float pid_output = 0.0f;
-            if (dryer_data.sensor_safe && !overshoot_critical) {
-                pid_output = pid_compute(&pid, dryer_data.temperature);
-            } else {
-                // Sensor não seguro OU overshoot crítico: resetar PID e forçar PWM = 0
-                pid_reset(&pid);
-                pid_output = 0.0f;
-                
-                if (overshoot_critical) {
-                    LOGW(TAG, "Heater disabled due to critical overshoot");
-                }
-            }
-            
-            // Atualizar PWM com saída do PID
-            hardware_control_update_pwm(&dryer_data, dryer_data.sensor_safe, pid_output);
-            
-            // Gerenciamento de tela baseado no status do sensor
-            if (!dryer_data.sensor_safe && !error_screen_displayed) {
-                // Sensor falhou - mostrar tela de erro crítica
-                display_critical_error_screen();
-                error_screen_displayed = true;
-                LOGE(TAG, "CRITICAL: Error screen displayed - Sensor failed!");
-            } else if (dryer_data.sensor_safe && error_screen_displayed) {
-                // Sensor recuperou - voltar à interface normal
-                draw_static_interface();
-                error_screen_displayed = false;
-                // Forçar atualização completa na próxima iteração
-                prev_data.temp_target = 39;
-                prev_data.pwm_percent = -1;
-                prev_data.total_sensor_failures = -1;
-                prev_data.total_unsafe_events = -1;
-                update_interface_smart(&dryer_data, &prev_data);
-                LOGI(TAG, "Main interface restored - Sensor recovered");
-            } else if (dryer_data.sensor_safe && !error_screen_displayed) {
-                // Operação normal - atualizar interface normalmente
-                update_interface_smart(&dryer_data, &prev_data);
-            }
-            // Se sensor falhou E tela já está exibida, não fazer nada (manter tela de erro)
-            
-            // Log no serial com status de segurança e PWM
-            const char* safety_status = dryer_data.sensor_safe ? "SAFE" : "UNSAFE";
-            const char* heater_status = dryer_data.heater_failure ? "[HEATER FAIL]" : "";
-            LOGI(TAG, "T:%.1f°C H:%.1f%% E:%.2fW Target:%.0f°C Heater:%s(%.0f%%) [%s]%s",
-                   dryer_data.temperature, dryer_data.humidity, dryer_data.energy_current,
-                   dryer_data.temp_target,
-                   heater_active ? "ON" : "OFF", dryer_data.pwm_percent,
-                   safety_status, heater_status);
-        }
-        
-        // Verificar botão de ajuste de temperatura usando módulo button_controller
-        bool temp_changed = button_controller_update(&dryer_data);
-        
-        // Se temperatura alvo mudou, atualizar display imediatamente E atualizar PID
-        if (temp_changed) {
-            LOGI(TAG, "Target temperature changed to %.0f°C", dryer_data.temp_target);
-            
-            // Atualizar setpoint do PID
-            pid_set_setpoint(&pid, dryer_data.temp_target);
-            pid_reset(&pid);
-
-            // Atualizar display imediatamente (sem esperar os 5s)
-            update_temperature_display(dryer_data.temperature, dryer_data.temp_target,
-                                        prev_data.temperature, prev_data.temp_target);
-        }
-        
-        // LED de status usando módulo hardware_control
-        hardware_control_led_status(dryer_data.sensor_safe, dryer_data.pwm_percent);
-        
-        sleep_ms(100);  // Loop principal a cada 100ms
+        safety_supervisor_heartbeat();
+        scheduler_dispatch(sched);
     }
 }
@@ -16,17 +16,27 @@
 #define ADC_VREF 3.3f
 #define ADC_RANGE 4096.0f
 
-static uint adc_channel;
 static uint gpio_pin_stored;
 
 void _acs712_init_internal(uint gpio_pin) {
-    adc_channel = gpio_pin - 26;
     gpio_pin_stored = gpio_pin;
     adc_gpio_init(gpio_pin);
 }
 
+bool acs712_init_pin(uint gpio_pin) {
+    if (gpio_pin < 26 || gpio_pin > 28) {
+        return false;
+    }
+    adc_gpio_init(gpio_pin);
+    return true;
+}
+
 float acs712_read_current(acs712_status_t *status) {
-    adc_select_input(adc_channel);
+    return acs712_read_current_pin(gpio_pin_stored, status);
+}
+
+float acs712_read_current_pin(uint gpio_pin, acs712_status_t *status) {
+    adc_select_input(gpio_pin - 26);
 
     // Realizar múltiplas leituras para média (filtro simples)
     // O ACS712 pode ser ruidoso
@@ -42,14 +52,14 @@ float acs712_read_current(acs712_status_t *status) {
     
     // Converter valor ADC para Tensão no pino
     float voltage = (avg_adc / ADC_RANGE) * ADC_VREF;
-    LOGD(TAG, "ACS712 GPIO %d: ADC=%.2f V=%.2fV", gpio_pin_stored, avg_adc, voltage);
+    LOGD(TAG, "ACS712 GPIO %d: ADC=%.2f V=%.2fV", gpio_pin, avg_adc, voltage);
 
     // Validar conexão e segurança
     if (voltage < 0.15f) {
         // Tensão muito baixa, sensor desabilitado ou desconectado
         if (status) {
             status->code = ACS712_DISCONNECTED;
-            status->gpio_pin = gpio_pin_stored;
+            status->gpio_pin = gpio_pin;
             status->voltage = voltage;
         }
         return 0.0f;
@@ -58,13 +68,13 @@ float acs712_read_current(acs712_status_t *status) {
         // Se subir muito, pode queimar o ADC (max 3.3V)
         if (status) {
             status->code = ACS712_HIGH_VOLTAGE_WARNING;
-            status->gpio_pin = gpio_pin_stored;
+            status->gpio_pin = gpio_pin;
             status->voltage = voltage;
         }
     } else {
         if (status) {
             status->code = ACS712_OK;
-            status->gpio_pin = gpio_pin_stored;
+            status->gpio_pin = gpio_pin;
             status->voltage = voltage;
         }
     }
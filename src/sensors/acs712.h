@@ -35,4 +35,17 @@ void _acs712_init_internal(uint gpio_pin);
  */
 float acs712_read_current(acs712_status_t *status);
 
+/**
+ * Inicializa um sensor adicional sem trocar o pino padrão (ex: uma câmara a mais)
+ * @param gpio_pin Pino ADC (26, 27 ou 28), validado em tempo de execução
+ * @return false se o pino não é uma entrada do ADC
+ */
+bool acs712_init_pin(uint gpio_pin);
+
+/**
+ * Lê a corrente do sensor no pino informado (inicializado com acs712_init()
+ * ou acs712_init_pin())
+ */
+float acs712_read_current_pin(uint gpio_pin, acs712_status_t *status);
+
 #endif // ACS712_H
@@ -30,13 +30,13 @@ static uint dht22_pin = 0;
 /**
  * Wait for pin to reach specified state with timeout - VERSÃO FUNCIONAL
  */
-static bool wait_for_pin(bool state, uint32_t timeout_us) {
+static bool wait_for_pin(uint pin, bool state, uint32_t timeout_us) {
     // Timeout baseado em loops em vez de tempo absoluto (mais simples)
     uint32_t max_loops = timeout_us / 5; // ~5us por loop
     if (max_loops > 20000) max_loops = 20000; // Limite máximo
     
     for (uint32_t i = 0; i < max_loops; i++) {
-        if (gpio_get(dht22_pin) == state) {
+        if (gpio_get(pin) == state) {
             return true; // Sucesso
         }
         sleep_us(5);
@@ -48,9 +48,9 @@ static bool wait_for_pin(bool state, uint32_t timeout_us) {
 /**
  * Measure pulse duration - VERSÃO SIMPLIFICADA
  */
-static uint32_t measure_pulse_us(bool state, uint32_t timeout_us) {
+static uint32_t measure_pulse_us(uint pin, bool state, uint32_t timeout_us) {
     // Aguardar início do pulso
-    if (!wait_for_pin(state, timeout_us)) {
+    if (!wait_for_pin(pin, state, timeout_us)) {
         return 0; // Timeout
     }
     
@@ -58,7 +58,7 @@ static uint32_t measure_pulse_us(bool state, uint32_t timeout_us) {
     uint32_t count = 0;
     uint32_t max_count = timeout_us / 5;
     
-    while (gpio_get(dht22_pin) == state && count < max_count) {
+    while (gpio_get(pin) == state && count < max_count) {
         sleep_us(5);
         count++;
     }
@@ -66,51 +66,58 @@ static uint32_t measure_pulse_us(bool state, uint32_t timeout_us) {
     return count * 5; // Aproximação em microsegundos
 }
 
-void dht22_init(uint pin) {
-    dht22_pin = pin;
-    
+void dht22_init_pin(uint pin) {
     // Inicializar GPIO
-    gpio_init(dht22_pin);
-    gpio_set_dir(dht22_pin, GPIO_IN);
-    gpio_pull_up(dht22_pin); // Enable internal pull-up
+    gpio_init(pin);
+    gpio_set_dir(pin, GPIO_IN);
+    gpio_pull_up(pin); // Enable internal pull-up
     
     // Aguardar estabilização
     sleep_ms(10);
 }
 
+void dht22_init(uint pin) {
+    dht22_pin = pin;
+    dht22_init_pin(pin);
+}
+
 dht22_result_t dht22_read(float *temperature, float *humidity) {
+    return dht22_read_pin(dht22_pin, temperature, humidity);
+}
+
+dht22_result_t dht22_read_pin(uint pin, float *temperature, float *humidity) {
     uint8_t data[5] = {0}; // 40 bits = 5 bytes
     
     // Step 1: Send start signal
-    gpio_set_dir(dht22_pin, GPIO_OUT);
-    gpio_put(dht22_pin, 0);                    // Pull low
+    gpio_set_dir(pin, GPIO_OUT);
+    gpio_put(pin, 0);                          // Pull low
     sleep_us(DHT22_START_SIGNAL_LOW);          // Wait 1ms
-    gpio_put(dht22_pin, 1);                    // Release (pull-up takes over)
+    gpio_put(pin, 1);                          // Release (pull-up takes over)
     sleep_us(DHT22_START_SIGNAL_HIGH);         // Wait 30µs
-    gpio_set_dir(dht22_pin, GPIO_IN);          // Switch to input
+    gpio_set_dir(pin, GPIO_IN);                // Switch to input
     
     // Step 2: Wait for DHT22 response
-    if (!wait_for_pin(0, DHT22_TIMEOUT_US)) {
+    if (!wait_for_pin(pin, 0, DHT22_TIMEOUT_US)) {
         return DHT22_ERROR_NO_RESPONSE;
     }
     
-    if (!wait_for_pin(1, DHT22_TIMEOUT_US)) {
+    if (!wait_for_pin(pin, 1, DHT22_TIMEOUT_US)) {
         return DHT22_ERROR_NO_RESPONSE;
     }
     
-    if (!wait_for_pin(0, DHT22_TIMEOUT_US)) {
+    if (!wait_for_pin(pin, 0, DHT22_TIMEOUT_US)) {
         return DHT22_ERROR_NO_RESPONSE;
     }
     
     // Step 3: Read 40 data bits
     for (int i = 0; i < DHT22_DATA_BITS; i++) {
         // Wait for bit start (low period)
-        if (!wait_for_pin(1, DHT22_TIMEOUT_US)) {
+        if (!wait_for_pin(pin, 1, DHT22_TIMEOUT_US)) {
             return DHT22_ERROR_TIMEOUT;
         }
         
         // Measure high period duration
-        uint32_t pulse_duration = measure_pulse_us(1, DHT22_TIMEOUT_US);
+        uint32_t pulse_duration = measure_pulse_us(pin, 1, DHT22_TIMEOUT_US);
         if (pulse_duration == 0) {
             return DHT22_ERROR_TIMEOUT;
         }
@@ -51,6 +51,22 @@ void dht22_init(uint pin);
  */
 dht22_result_t dht22_read(float *temperature, float *humidity);
 
+/**
+ * Initialize an additional DHT22 sensor without changing the default pin
+ * @param pin GPIO pin connected to DHT22 data line
+ */
+void dht22_init_pin(uint pin);
+
+/**
+ * Read temperature and humidity from the DHT22 on a specific pin
+ * (e.g. an optional ambient sensor next to the chamber sensor)
+ * @param pin GPIO pin initialized with dht22_init() or dht22_init_pin()
+ * @param temperature Pointer to store temperature (°C)
+ * @param humidity Pointer to store humidity (%RH)
+ * @return DHT22_OK on success, error code on failure
+ */
+dht22_result_t dht22_read_pin(uint pin, float *temperature, float *humidity);
+
 /**
  * Get string description of error code
  * @param result Error code from dht22_read()
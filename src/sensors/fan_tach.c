@@ -0,0 +1,92 @@
+#include "fan_tach.h"
+#include "hardware_control.h"
+#include "logger.h"
+
+#define TAG "FanTach"
+
+bool fan_tach_init(fan_tach_t *ft, uint8_t pin) {
+    ft->tach = hardware_control_tach_init(pin);
+    ft->last_edges = 0;
+    ft->last_us = 0;
+    ft->primed = false;
+    ft->sample.rpm = 0.0f;
+    ft->sample.time_ms = 0;
+    ft->sample.window_ms = 0;
+    ft->baseline_rpm = 0.0f;
+    ft->low_samples = 0;
+    ft->stalled = false;
+    ft->degraded = false;
+    ft->stalls = 0;
+    ft->degradations = 0;
+    return ft->tach >= 0;
+}
+
+// Parada e degradação a partir da amostra nova
+static void check_fan(fan_tach_t *ft) {
+    float rpm = ft->sample.rpm;
+    bool stalled = rpm < FAN_STALL_RPM;
+    if (stalled != ft->stalled) {
+        if (stalled) {
+            LOGE(TAG, "Circulation fan stalled (%.0f RPM)", rpm);
+            ft->stalls++;
+        } else {
+            LOGI(TAG, "Circulation fan running again (%.0f RPM)", rpm);
+        }
+        ft->stalled = stalled;
+    }
+    if (stalled) {
+        ft->low_samples = 0;
+        return;
+    }
+
+    if (ft->baseline_rpm <= 0.0f) {
+        ft->baseline_rpm = rpm;
+        LOGI(TAG, "Fan baseline %.0f RPM", rpm);
+        return;
+    }
+    if (rpm < ft->baseline_rpm * FAN_DEGRADED_RATIO) {
+        // Referência congelada enquanto a ventoinha está fraca
+        if (++ft->low_samples == FAN_DEGRADED_SAMPLES) {
+            LOGW(TAG, "Circulation fan degraded: %.0f RPM, baseline %.0f RPM", rpm, ft->baseline_rpm);
+            ft->degraded = true;
+            ft->degradations++;
+        }
+        return;
+    }
+    if (ft->degraded) {
+        LOGI(TAG, "Circulation fan back to %.0f RPM", rpm);
+        ft->degraded = false;
+    }
+    ft->low_samples = 0;
+    ft->baseline_rpm += (rpm - ft->baseline_rpm) * FAN_BASELINE_ALPHA;
+}
+
+bool fan_tach_update(fan_tach_t *ft) {
+    if (ft->tach < 0) {
+        return false;
+    }
+    uint16_t edges;
+    uint64_t now_us;
+    hardware_control_tach_read(ft->tach, &edges, &now_us);
+    if (!ft->primed) {
+        ft->last_edges = edges;
+        ft->last_us = now_us;
+        ft->primed = true;
+        return false;
+    }
+    uint64_t window_us = now_us - ft->last_us;
+    if (window_us < FAN_TACH_MIN_WINDOW_MS * 1000ull) {
+        return false;
+    }
+
+    // Diferença em 16 bits: vale com uma volta do contador na janela (até
+    // 65535 pulsos, ~10 min a 3000 RPM)
+    uint16_t count = (uint16_t)(edges - ft->last_edges);
+    ft->last_edges = edges;
+    ft->last_us = now_us;
+    ft->sample.rpm = (float)count / FAN_TACH_PULSES_PER_REV * 60e6f / (float)window_us;
+    ft->sample.time_ms = (uint32_t)(now_us / 1000u);
+    ft->sample.window_ms = (uint32_t)(window_us / 1000u);
+    check_fan(ft);
+    return true;
+}
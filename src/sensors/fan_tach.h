@@ -0,0 +1,73 @@
+#ifndef FAN_TACH_H
+#define FAN_TACH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Tacômetro da ventoinha de circulação (fio amarelo das ventoinhas de PC)
+ *
+ * Sem circulação o ar perto do heater esquenta muito mais que o resto da
+ * câmara e o DHT22, do outro lado, não vê: o bloco passa do ponto antes de
+ * o thermal runaway perceber que a energia não chega ao sensor. O RPM vem
+ * do contador de bordas de um slice PWM (hardware_control_tach_init): o
+ * hardware conta os pulsos sozinho e cada leitura do sensor_manager só
+ * pega a diferença do contador desde a anterior, com o instante da leitura.
+ *
+ *   RPM = bordas / FAN_TACH_PULSES_PER_REV / janela * 60
+ *
+ * - Parada: uma amostra abaixo de FAN_STALL_RPM (a ~3000 RPM uma janela
+ *   de 2 s sem nenhum pulso não deixa dúvida). Volta ao normal sozinha
+ *   quando a ventoinha gira de novo.
+ * - Degradada (rolamento gasto, poeira): FAN_DEGRADED_SAMPLES amostras
+ *   seguidas abaixo de FAN_DEGRADED_RATIO da referência aprendida (média
+ *   lenta das amostras saudáveis). Só aviso: a circulação ainda existe.
+ *
+ * A primeira janela inclui a partida da ventoinha e só prepara o contador.
+ */
+
+#define FAN_TACH_PULSES_PER_REV 2       // Ventoinhas de PC: dois pulsos por volta
+#define FAN_TACH_MIN_WINDOW_MS 1000     // Janela mínima entre amostras (resolução)
+#define FAN_STALL_RPM 500.0f            // Abaixo disso a ventoinha está parada
+#define FAN_DEGRADED_RATIO 0.7f         // Abaixo desta fração da referência: degradada
+#define FAN_DEGRADED_SAMPLES 12         // Amostras seguidas (~30 s a cada leitura de sensores)
+#define FAN_BASELINE_ALPHA 0.02f        // Peso de cada amostra saudável na referência
+
+// Uma amostra: RPM médio na janela que termina em time_ms
+typedef struct {
+    float rpm;
+    uint32_t time_ms;                   // Leitura do contador (ms desde o boot)
+    uint32_t window_ms;                 // Duração da janela
+} fan_tach_sample_t;
+
+typedef struct {
+    int tach;                           // Entrada do hardware_control (-1 = sem tacômetro)
+    uint16_t last_edges;
+    uint64_t last_us;
+    bool primed;                        // Já tem uma leitura de referência do contador
+
+    fan_tach_sample_t sample;           // Última amostra (rpm 0 e time_ms 0 = nenhuma)
+    float baseline_rpm;                 // Referência para a degradação (0 = ainda não)
+    uint32_t low_samples;
+    bool stalled;
+    bool degraded;
+
+    // Estatísticas
+    uint32_t stalls;
+    uint32_t degradations;
+} fan_tach_t;
+
+/**
+ * @param pin GPIO do tacômetro (canal B de um slice livre)
+ * @return false se o pino não serve; fan_tach_update() não faz nada
+ */
+bool fan_tach_init(fan_tach_t *ft, uint8_t pin);
+
+/**
+ * Lê o contador e, com pelo menos FAN_TACH_MIN_WINDOW_MS de janela, gera
+ * uma amostra nova e atualiza parada/degradação
+ * @return true se há amostra nova
+ */
+bool fan_tach_update(fan_tach_t *ft);
+
+#endif // FAN_TACH_H
@@ -0,0 +1,43 @@
+#include "hx711.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+void hx711_init(hx711_t *hx, uint dout_pin, uint sck_pin) {
+    hx->dout_pin = dout_pin;
+    hx->sck_pin = sck_pin;
+    gpio_init(dout_pin);
+    gpio_set_dir(dout_pin, GPIO_IN);
+    gpio_pull_up(dout_pin);             // Sem o módulo: DOUT alto, nunca pronto
+    gpio_init(sck_pin);
+    gpio_set_dir(sck_pin, GPIO_OUT);
+    gpio_put(sck_pin, false);
+}
+
+bool hx711_ready(const hx711_t *hx) {
+    return !gpio_get(hx->dout_pin);
+}
+
+bool hx711_read(const hx711_t *hx, int32_t *raw) {
+    if (!hx711_ready(hx)) {
+        return false;
+    }
+
+    // Sem interrupções: um pulso esticado por elas desligaria o chip
+    uint32_t value = 0;
+    uint32_t irq = save_and_disable_interrupts();
+    for (int i = 0; i < HX711_PULSES_GAIN_128; i++) {
+        gpio_put(hx->sck_pin, true);
+        busy_wait_us_32(HX711_CLOCK_HALF_US);
+        gpio_put(hx->sck_pin, false);
+        busy_wait_us_32(HX711_CLOCK_HALF_US);
+        if (i < 24) {
+            value = (value << 1) | (gpio_get(hx->dout_pin) ? 1u : 0u);
+        }
+    }
+    restore_interrupts(irq);
+
+    // Estende o sinal dos 24 bits
+    *raw = (int32_t)(value << 8) >> 8;
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef HX711_H
+#define HX711_H
+
+#include "pico/stdlib.h"
+
+/**
+ * HX711: ADC de 24 bits para célula de carga (peso do carretel)
+ *
+ * Conversão contínua a 10 SPS (pino RATE em GND) ou 80 SPS (RATE em VCC).
+ * DOUT vai a nível baixo com uma conversão pronta; cada pulso em PD_SCK
+ * tira um bit (MSB primeiro, complemento de dois) e os pulsos extras depois
+ * dos 24 bits escolhem canal e ganho da próxima conversão. PD_SCK alto por
+ * mais de 60 us desliga o chip, então a leitura (~50 us) roda com as
+ * interrupções mascaradas.
+ *
+ * A leitura não espera: sem conversão pronta hx711_read() volta na hora.
+ */
+
+#define HX711_PULSES_GAIN_128 25        // 24 bits + 1: canal A, ganho 128
+#define HX711_CLOCK_HALF_US 1           // Meio período do PD_SCK (us)
+
+typedef struct {
+    uint dout_pin;
+    uint sck_pin;
+} hx711_t;
+
+/**
+ * Configura DOUT como entrada e PD_SCK como saída baixa (chip ligado)
+ */
+void hx711_init(hx711_t *hx, uint dout_pin, uint sck_pin);
+
+/**
+ * Conversão pronta (DOUT baixo)
+ */
+bool hx711_ready(const hx711_t *hx);
+
+/**
+ * Lê a conversão pronta
+ * @param raw Recebe o valor com sinal (-8388608 a 8388607)
+ * @return false se não há conversão pronta
+ */
+bool hx711_read(const hx711_t *hx, int32_t *raw);
+
+#endif // HX711_H
@@ -0,0 +1,141 @@
+#include "load_cell.h"
+#include "logger.h"
+
+#define TAG "LoadCell"
+
+static void reset_history(load_cell_t *lc) {
+    lc->history_count = 0;
+    lc->history_pos = 0;
+    lc->next_history_ms = 0;
+    lc->rate_valid = false;
+    lc->loss_rate_gph = 0.0f;
+    lc->start_mass_g = 0.0f;
+}
+
+void load_cell_init(load_cell_t *lc, uint dout_pin, uint sck_pin, int32_t offset, float counts_per_g) {
+    hx711_init(&lc->hx, dout_pin, sck_pin);
+    lc->offset = offset;
+    lc->counts_per_g = counts_per_g;
+    lc->median_count = 0;
+    lc->median_pos = 0;
+    lc->filtered_counts = 0.0f;
+    lc->filtered_valid = false;
+    lc->last_sample_ms = 0;
+    lc->mass_g = 0.0f;
+    lc->samples = 0;
+    reset_history(lc);
+    LOGI(TAG, "HX711 on DOUT GPIO %d, SCK GPIO %d (tare %ld, %.1f counts/g)",
+         dout_pin, sck_pin, offset, counts_per_g);
+}
+
+static int32_t median(const int32_t *values, uint8_t count) {
+    int32_t sorted[LOAD_CELL_MEDIAN_SIZE];
+    for (uint8_t i = 0; i < count; i++) {
+        int32_t v = values[i];
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    return sorted[count / 2];
+}
+
+// Inclinação por mínimos quadrados dos pontos (x = 0, 1, ..., mais antigo primeiro)
+static float history_slope(const load_cell_t *lc) {
+    uint8_t n = lc->history_count;
+    uint8_t first = (uint8_t)((lc->history_pos + LOAD_CELL_RATE_POINTS - n) % LOAD_CELL_RATE_POINTS);
+    float x_mean = (n - 1) / 2.0f;
+    float y_mean = 0.0f;
+    for (uint8_t i = 0; i < n; i++) {
+        y_mean += lc->history[(first + i) % LOAD_CELL_RATE_POINTS];
+    }
+    y_mean /= n;
+    float sxy = 0.0f;
+    float sxx = 0.0f;
+    for (uint8_t i = 0; i < n; i++) {
+        float dx = i - x_mean;
+        sxy += dx * (lc->history[(first + i) % LOAD_CELL_RATE_POINTS] - y_mean);
+        sxx += dx * dx;
+    }
+    return sxx > 0.0f ? sxy / sxx : 0.0f;
+}
+
+static void update_rate(load_cell_t *lc, uint32_t now_ms) {
+    if (lc->next_history_ms == 0) {
+        lc->start_mass_g = lc->mass_g;
+        lc->next_history_ms = now_ms;
+    }
+    if ((int32_t)(now_ms - lc->next_history_ms) < 0) {
+        return;
+    }
+    lc->next_history_ms += LOAD_CELL_RATE_STEP_MS;
+    lc->history[lc->history_pos] = lc->mass_g;
+    lc->history_pos = (uint8_t)((lc->history_pos + 1) % LOAD_CELL_RATE_POINTS);
+    if (lc->history_count < LOAD_CELL_RATE_POINTS) {
+        lc->history_count++;
+    }
+    if (lc->history_count >= LOAD_CELL_RATE_MIN_POINTS) {
+        lc->loss_rate_gph = -history_slope(lc) * (3600000.0f / LOAD_CELL_RATE_STEP_MS);
+        lc->rate_valid = true;
+    }
+}
+
+bool load_cell_update(load_cell_t *lc, uint32_t now_ms) {
+    int32_t raw;
+    if (!hx711_read(&lc->hx, &raw)) {
+        return false;
+    }
+    lc->samples++;
+    lc->last_sample_ms = now_ms ? now_ms : 1;
+
+    lc->median_window[lc->median_pos] = raw;
+    lc->median_pos = (uint8_t)((lc->median_pos + 1) % LOAD_CELL_MEDIAN_SIZE);
+    if (lc->median_count < LOAD_CELL_MEDIAN_SIZE) {
+        lc->median_count++;
+        if (lc->median_count < LOAD_CELL_MEDIAN_SIZE) {
+            return true;                // Mediana ainda incompleta
+        }
+    }
+    float m = (float)median(lc->median_window, lc->median_count);
+    if (!lc->filtered_valid) {
+        lc->filtered_counts = m;
+        lc->filtered_valid = true;
+    } else {
+        lc->filtered_counts += (m - lc->filtered_counts) * LOAD_CELL_EMA_ALPHA;
+    }
+    lc->mass_g = (lc->filtered_counts - (float)lc->offset) / lc->counts_per_g;
+    update_rate(lc, now_ms);
+    return true;
+}
+
+bool load_cell_valid(const load_cell_t *lc, uint32_t now_ms) {
+    return lc->filtered_valid && lc->last_sample_ms != 0 && now_ms - lc->last_sample_ms < LOAD_CELL_STALE_MS;
+}
+
+void load_cell_tare(load_cell_t *lc) {
+    if (!lc->filtered_valid) {
+        return;
+    }
+    lc->offset = (int32_t)lc->filtered_counts;
+    lc->mass_g = 0.0f;
+    reset_history(lc);
+    LOGI(TAG, "Tare set to %ld counts", lc->offset);
+}
+
+void load_cell_calibrate(load_cell_t *lc, float known_mass_g) {
+    float counts = lc->filtered_counts - (float)lc->offset;
+    if (!lc->filtered_valid || known_mass_g <= 0.0f || counts <= 0.0f) {
+        LOGW(TAG, "Calibration ignored (%.0f counts over tare for %.1f g)", counts, known_mass_g);
+        return;
+    }
+    lc->counts_per_g = counts / known_mass_g;
+    lc->mass_g = known_mass_g;
+    reset_history(lc);
+    LOGI(TAG, "Calibrated: %.2f counts/g", lc->counts_per_g);
+}
+
+float load_cell_raw_counts(const load_cell_t *lc) {
+    return lc->filtered_counts;
+}
@@ -0,0 +1,92 @@
+#ifndef LOAD_CELL_H
+#define LOAD_CELL_H
+
+#include "hx711.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Peso do carretel pela célula de carga (HX711) e taxa de perda de massa
+ *
+ * A perda de massa é a única medida direta da água que sai do filamento: a
+ * umidade do ar só mostra o que ainda está no ar da câmara. Cada conversão
+ * (10 ou 80 SPS) passa por uma mediana de LOAD_CELL_MEDIAN_SIZE (descarta
+ * leituras com bit errado ou um tranco no carretel) e por uma média
+ * exponencial; massa = (contagens - tara) / contagens_por_grama.
+ *
+ * Taxa de perda: um ponto da massa filtrada a cada LOAD_CELL_RATE_STEP_MS
+ * e regressão linear nos últimos LOAD_CELL_RATE_POINTS (30 min), em g/h
+ * (positiva = perdendo massa). A 0.1 g de ruído a inclinação resolve
+ * ~0.02 g/h, bem abaixo do ~1 g/h do início da secagem.
+ *
+ * Tara e calibração: LOAD_CELL_OFFSET e LOAD_CELL_COUNTS_PER_G em
+ * dryer_config.h (contagens cruas no log de estatísticas, com a plataforma
+ * vazia e com um peso conhecido), ou load_cell_tare()/load_cell_calibrate()
+ * em operação.
+ */
+
+#define LOAD_CELL_MEDIAN_SIZE 5         // Conversões na mediana
+#define LOAD_CELL_EMA_ALPHA 0.1f        // Peso da mediana nova (~1 s a 10 SPS)
+#define LOAD_CELL_STALE_MS 1000         // Sem conversão há isso: HX711 ausente ou travado
+#define LOAD_CELL_RATE_STEP_MS 60000    // Um ponto da regressão por minuto
+#define LOAD_CELL_RATE_POINTS 30        // Janela da regressão (pontos)
+#define LOAD_CELL_RATE_MIN_POINTS 5     // Pontos para a primeira taxa
+
+typedef struct {
+    hx711_t hx;
+    int32_t offset;                     // Contagens com a plataforma vazia (tara)
+    float counts_per_g;                 // Calibração
+
+    // Filtro
+    int32_t median_window[LOAD_CELL_MEDIAN_SIZE];
+    uint8_t median_count;
+    uint8_t median_pos;
+    float filtered_counts;
+    bool filtered_valid;
+    uint32_t last_sample_ms;            // Última conversão lida (0 = nenhuma)
+
+    // Regressão da taxa (pontos igualmente espaçados, buffer circular)
+    float history[LOAD_CELL_RATE_POINTS];
+    uint8_t history_count;
+    uint8_t history_pos;
+    uint32_t next_history_ms;
+
+    // Saídas
+    float mass_g;                       // Massa filtrada sobre a plataforma
+    float start_mass_g;                 // Primeira massa válida da sessão
+    float loss_rate_gph;                // Perda de massa (g/h, positiva = secando)
+    bool rate_valid;
+
+    // Estatísticas
+    uint32_t samples;
+} load_cell_t;
+
+void load_cell_init(load_cell_t *lc, uint dout_pin, uint sck_pin, int32_t offset, float counts_per_g);
+
+/**
+ * Lê a conversão pronta do HX711, se houver (chamar na taxa do HX711)
+ * @return true se entrou uma conversão nova
+ */
+bool load_cell_update(load_cell_t *lc, uint32_t now_ms);
+
+/**
+ * Massa e taxa valem: conversão recente e filtro preenchido
+ */
+bool load_cell_valid(const load_cell_t *lc, uint32_t now_ms);
+
+/**
+ * Tara: a leitura filtrada atual passa a ser zero (plataforma vazia)
+ */
+void load_cell_tare(load_cell_t *lc);
+
+/**
+ * Calibração com um peso conhecido sobre a plataforma (depois da tara)
+ */
+void load_cell_calibrate(load_cell_t *lc, float known_mass_g);
+
+/**
+ * Contagens filtradas sem tara nem calibração (para levantar as constantes)
+ */
+float load_cell_raw_counts(const load_cell_t *lc);
+
+#endif // LOAD_CELL_H
@@ -0,0 +1,105 @@
+#include "ntc.h"
+#include "hardware/adc.h"
+#include "logger.h"
+
+#define TAG "NTC"
+
+// Configurações do ADC do RP2040
+#define ADC_VREF 3.3f
+#define ADC_RANGE 4096.0f
+
+// Limites de tensão para detectar falha do termistor
+#define NTC_OPEN_VOLTAGE 3.25f      // ~0°C: acima disso o NTC está aberto
+#define NTC_SHORT_VOLTAGE 0.05f     // Acima de 300°C: abaixo disso o NTC está em curto
+
+#define KELVIN_OFFSET 273.15f
+
+// Tabela de linearização: temperatura a cada NTC_TABLE_STEP contagens do ADC
+#define NTC_TABLE_STEP 32
+#define NTC_TABLE_SIZE (4096 / NTC_TABLE_STEP + 1)
+
+// ln(R / R25) do NTC com o ADC em 'c' contagens (divisor com pull-up).
+// As pontas (0 e 4096) são deslocadas meia contagem só para o valor ser finito:
+// nessa região a leitura já é tratada como curto ou aberto.
+#define NTC_ADC_CLAMP(c) ((c) < 0.5f ? 0.5f : ((c) > 4095.5f ? 4095.5f : (c)))
+#define NTC_LN_RATIO(c) \
+    __builtin_logf(NTC_PULLUP * NTC_ADC_CLAMP(c) / ((ADC_RANGE - NTC_ADC_CLAMP(c)) * NTC_R25))
+
+// 1/T em Kelvin: Steinhart-Hart se os coeficientes foram definidos, senão Beta
+#ifdef NTC_SH_A
+#define NTC_INV_KELVIN(c) (NTC_SH_A + NTC_SH_B * (NTC_LN_RATIO(c) + __builtin_logf(NTC_R25)) + \
+    NTC_SH_C * (NTC_LN_RATIO(c) + __builtin_logf(NTC_R25)) * \
+    (NTC_LN_RATIO(c) + __builtin_logf(NTC_R25)) * (NTC_LN_RATIO(c) + __builtin_logf(NTC_R25)))
+#else
+#define NTC_INV_KELVIN(c) (1.0f / (25.0f + KELVIN_OFFSET) + NTC_LN_RATIO(c) / NTC_BETA)
+#endif
+
+#define NTC_ENTRY(i) (1.0f / NTC_INV_KELVIN((float)((i) * NTC_TABLE_STEP)) - KELVIN_OFFSET)
+#define NTC_ENTRIES_8(i) NTC_ENTRY(i), NTC_ENTRY(i + 1), NTC_ENTRY(i + 2), NTC_ENTRY(i + 3), \
+    NTC_ENTRY(i + 4), NTC_ENTRY(i + 5), NTC_ENTRY(i + 6), NTC_ENTRY(i + 7)
+#define NTC_ENTRIES_64(i) NTC_ENTRIES_8(i), NTC_ENTRIES_8(i + 8), NTC_ENTRIES_8(i + 16), \
+    NTC_ENTRIES_8(i + 24), NTC_ENTRIES_8(i + 32), NTC_ENTRIES_8(i + 40), \
+    NTC_ENTRIES_8(i + 48), NTC_ENTRIES_8(i + 56)
+
+// Gerada pelo compilador a partir dos coeficientes (o GCC resolve __builtin_logf com
+// argumentos constantes): nenhum log() em tempo de execução. Erro da interpolação
+// abaixo de 0.1°C entre 20 e 150°C.
+static const float ntc_table[NTC_TABLE_SIZE] = {
+    NTC_ENTRIES_64(0), NTC_ENTRIES_64(64), NTC_ENTRY(128)
+};
+
+_Static_assert(NTC_TABLE_SIZE == 129, "NTC table generator covers 129 entries");
+
+static uint gpio_pin_stored;
+
+void _ntc_init_internal(uint gpio_pin) {
+    gpio_pin_stored = gpio_pin;
+    adc_gpio_init(gpio_pin);
+}
+
+bool ntc_init_pin(uint gpio_pin) {
+    if (gpio_pin < 26 || gpio_pin > 28) {
+        return false;
+    }
+    adc_gpio_init(gpio_pin);
+    return true;
+}
+
+float ntc_read_temperature(ntc_status_t *status) {
+    return ntc_read_temperature_pin(gpio_pin_stored, status);
+}
+
+float ntc_read_temperature_pin(uint gpio_pin, ntc_status_t *status) {
+    adc_select_input(gpio_pin - 26);
+
+    // Soma de algumas conversões (cada uma leva 2 us)
+    uint32_t sum = 0;
+    for (int i = 0; i < NTC_OVERSAMPLE; i++) {
+        sum += adc_read();
+    }
+
+    float voltage = ((float)sum / NTC_OVERSAMPLE / ADC_RANGE) * ADC_VREF;
+
+    ntc_status_code_t code = NTC_OK;
+    if (voltage >= NTC_OPEN_VOLTAGE) {
+        code = NTC_OPEN;
+    } else if (voltage <= NTC_SHORT_VOLTAGE) {
+        code = NTC_SHORT;
+    }
+
+    if (status) {
+        status->code = code;
+        status->gpio_pin = gpio_pin;
+        status->voltage = voltage;
+    }
+    if (code != NTC_OK) {
+        return 0.0f;
+    }
+
+    // Interpolação linear na tabela, direto sobre a soma (sem perder a resolução
+    // extra da média): cada entrada cobre NTC_TABLE_STEP * NTC_OVERSAMPLE
+    const uint32_t span = NTC_TABLE_STEP * NTC_OVERSAMPLE;
+    uint32_t index = sum / span;
+    float frac = (float)(sum % span) / (float)span;
+    return ntc_table[index] + (ntc_table[index + 1] - ntc_table[index]) * frac;
+}
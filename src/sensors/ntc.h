@@ -0,0 +1,74 @@
+#ifndef NTC_H
+#define NTC_H
+
+#include "pico/stdlib.h"
+
+/**
+ * Termistor NTC no bloco do heater (hotend)
+ *
+ * Divisor de tensão: 3.3V -> resistor de pull-up -> pino ADC -> NTC -> GND.
+ * Mesmo termistor dos hotends de impressora 3D (100k, Beta 3950) com o
+ * pull-up de 4.7k usado nas placas de impressora.
+ *
+ * A conversão contagens -> °C usa uma tabela com interpolação linear gerada
+ * em tempo de compilação a partir dos coeficientes abaixo (sem log() em
+ * tempo de execução): uma leitura leva ~40 us, o que permite amostrar a
+ * 100 Hz ou mais, contra 0.5 Hz do DHT22.
+ */
+
+// Configurações do termistor e do divisor
+#define NTC_R25 100000.0f           // Resistência a 25°C (ohm)
+#define NTC_BETA 3950.0f            // Coeficiente Beta (K)
+#define NTC_PULLUP 4700.0f          // Resistor de pull-up para 3.3V (ohm)
+#define NTC_OVERSAMPLE 16           // Leituras do ADC somadas por amostra
+
+// Opcional: coeficientes de Steinhart-Hart (1/T = A + B ln R + C ln³ R) no lugar
+// do Beta, para termistores com curva de fabricante
+// #define NTC_SH_A 0.0007926f
+// #define NTC_SH_B 0.0002086f
+// #define NTC_SH_C 1.079e-7f
+
+typedef enum {
+    NTC_OK,
+    NTC_OPEN,       // Tensão perto de 3.3V: termistor desconectado
+    NTC_SHORT       // Tensão perto de 0V: termistor em curto
+} ntc_status_code_t;
+
+typedef struct {
+    ntc_status_code_t code;
+    uint gpio_pin;  // GPIO onde o divisor está conectado
+    float voltage;  // Tensão lida (para diagnóstico)
+} ntc_status_t;
+
+/**
+ * Inicializa o termistor no pino especificado.
+ * @param gpio_pin Pino GPIO conectado ao divisor (deve ser um pino ADC: 26, 27, 28)
+ */
+void _ntc_init_internal(uint gpio_pin);
+
+// Macro para validar o pino em tempo de compilação
+#define ntc_init(pin) do { \
+    _Static_assert((pin) == 26 || (pin) == 27 || (pin) == 28, "NTC must use ADC pins 26, 27, or 28"); \
+    _ntc_init_internal(pin); \
+} while(0)
+
+/**
+ * Lê a temperatura do termistor em °C.
+ * @param status Ponteiro para armazenar o status da leitura (opcional, pode ser NULL)
+ * @return Temperatura em °C (0 se a leitura não for NTC_OK)
+ */
+float ntc_read_temperature(ntc_status_t *status);
+
+/**
+ * Inicializa um termistor adicional sem trocar o pino padrão
+ * @param gpio_pin Pino ADC (26, 27 ou 28), validado em tempo de execução
+ * @return false se o pino não é uma entrada do ADC
+ */
+bool ntc_init_pin(uint gpio_pin);
+
+/**
+ * Lê o termistor no pino informado (inicializado com ntc_init() ou ntc_init_pin())
+ */
+float ntc_read_temperature_pin(uint gpio_pin, ntc_status_t *status);
+
+#endif // NTC_H
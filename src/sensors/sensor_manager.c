@@ -1,43 +1,70 @@
 #include "sensor_manager.h"
 #include "dht22.h"
 #include "acs712.h"
+#include "ntc.h"
+#include "hardware_control.h"
 #include "logger.h"
 #include "hardware/adc.h"
 #include "pico/time.h"
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define TAG "SensorMgr"
 
-// Variáveis privadas do módulo DHT22
-static uint32_t last_dht22_read = 0;
-static float last_temperature = 25.0;
-static float last_humidity = 50.0;
-static bool dht22_initialized = false;
-static uint32_t dht22_error_count = 0;
-static uint32_t acs712_error_count = 0;
-
-// Inicialização do módulo de sensores
-void sensor_manager_init(void) {
-    // Inicializar ADC para sensor de energia
+// Inicialização dos sensores de uma câmara
+void sensor_manager_init(sensor_manager_t *sm, const sensor_manager_config_t *config) {
+    sm->config = *config;
+    
+    // Inicializar ADC para sensor de energia (várias câmaras: o mesmo ADC)
     adc_init();
-    acs712_init(ENERGY_SENSOR_PIN);
+    if (config->energy_pin != SENSOR_PIN_NONE && !acs712_init_pin(config->energy_pin)) {
+        LOGE(TAG, "ACS712 GPIO %d is not an ADC input, energy monitoring disabled", config->energy_pin);
+        sm->config.energy_pin = SENSOR_PIN_NONE;
+    }
+    if (config->ntc_pin != SENSOR_PIN_NONE && !ntc_init_pin(config->ntc_pin)) {
+        LOGE(TAG, "NTC GPIO %d is not an ADC input, block temperature disabled", config->ntc_pin);
+        sm->config.ntc_pin = SENSOR_PIN_NONE;
+    }
+    if (config->tach_pin != SENSOR_PIN_NONE && !fan_tach_init(&sm->fan, config->tach_pin)) {
+        sm->config.tach_pin = SENSOR_PIN_NONE;
+    }
+    if (config->load_cell_dout_pin != SENSOR_PIN_NONE) {
+        load_cell_init(&sm->load_cell, config->load_cell_dout_pin, config->load_cell_sck_pin,
+                       LOAD_CELL_OFFSET, LOAD_CELL_COUNTS_PER_G);
+    }
     
     // Reset das variáveis DHT22
-    last_dht22_read = 0;
-    last_temperature = 25.0;
-    last_humidity = 50.0;
-    dht22_initialized = false;
-    dht22_error_count = 0;
-    acs712_error_count = 0;
-    
-    LOGI(TAG, "Initialized (DHT22: GPIO %d, ACS712: GPIO %d)", 
-           DHT22_PIN, ENERGY_SENSOR_PIN);
+    sm->last_dht22_read = 0;
+    sm->last_dht22_valid = 0;
+    sm->last_temperature = 25.0;
+    sm->last_humidity = 50.0;
+    sm->dht22_initialized = false;
+    sm->dht22_error_count = 0;
+    sm->acs712_error_count = 0;
+    sm->energy_full_power = 0.0f;
+    
+    // Sensor ambiente começa inválido até a primeira leitura boa
+    sm->last_ambient_read = 0;
+    sm->last_ambient_temperature = AMBIENT_TEMP_DEFAULT;
+    sm->last_ambient_humidity = AMBIENT_RH_DEFAULT;
+    sm->ambient_error_count = AMBIENT_MAX_CONSECUTIVE_ERRORS;
+    
+    // NTC do bloco começa inválido até a primeira leitura boa
+    sm->last_block_temperature = 0.0f;
+    sm->block_error_count = BLOCK_NTC_MAX_CONSECUTIVE_ERRORS;
+    if (config->ambient_pin != SENSOR_PIN_NONE) {
+        dht22_init_pin(config->ambient_pin);
+        LOGI(TAG, "Ambient DHT22 initialized (GPIO %d)", config->ambient_pin);
+    }
+    
+    LOGI(TAG, "Initialized (DHT22: GPIO %d, ACS712: GPIO %d, NTC: GPIO %d)", 
+           config->dht22_pin, sm->config.energy_pin, sm->config.ntc_pin);
 }
 
 // Leitura do DHT22
-static void read_dht22_sensor(sensor_data_t *sensor_data) {
+static void read_dht22_sensor(sensor_manager_t *sm, sensor_data_t *sensor_data) {
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
     
     // Inicializar eventos como false por padrão
@@ -46,32 +73,33 @@ static void read_dht22_sensor(sensor_data_t *sensor_data) {
     strcpy(sensor_data->dht_status, "Nenhum erro");
     
     // Inicializar DHT22 na primeira chamada
-    if (!dht22_initialized) {
-        dht22_init(DHT22_PIN);
-        dht22_initialized = true;
-        LOGI(TAG, "DHT22 initialized (GPIO %d)", DHT22_PIN);
-        last_dht22_read = current_time;
+    if (!sm->dht22_initialized) {
+        dht22_init_pin(sm->config.dht22_pin);
+        sm->dht22_initialized = true;
+        LOGI(TAG, "DHT22 initialized (GPIO %d)", sm->config.dht22_pin);
+        sm->last_dht22_read = current_time;
         sensor_data->sensor_safe = true;
         LOGI(TAG, "DHT22 ready for readings");
     }
     
     // Verificar se já passou tempo suficiente desde a última leitura
-    if (current_time - last_dht22_read >= DHT22_READ_INTERVAL_MS) {
-        last_dht22_read = current_time;
+    if (current_time - sm->last_dht22_read >= DHT22_READ_INTERVAL_MS) {
+        sm->last_dht22_read = current_time;
         
         float new_temp, new_hum;
-        dht22_result_t result = dht22_read(&new_temp, &new_hum);
+        dht22_result_t result = dht22_read_pin(sm->config.dht22_pin, &new_temp, &new_hum);
         
         if (result == DHT22_OK) {
             // SENSOR OK - Sistema pode operar normalmente
-            last_temperature = new_temp;
-            last_humidity = new_hum;
-            dht22_error_count = 0; // Reset contador de erros
+            sm->last_temperature = new_temp;
+            sm->last_humidity = new_hum;
+            sm->last_dht22_valid = current_time;
+            sm->dht22_error_count = 0; // Reset contador de erros
             sensor_data->sensor_safe = true;
             
         } else {
             // ERRO CRÍTICO - Reportar evento de falha
-            dht22_error_count++;
+            sm->dht22_error_count++;
             sensor_data->sensor_failure_event = true;  // Reportar evento de falha
             
             // Armazenar mensagem da última falha
@@ -79,35 +107,75 @@ static void read_dht22_sensor(sensor_data_t *sensor_data) {
                     "%s", dht22_error_string(result));
             
             LOGE(TAG, "DHT22 CRITICAL ERROR #%lu: %s", 
-                   dht22_error_count, dht22_error_string(result));
+                   sm->dht22_error_count, dht22_error_string(result));
             
             // PARADA DE SEGURANÇA se muitos erros consecutivos
-            if (dht22_error_count >= DHT22_MAX_CONSECUTIVE_ERRORS) {
+            if (sm->dht22_error_count >= DHT22_MAX_CONSECUTIVE_ERRORS) {
                 sensor_data->sensor_safe = false;
-                if (dht22_error_count == DHT22_MAX_CONSECUTIVE_ERRORS) {
+                if (sm->dht22_error_count == DHT22_MAX_CONSECUTIVE_ERRORS) {
                     // Apenas logar na primeira vez que atingir o limite
                     sensor_data->unsafe_event = true;  // Reportar evento unsafe
                     LOGE(TAG, "CRITICAL: DHT22 SENSOR FAILURE!");
                     LOGE(TAG, "Heater disabled for safety");
                     LOGE(TAG, "Check sensor connections");
-                    LOGE(TAG, "Consecutive errors: %lu", dht22_error_count);
+                    LOGE(TAG, "Consecutive errors: %lu", sm->dht22_error_count);
                 }
             }
         }
     }
     
     // IMPORTANTE: Preencher estrutura com últimos valores mesmo com erro
-    sensor_data->temperature = last_temperature;
-    sensor_data->humidity = last_humidity;
-    sensor_data->error_count = dht22_error_count;
+    sensor_data->temperature = sm->last_temperature;
+    sensor_data->humidity = sm->last_humidity;
+    sensor_data->last_read_time = sm->last_dht22_valid;
+    sensor_data->error_count = sm->dht22_error_count;
+}
+
+// Leitura do DHT22 ambiente (opcional, não participa da segurança)
+static void read_ambient_sensor(sensor_manager_t *sm, sensor_data_t *sensor_data) {
+    uint32_t current_time = to_ms_since_boot(get_absolute_time());
+    
+    // Primeira leitura imediata, depois a cada AMBIENT_READ_INTERVAL_MS
+    bool first_read = (sm->last_ambient_read == 0);
+    if (sm->config.ambient_pin != SENSOR_PIN_NONE &&
+        (first_read || current_time - sm->last_ambient_read >= AMBIENT_READ_INTERVAL_MS)) {
+        sm->last_ambient_read = current_time;
+        
+        float new_temp, new_hum;
+        dht22_result_t result = dht22_read_pin(sm->config.ambient_pin, &new_temp, &new_hum);
+        if (result == DHT22_OK) {
+            sm->last_ambient_temperature = new_temp;
+            sm->last_ambient_humidity = new_hum;
+            sm->ambient_error_count = 0;
+        } else if (sm->ambient_error_count < AMBIENT_MAX_CONSECUTIVE_ERRORS) {
+            sm->ambient_error_count++;
+            LOGW(TAG, "Ambient DHT22 error #%lu: %s", sm->ambient_error_count, dht22_error_string(result));
+            if (sm->ambient_error_count == AMBIENT_MAX_CONSECUTIVE_ERRORS) {
+                LOGW(TAG, "Ambient sensor lost, assuming %.1f°C %.0f%%", AMBIENT_TEMP_DEFAULT, AMBIENT_RH_DEFAULT);
+            }
+        }
+    }
+    
+    // Sem sensor (ou após falhas seguidas) usar os valores ambiente padrão
+    sensor_data->ambient_valid = (sm->ambient_error_count < AMBIENT_MAX_CONSECUTIVE_ERRORS);
+    sensor_data->ambient_temperature = sensor_data->ambient_valid ?
+                                       sm->last_ambient_temperature : AMBIENT_TEMP_DEFAULT;
+    sensor_data->ambient_humidity = sensor_data->ambient_valid ?
+                                    sm->last_ambient_humidity : AMBIENT_RH_DEFAULT;
 }
 
 // Leitura do sensor de energia (ACS712)
-static float sensor_manager_read_energy(bool *disconnected) {
+static float sensor_manager_read_energy(sensor_manager_t *sm, bool *disconnected) {
+    // Câmara sem ACS712: mesmo tratamento do sensor desconectado, sem log
+    if (sm->config.energy_pin == SENSOR_PIN_NONE) {
+        *disconnected = true;
+        return 0.0f;
+    }
+    
     // Retorna potência em Watts (P = V * I)
     // Hotend em 12V de alimentação
     acs712_status_t status;
-    float current = acs712_read_current(&status);
+    float current = acs712_read_current_pin(sm->config.energy_pin, &status);
     
     if (status.code == ACS712_DISCONNECTED) {
         // Sensor desconectado - sistema pode funcionar sem ele
@@ -127,54 +195,143 @@ static float sensor_manager_read_energy(bool *disconnected) {
     return current * 12.0f;
 }
 
-// Detecção de falha do hotend
-static void check_heater_failure(sensor_data_t *sensor_data, bool heater_on) {
+// Potência média no duty pedido a partir da medida no duty aplicado na janela.
+// Só janelas com o mesmo nível do início ao fim (PWM, sigma-delta, trecho
+// cheio ou vazio do burst) medem a potência sem o erro das bordas.
+static float energy_average(sensor_manager_t *sm, float power, float applied, float applied_min, float commanded) {
+    bool uniform = applied - applied_min < ENERGY_DUTY_MATCH;
+    if (uniform && hardware_control_heater_is_active(applied)) {
+        sm->energy_full_power = power * 100.0f / applied;
+    }
+    if (uniform && fabsf(applied - commanded) < ENERGY_DUTY_MATCH) {
+        return power;
+    }
+    return sm->energy_full_power * commanded / 100.0f;
+}
+
+// Detecção de falha do hotend (medida x duty aplicado na mesma janela)
+static void check_heater_failure(sensor_manager_t *sm, sensor_data_t *sensor_data, bool heater_on) {
     // Inicializar como sem falha
     sensor_data->heater_failure = false;
     
     // Se aquecedor está ligado, verificar se está consumindo energia
     if (heater_on) {
-        if (sensor_data->energy_current < ACS712_MIN_ENERGY_THRESHOLD) {
+        if (sensor_data->energy_read < ACS712_MIN_ENERGY_THRESHOLD) {
             // Aquecedor ligado mas SEM corrente - possível falha
-            acs712_error_count++;
+            sm->acs712_error_count++;
             
             LOGW(TAG, "ACS712: Heater ON but no current detected (%.2fW < %.2fW threshold) - Error #%lu/%lu", 
-                sensor_data->energy_current, ACS712_MIN_ENERGY_THRESHOLD, 
-                acs712_error_count, (uint32_t)ACS712_MAX_CONSECUTIVE_ERRORS);
+                sensor_data->energy_read, ACS712_MIN_ENERGY_THRESHOLD, 
+                sm->acs712_error_count, (uint32_t)ACS712_MAX_CONSECUTIVE_ERRORS);
             
-            if (acs712_error_count >= ACS712_MAX_CONSECUTIVE_ERRORS) {
+            if (sm->acs712_error_count >= ACS712_MAX_CONSECUTIVE_ERRORS) {
                 sensor_data->heater_failure = true;
                 
-                if (acs712_error_count == ACS712_MAX_CONSECUTIVE_ERRORS) {
+                if (sm->acs712_error_count == ACS712_MAX_CONSECUTIVE_ERRORS) {
                     LOGW(TAG, "WARNING: Possible heating system failure detected");
                     LOGW(TAG, "If temperature doesn't rise, check hotend/MOSFET.");
                 }
             }
         } else {
             // Corrente detectada - reset contador
-            acs712_error_count = 0;
+            sm->acs712_error_count = 0;
         }
     }
     
-    sensor_data->heater_error_count = acs712_error_count;
+    sensor_data->heater_error_count = sm->acs712_error_count;
+}
+
+// Ventoinha de circulação: o contador corre no hardware, aqui só a amostra
+static void read_fan_tach(sensor_manager_t *sm, sensor_data_t *sensor_data) {
+    sensor_data->fan_monitored = sm->config.tach_pin != SENSOR_PIN_NONE;
+    if (!sensor_data->fan_monitored) {
+        sensor_data->fan_failure = false;
+        sensor_data->fan_degraded = false;
+        return;
+    }
+    fan_tach_update(&sm->fan);
+    sensor_data->fan_rpm = sm->fan.sample.rpm;
+    sensor_data->fan_sample_time = sm->fan.sample.time_ms;
+    sensor_data->fan_failure = sm->fan.stalled;
+    sensor_data->fan_degraded = sm->fan.degraded;
+}
+
+// Célula de carga: as conversões entram pela tarefa própria, aqui só o resultado
+static void read_load_cell(sensor_manager_t *sm, sensor_data_t *sensor_data) {
+    const load_cell_t *lc = &sm->load_cell;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    sensor_data->spool_valid = sm->config.load_cell_dout_pin != SENSOR_PIN_NONE && load_cell_valid(lc, now);
+    if (!sensor_data->spool_valid) {
+        sensor_data->mass_rate_valid = false;
+        return;
+    }
+    sensor_data->spool_mass_g = lc->mass_g;
+    sensor_data->spool_mass_lost_g = lc->start_mass_g - lc->mass_g;
+    sensor_data->mass_loss_rate_gph = lc->loss_rate_gph;
+    sensor_data->mass_rate_valid = lc->rate_valid;
 }
 
 // Atualizar todos os sensores
-void sensor_manager_update(sensor_data_t *sensor_data, bool heater_on) {
-    read_dht22_sensor(sensor_data);
+void sensor_manager_update(sensor_manager_t *sm, sensor_data_t *sensor_data, float heater_duty) {
+    read_dht22_sensor(sm, sensor_data);
+    read_ambient_sensor(sm, sensor_data);
+    read_fan_tach(sm, sensor_data);
+    read_load_cell(sm, sensor_data);
     
-    // Ler sensor de energia e incluir na mesma estrutura
+    // Ler sensor de energia e incluir na mesma estrutura, com o duty que o
+    // pino teve durante a leitura
     bool acs712_disconnected = false;
-    sensor_data->energy_current = sensor_manager_read_energy(&acs712_disconnected);
+    heater_window_t window;
+    hardware_control_heater_window_begin(sm->config.heater, &window);
+    float duty_min;
+    sensor_data->energy_read = sensor_manager_read_energy(sm, &acs712_disconnected);
+    sensor_data->heater_duty_read = hardware_control_heater_window_duty(sm->config.heater, &window, &duty_min);
+    sensor_data->energy_current = energy_average(sm, sensor_data->energy_read,
+                                                 sensor_data->heater_duty_read, duty_min, heater_duty);
     sensor_data->acs712_disconnected = acs712_disconnected;
     
     // Verificar falha do sistema de aquecimento (só se sensor estiver conectado)
     if (!acs712_disconnected) {
-        check_heater_failure(sensor_data, heater_on);
+        check_heater_failure(sm, sensor_data, hardware_control_heater_is_active(duty_min));
     } else {
         // Sensor desconectado - não há detecção de falha do hotend
         sensor_data->heater_failure = false;
         sensor_data->heater_error_count = 0;
-        acs712_error_count = 0;
+        sm->acs712_error_count = 0;
     }
-}
\ No newline at end of file
+}
+
+// Leitura do NTC do bloco do heater (chamada em alta frequência pela malha interna)
+bool sensor_manager_read_block_temp(sensor_manager_t *sm, float *temperature) {
+    if (sm->config.ntc_pin == SENSOR_PIN_NONE) {
+        *temperature = 0.0f;
+        return false;
+    }
+    ntc_status_t status;
+    float new_temp = ntc_read_temperature_pin(sm->config.ntc_pin, &status);
+    
+    if (status.code == NTC_OK) {
+        if (sm->block_error_count >= BLOCK_NTC_MAX_CONSECUTIVE_ERRORS) {
+            LOGI(TAG, "Block NTC OK (%.1f°C)", new_temp);
+        }
+        sm->last_block_temperature = new_temp;
+        sm->block_error_count = 0;
+    } else if (sm->block_error_count < BLOCK_NTC_MAX_CONSECUTIVE_ERRORS) {
+        sm->block_error_count++;
+        if (sm->block_error_count == BLOCK_NTC_MAX_CONSECUTIVE_ERRORS) {
+            LOGW(TAG, "Block NTC %s on GPIO %d (%.2fV)",
+                 status.code == NTC_OPEN ? "open" : "shorted", status.gpio_pin, status.voltage);
+        }
+    }
+    
+    *temperature = sm->last_block_temperature;
+    return sm->block_error_count < BLOCK_NTC_MAX_CONSECUTIVE_ERRORS;
+}
+
+// Conversão do HX711 (chamada pela tarefa da célula de carga)
+void sensor_manager_sample_load_cell(sensor_manager_t *sm) {
+    if (sm->config.load_cell_dout_pin == SENSOR_PIN_NONE) {
+        return;
+    }
+    load_cell_update(&sm->load_cell, to_ms_since_boot(get_absolute_time()));
+}
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "fan_tach.h"
+#include "load_cell.h"
 
 // Configurações dos sensores
 #define DHT22_PIN 22                       // GPIO para DHT22
@@ -11,24 +13,141 @@
 #define DHT22_MAX_CONSECUTIVE_ERRORS 3     // Máximo de erros consecutivos antes de PARADA DE SEGURANÇA
 #define ACS712_MIN_ENERGY_THRESHOLD 1.2    // Energía mínima em Watts para considerar o hotend ligado 
 #define ACS712_MAX_CONSECUTIVE_ERRORS 5    // Máximo de erros consecutivos antes de PARADA DE SEGURANÇA
+#define ENERGY_DUTY_MATCH 0.5f             // Aplicado na janela ~ pedido (%): a medida já é a média
+
+// Sensor de temperatura ambiente opcional (segundo DHT22, fora da câmara)
+// Usado pelo feed-forward e pela exaustão; sem ele valem AMBIENT_TEMP_DEFAULT e
+// AMBIENT_RH_DEFAULT. Falhas não afetam a segurança.
+#ifndef AMBIENT_SENSOR_ENABLED
+#define AMBIENT_SENSOR_ENABLED 0           // 1 = DHT22 ambiente instalado
+#endif
+#define AMBIENT_DHT22_PIN 15               // GPIO para DHT22 ambiente
+#define AMBIENT_TEMP_DEFAULT 25.0f         // Temperatura ambiente assumida sem sensor (°C)
+#define AMBIENT_RH_DEFAULT 60.0f           // Umidade ambiente assumida sem sensor (%)
+#define AMBIENT_READ_INTERVAL_MS 10000     // Ambiente varia devagar
+#define AMBIENT_MAX_CONSECUTIVE_ERRORS 3   // Erros seguidos antes de voltar ao valor padrão
+
+// NTC no bloco do heater (malha interna do controle em cascata)
+// Lido pela tarefa da malha interna (100 ms), fora do ciclo dos outros sensores
+#define BLOCK_NTC_PIN 28                   // GPIO ADC para o NTC do bloco
+#define BLOCK_NTC_MAX_CONSECUTIVE_ERRORS 5 // Leituras ruins seguidas antes de invalidar
+
+// Tacômetro da ventoinha de circulação (fan_tach): GPIO ímpar num slice PWM livre
+#define FAN_TACH_PIN 9                     // GPIO do tacômetro (slice 4, canal B)
+
+// Célula de carga sob o carretel (HX711, load_cell): a perda de massa é a água
+// que saiu do filamento. Lida pela tarefa da célula de carga, fora do ciclo dos
+// outros sensores; só na primeira câmara. Constantes pelo log de estatísticas
+// (contagens cruas com a plataforma vazia e com um peso conhecido)
+#ifndef LOAD_CELL_ENABLED
+#define LOAD_CELL_ENABLED 0                // 1 = HX711 e célula de carga instalados
+#endif
+#define LOAD_CELL_DOUT_PIN 10              // GPIO do DOUT do HX711
+#define LOAD_CELL_SCK_PIN 11               // GPIO do PD_SCK do HX711
+#define LOAD_CELL_OFFSET 8000              // Contagens com a plataforma vazia (tara)
+#define LOAD_CELL_COUNTS_PER_G 420.0f      // Célula de 5 kg, 1 mV/V, ganho 128
+
+#define SENSOR_PIN_NONE 0xFF               // Sensor não instalado nesta câmara
 
 // Estrutura de dados dos sensores
 typedef struct {
     float temperature;
     float humidity;
+    uint32_t last_read_time;    // Momento da última leitura válida do DHT22 (ms, 0 = nenhuma ainda)
     bool sensor_safe;
     uint32_t error_count;
     bool sensor_failure_event;  // TRUE se houve uma falha de leitura neste ciclo
     bool unsafe_event;          // TRUE se o sistema entrou em modo unsafe neste ciclo
-    float energy_current;       // Consumo de energia atual (W)
+    float energy_current;       // Consumo de energia atual (W), média no duty pedido
+    float energy_read;          // Potência medida na janela do ACS712 (W)
+    float heater_duty_read;     // Duty aplicado durante a janela do ACS712 (%)
     bool heater_failure;        // TRUE se hotend/MOSFET falhou (sem corrente quando ligado)
     uint32_t heater_error_count; // Contador de erros do sistema de aquecimento
     bool acs712_disconnected;   // TRUE se sensor ACS712 está desconectado (pode funcionar sem ele)
     char dht_status[64]; // Descrição da última falha do sensor
+    float ambient_temperature;  // Temperatura ambiente (°C), medida ou AMBIENT_TEMP_DEFAULT
+    float ambient_humidity;     // Umidade ambiente (%), medida ou AMBIENT_RH_DEFAULT
+    bool ambient_valid;         // TRUE se ambient_temperature veio do sensor ambiente
+    bool fan_monitored;         // TRUE se a câmara tem tacômetro
+    float fan_rpm;              // RPM da ventoinha de circulação na última janela
+    uint32_t fan_sample_time;   // Fim da janela da última amostra (ms, 0 = nenhuma ainda)
+    bool fan_failure;           // TRUE se a ventoinha de circulação parou (corta o heater)
+    bool fan_degraded;          // TRUE se o RPM caiu bem abaixo da referência (aviso)
+    bool spool_valid;           // TRUE se a célula de carga tem leitura recente
+    float spool_mass_g;         // Massa sobre a plataforma (g)
+    float spool_mass_lost_g;    // Massa perdida desde o início da sessão (g)
+    float mass_loss_rate_gph;   // Perda de massa (g/h, positiva = secando)
+    bool mass_rate_valid;       // TRUE se a regressão já tem pontos suficientes
 } sensor_data_t;
 
+// Pinos dos sensores de uma câmara (uma linha da CHAMBER_TABLE)
+typedef struct {
+    uint8_t dht22_pin;          // DHT22 da câmara
+    uint8_t energy_pin;         // ACS712 (ADC) ou SENSOR_PIN_NONE
+    uint8_t ntc_pin;            // NTC do bloco (ADC) ou SENSOR_PIN_NONE
+    uint8_t ambient_pin;        // DHT22 ambiente ou SENSOR_PIN_NONE
+    uint8_t tach_pin;           // Tacômetro da ventoinha ou SENSOR_PIN_NONE
+    uint8_t load_cell_dout_pin; // DOUT do HX711 ou SENSOR_PIN_NONE
+    uint8_t load_cell_sck_pin;  // PD_SCK do HX711
+    uint8_t heater;             // Saída do hardware_control medida pelo ACS712
+} sensor_manager_config_t;
+
+// Estado dos sensores de uma câmara (uma instância por câmara)
+typedef struct {
+    sensor_manager_config_t config;
+    
+    // DHT22 da câmara
+    uint32_t last_dht22_read;
+    uint32_t last_dht22_valid;
+    float last_temperature;
+    float last_humidity;
+    bool dht22_initialized;
+    uint32_t dht22_error_count;
+    
+    // ACS712
+    uint32_t acs712_error_count;
+    float energy_full_power;    // Potência a 100% pela última medida com o heater ativo (W)
+    
+    // DHT22 ambiente (opcional)
+    uint32_t last_ambient_read;
+    float last_ambient_temperature;
+    float last_ambient_humidity;
+    uint32_t ambient_error_count;
+    
+    // NTC do bloco
+    float last_block_temperature;
+    uint32_t block_error_count;
+    
+    // Tacômetro da ventoinha de circulação
+    fan_tach_t fan;
+    
+    // Célula de carga do carretel
+    load_cell_t load_cell;
+} sensor_manager_t;
+
 // Funções públicas do módulo
-void sensor_manager_init(void);
-void sensor_manager_update(sensor_data_t *sensor_data, bool heater_on);
+void sensor_manager_init(sensor_manager_t *sm, const sensor_manager_config_t *config);
+
+/**
+ * Lê DHT22, ambiente, ACS712 e tacômetro da câmara
+ * @param heater_duty Duty pedido ao heater (%). Com burst ou sigma-delta a
+ *        janela do ACS712 (~2 ms) vê só parte do padrão: a medida vale para o
+ *        duty aplicado nela e a média é estimada para o duty pedido.
+ */
+void sensor_manager_update(sensor_manager_t *sm, sensor_data_t *sensor_data, float heater_duty);
+
+/**
+ * Lê a temperatura do bloco do heater pelo NTC
+ * @param temperature Recebe a última temperatura válida (°C)
+ * @return false se o NTC está aberto/em curto há BLOCK_NTC_MAX_CONSECUTIVE_ERRORS leituras
+ *         ou a câmara não tem NTC
+ */
+bool sensor_manager_read_block_temp(sensor_manager_t *sm, float *temperature);
+
+/**
+ * Lê a conversão pronta do HX711 (chamada acima da taxa do HX711 pela tarefa
+ * da célula de carga); sem célula de carga não faz nada
+ */
+void sensor_manager_sample_load_cell(sensor_manager_t *sm);
 
 #endif // SENSOR_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "clock_scaling.h"
+#include "logger.h"
+#include "pico/time.h"
+#include "pico/critical_section.h"
+#include "hardware/clocks.h"
+
+#define TAG "Clock"
+
+static critical_section_t clock_lock;
+static bool initialized = false;
+static uint32_t pll_hz;                     // PLL_SYS (clk_sys no boot)
+static uint8_t idle_div_value;
+static uint8_t boost_div_value;
+static clock_scaling_changed_fn changed_fn;
+
+static uint32_t boost_count;                // Pedidos de boost em aberto
+static uint8_t current_div;                 // Divisor aplicado no clk_sys
+static bool switching;                      // Algum núcleo está trocando o clk_sys
+static uint64_t boost_start_us;
+static clock_scaling_stats_t stats;
+
+// Troca o divisor do clk_sys (fonte continua o PLL_SYS) e avisa quem depende dele.
+// Nunca com o clock_lock: o callback pega o lock do PWM, e dois critical
+// sections podem cair no mesmo spinlock
+static void clock_set_div(uint8_t div) {
+    clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                    CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, pll_hz, pll_hz / div);
+    if (changed_fn) {
+        changed_fn();
+    }
+}
+
+// Leva o clk_sys ao divisor que o boost_count pede. Só um núcleo troca por vez;
+// se o outro mudar o boost_count no meio, quem está trocando vê o alvo novo na
+// volta do loop e aplica antes de sair
+static void clock_apply(void) {
+    critical_section_enter_blocking(&clock_lock);
+    if (switching) {
+        critical_section_exit(&clock_lock);
+        return;
+    }
+    switching = true;
+    for (;;) {
+        uint8_t div = boost_count > 0 ? boost_div_value : idle_div_value;
+        if (div == current_div) {
+            break;
+        }
+        critical_section_exit(&clock_lock);
+        clock_set_div(div);
+        critical_section_enter_blocking(&clock_lock);
+        current_div = div;
+        stats.switches++;
+    }
+    switching = false;
+    critical_section_exit(&clock_lock);
+}
+
+void clock_scaling_init(uint8_t idle_div, uint8_t boost_div, clock_scaling_changed_fn on_change) {
+    if (idle_div < 1) idle_div = 1;
+    if (idle_div > CLOCK_SCALING_MAX_DIV) idle_div = CLOCK_SCALING_MAX_DIV;
+    if (boost_div < 1) boost_div = 1;
+    if (boost_div > idle_div) boost_div = idle_div;
+
+    pll_hz = clock_get_hz(clk_sys);
+    idle_div_value = idle_div;
+    boost_div_value = boost_div;
+    changed_fn = on_change;
+    boost_count = 0;
+    current_div = 1;
+    switching = false;
+    stats.idle_hz = pll_hz / idle_div;
+    stats.boost_hz = pll_hz / boost_div;
+    stats.switches = 0;
+    stats.boost_us = 0;
+    stats.max_boost_us = 0;
+    critical_section_init(&clock_lock);
+
+    // Periféricos direto do PLL: o baud do SPI e da UART não depende do clk_sys
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, pll_hz, pll_hz);
+
+    initialized = true;
+    clock_apply();
+
+    LOGI(TAG, "Clock scaling: %lu MHz idle, %lu MHz boost (PLL %lu MHz)",
+         stats.idle_hz / 1000000u, stats.boost_hz / 1000000u, pll_hz / 1000000u);
+}
+
+void clock_scaling_boost(void) {
+    if (!initialized) {
+        return;
+    }
+    critical_section_enter_blocking(&clock_lock);
+    if (boost_count++ == 0) {
+        boost_start_us = time_us_64();
+    }
+    critical_section_exit(&clock_lock);
+    clock_apply();
+}
+
+void clock_scaling_release(void) {
+    if (!initialized) {
+        return;
+    }
+    critical_section_enter_blocking(&clock_lock);
+    if (boost_count > 0 && --boost_count == 0) {
+        uint64_t duration = time_us_64() - boost_start_us;
+        stats.boost_us += duration;
+        if (duration > stats.max_boost_us) {
+            stats.max_boost_us = (uint32_t)duration;
+        }
+    }
+    critical_section_exit(&clock_lock);
+    clock_apply();
+}
+
+void clock_scaling_get_stats(clock_scaling_stats_t *out) {
+    if (!initialized) {
+        *out = stats;
+        return;
+    }
+    critical_section_enter_blocking(&clock_lock);
+    *out = stats;
+    critical_section_exit(&clock_lock);
+}
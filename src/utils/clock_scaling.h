@@ -0,0 +1,58 @@
+#ifndef CLOCK_SCALING_H
+#define CLOCK_SCALING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Escala dinâmica do clock do sistema
+ *
+ * A CPU passa a maior parte do tempo em WFE esperando o próximo evento; o
+ * que ela faz acordada é pouco e curto, com exceção das atualizações do
+ * display (CPU alimentando o SPI pixel a pixel) e de rajadas de cálculo
+ * (MPC). A política: clk_sys baixo o tempo todo e velocidade máxima só
+ * entre clock_scaling_boost() e clock_scaling_release().
+ *
+ * A troca é só no divisor do clk_sys, com o PLL_SYS travado: sem esperar o
+ * PLL. O clock_configure() passa o clk_sys pelo clk_ref por alguns ciclos
+ * durante a troca (o glitchless mux do aux). O clk_peri passa a vir
+ * direto do PLL_SYS, então SPI e UART mantêm o baud com qualquer clk_sys.
+ * O PWM do heater é clocado pelo clk_sys: a cada troca o callback
+ * informado no init reprograma divisor e TOP.
+ *
+ * Pedidos de boost são contados (aninháveis e dos dois núcleos); o clock
+ * volta ao nível baixo quando o último pedido é liberado. A troca acontece
+ * fora do lock da contagem: se o outro núcleo estiver no meio de uma troca,
+ * o boost retorna e é ele quem aplica o clock novo ao terminar.
+ */
+
+#define CLOCK_SCALING_MAX_DIV 16            // Divisor máximo aceito para o nível baixo
+
+typedef void (*clock_scaling_changed_fn)(void);
+
+typedef struct {
+    uint32_t idle_hz;                       // clk_sys no nível baixo
+    uint32_t boost_hz;                      // clk_sys durante o boost
+    uint32_t switches;                      // Trocas de clock
+    uint64_t boost_us;                      // Tempo total em boost
+    uint32_t max_boost_us;                  // Maior boost contínuo
+} clock_scaling_stats_t;
+
+/**
+ * Move o clk_peri para o PLL_SYS e baixa o clk_sys para PLL / idle_div
+ *
+ * @param idle_div Divisor do clk_sys fora do boost (1 = sem escala)
+ * @param boost_div Divisor durante o boost (normalmente 1; igual a idle_div desliga o boost)
+ * @param on_change Chamado depois de cada troca do clk_sys (ex: reprogramar o PWM)
+ */
+void clock_scaling_init(uint8_t idle_div, uint8_t boost_div, clock_scaling_changed_fn on_change);
+
+/**
+ * Pede velocidade máxima até o clock_scaling_release() correspondente
+ */
+void clock_scaling_boost(void);
+void clock_scaling_release(void);
+
+void clock_scaling_get_stats(clock_scaling_stats_t *stats);
+
+#endif // CLOCK_SCALING_H
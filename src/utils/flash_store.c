@@ -0,0 +1,156 @@
+#include "flash_store.h"
+#include "logger.h"
+#include "pico/time.h"
+#include "pico/flash.h"
+#include <string.h>
+
+#define TAG "Flash"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint16_t len;
+    uint16_t reserved;
+    uint32_t crc;                       // CRC-32 de seq, len e dados
+} flash_record_header_t;
+
+_Static_assert(sizeof(flash_record_header_t) == FLASH_STORE_HEADER_SIZE, "cabeçalho do registro");
+
+// Operação passada para flash_safe_execute (roda com o outro núcleo parado)
+typedef struct {
+    uint32_t offset;                    // Página a programar
+    bool erase;                         // Apaga o setor dela antes
+    const uint8_t *page;
+} flash_store_op_t;
+
+static const uint8_t *slot_ptr(uint16_t slot) {
+    return (const uint8_t *)(XIP_BASE + FLASH_STORE_OFFSET + (uint32_t)slot * FLASH_PAGE_SIZE);
+}
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1u));
+        }
+    }
+    return crc;
+}
+
+static uint32_t record_crc(const flash_record_header_t *hdr, const uint8_t *data) {
+    uint32_t crc = 0xFFFFFFFFu;
+    crc = crc32_update(crc, (const uint8_t *)&hdr->seq, sizeof(hdr->seq));
+    crc = crc32_update(crc, (const uint8_t *)&hdr->len, sizeof(hdr->len));
+    crc = crc32_update(crc, data, hdr->len);
+    return ~crc;
+}
+
+static bool slot_valid(uint16_t slot, flash_record_header_t *hdr) {
+    const uint8_t *p = slot_ptr(slot);
+    memcpy(hdr, p, sizeof(*hdr));
+    return hdr->magic == FLASH_STORE_MAGIC && hdr->len <= FLASH_STORE_MAX_DATA &&
+           hdr->crc == record_crc(hdr, p + FLASH_STORE_HEADER_SIZE);
+}
+
+static bool slot_blank(uint16_t slot) {
+    const uint8_t *p = slot_ptr(slot);
+    for (uint32_t i = 0; i < FLASH_PAGE_SIZE; i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void flash_store_init(flash_store_t *fs) {
+    memset(&fs->stats, 0, sizeof(fs->stats));
+    fs->latest = -1;
+    fs->seq = 0;
+    for (uint16_t slot = 0; slot < FLASH_STORE_SLOTS; slot++) {
+        flash_record_header_t hdr;
+        if (slot_valid(slot, &hdr) && (fs->latest < 0 || (int32_t)(hdr.seq - fs->seq) > 0)) {
+            fs->latest = (int16_t)slot;
+            fs->seq = hdr.seq;
+        }
+    }
+    fs->next = fs->latest < 0 ? 0 : (uint16_t)((fs->latest + 1) % FLASH_STORE_SLOTS);
+    if (fs->latest < 0) {
+        LOGI(TAG, "No record at 0x%06X", (unsigned)FLASH_STORE_OFFSET);
+    } else {
+        LOGI(TAG, "Record #%u at slot %d", (unsigned)fs->seq, fs->latest);
+    }
+}
+
+bool flash_store_load(const flash_store_t *fs, void *data, uint16_t len) {
+    flash_record_header_t hdr;
+    if (fs->latest < 0 || !slot_valid((uint16_t)fs->latest, &hdr) || hdr.len != len) {
+        return false;
+    }
+    memcpy(data, slot_ptr((uint16_t)fs->latest) + FLASH_STORE_HEADER_SIZE, len);
+    return true;
+}
+
+static void flash_store_op(void *param) {
+    const flash_store_op_t *op = param;
+    if (op->erase) {
+        uint32_t sector = op->offset - op->offset % FLASH_SECTOR_SIZE;
+        flash_range_erase(sector, FLASH_SECTOR_SIZE);
+    }
+    flash_range_program(op->offset, op->page, FLASH_PAGE_SIZE);
+}
+
+bool flash_store_save(flash_store_t *fs, const void *data, uint16_t len) {
+    if (len > FLASH_STORE_MAX_DATA) {
+        return false;
+    }
+
+    // Próxima página livre; restos de uma gravação interrompida são pulados
+    // até o começo do outro setor, que é apagado
+    uint16_t slot = fs->next;
+    uint16_t slots_per_sector = FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE;
+    while (slot % slots_per_sector != 0 && !slot_blank(slot)) {
+        slot = (uint16_t)((slot + 1) % FLASH_STORE_SLOTS);
+    }
+    bool erase = slot % slots_per_sector == 0;
+
+    static uint8_t page[FLASH_PAGE_SIZE];
+    memset(page, 0xFF, sizeof(page));
+    flash_record_header_t hdr = {
+        .magic = FLASH_STORE_MAGIC,
+        .seq = fs->seq + 1,
+        .len = len,
+        .reserved = 0xFFFF,
+    };
+    hdr.crc = record_crc(&hdr, data);
+    memcpy(page, &hdr, sizeof(hdr));
+    memcpy(page + FLASH_STORE_HEADER_SIZE, data, len);
+
+    flash_store_op_t op = {
+        .offset = FLASH_STORE_OFFSET + (uint32_t)slot * FLASH_PAGE_SIZE,
+        .erase = erase,
+        .page = page,
+    };
+    uint32_t start = time_us_32();
+    int rc = flash_safe_execute(flash_store_op, &op, FLASH_STORE_TIMEOUT_MS);
+    uint32_t elapsed = time_us_32() - start;
+    if (elapsed > fs->stats.max_us) {
+        fs->stats.max_us = elapsed;
+    }
+    if (rc != PICO_OK || memcmp(slot_ptr(slot), page, FLASH_PAGE_SIZE) != 0) {
+        fs->stats.failures++;
+        fs->next = (uint16_t)((slot + 1) % FLASH_STORE_SLOTS);
+        LOGE(TAG, "Write to slot %d failed (rc %d)", slot, rc);
+        return false;
+    }
+
+    fs->stats.writes++;
+    if (erase) {
+        fs->stats.erases++;
+    }
+    fs->latest = (int16_t)slot;
+    fs->seq = hdr.seq;
+    fs->next = (uint16_t)((slot + 1) % FLASH_STORE_SLOTS);
+    LOGD(TAG, "Record #%u at slot %d (%lu us%s)", (unsigned)fs->seq, slot,
+         (unsigned long)elapsed, erase ? ", erased" : "");
+    return true;
+}
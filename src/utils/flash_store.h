@@ -0,0 +1,66 @@
+#ifndef FLASH_STORE_H
+#define FLASH_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/flash.h"
+
+/**
+ * Registro pequeno persistente no fim do flash (checkpoint)
+ *
+ * Os dois últimos setores do flash guardam uma sequência de registros de uma
+ * página (cabeçalho com número de sequência e CRC-32 + dados). Cada gravação
+ * vai para a próxima página livre; o setor só é apagado quando a gravação
+ * chega ao começo dele, com o registro mais novo a salvo no outro setor.
+ * Assim uma queda de energia no meio da gravação perde no máximo aquele
+ * registro (CRC inválido) e o anterior continua valendo, e cada setor leva
+ * um apagamento a cada FLASH_STORE_SLOTS / 2 gravações.
+ *
+ * Apagar e programar param o XIP: a operação roda em flash_safe_execute(),
+ * que segura o outro núcleo na RAM e mascara as interrupções do que grava
+ * (~50 ms com apagamento, até 400 ms no pior caso do W25Q16JV; ~1 ms só
+ * programando). Não chamar de dentro do caminho de controle; o efeito no
+ * supervisor de segurança está em SAFETY_HEARTBEAT_TIMEOUT_MS.
+ */
+
+#define FLASH_STORE_SECTORS 2
+#define FLASH_STORE_SIZE (FLASH_STORE_SECTORS * FLASH_SECTOR_SIZE)
+#define FLASH_STORE_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_STORE_SIZE)
+#define FLASH_STORE_SLOTS (FLASH_STORE_SIZE / FLASH_PAGE_SIZE)
+#define FLASH_STORE_HEADER_SIZE 16
+#define FLASH_STORE_MAX_DATA (FLASH_PAGE_SIZE - FLASH_STORE_HEADER_SIZE)
+#define FLASH_STORE_MAGIC 0x44525931u       // "DRY1"
+#define FLASH_STORE_TIMEOUT_MS 100          // Espera pelo outro núcleo parar
+
+typedef struct {
+    uint32_t writes;
+    uint32_t erases;
+    uint32_t failures;                  // Gravações que não conferiram ou sem o outro núcleo
+    uint32_t max_us;                    // Gravação mais longa (com apagamento)
+} flash_store_stats_t;
+
+typedef struct {
+    int16_t latest;                     // Página do registro mais novo (-1 = nenhum)
+    uint16_t next;                      // Página da próxima gravação
+    uint32_t seq;                       // Sequência do registro mais novo
+    flash_store_stats_t stats;
+} flash_store_t;
+
+/**
+ * Procura o registro válido mais novo nos setores
+ */
+void flash_store_init(flash_store_t *fs);
+
+/**
+ * Copia o registro mais novo
+ * @return false sem registro ou com tamanho diferente de len
+ */
+bool flash_store_load(const flash_store_t *fs, void *data, uint16_t len);
+
+/**
+ * Grava um registro novo (len <= FLASH_STORE_MAX_DATA)
+ * @return true se gravou e conferiu
+ */
+bool flash_store_save(flash_store_t *fs, const void *data, uint16_t len);
+
+#endif // FLASH_STORE_H
@@ -0,0 +1,189 @@
+#include "scheduler.h"
+#include "logger.h"
+#include "pico/time.h"
+#include "hardware/sync.h"
+
+#define TAG "Sched"
+
+void scheduler_init(scheduler_t *sched) {
+    sched->task_count = 0;
+    sched->idle_us = 0;
+    sched->wakeups = 0;
+    sched->start_us = time_us_64();
+}
+
+int scheduler_add_task(scheduler_t *sched, const char *name, scheduler_task_fn fn, void *ctx,
+                       uint32_t period_ms, uint32_t deadline_ms, uint8_t priority) {
+    if (sched->task_count >= SCHEDULER_MAX_TASKS) {
+        LOGE(TAG, "Task table full, '%s' not added", name);
+        return -1;
+    }
+
+    scheduler_task_t *task = &sched->tasks[sched->task_count];
+    task->name = name;
+    task->fn = fn;
+    task->ctx = ctx;
+    task->period_us = period_ms * 1000u;
+    task->deadline_us = (deadline_ms ? deadline_ms : period_ms) * 1000u;
+    task->priority = priority;
+    task->next_release_us = time_us_64();
+    task->notified = false;
+    task->notify_us = 0;
+    task->alarm_armed = false;
+    task->alarm_us = 0;
+
+    task->runs = 0;
+    task->overruns = 0;
+    task->max_jitter_us = 0;
+    task->jitter_sum_us = 0;
+    task->max_exec_us = 0;
+    task->exec_sum_us = 0;
+    task->max_response_us = 0;
+
+    LOGD(TAG, "Task '%s': period %lums, deadline %lums, priority %d",
+         name, period_ms, deadline_ms ? deadline_ms : period_ms, priority);
+    return sched->task_count++;
+}
+
+void scheduler_notify(scheduler_t *sched, int task_id) {
+    if (task_id < 0 || task_id >= sched->task_count) {
+        return;
+    }
+    scheduler_task_t *task = &sched->tasks[task_id];
+    if (!task->notified) {
+        task->notify_us = time_us_64();
+        task->notified = true;
+    }
+    __sev(); // Tarefa do outro núcleo: acordá-lo do WFE
+}
+
+void scheduler_notify_in(scheduler_t *sched, int task_id, uint32_t delay_ms) {
+    if (task_id < 0 || task_id >= sched->task_count) {
+        return;
+    }
+    scheduler_task_t *task = &sched->tasks[task_id];
+    task->alarm_us = time_us_64() + (uint64_t)delay_ms * 1000u;
+    task->alarm_armed = true;
+}
+
+// Instante de liberação pendente mais antigo da tarefa; false se não está pronta
+static bool task_release(const scheduler_task_t *task, uint64_t now, uint64_t *release) {
+    bool ready = false;
+    uint64_t earliest = 0;
+
+    if (task->period_us && now >= task->next_release_us) {
+        earliest = task->next_release_us;
+        ready = true;
+    }
+    if (task->alarm_armed && now >= task->alarm_us && (!ready || task->alarm_us < earliest)) {
+        earliest = task->alarm_us;
+        ready = true;
+    }
+    if (task->notified && (!ready || task->notify_us < earliest)) {
+        earliest = task->notify_us;
+        ready = true;
+    }
+    *release = earliest;
+    return ready;
+}
+
+// Próximo instante em que a tarefa fica pronta sozinha (período ou alarme)
+static uint64_t task_next_wake(const scheduler_task_t *task, uint64_t next_wake) {
+    if (task->period_us && task->next_release_us < next_wake) {
+        next_wake = task->next_release_us;
+    }
+    if (task->alarm_armed && task->alarm_us < next_wake) {
+        next_wake = task->alarm_us;
+    }
+    return next_wake;
+}
+
+static void task_run(scheduler_task_t *task, uint64_t release, uint64_t start) {
+    task->notified = false;
+    if (task->alarm_armed && start >= task->alarm_us) {
+        task->alarm_armed = false;
+    }
+
+    // Próxima liberação periódica; liberações já vencidas contam como overrun
+    if (task->period_us && start >= task->next_release_us) {
+        task->next_release_us += task->period_us;
+        while (task->next_release_us <= start) {
+            task->next_release_us += task->period_us;
+            task->overruns++;
+        }
+    }
+
+    task->fn(task->ctx);
+    uint64_t end = time_us_64();
+
+    uint32_t jitter = (uint32_t)(start - release);
+    uint32_t exec = (uint32_t)(end - start);
+    uint32_t response = (uint32_t)(end - release);
+    task->runs++;
+    task->jitter_sum_us += jitter;
+    if (jitter > task->max_jitter_us) {
+        task->max_jitter_us = jitter;
+    }
+    task->exec_sum_us += exec;
+    if (exec > task->max_exec_us) {
+        task->max_exec_us = exec;
+    }
+    if (response > task->max_response_us) {
+        task->max_response_us = response;
+    }
+    if (task->deadline_us && response > task->deadline_us) {
+        task->overruns++;
+    }
+}
+
+void scheduler_dispatch(scheduler_t *sched) {
+    uint64_t now = time_us_64();
+    scheduler_task_t *best = NULL;
+    uint64_t best_release = 0;
+    uint64_t next_wake = UINT64_MAX;
+
+    for (uint8_t i = 0; i < sched->task_count; i++) {
+        scheduler_task_t *task = &sched->tasks[i];
+        uint64_t release;
+
+        if (!task_release(task, now, &release)) {
+            next_wake = task_next_wake(task, next_wake);
+            continue;
+        }
+        // Maior prioridade; empate vai para a liberação mais antiga
+        if (!best || task->priority > best->priority ||
+            (task->priority == best->priority && release < best_release)) {
+            best = task;
+            best_release = release;
+        }
+    }
+
+    if (best) {
+        task_run(best, best_release, now);
+        return;
+    }
+
+    // Nada pronto: WFE até a próxima liberação (alarme do timer) ou um evento
+    // (interrupção, SEV); na volta a tabela é reavaliada
+    best_effort_wfe_or_timeout(from_us_since_boot(next_wake));
+    sched->idle_us += time_us_64() - now;
+    sched->wakeups++;
+}
+
+void scheduler_log_stats(const scheduler_t *sched) {
+    uint64_t elapsed = time_us_64() - sched->start_us;
+    LOGI(TAG, "Idle %.1f%% of %lus, %.1f wakeups/s",
+         elapsed ? 100.0 * (double)sched->idle_us / (double)elapsed : 0.0,
+         (uint32_t)(elapsed / 1000000u),
+         elapsed ? (double)sched->wakeups * 1e6 / (double)elapsed : 0.0);
+
+    for (uint8_t i = 0; i < sched->task_count; i++) {
+        const scheduler_task_t *task = &sched->tasks[i];
+        LOGI(TAG, "  %-8s runs %lu, overruns %lu, jitter avg %luus max %luus, exec avg %luus max %luus, "
+             "response max %luus",
+             task->name, task->runs, task->overruns,
+             task->runs ? (uint32_t)(task->jitter_sum_us / task->runs) : 0u,
+             task->max_jitter_us, task->runs ? (uint32_t)(task->exec_sum_us / task->runs) : 0u,
+             task->max_exec_us, task->max_response_us);
+    }
+}
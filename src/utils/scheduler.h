@@ -0,0 +1,119 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Escalonador cooperativo de tarefas
+ *
+ * Cada tarefa tem período, prazo (deadline) e prioridade próprios. O loop
+ * principal chama scheduler_dispatch() sem parar: ela executa a tarefa
+ * pronta de maior prioridade (uma por chamada, até o fim, sem preempção)
+ * ou, sem nenhuma pronta, dorme em WFE até a próxima liberação
+ * (best_effort_wfe_or_timeout: alarme do timer) ou até um evento antes
+ * disso: interrupção de timer ou GPIO do núcleo, ou SEV do outro núcleo.
+ * Não há mais espera máxima: sem nada agendado o núcleo só acorda por
+ * interrupção.
+ *
+ * Uma tarefa fica pronta quando chega o seu instante de liberação
+ * (período), quando alguém chama scheduler_notify() (evento, ex: leitura
+ * nova do sensor, borda do botão) ou quando vence o alarme pedido com
+ * scheduler_notify_in() (ex: próxima troca do LED). Tarefas só de evento
+ * usam período 0; as que calculam o próprio próximo instante se
+ * reagendam com scheduler_notify_in() em vez de acordar por polling.
+ *
+ * Estatísticas por tarefa:
+ * - jitter: atraso do início em relação à liberação (us)
+ * - overrun: término depois de liberação + prazo, ou liberações perdidas
+ *   porque a tarefa ainda não tinha rodado quando chegou a seguinte
+ * - resposta: da liberação até o fim da execução (latência de pior caso)
+ *
+ * Cada núcleo roda o seu próprio escalonador. scheduler_notify() pode
+ * liberar uma tarefa do outro núcleo: o SEV acorda o outro núcleo do WFE.
+ *
+ * Para acompanhar o consumo em espera: fração do tempo ociosa e despertares
+ * do WFE por segundo (cada um custa entrada e saída de interrupção e uma
+ * volta no escalonador, mesmo quando nada fica pronto).
+ */
+
+#define SCHEDULER_MAX_TASKS 12
+
+// Prioridades sugeridas (maior valor = mais urgente)
+#define SCHEDULER_PRIORITY_LOW 0
+#define SCHEDULER_PRIORITY_NORMAL 1
+#define SCHEDULER_PRIORITY_HIGH 2
+#define SCHEDULER_PRIORITY_CRITICAL 3
+
+typedef void (*scheduler_task_fn)(void *ctx);
+
+typedef struct {
+    const char *name;
+    scheduler_task_fn fn;
+    void *ctx;
+    uint32_t period_us;                 // 0 = só por evento
+    uint32_t deadline_us;               // Prazo a partir da liberação
+    uint8_t priority;
+
+    uint64_t next_release_us;           // Próxima liberação periódica
+    volatile bool notified;             // Evento pendente (scheduler_notify)
+    volatile uint64_t notify_us;        // Instante do evento pendente
+    bool alarm_armed;                   // Liberação única pedida (scheduler_notify_in)
+    uint64_t alarm_us;
+
+    // Estatísticas
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t max_jitter_us;
+    uint64_t jitter_sum_us;
+    uint32_t max_exec_us;
+    uint64_t exec_sum_us;               // Para o tempo médio por execução
+    uint32_t max_response_us;           // Maior tempo da liberação até o fim da execução
+} scheduler_task_t;
+
+typedef struct {
+    scheduler_task_t tasks[SCHEDULER_MAX_TASKS];
+    uint8_t task_count;
+    uint64_t idle_us;                   // Tempo total dormindo entre tarefas
+    uint32_t wakeups;                   // Saídas do WFE
+    uint64_t start_us;
+} scheduler_t;
+
+void scheduler_init(scheduler_t *sched);
+
+/**
+ * Registra uma tarefa. A primeira liberação é imediata (ou no primeiro
+ * evento, se period_ms = 0).
+ *
+ * @param period_ms Período (ms); 0 = executa só com scheduler_notify()
+ * @param deadline_ms Prazo após a liberação (ms); 0 = igual ao período
+ * @param priority Prioridade (SCHEDULER_PRIORITY_*), maior = mais urgente
+ * @return Identificador da tarefa ou -1 se a tabela está cheia
+ */
+int scheduler_add_task(scheduler_t *sched, const char *name, scheduler_task_fn fn, void *ctx,
+                       uint32_t period_ms, uint32_t deadline_ms, uint8_t priority);
+
+/**
+ * Libera a tarefa agora, fora do período (evento). Seguro em interrupção.
+ */
+void scheduler_notify(scheduler_t *sched, int task_id);
+
+/**
+ * Libera a tarefa uma vez daqui a delay_ms (alarme). Substitui um alarme
+ * anterior ainda não vencido. Chamar no núcleo do escalonador.
+ */
+void scheduler_notify_in(scheduler_t *sched, int task_id, uint32_t delay_ms);
+
+/**
+ * Executa a tarefa pronta de maior prioridade ou dorme (WFE) até a próxima
+ * liberação ou um evento. Chamar em loop infinito.
+ */
+void scheduler_dispatch(scheduler_t *sched);
+
+/**
+ * Registra no log execuções, overruns, jitter e tempo de execução de cada
+ * tarefa, a fração de tempo ociosa e os despertares por segundo
+ */
+void scheduler_log_stats(const scheduler_t *sched);
+
+#endif // SCHEDULER_H
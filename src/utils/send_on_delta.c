@@ -0,0 +1,63 @@
+#include "send_on_delta.h"
+#include "logger.h"
+#include <math.h>
+
+#define TAG "Event"
+
+void send_on_delta_init(send_on_delta_t *trig, const char *name, uint32_t max_interval_ms) {
+    trig->name = name;
+    trig->max_interval_ms = max_interval_ms;
+    trig->input_count = 0;
+    trig->last_fire_ms = 0;
+    trig->pending = true;
+    trig->fired = 0;
+    trig->skipped = 0;
+    trig->fired_by_timeout = 0;
+}
+
+int send_on_delta_add_input(send_on_delta_t *trig, float delta) {
+    if (trig->input_count >= SEND_ON_DELTA_MAX_INPUTS) {
+        LOGE(TAG, "'%s': too many inputs", trig->name);
+        return -1;
+    }
+    trig->delta[trig->input_count] = delta;
+    trig->last[trig->input_count] = 0.0f;
+    return trig->input_count++;
+}
+
+bool send_on_delta_check(send_on_delta_t *trig, const float *values, uint32_t now_ms) {
+    bool fire = trig->pending;
+
+    for (uint8_t i = 0; i < trig->input_count && !fire; i++) {
+        if (fabsf(values[i] - trig->last[i]) >= trig->delta[i]) {
+            fire = true;
+        }
+    }
+    if (!fire && trig->max_interval_ms && now_ms - trig->last_fire_ms >= trig->max_interval_ms) {
+        fire = true;
+        trig->fired_by_timeout++;
+    }
+
+    if (!fire) {
+        trig->skipped++;
+        return false;
+    }
+    for (uint8_t i = 0; i < trig->input_count; i++) {
+        trig->last[i] = values[i];
+    }
+    trig->last_fire_ms = now_ms;
+    trig->pending = false;
+    trig->fired++;
+    return true;
+}
+
+void send_on_delta_force(send_on_delta_t *trig) {
+    trig->pending = true;
+}
+
+void send_on_delta_log_stats(const send_on_delta_t *trig) {
+    uint32_t total = trig->fired + trig->skipped;
+    LOGI(TAG, "  %-8s ran %lu of %lu cycles (%lu by max interval), skipped %.1f%%",
+         trig->name, trig->fired, total, trig->fired_by_timeout,
+         total ? 100.0f * (float)trig->skipped / (float)total : 0.0f);
+}
@@ -0,0 +1,72 @@
+#ifndef SEND_ON_DELTA_H
+#define SEND_ON_DELTA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Disparo por evento (send-on-delta)
+ *
+ * Decide se um ciclo periódico (controle, display, log) precisa rodar:
+ * roda quando alguma entrada se afastou pelo menos o seu delta do valor
+ * no último disparo, quando passou o intervalo máximo sem disparo ou
+ * depois de send_on_delta_force(). Nos outros ciclos a tarefa volta sem
+ * fazer nada e só o contador de ciclos pulados anda.
+ *
+ * Uso:
+ *   send_on_delta_init(&trig, "ui", 30000);
+ *   send_on_delta_add_input(&trig, 0.2f);          // temperatura
+ *   send_on_delta_add_input(&trig, 1.0f);          // umidade
+ *   ...
+ *   float inputs[] = { temp, rh };
+ *   if (!send_on_delta_check(&trig, inputs, now_ms)) return;
+ */
+
+#define SEND_ON_DELTA_MAX_INPUTS 8
+
+typedef struct {
+    const char *name;
+    uint32_t max_interval_ms;           // Disparo forçado depois deste tempo
+    uint8_t input_count;
+    float delta[SEND_ON_DELTA_MAX_INPUTS];
+    float last[SEND_ON_DELTA_MAX_INPUTS]; // Valores no último disparo
+    uint32_t last_fire_ms;
+    bool pending;                       // Próxima verificação dispara (início ou force)
+
+    // Estatísticas
+    uint32_t fired;
+    uint32_t skipped;
+    uint32_t fired_by_timeout;          // Disparos só pelo intervalo máximo
+} send_on_delta_t;
+
+/**
+ * Inicializa sem entradas; a primeira verificação sempre dispara
+ * @param max_interval_ms Intervalo máximo sem disparo (0 = sem limite)
+ */
+void send_on_delta_init(send_on_delta_t *trig, const char *name, uint32_t max_interval_ms);
+
+/**
+ * Registra uma entrada na ordem em que vem no vetor de send_on_delta_check()
+ * @param delta Variação mínima que dispara (mesma unidade da entrada)
+ * @return Índice da entrada ou -1 se a tabela está cheia
+ */
+int send_on_delta_add_input(send_on_delta_t *trig, float delta);
+
+/**
+ * Verifica as entradas atuais; no disparo guarda os valores e o instante
+ * @param values Uma posição por entrada registrada
+ * @return true se o ciclo deve rodar
+ */
+bool send_on_delta_check(send_on_delta_t *trig, const float *values, uint32_t now_ms);
+
+/**
+ * Faz a próxima verificação disparar (mudança que as entradas não mostram)
+ */
+void send_on_delta_force(send_on_delta_t *trig);
+
+/**
+ * Registra no log disparos e ciclos pulados
+ */
+void send_on_delta_log_stats(const send_on_delta_t *trig);
+
+#endif // SEND_ON_DELTA_H
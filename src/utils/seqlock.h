@@ -0,0 +1,58 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include "hardware/sync.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Seqlock: um escritor, leitores em outro núcleo, sem bloqueio
+ *
+ * O escritor incrementa a sequência antes e depois de alterar os dados
+ * (ímpar = escrita em andamento) e nunca espera. O leitor copia os dados e
+ * confere se a sequência não mudou; se mudou, a cópia pode estar rasgada
+ * e ele tenta de novo.
+ *
+ * Uso:
+ *   seqlock_write_begin(&lock); dados = novo; seqlock_write_end(&lock);
+ *
+ *   uint32_t seq;
+ *   do {
+ *       seq = seqlock_read_begin(&lock);
+ *       copia = dados;
+ *   } while (seqlock_read_retry(&lock, seq));
+ */
+
+typedef struct {
+    volatile uint32_t sequence;
+} seqlock_t;
+
+static inline void seqlock_init(seqlock_t *lock) {
+    lock->sequence = 0;
+}
+
+static inline void seqlock_write_begin(seqlock_t *lock) {
+    lock->sequence++;
+    __dmb();
+}
+
+static inline void seqlock_write_end(seqlock_t *lock) {
+    __dmb();
+    lock->sequence++;
+}
+
+static inline uint32_t seqlock_read_begin(const seqlock_t *lock) {
+    uint32_t seq;
+    do {
+        seq = lock->sequence;
+    } while (seq & 1u);
+    __dmb();
+    return seq;
+}
+
+static inline bool seqlock_read_retry(const seqlock_t *lock, uint32_t seq) {
+    __dmb();
+    return lock->sequence != seq;
+}
+
+#endif // SEQLOCK_H